@@ -16,6 +16,13 @@
     # inverts the condition and ships _FORTIFY_SOURCE=0 in the release build.
     "fs_sanitize%": "<!(node -p \"process.env.FS_METADATA_SANITIZE ? 'on' : 'off'\")",
 
+    # Test-only fault injection (FS_METADATA_INJECT_PROBE_HANG_MS, see
+    # src/common/shutdown.cpp) is compiled in only when FS_METADATA_TEST_HOOKS
+    # is set at build time, or in Debug builds. Prebuilds never have it, so no
+    # environment variable can make a shipped binary stall its probes.
+    # "on"/"off" for the same reason as fs_sanitize.
+    "fs_test_hooks%": "<!(node -p \"process.env.FS_METADATA_TEST_HOOKS ? 'on' : 'off'\")",
+
     # Absolute path to node-addon-api's headers, for -isystem.
     #
     # node-addon-api is also in include_dirs (-I), but -Wformat=2 makes clang
@@ -33,7 +40,11 @@
     {
       "target_name": "fs_metadata",
       "sources": [
-        "src/binding.cpp"
+        "src/binding.cpp",
+        "src/common/cache_budget.cpp",
+        "src/common/dir_probe.cpp",
+        "src/common/shutdown.cpp",
+        "src/common/volume_snapshot.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -46,16 +57,39 @@
         "NAPI_CPP_EXCEPTIONS",
         "NAPI_VERSION=9"
       ],
+      "configurations": {
+        "Debug": {
+          "defines": ["FS_METADATA_TEST_HOOKS"]
+        }
+      },
       "conditions": [
+        [
+          "fs_test_hooks=='on'",
+          {
+            "defines": ["FS_METADATA_TEST_HOOKS"]
+          }
+        ],
         [
           "OS=='linux'",
           {
             "sources": [
               "src/linux/blkid_cache.cpp",
-              "src/linux/volume_metadata.cpp"
+              "src/linux/block_devices.cpp",
+              "src/linux/block_topology.cpp",
+              "src/linux/btrfs_subvolumes.cpp",
+              "src/linux/mountinfo.cpp",
+              "src/linux/quota_probe.cpp",
+              "src/linux/shared_volume_cache.cpp",
+              "src/linux/uevent_monitor.cpp",
+              "src/linux/volume_metadata.cpp",
+              "src/linux/volume_metadata_fd.cpp",
+              "src/linux/volume_probe.cpp"
             ],
             "libraries": [
-              "-lblkid"
+              "-lblkid",
+              # shm_open() is only in libc itself from glibc 2.34; Bullseye
+              # ships 2.31.
+              "-lrt"
             ],
             # OpenSSF Compiler Options Hardening Guide baseline.
             #
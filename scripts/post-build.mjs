@@ -15,12 +15,19 @@ const distDir = join(__dirname, "..", "dist");
 // resolved JavaScript (`index.mjs`) is ESM. That mismatch is the "Masquerading
 // as CJS" / FalseCJS problem reported by arethetypeswrong. A .d.cts pairs with
 // the CJS `.cjs` output; a .d.mts pairs with the ESM `.mjs` output.
+//
+// Every entry in package.json "exports" needs the pair.
+const entries = ["index", "hidden", "mount-points"];
+
 async function createDualTypes() {
   try {
-    await copyFile(join(distDir, "index.d.ts"), join(distDir, "index.d.cts"));
-    console.log("Created index.d.cts for CommonJS type safety");
-    await copyFile(join(distDir, "index.d.ts"), join(distDir, "index.d.mts"));
-    console.log("Created index.d.mts for ESM type safety");
+    for (const entry of entries) {
+      const dts = join(distDir, `${entry}.d.ts`);
+      await copyFile(dts, join(distDir, `${entry}.d.cts`));
+      console.log(`Created ${entry}.d.cts for CommonJS type safety`);
+      await copyFile(dts, join(distDir, `${entry}.d.mts`));
+      console.log(`Created ${entry}.d.mts for ESM type safety`);
+    }
   } catch (error) {
     console.error("Error creating dual declaration files:", error);
     process.exit(1);
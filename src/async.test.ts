@@ -1,6 +1,12 @@
 import { jest } from "@jest/globals";
 import { times } from "./array";
-import { delay, mapConcurrent, TimeoutError, withTimeout } from "./async";
+import {
+  createSlicer,
+  delay,
+  mapConcurrent,
+  TimeoutError,
+  withTimeout,
+} from "./async";
 import { itSkipAlpineARM64 } from "./test-utils/platform";
 import { DayMs, HourMs } from "./units";
 
@@ -538,4 +544,47 @@ describe("async", () => {
       });
     });
   });
+
+  describe("createSlicer()", () => {
+    // Busy-waits, so every item overruns a 1ms budget.
+    function spin(ms: number) {
+      const end = performance.now() + ms;
+      while (performance.now() < end) {
+        // spin
+      }
+    }
+
+    it("maps and filters in order", async () => {
+      const slicer = createSlicer(1);
+      const items = times(500, (i) => i);
+      expect(await slicer.map(items, (i) => i * 2)).toEqual(
+        items.map((i) => i * 2),
+      );
+      expect(await slicer.filter(items, (i) => i % 3 === 0)).toEqual(
+        items.filter((i) => i % 3 === 0),
+      );
+    });
+
+    it("yields to the event loop once a slice exceeds its budget", async () => {
+      let immediates = 0;
+      const tick = () => {
+        immediates++;
+        if (!done) setImmediate(tick);
+      };
+      let done = false;
+      setImmediate(tick);
+      await createSlicer(1).forEach(times(256, String), () => spin(0.05));
+      done = true;
+      // 256 items * 0.05ms, checked every 64 items: several slices.
+      expect(immediates).toBeGreaterThanOrEqual(2);
+    });
+
+    it("never yields with a budget of 0", async () => {
+      let ran = false;
+      setImmediate(() => (ran = true));
+      await createSlicer(0).forEach(times(256, String), () => spin(0.05));
+      await createSlicer(0).checkpoint();
+      expect(ran).toBe(false);
+    });
+  });
 });
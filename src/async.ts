@@ -170,3 +170,68 @@ export async function mapConcurrent<I, O>({
 
   return Promise.all(results);
 }
+
+/**
+ * Runs long synchronous loops in slices of at most `budgetMs` of event-loop
+ * time, yielding to pending timers and I/O between slices. One slicer is
+ * shared by every loop in a call, so back-to-back loops can't each spend a
+ * full budget without yielding.
+ */
+export interface Slicer {
+  forEach<T>(items: readonly T[], fn: (item: T) => void): Promise<void>;
+  map<T, U>(items: readonly T[], fn: (item: T) => U): Promise<U[]>;
+  filter<T>(items: readonly T[], fn: (item: T) => boolean): Promise<T[]>;
+  /**
+   * Yields if the current slice has used its budget. Use around steps that
+   * can't be split, like a sort.
+   */
+  checkpoint(): Promise<void>;
+}
+
+// performance.now() is cheap, but not free: only look at the clock every
+// this-many items.
+const SliceCheckInterval = 64;
+
+/**
+ * @param budgetMs Maximum event-loop time per slice. 0 disables yielding.
+ */
+export function createSlicer(budgetMs: number): Slicer {
+  let sliceStart = performance.now();
+
+  async function checkpoint(): Promise<void> {
+    if (budgetMs > 0 && performance.now() - sliceStart >= budgetMs) {
+      await new Promise<void>((resolve) => setImmediate(resolve));
+      sliceStart = performance.now();
+    }
+  }
+
+  async function forEach<T>(
+    items: readonly T[],
+    fn: (item: T) => void,
+  ): Promise<void> {
+    for (let i = 0; i < items.length; i++) {
+      fn(items[i] as T);
+      if (i % SliceCheckInterval === SliceCheckInterval - 1) {
+        await checkpoint();
+      }
+    }
+  }
+
+  return {
+    forEach,
+    async map(items, fn) {
+      const result = new Array(items.length);
+      let i = 0;
+      await forEach(items, (ea) => (result[i++] = fn(ea)));
+      return result;
+    },
+    async filter(items, fn) {
+      const result: (typeof items)[number][] = [];
+      await forEach(items, (ea) => {
+        if (fn(ea)) result.push(ea);
+      });
+      return result;
+    },
+    checkpoint,
+  };
+}
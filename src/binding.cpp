@@ -2,8 +2,11 @@
 #include <napi.h>
 #include <string>
 
+#include "common/cache_budget.h"
 #include "common/debug_log.h"
+#include "common/dir_probe.h"
 #include "common/shutdown.h"
+#include "common/volume_snapshot.h"
 #if defined(_WIN32)
 #include "windows/fs_meta.h"
 #include "windows/hidden.h"
@@ -13,6 +16,7 @@
 #include "darwin/hidden.h"
 #elif defined(__linux__)
 #include "common/volume_metadata.h"
+#include "linux/fs_meta.h"
 #endif
 
 namespace {
@@ -51,6 +55,106 @@ Napi::Value GetVolumeMetadata(const Napi::CallbackInfo &info) {
   return FSMeta::GetVolumeMetadata(info);
 }
 
+Napi::Value DecodeVolumeSnapshot(const Napi::CallbackInfo &info) {
+  return FSMeta::DecodeVolumeSnapshot(info);
+}
+
+Napi::Value CanReaddir(const Napi::CallbackInfo &info) {
+  return FSMeta::CanReaddir(info);
+}
+
+Napi::Value GetNativeCacheStats(const Napi::CallbackInfo &info) {
+  return FSMeta::GetNativeCacheStats(info);
+}
+
+Napi::Value SetNativeCacheBudget(const Napi::CallbackInfo &info) {
+  return FSMeta::SetNativeCacheBudget(info);
+}
+
+#if defined(__linux__)
+Napi::Value GetVolumeMetadataSync(const Napi::CallbackInfo &info) {
+  return FSMeta::GetVolumeMetadataSync(info);
+}
+
+Napi::Value GetVolumeMetadataForFd(const Napi::CallbackInfo &info) {
+  return FSMeta::GetVolumeMetadataForFd(info);
+}
+
+Napi::Value OpenVolumeProbe(const Napi::CallbackInfo &info) {
+  return FSMeta::OpenVolumeProbe(info);
+}
+
+Napi::Value RefreshVolumeProbe(const Napi::CallbackInfo &info) {
+  return FSMeta::RefreshVolumeProbe(info);
+}
+
+Napi::Value GetVolumeProbeTrend(const Napi::CallbackInfo &info) {
+  return FSMeta::GetVolumeProbeTrend(info);
+}
+
+Napi::Value CloseVolumeProbe(const Napi::CallbackInfo &info) {
+  return FSMeta::CloseVolumeProbe(info);
+}
+
+Napi::Value GetBtrfsSubvolumes(const Napi::CallbackInfo &info) {
+  return FSMeta::GetBtrfsSubvolumes(info);
+}
+
+Napi::Value StartUeventMonitor(const Napi::CallbackInfo &info) {
+  return FSMeta::StartUeventMonitor(info);
+}
+
+Napi::Value ClassifyBlockDevices(const Napi::CallbackInfo &info) {
+  return FSMeta::ClassifyBlockDevices(info);
+}
+
+Napi::Value GetBlockDeviceIdentities(const Napi::CallbackInfo &info) {
+  return FSMeta::GetBlockDeviceIdentities(info);
+}
+
+Napi::Value StopUeventMonitor(const Napi::CallbackInfo &info) {
+  return FSMeta::StopUeventMonitor(info);
+}
+
+#if defined(FS_METADATA_TEST_HOOKS)
+Napi::Value ParseMountInfoForTest(const Napi::CallbackInfo &info) {
+  return FSMeta::ParseMountInfoForTest(info);
+}
+
+Napi::Value ClassifySysfsBlockDeviceForTest(const Napi::CallbackInfo &info) {
+  return FSMeta::ClassifySysfsBlockDeviceForTest(info);
+}
+#endif
+
+Napi::Value OpenSharedVolumeCache(const Napi::CallbackInfo &info) {
+  return FSMeta::OpenSharedVolumeCache(info);
+}
+
+Napi::Value ReadSharedVolumeCache(const Napi::CallbackInfo &info) {
+  return FSMeta::ReadSharedVolumeCache(info);
+}
+
+Napi::Value TryAcquireSharedVolumeCacheLease(const Napi::CallbackInfo &info) {
+  return FSMeta::TryAcquireSharedVolumeCacheLease(info);
+}
+
+Napi::Value ReleaseSharedVolumeCacheLease(const Napi::CallbackInfo &info) {
+  return FSMeta::ReleaseSharedVolumeCacheLease(info);
+}
+
+Napi::Value PublishSharedVolumeCache(const Napi::CallbackInfo &info) {
+  return FSMeta::PublishSharedVolumeCache(info);
+}
+
+Napi::Value CloseSharedVolumeCache(const Napi::CallbackInfo &info) {
+  return FSMeta::CloseSharedVolumeCache(info);
+}
+
+Napi::Value UnlinkSharedVolumeCache(const Napi::CallbackInfo &info) {
+  return FSMeta::UnlinkSharedVolumeCache(info);
+}
+#endif
+
 #if defined(__APPLE__)
 Napi::Value GetMountPointForPath(const Napi::CallbackInfo &info) {
   return FSMeta::GetMountPoint(info);
@@ -74,6 +178,9 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
 
   exports.Set("setDebugLogging", Napi::Function::New(env, SetDebugLogging));
   exports.Set("setDebugPrefix", Napi::Function::New(env, SetDebugPrefix));
+#if defined(FS_METADATA_TEST_HOOKS)
+  exports.Set("testHooks", Napi::Boolean::New(env, true));
+#endif
 
 #if defined(_WIN32) || defined(__APPLE__)
   exports.Set("getVolumeMountPoints",
@@ -81,6 +188,55 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
 #endif
 
   exports.Set("getVolumeMetadata", Napi::Function::New(env, GetVolumeMetadata));
+  exports.Set("decodeVolumeSnapshot",
+              Napi::Function::New(env, DecodeVolumeSnapshot));
+  exports.Set("canReaddir", Napi::Function::New(env, CanReaddir));
+  exports.Set("getNativeCacheStats",
+              Napi::Function::New(env, GetNativeCacheStats));
+  exports.Set("setNativeCacheBudget",
+              Napi::Function::New(env, SetNativeCacheBudget));
+
+#if defined(__linux__)
+  exports.Set("getVolumeMetadataSync",
+              Napi::Function::New(env, GetVolumeMetadataSync));
+  exports.Set("getVolumeMetadataForFd",
+              Napi::Function::New(env, GetVolumeMetadataForFd));
+  exports.Set("openVolumeProbe", Napi::Function::New(env, OpenVolumeProbe));
+  exports.Set("refreshVolumeProbe",
+              Napi::Function::New(env, RefreshVolumeProbe));
+  exports.Set("getVolumeProbeTrend",
+              Napi::Function::New(env, GetVolumeProbeTrend));
+  exports.Set("closeVolumeProbe", Napi::Function::New(env, CloseVolumeProbe));
+  exports.Set("getBtrfsSubvolumes",
+              Napi::Function::New(env, GetBtrfsSubvolumes));
+  exports.Set("startUeventMonitor",
+              Napi::Function::New(env, StartUeventMonitor));
+  exports.Set("stopUeventMonitor", Napi::Function::New(env, StopUeventMonitor));
+  exports.Set("classifyBlockDevices",
+              Napi::Function::New(env, ClassifyBlockDevices));
+  exports.Set("getBlockDeviceIdentities",
+              Napi::Function::New(env, GetBlockDeviceIdentities));
+  exports.Set("openSharedVolumeCache",
+              Napi::Function::New(env, OpenSharedVolumeCache));
+  exports.Set("readSharedVolumeCache",
+              Napi::Function::New(env, ReadSharedVolumeCache));
+  exports.Set("tryAcquireSharedVolumeCacheLease",
+              Napi::Function::New(env, TryAcquireSharedVolumeCacheLease));
+  exports.Set("releaseSharedVolumeCacheLease",
+              Napi::Function::New(env, ReleaseSharedVolumeCacheLease));
+  exports.Set("publishSharedVolumeCache",
+              Napi::Function::New(env, PublishSharedVolumeCache));
+  exports.Set("closeSharedVolumeCache",
+              Napi::Function::New(env, CloseSharedVolumeCache));
+  exports.Set("unlinkSharedVolumeCache",
+              Napi::Function::New(env, UnlinkSharedVolumeCache));
+#if defined(FS_METADATA_TEST_HOOKS)
+  exports.Set("parseMountInfoForTest",
+              Napi::Function::New(env, ParseMountInfoForTest));
+  exports.Set("classifySysfsBlockDeviceForTest",
+              Napi::Function::New(env, ClassifySysfsBlockDeviceForTest));
+#endif
+#endif
 
 #if defined(__APPLE__)
   exports.Set("getMountPoint", Napi::Function::New(env, GetMountPointForPath));
@@ -0,0 +1,214 @@
+// src/block_device_filter.test.ts
+//
+// With blockDeviceFilter, enumeration must classify devices natively from
+// the mount table and touch only the matching volumes.
+//
+// Uses a fake mount table and a mock classifier. Non-matching mount points
+// don't exist: had they been health-checked they'd be in the results as
+// inaccessible, and had they been probed, `probed` would name them.
+
+import { mkdir, mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import {
+  matchesBlockDeviceFilter,
+  validateBlockDeviceFilter,
+} from "./linux/block_devices";
+import { optionsWithDefaults } from "./options";
+import { describePlatform } from "./test-utils/platform";
+import type {
+  BlockDeviceClass,
+  BlockDeviceFilter,
+} from "./types/block_device";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindings,
+} from "./types/native_bindings";
+import { getAllVolumeMetadataImpl } from "./volume_metadata";
+import { getVolumeMountPointsImpl } from "./volume_mount_points";
+
+describe("matchesBlockDeviceFilter()", () => {
+  const usbStick: BlockDeviceClass = {
+    major: 8,
+    minor: 17,
+    removable: false,
+    transport: "usb",
+  };
+  const cardReader: BlockDeviceClass = {
+    major: 8,
+    minor: 33,
+    removable: true,
+    transport: "scsi",
+  };
+  const nvme: BlockDeviceClass = {
+    major: 259,
+    minor: 1,
+    removable: false,
+    transport: "nvme",
+  };
+
+  it("matches removable devices or listed transports", () => {
+    const filter: BlockDeviceFilter = { removable: true, transports: ["usb"] };
+    expect(matchesBlockDeviceFilter(usbStick, filter)).toBe(true);
+    expect(matchesBlockDeviceFilter(cardReader, filter)).toBe(true);
+    expect(matchesBlockDeviceFilter(nvme, filter)).toBe(false);
+  });
+
+  it("matches only listed transports without removable", () => {
+    const filter: BlockDeviceFilter = { transports: ["mmc", "usb"] };
+    expect(matchesBlockDeviceFilter(usbStick, filter)).toBe(true);
+    expect(matchesBlockDeviceFilter(cardReader, filter)).toBe(false);
+    expect(
+      matchesBlockDeviceFilter({ ...usbStick, transport: undefined }, filter),
+    ).toBe(false);
+  });
+
+  it("matches every block device with an empty filter", () => {
+    expect(matchesBlockDeviceFilter(nvme, {})).toBe(true);
+    expect(matchesBlockDeviceFilter(nvme, { removable: false })).toBe(true);
+  });
+
+  it("never matches a volume without a block device", () => {
+    expect(matchesBlockDeviceFilter(null, {})).toBe(false);
+    expect(matchesBlockDeviceFilter(undefined, { removable: true })).toBe(
+      false,
+    );
+  });
+});
+
+describe("validateBlockDeviceFilter()", () => {
+  it.each([null, "usb", ["usb"], { removable: 1 }, { transports: "usb" }])(
+    "rejects %o",
+    (filter) => {
+      expect(() => validateBlockDeviceFilter(filter)).toThrow(TypeError);
+    },
+  );
+
+  it("accepts a valid filter", () => {
+    const filter = { removable: true, transports: ["usb", "mmc"] };
+    expect(validateBlockDeviceFilter(filter)).toBe(filter);
+  });
+});
+
+describePlatform("linux")("blockDeviceFilter (Linux)", () => {
+  let dir: string;
+  let mtabPath: string;
+  let camera: string;
+  let sdCard: string;
+
+  const classified: string[][] = [];
+  const probed: string[] = [];
+  const classes: Record<string, BlockDeviceClass> = {
+    "/dev/sdb1": { major: 8, minor: 17, removable: false, transport: "usb" },
+    "/dev/mmcblk0p1": {
+      major: 179,
+      minor: 1,
+      removable: false,
+      transport: "mmc",
+    },
+    "/dev/nvme0n1p2": {
+      major: 259,
+      minor: 2,
+      removable: false,
+      transport: "nvme",
+    },
+  };
+  const mockNativeFn = () =>
+    ({
+      classifyBlockDevices: async (devices: string[]) => {
+        classified.push(devices);
+        return devices.map((ea) => classes[ea] ?? null);
+      },
+      getVolumeMetadata: async (o: GetVolumeMetadataOptions) => {
+        probed.push(o.mountPoint);
+        return { size: 100, used: 50, available: 50 };
+      },
+    }) as unknown as NativeBindings;
+
+  const opts = (blockDeviceFilter?: BlockDeviceFilter) =>
+    optionsWithDefaults({
+      linuxMountTablePaths: [mtabPath],
+      includeSystemVolumes: true,
+      blockDeviceFilter,
+    });
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-blockdev-"));
+    mtabPath = join(dir, "mtab");
+    camera = join(dir, "camera");
+    sdCard = join(dir, "sdcard");
+    await mkdir(camera);
+    await mkdir(sdCard);
+    await writeFile(
+      mtabPath,
+      [
+        `/dev/nvme0n1p2 ${dir}/root ext4 rw 0 0`,
+        `/dev/sdb1 ${camera} vfat rw 0 0`,
+        `/dev/mmcblk0p1 ${sdCard} exfat rw 0 0`,
+        // The same device, bind-mounted elsewhere:
+        `/dev/sdb1 ${dir}/camera-bind vfat rw 0 0`,
+        `nas:/photos ${dir}/nas nfs4 rw 0 0`,
+        `tmpfs ${dir}/tmp tmpfs rw 0 0`,
+      ].join("\n") + "\n",
+    );
+  });
+
+  beforeEach(() => {
+    classified.length = 0;
+    probed.length = 0;
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  it("classifies each /dev device once", async () => {
+    await getVolumeMountPointsImpl(opts({ removable: true }), mockNativeFn);
+    expect(classified).toEqual([
+      ["/dev/nvme0n1p2", "/dev/sdb1", "/dev/mmcblk0p1"],
+    ]);
+  });
+
+  it("lists and health-checks only matching volumes", async () => {
+    const mps = await getVolumeMountPointsImpl(
+      opts({ transports: ["mmc"] }),
+      mockNativeFn,
+    );
+    expect(mps.map((ea) => [ea.mountPoint, ea.status])).toEqual([
+      [sdCard, "healthy"],
+    ]);
+  });
+
+  it("may match nothing", async () => {
+    const mps = await getVolumeMountPointsImpl(
+      opts({ transports: ["firewire"] }),
+      mockNativeFn,
+    );
+    expect(mps).toEqual([]);
+  });
+
+  it("probes only matching volumes", async () => {
+    const results = await getAllVolumeMetadataImpl(
+      opts({ transports: ["usb", "mmc"] }),
+      mockNativeFn,
+    );
+    expect(probed.sort()).toEqual([camera, sdCard].sort());
+    expect(results.map((ea) => ea.mountPoint).sort()).toContain(camera);
+    expect(results.some((ea) => ea.mountPoint.endsWith("/nas"))).toBe(false);
+  });
+
+  it("leaves enumeration alone without a filter", async () => {
+    const mps = await getVolumeMountPointsImpl(opts(), mockNativeFn);
+    expect(classified).toEqual([]);
+    expect(mps.length).toBeGreaterThan(3);
+  });
+
+  it("rejects an invalid filter", async () => {
+    await expect(
+      getVolumeMountPointsImpl(
+        opts({ transports: "usb" } as unknown as BlockDeviceFilter),
+        mockNativeFn,
+      ),
+    ).rejects.toThrow(TypeError);
+  });
+});
@@ -0,0 +1,251 @@
+// src/cache_manager.test.ts
+
+import { open } from "node:fs/promises";
+import {
+  CacheMaxBytesDefault,
+  CacheMaxFdsDefault,
+  createManagedCache,
+  getCacheBudget,
+  getCacheStatsImpl,
+  getJsCacheStats,
+  setCacheBudgetImpl,
+  setJsCacheBudget,
+} from "./cache_manager";
+import { compileGlob } from "./glob";
+import {
+  getCacheStats,
+  getVolumeMetadataForFd,
+  setCacheBudget,
+} from "./index";
+import { describePlatform } from "./test-utils/platform";
+import type { CacheBudget } from "./types/cache";
+import type { NativeBindings } from "./types/native_bindings";
+
+// Every entry costs this much plus its own cost.
+const Overhead = 96;
+
+let seq = 0;
+function newCache(maxEntries?: number) {
+  const name = `test${++seq}`;
+  const cache = createManagedCache<string, string>(name, {
+    cost: (_key, value) => value.length,
+    maxEntries,
+  });
+  const stats = () => getJsCacheStats().find((ea) => ea.name === name);
+  return { name, cache, stats };
+}
+
+describe("createManagedCache()", () => {
+  afterEach(() => {
+    setJsCacheBudget({
+      maxBytes: CacheMaxBytesDefault,
+      maxFds: CacheMaxFdsDefault,
+    });
+  });
+
+  it("counts hits, misses and bytes", () => {
+    const { name, cache, stats } = newCache();
+    cache.set("a", "x".repeat(100));
+    expect(cache.get("a")).toBe("x".repeat(100));
+    expect(cache.get("b")).toBeUndefined();
+    expect(stats()).toEqual({
+      name,
+      native: false,
+      entries: 1,
+      bytes: Overhead + 100,
+      fds: 0,
+      hits: 1,
+      misses: 1,
+      evictions: 0,
+    });
+  });
+
+  it("rejects duplicate names", () => {
+    const { name } = newCache();
+    expect(() => createManagedCache(name, { cost: () => 0 })).toThrow(
+      /already exists/,
+    );
+  });
+
+  it("evicts the least recently used entry across caches", () => {
+    const first = newCache();
+    const second = newCache();
+    setJsCacheBudget({ maxBytes: 3 * (Overhead + 10) });
+    first.cache.set("a", "x".repeat(10));
+    second.cache.set("b", "x".repeat(10));
+    first.cache.set("c", "x".repeat(10));
+    first.cache.get("a"); // "b" is now the oldest
+    second.cache.set("d", "x".repeat(10));
+    expect(first.cache.get("a")).toBeDefined();
+    expect(first.cache.get("c")).toBeDefined();
+    expect(second.cache.get("b")).toBeUndefined();
+    expect(second.cache.get("d")).toBeDefined();
+    expect(second.stats()?.evictions).toBe(1);
+  });
+
+  it("keeps the newest entry even if it alone exceeds the budget", () => {
+    const { cache, stats } = newCache();
+    setJsCacheBudget({ maxBytes: 10 });
+    cache.set("a", "small");
+    cache.set("b", "x".repeat(1000));
+    expect(cache.size).toBe(1);
+    expect(cache.get("b")).toBeDefined();
+    expect(stats()?.evictions).toBe(1);
+  });
+
+  it("evicts immediately when the budget shrinks", () => {
+    const { cache, stats } = newCache();
+    for (let i = 0; i < 5; i++) cache.set(String(i), "x");
+    setJsCacheBudget({ maxBytes: 2 * (Overhead + 1) });
+    expect(cache.size).toBeLessThanOrEqual(2);
+    expect(cache.get("4")).toBe("x");
+    expect(stats()?.bytes).toBe(cache.size * (Overhead + 1));
+  });
+
+  it("bounds a cache by maxEntries, by recency", () => {
+    const { cache } = newCache(2);
+    cache.set("a", "1");
+    cache.set("b", "2");
+    cache.get("a");
+    cache.set("c", "3");
+    expect([cache.get("a"), cache.get("b"), cache.get("c")]).toEqual([
+      "1",
+      undefined,
+      "3",
+    ]);
+  });
+
+  it("releases bytes on delete, overwrite and clear", () => {
+    const { cache, stats } = newCache();
+    cache.set("a", "x".repeat(50));
+    cache.set("a", "x".repeat(10));
+    expect(stats()?.bytes).toBe(Overhead + 10);
+    expect(cache.delete("a")).toBe(true);
+    expect(cache.delete("a")).toBe(false);
+    cache.set("b", "y");
+    cache.clear();
+    expect(stats()).toMatchObject({ entries: 0, bytes: 0 });
+  });
+
+  it.each([
+    null,
+    { maxBytes: -1 },
+    { maxBytes: 1.5 },
+    { maxFds: "8" },
+    { maxBytes: Number.MAX_VALUE },
+  ])("rejects budget %o", (budget) => {
+    const before = getCacheBudget();
+    expect(() =>
+      setJsCacheBudget(budget as unknown as Partial<CacheBudget>),
+    ).toThrow(TypeError);
+    expect(getCacheBudget()).toEqual(before);
+  });
+
+  it("bounds compileGlob()", () => {
+    for (let i = 0; i < 300; i++) compileGlob([`bounded${i}.txt`]);
+    const glob = getJsCacheStats().find((ea) => ea.name === "compileGlob");
+    expect(glob?.entries).toBeLessThanOrEqual(256);
+    expect(glob?.evictions).toBeGreaterThan(0);
+  });
+});
+
+describe("getCacheStatsImpl()", () => {
+  it("merges native stats", async () => {
+    const nativeStats = {
+      name: "mountInfo",
+      entries: 40,
+      bytes: 12_000,
+      fds: 1,
+      hits: 9,
+      misses: 1,
+      evictions: 0,
+    };
+    const stats = await getCacheStatsImpl(
+      () =>
+        ({
+          getNativeCacheStats: () => [nativeStats],
+        }) as unknown as NativeBindings,
+    );
+    expect(stats).toContainEqual({ ...nativeStats, native: true });
+    expect(stats.some((ea) => ea.name === "compileGlob")).toBe(true);
+  });
+
+  it("tolerates bindings without native stats", async () => {
+    const stats = await getCacheStatsImpl(
+      () => ({}) as unknown as NativeBindings,
+    );
+    expect(stats.every((ea) => !ea.native)).toBe(true);
+  });
+});
+
+describe("setCacheBudgetImpl()", () => {
+  afterEach(() => {
+    setJsCacheBudget({
+      maxBytes: CacheMaxBytesDefault,
+      maxFds: CacheMaxFdsDefault,
+    });
+  });
+
+  it("applies the budget to both sides", async () => {
+    const forwarded: Partial<CacheBudget>[] = [];
+    await setCacheBudgetImpl(
+      { maxFds: 2 },
+      () =>
+        ({
+          setNativeCacheBudget: (b: Partial<CacheBudget>) => forwarded.push(b),
+        }) as unknown as NativeBindings,
+    );
+    expect(getCacheBudget()).toEqual({
+      maxBytes: CacheMaxBytesDefault,
+      maxFds: 2,
+    });
+    expect(forwarded).toEqual([{ maxFds: 2 }]);
+  });
+
+  it("rejects an invalid budget before touching native", async () => {
+    const forwarded: unknown[] = [];
+    await expect(
+      setCacheBudgetImpl(
+        { maxBytes: -5 },
+        () =>
+          ({
+            setNativeCacheBudget: (b: unknown) => forwarded.push(b),
+          }) as unknown as NativeBindings,
+      ),
+    ).rejects.toThrow(TypeError);
+    expect(forwarded).toEqual([]);
+  });
+});
+
+describePlatform("linux")("native cache budget", () => {
+  afterEach(async () => {
+    await setCacheBudget({
+      maxBytes: CacheMaxBytesDefault,
+      maxFds: CacheMaxFdsDefault,
+    });
+  });
+
+  async function mountInfo() {
+    const handle = await open(__filename, "r");
+    try {
+      await getVolumeMetadataForFd(handle.fd);
+    } finally {
+      await handle.close();
+    }
+    const stats = await getCacheStats();
+    return stats.find((ea) => ea.native && ea.name === "mountInfo");
+  }
+
+  it("closes held descriptors as soon as maxFds drops", async () => {
+    expect((await mountInfo())?.fds).toBe(1);
+    await setCacheBudget({ maxFds: 0 });
+    const stats = await getCacheStats();
+    const after = stats.find((ea) => ea.native && ea.name === "mountInfo");
+    expect(after).toMatchObject({ fds: 0, entries: 0, bytes: 0 });
+  });
+
+  it("keeps the mountinfo snapshot only if it fits by itself", async () => {
+    await setCacheBudget({ maxBytes: 1 });
+    expect(await mountInfo()).toMatchObject({ fds: 0, entries: 0, bytes: 0 });
+  });
+});
@@ -0,0 +1,235 @@
+// src/cache_manager.ts
+//
+// Every cache in this module registers here, so one budget bounds them all
+// and getCacheStats() can report on each. Native caches have their own
+// registry with the same budget (src/common/cache_budget.h).
+
+import { debug } from "./debuglog";
+import { isObject } from "./object";
+import type { CacheBudget, CacheStats } from "./types/cache";
+import type { NativeBindingsFn } from "./types/native_bindings";
+
+/**
+ * Default value for {@link CacheBudget.maxBytes}: 16 MiB.
+ */
+export const CacheMaxBytesDefault = 16 * 1024 * 1024;
+
+/**
+ * Default value for {@link CacheBudget.maxFds}.
+ */
+export const CacheMaxFdsDefault = 8;
+
+// Map entry, LRU set node and bookkeeping: a rough per-entry overhead.
+const EntryOverheadBytes = 96;
+
+export interface ManagedCache<K, V> {
+  get(key: K): V | undefined;
+  set(key: K, value: V): void;
+  delete(key: K): boolean;
+  clear(): void;
+  readonly size: number;
+}
+
+export interface ManagedCacheOptions<K, V> {
+  /** Estimated bytes held by one entry, beyond a fixed overhead. */
+  cost: (key: K, value: V) => number;
+  /** Evict this cache's least recently used entry beyond this many. */
+  maxEntries?: number;
+}
+
+interface Slot {
+  cache: CacheState;
+  key: unknown;
+  value: unknown;
+  bytes: number;
+}
+
+interface CacheState {
+  name: string;
+  slots: Map<unknown, Slot>;
+  bytes: number;
+  hits: number;
+  misses: number;
+  evictions: number;
+}
+
+const budget: CacheBudget = {
+  maxBytes: CacheMaxBytesDefault,
+  maxFds: CacheMaxFdsDefault,
+};
+const caches = new Map<string, CacheState>();
+// Every cache's slots, least recently used first.
+const lru = new Set<Slot>();
+let totalBytes = 0;
+
+function remove(slot: Slot): void {
+  lru.delete(slot);
+  slot.cache.slots.delete(slot.key);
+  slot.cache.bytes -= slot.bytes;
+  totalBytes -= slot.bytes;
+}
+
+function evictOverBudget(): void {
+  for (const slot of lru) {
+    // Always keep the newest entry, however large.
+    if (totalBytes <= budget.maxBytes || lru.size <= 1) return;
+    remove(slot);
+    slot.cache.evictions++;
+  }
+}
+
+/**
+ * Creates a cache bounded by the shared {@link CacheBudget}.
+ *
+ * @param name Unique; reported by {@link getCacheStats}
+ */
+export function createManagedCache<K, V>(
+  name: string,
+  options: ManagedCacheOptions<K, V>,
+): ManagedCache<K, V> {
+  if (caches.has(name)) {
+    throw new Error(`A cache named ${name} already exists`);
+  }
+  const state: CacheState = {
+    name,
+    slots: new Map(),
+    bytes: 0,
+    hits: 0,
+    misses: 0,
+    evictions: 0,
+  };
+  caches.set(name, state);
+  const { cost, maxEntries } = options;
+
+  return {
+    get(key) {
+      const slot = state.slots.get(key);
+      if (slot == null) {
+        state.misses++;
+        return;
+      }
+      state.hits++;
+      lru.delete(slot);
+      lru.add(slot);
+      return slot.value as V;
+    },
+
+    set(key, value) {
+      const prior = state.slots.get(key);
+      if (prior != null) remove(prior);
+      const slot: Slot = {
+        cache: state,
+        key,
+        value,
+        bytes: EntryOverheadBytes + Math.max(0, cost(key, value)),
+      };
+      state.slots.set(key, slot);
+      state.bytes += slot.bytes;
+      totalBytes += slot.bytes;
+      lru.add(slot);
+      if (maxEntries != null && state.slots.size > maxEntries) {
+        // Map iteration order is insertion order, not recency: find this
+        // cache's oldest slot in the shared LRU instead.
+        for (const ea of lru) {
+          if (ea.cache === state) {
+            remove(ea);
+            state.evictions++;
+            break;
+          }
+        }
+      }
+      evictOverBudget();
+    },
+
+    delete(key) {
+      const slot = state.slots.get(key);
+      if (slot == null) return false;
+      remove(slot);
+      return true;
+    },
+
+    clear() {
+      for (const slot of [...state.slots.values()]) remove(slot);
+    },
+
+    get size() {
+      return state.slots.size;
+    },
+  };
+}
+
+/**
+ * The current {@link CacheBudget}.
+ */
+export function getCacheBudget(): CacheBudget {
+  return { ...budget };
+}
+
+function validateBudget(value: unknown, field: keyof CacheBudget): void {
+  if (
+    value != null &&
+    !(typeof value === "number" && Number.isSafeInteger(value) && value >= 0)
+  ) {
+    throw new TypeError(`${field} must be a non-negative integer`);
+  }
+}
+
+/**
+ * Applies `partial` to the JavaScript caches' budget, evicting immediately if
+ * they're now over it.
+ *
+ * @throws {TypeError} unless `partial` is an object whose limits are
+ * non-negative integers
+ */
+export function setJsCacheBudget(partial: Partial<CacheBudget>): void {
+  if (!isObject(partial)) {
+    throw new TypeError("cache budget must be an object");
+  }
+  validateBudget(partial.maxBytes, "maxBytes");
+  validateBudget(partial.maxFds, "maxFds");
+  if (partial.maxBytes != null) budget.maxBytes = partial.maxBytes;
+  if (partial.maxFds != null) budget.maxFds = partial.maxFds;
+  debug("[setCacheBudget] %o", budget);
+  evictOverBudget();
+}
+
+export async function setCacheBudgetImpl(
+  partial: Partial<CacheBudget>,
+  nativeFn: NativeBindingsFn,
+): Promise<void> {
+  setJsCacheBudget(partial);
+  const native = await nativeFn();
+  const forwarded: Partial<CacheBudget> = {};
+  if (partial.maxBytes != null) forwarded.maxBytes = partial.maxBytes;
+  if (partial.maxFds != null) forwarded.maxFds = partial.maxFds;
+  native.setNativeCacheBudget?.(forwarded);
+}
+
+/**
+ * Stats for the JavaScript caches only.
+ */
+export function getJsCacheStats(): CacheStats[] {
+  return [...caches.values()].map((ea) => ({
+    name: ea.name,
+    native: false,
+    entries: ea.slots.size,
+    bytes: ea.bytes,
+    fds: 0,
+    hits: ea.hits,
+    misses: ea.misses,
+    evictions: ea.evictions,
+  }));
+}
+
+export async function getCacheStatsImpl(
+  nativeFn: NativeBindingsFn,
+): Promise<CacheStats[]> {
+  const native = await nativeFn();
+  return [
+    ...getJsCacheStats(),
+    ...(native.getNativeCacheStats?.() ?? []).map((ea) => ({
+      ...ea,
+      native: true,
+    })),
+  ];
+}
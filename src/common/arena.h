@@ -0,0 +1,108 @@
+// src/common/arena.h
+// Bump allocator for data built and freed together
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace FSMeta {
+
+/**
+ * Monotonic arena: allocations are carved out of a few large blocks and
+ * freed all at once when the arena is destroyed.
+ *
+ * For results that are built in one pass and then read until discarded,
+ * such as a parsed mount table, where per-field std::strings would mean
+ * thousands of small heap allocations per sweep.
+ *
+ * Usage:
+ *   Arena arena;
+ *   std::string_view name = arena.Copy(field); // valid while arena lives
+ *
+ * Not thread-safe while allocating. Once built, the views are immutable and
+ * may be read from any thread.
+ */
+class Arena {
+public:
+  explicit Arena(size_t blockSize = 4096) noexcept : blockSize_(blockSize) {}
+
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+  // The blocks move, so views stay valid. The source is left empty: its
+  // next allocation starts a block of its own.
+  Arena(Arena &&other) noexcept
+      : blockSize_(other.blockSize_), blocks_(std::move(other.blocks_)),
+        next_(std::exchange(other.next_, nullptr)),
+        remaining_(std::exchange(other.remaining_, 0)),
+        reserved_(std::exchange(other.reserved_, 0)) {
+    other.blocks_.clear();
+  }
+  Arena &operator=(Arena &&other) noexcept {
+    if (this != &other) {
+      blockSize_ = other.blockSize_;
+      blocks_ = std::move(other.blocks_);
+      other.blocks_.clear();
+      next_ = std::exchange(other.next_, nullptr);
+      remaining_ = std::exchange(other.remaining_, 0);
+      reserved_ = std::exchange(other.reserved_, 0);
+    }
+    return *this;
+  }
+
+  // `n` bytes with no alignment guarantee: for character data only.
+  char *Allocate(size_t n) {
+    if (n > remaining_) {
+      // Requests of a block or more get a block of their own, so one long
+      // field doesn't waste the rest of the current block.
+      const size_t size = std::max(n, blockSize_);
+      blocks_.push_back(std::make_unique<char[]>(size));
+      reserved_ += size;
+      if (n >= blockSize_) {
+        return blocks_.back().get();
+      }
+      next_ = blocks_.back().get();
+      remaining_ = size;
+    }
+    char *result = next_;
+    next_ += n;
+    remaining_ -= n;
+    return result;
+  }
+
+  std::string_view Copy(std::string_view s) {
+    if (s.empty()) {
+      return {};
+    }
+    char *dst = Allocate(s.size());
+    memcpy(dst, s.data(), s.size());
+    return {dst, s.size()};
+  }
+
+  // `a` + `separator` + `b` in one allocation.
+  std::string_view Join(std::string_view a, char separator,
+                        std::string_view b) {
+    char *dst = Allocate(a.size() + 1 + b.size());
+    memcpy(dst, a.data(), a.size());
+    dst[a.size()] = separator;
+    memcpy(dst + a.size() + 1, b.data(), b.size());
+    return {dst, a.size() + 1 + b.size()};
+  }
+
+  // Heap bytes held, for CacheBudget accounting.
+  size_t BytesReserved() const noexcept { return reserved_; }
+
+private:
+  size_t blockSize_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char *next_ = nullptr;
+  size_t remaining_ = 0;
+  size_t reserved_ = 0;
+};
+
+} // namespace FSMeta
@@ -0,0 +1,69 @@
+// src/common/cache_budget.cpp
+
+#include "cache_budget.h"
+#include "debug_log.h"
+#include <cmath> // for std::floor()
+
+namespace FSMeta {
+
+Napi::Value GetNativeCacheStats(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  const auto snapshot = CacheBudget::Snapshot();
+  auto result = Napi::Array::New(env, snapshot.size());
+  for (size_t i = 0; i < snapshot.size(); i++) {
+    const CacheStats &s = snapshot[i];
+    auto obj = Napi::Object::New(env);
+    obj.Set("name", Napi::String::New(env, s.name));
+    obj.Set("entries", Napi::Number::New(env, static_cast<double>(s.entries)));
+    obj.Set("bytes", Napi::Number::New(env, static_cast<double>(s.bytes)));
+    obj.Set("fds", Napi::Number::New(env, static_cast<double>(s.fds)));
+    obj.Set("hits", Napi::Number::New(env, static_cast<double>(s.hits)));
+    obj.Set("misses", Napi::Number::New(env, static_cast<double>(s.misses)));
+    obj.Set("evictions",
+            Napi::Number::New(env, static_cast<double>(s.evictions)));
+    result.Set(static_cast<uint32_t>(i), obj);
+  }
+  return result;
+}
+
+namespace {
+
+// Non-negative integers only; anything else is a caller bug worth a
+// TypeError rather than a silently wrapped size_t.
+size_t ParseLimit(const Napi::Object &obj, const char *name) {
+  const Napi::Value value = obj.Get(name);
+  const double n =
+      value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : -1;
+  if (!(n >= 0) || n != std::floor(n) || n > 9007199254740991.0) {
+    throw Napi::TypeError::New(obj.Env(), std::string(name) +
+                                              " must be a non-negative "
+                                              "integer");
+  }
+  return static_cast<size_t>(n);
+}
+
+} // namespace
+
+Napi::Value SetNativeCacheBudget(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "Expected a cache budget object");
+  }
+  auto obj = info[0].As<Napi::Object>();
+  // Validate both before applying either.
+  const bool hasBytes = obj.Has("maxBytes");
+  const bool hasFds = obj.Has("maxFds");
+  const size_t maxBytes = hasBytes ? ParseLimit(obj, "maxBytes") : 0;
+  const size_t maxFds = hasFds ? ParseLimit(obj, "maxFds") : 0;
+  if (hasBytes) {
+    CacheBudget::SetMaxBytes(maxBytes);
+  }
+  if (hasFds) {
+    CacheBudget::SetMaxFds(maxFds);
+  }
+  DEBUG_LOG("[CacheBudget] maxBytes=%zu maxFds=%zu", CacheBudget::MaxBytes(),
+            CacheBudget::MaxFds());
+  return env.Undefined();
+}
+
+} // namespace FSMeta
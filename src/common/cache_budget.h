@@ -0,0 +1,358 @@
+// src/common/cache_budget.h
+//
+// One memory and file-descriptor budget shared by every native cache, with
+// per-cache counters for getCacheStats() (see src/cache_manager.ts, which
+// does the same for the JavaScript caches).
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <napi.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace FSMeta {
+
+struct CacheStats {
+  const char *name = "";
+  uint64_t entries = 0;
+  uint64_t bytes = 0; // estimated, including container overhead
+  uint64_t fds = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+};
+
+// Lock-free counters a cache can bump while holding only its own lock.
+struct CacheCounters {
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+  std::atomic<uint64_t> evictions{0};
+};
+
+class CacheBudget {
+public:
+  static constexpr size_t kDefaultMaxBytes = 16 * 1024 * 1024;
+  static constexpr size_t kDefaultMaxFds = 8;
+
+  static size_t MaxBytes() { return MaxBytesRef().load(); }
+  static size_t MaxFds() { return MaxFdsRef().load(); }
+  // Lowering the limit evicts at once, like SetMaxFds().
+  static void SetMaxBytes(size_t n) {
+    MaxBytesRef().store(n);
+    EvictOverBudget();
+  }
+  // Lowering the limit closes held descriptors at once, through the caches'
+  // release callbacks, until the rest fit.
+  static void SetMaxFds(size_t n) {
+    MaxFdsRef().store(n);
+    if (!OverFds()) {
+      return;
+    }
+    std::vector<ReleaseFdsFn> fns;
+    {
+      std::lock_guard<std::mutex> lock(RegistryMutex());
+      fns = FdHolders();
+    }
+    for (auto fn : fns) {
+      if (!OverFds()) {
+        break;
+      }
+      fn();
+    }
+  }
+
+  // Bytes held by all native caches together. Each cache adds and subtracts
+  // its own entries' costs.
+  static void AddBytes(size_t n) { TotalBytesRef().fetch_add(n); }
+  static void SubtractBytes(size_t n) { TotalBytesRef().fetch_sub(n); }
+  static bool OverBytes() { return TotalBytesRef().load() > MaxBytes(); }
+
+  // One recency clock for every native cache, so entries can be compared
+  // across caches: each use stamps an entry with the next tick.
+  static uint64_t NextTick() { return ClockRef().fetch_add(1) + 1; }
+
+  // A cache CacheBudget may evict from on behalf of any other. Both calls
+  // come from whichever thread pushed the total over budget, so they only
+  // try_lock the cache: a busy cache is passed over.
+  class Evictable {
+  public:
+    static constexpr uint64_t kNoEntries = UINT64_MAX;
+    virtual ~Evictable() = default;
+    // Tick of the least recently used entry; kNoEntries if empty or busy.
+    virtual uint64_t OldestTick() = 0;
+    // Drops the least recently used entry; false if empty or busy.
+    virtual bool TryEvictOldest() = 0;
+  };
+
+  static bool RegisterEvictable(Evictable *cache) {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    Evictables().push_back(cache);
+    return true;
+  }
+  static void UnregisterEvictable(Evictable *cache) {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    auto &caches = Evictables();
+    for (auto it = caches.begin(); it != caches.end(); ++it) {
+      if (*it == cache) {
+        caches.erase(it);
+        return;
+      }
+    }
+  }
+
+  // Evicts the least recently used entry of all registered caches, one at a
+  // time, until the native caches fit the byte budget again. Caches call
+  // this after adding bytes, without holding the lock their Evictable takes.
+  static void EvictOverBudget() {
+    if (!OverBytes()) {
+      return;
+    }
+    std::vector<Evictable *> caches;
+    {
+      std::lock_guard<std::mutex> lock(RegistryMutex());
+      caches = Evictables();
+    }
+    while (OverBytes()) {
+      Evictable *victim = nullptr;
+      uint64_t oldest = Evictable::kNoEntries;
+      for (auto *cache : caches) {
+        const uint64_t tick = cache->OldestTick();
+        if (tick < oldest) {
+          oldest = tick;
+          victim = cache;
+        }
+      }
+      // Nothing left to evict, or a race with the victim's owner: the next
+      // insert tries again.
+      if (victim == nullptr || !victim->TryEvictOldest()) {
+        return;
+      }
+    }
+  }
+
+  // Reserves one descriptor a cache wants to keep open between calls.
+  // False if the budget is spent: the cache must close it after use.
+  static bool TryAcquireFd() {
+    auto &held = HeldFdsRef();
+    size_t n = held.load();
+    while (n < MaxFds()) {
+      if (held.compare_exchange_weak(n, n + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  static void ReleaseFd() { HeldFdsRef().fetch_sub(1); }
+  static bool OverFds() { return HeldFdsRef().load() > MaxFds(); }
+
+  // Caches that keep descriptors open also register a callback that closes
+  // them and releases their slots, for SetMaxFds().
+  using ReleaseFdsFn = void (*)();
+  static bool RegisterFdHolder(ReleaseFdsFn fn) {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    FdHolders().push_back(fn);
+    return true;
+  }
+
+  // Caches register a stats callback once, from a static initializer.
+  using StatsFn = CacheStats (*)();
+  static bool Register(StatsFn fn) {
+    std::lock_guard<std::mutex> lock(RegistryMutex());
+    Registry().push_back(fn);
+    return true;
+  }
+
+  static std::vector<CacheStats> Snapshot() {
+    std::vector<StatsFn> fns;
+    {
+      std::lock_guard<std::mutex> lock(RegistryMutex());
+      fns = Registry();
+    }
+    std::vector<CacheStats> result;
+    result.reserve(fns.size());
+    for (auto fn : fns) {
+      result.push_back(fn());
+    }
+    return result;
+  }
+
+private:
+  static std::atomic<size_t> &MaxBytesRef() {
+    static std::atomic<size_t> n{kDefaultMaxBytes};
+    return n;
+  }
+  static std::atomic<size_t> &MaxFdsRef() {
+    static std::atomic<size_t> n{kDefaultMaxFds};
+    return n;
+  }
+  static std::atomic<size_t> &TotalBytesRef() {
+    static std::atomic<size_t> n{0};
+    return n;
+  }
+  static std::atomic<size_t> &HeldFdsRef() {
+    static std::atomic<size_t> n{0};
+    return n;
+  }
+  static std::atomic<uint64_t> &ClockRef() {
+    static std::atomic<uint64_t> n{0};
+    return n;
+  }
+  static std::mutex &RegistryMutex() {
+    static std::mutex m;
+    return m;
+  }
+  static std::vector<StatsFn> &Registry() {
+    static std::vector<StatsFn> fns;
+    return fns;
+  }
+  static std::vector<ReleaseFdsFn> &FdHolders() {
+    static std::vector<ReleaseFdsFn> fns;
+    return fns;
+  }
+  static std::vector<Evictable *> &Evictables() {
+    static std::vector<Evictable *> caches;
+    return caches;
+  }
+};
+
+// Map with least-recently-used eviction against CacheBudget: once all native
+// caches together exceed the byte budget, Put() evicts the least recently
+// used entries of any registered cache, this one included, until they don't.
+// Thread-safe, since other caches' inserts evict from it; owners still lock
+// around state of their own, such as epochs.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LruCache : public CacheBudget::Evictable {
+public:
+  // `cost` estimates one entry's heap footprint beyond the per-node overhead.
+  explicit LruCache(size_t (*cost)(const V &)) : cost_(cost) {
+    CacheBudget::RegisterEvictable(this);
+  }
+  ~LruCache() override { CacheBudget::UnregisterEvictable(this); }
+
+  LruCache(const LruCache &) = delete;
+  LruCache &operator=(const LruCache &) = delete;
+
+  bool Get(const K &key, V &out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      counters_.misses++;
+      return false;
+    }
+    counters_.hits++;
+    order_.splice(order_.begin(), order_, it->second);
+    it->second->tick = CacheBudget::NextTick();
+    out = it->second->value;
+    return true;
+  }
+
+  void Put(const K &key, V value) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      EraseKey(key);
+      const size_t bytes = kNodeOverhead + cost_(value);
+      order_.push_front(
+          Node{key, std::move(value), bytes, CacheBudget::NextTick()});
+      index_[key] = order_.begin();
+      bytes_ += bytes;
+      CacheBudget::AddBytes(bytes);
+    }
+    CacheBudget::EvictOverBudget();
+  }
+
+  void Erase(const K &key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    EraseKey(key);
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CacheBudget::SubtractBytes(bytes_);
+    bytes_ = 0;
+    index_.clear();
+    order_.clear();
+  }
+
+  CacheStats Stats(const char *name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CacheStats stats;
+    stats.name = name;
+    stats.entries = order_.size();
+    stats.bytes = bytes_;
+    stats.hits = counters_.hits.load();
+    stats.misses = counters_.misses.load();
+    stats.evictions = counters_.evictions.load();
+    return stats;
+  }
+
+  // Misses that never reach Get() (the cache was inactive) still count.
+  void CountMiss() { counters_.misses++; }
+
+  uint64_t OldestTick() override {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || order_.empty()) {
+      return kNoEntries;
+    }
+    return order_.back().tick;
+  }
+
+  bool TryEvictOldest() override {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || order_.empty()) {
+      return false;
+    }
+    EraseNode(std::prev(order_.end()));
+    counters_.evictions++;
+    return true;
+  }
+
+private:
+  struct Node {
+    K key;
+    V value;
+    size_t bytes;
+    uint64_t tick; // CacheBudget::NextTick() at last use
+  };
+  using Iterator = typename std::list<Node>::iterator;
+
+  // List node, hash node and bucket: roughly what libstdc++ allocates.
+  static constexpr size_t kNodeOverhead =
+      sizeof(Node) + 2 * sizeof(void *) + sizeof(K) + 3 * sizeof(void *);
+
+  // Caller holds mutex_.
+  void EraseKey(const K &key) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+      EraseNode(it->second);
+    }
+  }
+
+  void EraseNode(Iterator it) {
+    bytes_ -= it->bytes;
+    CacheBudget::SubtractBytes(it->bytes);
+    index_.erase(it->key);
+    order_.erase(it);
+  }
+
+  size_t (*cost_)(const V &);
+  mutable std::mutex mutex_;
+  std::list<Node> order_; // most recently used first
+  std::unordered_map<K, Iterator, Hash> index_;
+  size_t bytes_ = 0;
+  CacheCounters counters_;
+};
+
+// getNativeCacheStats(): [{name, entries, bytes, fds, hits, misses,
+// evictions}] for every registered native cache.
+Napi::Value GetNativeCacheStats(const Napi::CallbackInfo &info);
+
+// setNativeCacheBudget({maxBytes?, maxFds?}). A lower limit takes effect at
+// once: held descriptors are closed, and entries evicted.
+Napi::Value SetNativeCacheBudget(const Napi::CallbackInfo &info);
+
+} // namespace FSMeta
@@ -0,0 +1,135 @@
+// src/common/capacity_history.h
+//
+// Fixed-size ring of recent space and inode samples for one watched volume,
+// with least-squares fill rates, so trend queries never need the history in
+// JavaScript.
+
+#pragma once
+#include "./volume_metadata.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace FSMeta {
+
+struct CapacityTrend {
+  size_t samples = 0;
+  double spanSeconds = 0.0; // oldest to newest sample
+  double used = 0.0;        // newest sample
+  double available = 0.0;
+  double bytesPerSecond = 0.0; // growth of `used`; negative while shrinking
+  double secondsToFull = -1.0; // < 0: not filling
+  bool hasInodes = false;      // false if the filesystem reports no f_files
+  double inodesFree = 0.0;
+  double inodesPerSecond = 0.0;
+  double secondsToInodesExhausted = -1.0;
+};
+
+class CapacityHistory {
+public:
+  static constexpr size_t kDefaultCapacity = 64;
+  static constexpr size_t kMaxCapacity = 4096;
+
+  explicit CapacityHistory(size_t capacity)
+      : samples_(std::clamp<size_t>(capacity, 2, kMaxCapacity)) {}
+
+  // Appends a sample from a successful space read, overwriting the oldest
+  // once the ring is full. Thread-safe: refreshes run on the worker pool.
+  void Record(const VolumeMetadata &metadata) {
+    Sample sample;
+    sample.seconds = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+    sample.used = metadata.used;
+    sample.available = metadata.available;
+    sample.hasInodes = metadata.inodes > 0;
+    sample.inodesUsed = metadata.inodes - metadata.inodesFree;
+    sample.inodesFree = metadata.inodesFree;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    samples_[next_] = sample;
+    next_ = (next_ + 1) % samples_.size();
+    count_ = std::min(count_ + 1, samples_.size());
+  }
+
+  CapacityTrend Trend() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CapacityTrend trend;
+    trend.samples = count_;
+    if (count_ == 0) {
+      return trend;
+    }
+    const Sample &newest = At(count_ - 1);
+    trend.spanSeconds = newest.seconds - At(0).seconds;
+    trend.used = newest.used;
+    trend.available = newest.available;
+    trend.bytesPerSecond =
+        Slope([](const Sample &s) { return s.used; }, false);
+    if (trend.bytesPerSecond > 0) {
+      trend.secondsToFull = newest.available / trend.bytesPerSecond;
+    }
+    trend.hasInodes = newest.hasInodes;
+    if (trend.hasInodes) {
+      trend.inodesFree = newest.inodesFree;
+      trend.inodesPerSecond =
+          Slope([](const Sample &s) { return s.inodesUsed; }, true);
+      if (trend.inodesPerSecond > 0) {
+        trend.secondsToInodesExhausted =
+            newest.inodesFree / trend.inodesPerSecond;
+      }
+    }
+    return trend;
+  }
+
+private:
+  struct Sample {
+    double seconds = 0.0; // steady clock
+    double used = 0.0;
+    double available = 0.0;
+    bool hasInodes = false;
+    double inodesUsed = 0.0;
+    double inodesFree = 0.0;
+  };
+
+  // i-th oldest sample. Caller holds mutex_.
+  const Sample &At(size_t i) const {
+    const size_t oldest = count_ < samples_.size() ? 0 : next_;
+    return samples_[(oldest + i) % samples_.size()];
+  }
+
+  // Least-squares slope of `value` over time, in units per second: robust to
+  // the jitter of any single sample, unlike (newest - oldest) / span.
+  template <typename Fn> double Slope(Fn value, bool inodesOnly) const {
+    double n = 0, meanT = 0, meanV = 0;
+    const double t0 = At(0).seconds;
+    for (size_t i = 0; i < count_; i++) {
+      const Sample &s = At(i);
+      if (inodesOnly && !s.hasInodes) {
+        continue;
+      }
+      n++;
+      meanT += (s.seconds - t0 - meanT) / n;
+      meanV += (value(s) - meanV) / n;
+    }
+    double covariance = 0, variance = 0;
+    for (size_t i = 0; i < count_; i++) {
+      const Sample &s = At(i);
+      if (inodesOnly && !s.hasInodes) {
+        continue;
+      }
+      const double dt = s.seconds - t0 - meanT;
+      covariance += dt * (value(s) - meanV);
+      variance += dt * dt;
+    }
+    return n >= 2 && variance > 0 ? covariance / variance : 0.0;
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<Sample> samples_;
+  size_t next_ = 0;
+  size_t count_ = 0;
+};
+
+} // namespace FSMeta
@@ -0,0 +1,188 @@
+// src/common/dir_probe.cpp
+
+#include "dir_probe.h"
+#include "debug_log.h"
+#include "error_utils.h"
+#include "shutdown.h"
+#include <string>
+
+#if defined(_WIN32)
+#include "../windows/security_utils.h"
+#else
+#include <cerrno>
+#include <dirent.h>
+#endif
+
+namespace FSMeta {
+
+namespace {
+
+#if defined(_WIN32)
+// The codes errorToDirectoryStatus() in src/volume_health_status.ts knows.
+const char *ErrorCode(DWORD error) {
+  switch (error) {
+  case ERROR_FILE_NOT_FOUND:
+  case ERROR_PATH_NOT_FOUND:
+    return "ENOENT";
+  case ERROR_DIRECTORY:
+    return "ENOTDIR";
+  case ERROR_ACCESS_DENIED:
+  case ERROR_LOGON_FAILURE:
+  case ERROR_SHARING_VIOLATION:
+    return "EACCES";
+  case ERROR_BAD_NET_NAME:
+  case ERROR_NETWORK_UNREACHABLE:
+  case ERROR_NOT_CONNECTED:
+  case ERROR_NETWORK_ACCESS_DENIED:
+  case ERROR_BAD_NETPATH:
+  case ERROR_NO_NET_OR_BAD_PATH:
+  case ERROR_NETNAME_DELETED:
+    return "ENOTCONN";
+  case ERROR_NOT_READY:
+    return "ENODEV";
+  default:
+    return "EIO";
+  }
+}
+#else
+// Enough for errorToDirectoryStatus(); anything else is reported as EIO.
+const char *ErrorCode(int error) {
+  switch (error) {
+  case ENOENT:
+    return "ENOENT";
+  case ENOTDIR:
+    return "ENOTDIR";
+  case EACCES:
+    return "EACCES";
+  case EPERM:
+    return "EPERM";
+  case ENOTCONN:
+    return "ENOTCONN";
+  case ESTALE:
+    return "ESTALE";
+  case EHOSTDOWN:
+    return "EHOSTDOWN";
+  case ENODEV:
+    return "ENODEV";
+  case ENXIO:
+    return "ENXIO";
+  case ELOOP:
+    return "ELOOP";
+  case ENAMETOOLONG:
+    return "ENAMETOOLONG";
+  case EMFILE:
+    return "EMFILE";
+  case ENFILE:
+    return "ENFILE";
+  case ENOMEM:
+    return "ENOMEM";
+  default:
+    return "EIO";
+  }
+}
+#endif
+
+class CanReaddirWorker : public SafeAsyncWorker {
+public:
+  CanReaddirWorker(const std::string &path,
+                   const Napi::Promise::Deferred &deferred)
+      : SafeAsyncWorker(deferred.Env()), path_(path), deferred_(deferred) {}
+
+  void Execute() override {
+    if (IsShuttingDown()) {
+      SetError("fs-metadata: shutdown in progress");
+      return;
+    }
+#if defined(_WIN32)
+    if (!SecurityUtils::IsPathSecure(path_)) {
+      Fail("canReaddir", ERROR_ACCESS_DENIED);
+      return;
+    }
+    std::wstring searchPath = SecurityUtils::SafeStringToWide(path_);
+    if (!searchPath.empty() && searchPath.back() != L'\\') {
+      searchPath += L'\\';
+    }
+    searchPath += L'*';
+    WIN32_FIND_DATAW findData;
+    FindHandleGuard findHandle(FindFirstFileExW(
+        searchPath.c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch,
+        nullptr, FIND_FIRST_EX_ON_DISK_ENTRIES_ONLY));
+    const DWORD error = findHandle ? ERROR_SUCCESS : GetLastError();
+    // An empty root has no match for the wildcard, but was still read.
+    if (error != ERROR_SUCCESS && error != ERROR_FILE_NOT_FOUND) {
+      Fail("FindFirstFileEx", error);
+    }
+#else
+    DIR *dir = opendir(path_.c_str());
+    if (dir == nullptr) {
+      Fail("opendir", errno);
+      return;
+    }
+    // opendir() alone can succeed from the dentry cache: only a read reaches
+    // the filesystem.
+    errno = 0;
+    const bool read = readdir(dir) != nullptr || errno == 0;
+    const int error = errno;
+    closedir(dir);
+    if (!read) {
+      Fail("readdir", error);
+    }
+#endif
+  }
+
+  void OnOK() override {
+    Napi::HandleScope scope(Env());
+    SafeResolve(deferred_, Napi::Boolean::New(Env(), true));
+  }
+
+  void OnError(const Napi::Error &error) override {
+    Napi::HandleScope scope(Env());
+    Napi::Object value = error.Value();
+    if (code_ != nullptr) {
+      value.Set("code", Napi::String::New(Env(), code_));
+    }
+    SafeReject(deferred_, value);
+  }
+
+private:
+#if defined(_WIN32)
+  void Fail(const char *operation, DWORD error) {
+    DEBUG_LOG("[CanReaddir] %s failed for %s: %lu", operation, path_.c_str(),
+              error);
+    code_ = ErrorCode(error);
+    SetError(std::string(code_) + ": " + operation + " failed for '" + path_ +
+             "' (" + std::to_string(error) + ")");
+  }
+#else
+  void Fail(const char *operation, int error) {
+    DEBUG_LOG("[CanReaddir] %s failed for %s: %d", operation, path_.c_str(),
+              error);
+    code_ = ErrorCode(error);
+    SetError(std::string(code_) + ": " +
+             CreatePathErrorMessage(operation, path_, error));
+  }
+#endif
+
+  std::string path_;
+  Napi::Promise::Deferred deferred_;
+  const char *code_ = nullptr;
+};
+
+} // namespace
+
+Napi::Value CanReaddir(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    throw Napi::TypeError::New(env, "String expected for path");
+  }
+  const std::string path = info[0].As<Napi::String>();
+  if (path.empty() || path.find('\0') != std::string::npos) {
+    throw Napi::TypeError::New(env, "Invalid path");
+  }
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto *worker = new CanReaddirWorker(path, deferred);
+  worker->Queue();
+  return deferred.Promise();
+}
+
+} // namespace FSMeta
@@ -0,0 +1,13 @@
+// src/common/dir_probe.h
+#pragma once
+#include <napi.h>
+
+namespace FSMeta {
+
+// canReaddir(path): opens `path` as a directory and reads its first entry on
+// the addon's own pool (see shutdown.h), so a read stuck on a dead mount holds
+// one of its threads rather than one of libuv's. Resolves true, or rejects
+// with an Error whose `code` is the errno name, as node:fs errors have.
+Napi::Value CanReaddir(const Napi::CallbackInfo &info);
+
+} // namespace FSMeta
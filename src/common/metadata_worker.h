@@ -3,6 +3,8 @@
 #include "./shutdown.h"
 #include "./volume_metadata.h"
 #include <napi.h>
+#include <string>
+#include <string_view>
 
 namespace FSMeta {
 
@@ -12,7 +14,7 @@ protected:
   VolumeMetadata metadata;
   Napi::Promise::Deferred deferred_;
 
-  MetadataWorkerBase(const std::string &path,
+  MetadataWorkerBase(std::string_view path,
                      const Napi::Promise::Deferred &deferred)
       : SafeAsyncWorker(deferred.Env()), mountPoint(path), deferred_(deferred) {
   }
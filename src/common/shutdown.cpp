@@ -0,0 +1,349 @@
+// src/common/shutdown.cpp
+//
+// The thread pool behind SafeAsyncWorker. See shutdown.h for why it isn't
+// libuv's.
+//
+// Threads are started on demand, up to a per-lane maximum, detached, and only
+// stopped at process exit: one stuck in a syscall on a dead mount is simply
+// left there, and no longer counts toward the maximum (see kStuckAfter). The
+// pool itself, and the addon's code, are pinned for the life of the process
+// for the same reason.
+//
+// Each WorkPriority has its own lane (queue and threads). Background threads
+// lower their own priority once, when they start: an unprivileged thread
+// can't raise it again, so they never run normal work.
+
+#include "shutdown.h"
+#include "debug_log.h"
+#include <algorithm> // for std::min()
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib> // for atexit(), getenv(), strtoul()
+#include <deque>
+#include <iterator> // for std::distance()
+#include <memory>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>        // for dladdr(), dlopen()
+#include <sys/resource.h> // for setpriority()
+#endif
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/syscall.h> // for SYS_gettid, SYS_ioprio_set
+#include <unistd.h>
+#endif
+
+namespace FSMeta {
+
+namespace {
+
+// libuv's default is 4, shared with all of Node's fs work. Probes that hang
+// on dead mounts each hold a thread until the kernel gives up, so allow a few
+// more before later work has to wait.
+constexpr size_t kMaxPoolThreads = 8;
+
+// Background sweeps trade latency for staying out of the way.
+constexpr size_t kMaxBackgroundThreads = 2;
+
+// A worker running longer than the default timeoutMs is presumed stuck on a
+// dead mount. Its thread stops counting toward its lane's maximum, so later
+// work gets a new thread instead of queueing behind it for good: otherwise
+// two hung mounts would stop every background probe. Each lane replaces at
+// most kMaxReplacedThreads stuck threads.
+constexpr std::chrono::seconds kStuckAfter{5};
+constexpr size_t kMaxReplacedThreads = 8;
+
+// How long process exit waits for running workers before static destructors
+// run under them. Healthy probes take milliseconds; stuck ones never finish.
+constexpr std::chrono::milliseconds kExitGrace{100};
+
+struct Lane {
+  std::condition_variable ready;
+  std::deque<SafeAsyncWorker *> queue;
+  std::multiset<std::chrono::steady_clock::time_point> busySince;
+  size_t threads = 0;
+  size_t idle = 0;
+};
+
+struct Pool {
+  std::mutex mutex;
+  Lane lanes[2]; // indexed by WorkPriority
+  std::condition_variable finished;
+  size_t threads = 0;
+  size_t running = 0;
+  bool exiting = false;
+};
+
+Lane &GetLane(Pool &pool, WorkPriority priority) {
+  return pool.lanes[static_cast<size_t>(priority)];
+}
+
+// Counts threads presumed stuck (see kStuckAfter) as extra room. Under
+// pool.mutex.
+size_t MaxThreads(const Lane &lane, WorkPriority priority) {
+  const auto cutoff = std::chrono::steady_clock::now() - kStuckAfter;
+  const auto stuck = static_cast<size_t>(std::distance(
+      lane.busySince.begin(), lane.busySince.lower_bound(cutoff)));
+  return (priority == WorkPriority::Background ? kMaxBackgroundThreads
+                                               : kMaxPoolThreads) +
+         std::min(stuck, kMaxReplacedThreads);
+}
+
+// Deliberately leaked: detached pool threads outlive static destruction.
+Pool &GetPool() {
+  static Pool *const pool = new Pool();
+  return *pool;
+}
+
+// Node unloads an addon with the last env that loaded it, which may be a
+// worker_thread's; the pool's threads run this library's code until the
+// process exits.
+void PinModule() {
+#if defined(_WIN32)
+  HMODULE module = nullptr;
+  if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                              GET_MODULE_HANDLE_EX_FLAG_PIN,
+                          reinterpret_cast<LPCWSTR>(&PinModule), &module)) {
+    DEBUG_LOG("[Pool] GetModuleHandleEx failed: %lu", GetLastError());
+  }
+#else
+  Dl_info info{};
+  if (dladdr(reinterpret_cast<void *>(&PinModule), &info) == 0 ||
+      info.dli_fname == nullptr ||
+      dlopen(info.dli_fname, RTLD_NOW | RTLD_NOLOAD | RTLD_NODELETE) ==
+          nullptr) {
+    DEBUG_LOG("[Pool] failed to pin the addon");
+  }
+#endif
+}
+
+#if defined(FS_METADATA_TEST_HOOKS)
+// Test-only fault injection: FS_METADATA_INJECT_PROBE_HANG_MS makes every
+// worker sleep that long before Execute(), as if its mount were hung. Read
+// once. Only in Debug and FS_METADATA_TEST_HOOKS builds (see binding.gyp), so
+// the environment can't stall a release build. See src/shutdown.test.ts.
+std::chrono::milliseconds InjectedHang() {
+  static const std::chrono::milliseconds hang = [] {
+    const char *value = getenv("FS_METADATA_INJECT_PROBE_HANG_MS");
+    return std::chrono::milliseconds(
+        value == nullptr ? 0 : strtoul(value, nullptr, 10));
+  }();
+  return hang;
+}
+#endif
+
+// Idle I/O class and +10 nice on Linux (both per thread there), background
+// QoS on macOS, background mode on Windows. Best effort: failures only lose
+// the hint.
+void LowerThreadPriority() {
+#if defined(__linux__)
+  // glibc has no ioprio_set() wrapper; values from linux/ioprio.h.
+  constexpr int kIoprioWhoProcess = 1;
+  constexpr int kIoprioClassIdle = 3;
+  constexpr int kIoprioClassShift = 13;
+  constexpr int kBackgroundNiceIncrement = 10;
+  const auto tid = static_cast<pid_t>(syscall(SYS_gettid));
+  if (syscall(SYS_ioprio_set, kIoprioWhoProcess, tid,
+              kIoprioClassIdle << kIoprioClassShift) != 0) {
+    DEBUG_LOG("[Pool] ioprio_set failed: %d", errno);
+  }
+  errno = 0;
+  const int nice = getpriority(PRIO_PROCESS, static_cast<id_t>(tid));
+  if (errno == 0 &&
+      setpriority(PRIO_PROCESS, static_cast<id_t>(tid),
+                  std::min(nice + kBackgroundNiceIncrement, 19)) != 0) {
+    DEBUG_LOG("[Pool] setpriority failed: %d", errno);
+  }
+#elif defined(__APPLE__)
+  // Throttles both CPU and I/O for this thread.
+  if (setpriority(PRIO_DARWIN_THREAD, 0, PRIO_DARWIN_BG) != 0) {
+    DEBUG_LOG("[Pool] setpriority(PRIO_DARWIN_BG) failed");
+  }
+#elif defined(_WIN32)
+  if (!SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN)) {
+    DEBUG_LOG("[Pool] SetThreadPriority failed: %lu", GetLastError());
+  }
+#endif
+}
+
+void DeliverCompletion(Napi::Env env, Napi::Function /*callback*/,
+                       SafeAsyncWorker *worker) {
+  worker->Complete(env);
+}
+
+void PostCompletion(SafeAsyncWorker *worker) {
+  // `worker` may be deleted on the JS thread as soon as the call is queued,
+  // and with it the last other reference to `state`.
+  const std::shared_ptr<ShutdownState> state = worker->State();
+  std::lock_guard<std::mutex> lock(state->mutex);
+  if (!state->completionsOpen ||
+      state->completions.NonBlockingCall(worker, DeliverCompletion) !=
+          napi_ok) {
+    // The env is gone: leak the worker rather than run its destructor (and
+    // its napi handles' destructors) off the JS thread.
+    DEBUG_LOG("[Pool] dropping a result for a torn-down env");
+  }
+}
+
+void PoolThread(WorkPriority priority) {
+  if (priority == WorkPriority::Background) {
+    LowerThreadPriority();
+  }
+  Pool &pool = GetPool();
+  Lane &lane = GetLane(pool, priority);
+  std::unique_lock<std::mutex> lock(pool.mutex);
+  for (;;) {
+    lane.idle++;
+    lane.ready.wait(
+        lock, [&pool, &lane] { return !lane.queue.empty() || pool.exiting; });
+    lane.idle--;
+    if (pool.exiting) {
+      return;
+    }
+    SafeAsyncWorker *worker = lane.queue.front();
+    lane.queue.pop_front();
+    pool.running++;
+    const auto busy = lane.busySince.insert(std::chrono::steady_clock::now());
+    lock.unlock();
+    worker->Run();
+    PostCompletion(worker);
+    lock.lock();
+    lane.busySince.erase(busy);
+    if (--pool.running == 0) {
+      pool.finished.notify_all();
+    }
+  }
+}
+
+// atexit(): stop starting work, and give running workers a moment to finish
+// before this library's statics are destroyed.
+void DrainOnExit() {
+  Pool &pool = GetPool();
+  std::unique_lock<std::mutex> lock(pool.mutex);
+  pool.exiting = true;
+  for (auto &lane : pool.lanes) {
+    lane.ready.notify_all();
+  }
+  if (!pool.finished.wait_for(lock, kExitGrace,
+                              [&pool] { return pool.running == 0; })) {
+    DEBUG_LOG("[Pool] exiting with %zu workers still running", pool.running);
+  }
+}
+
+} // namespace
+
+void SafeAsyncWorker::Queue(WorkPriority priority) {
+  Napi::Env env = Env();
+  ShutdownState &state = *shutdownState_;
+  if (!state.completionsOpen) {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    // Never released: the finalizer runs at env teardown.
+    state.completions = Napi::ThreadSafeFunction::New(
+        env, Napi::Function(), "fs-metadata worker", 0, 1,
+        [owner = shutdownState_](Napi::Env /*env*/) {
+          std::lock_guard<std::mutex> lock(owner->mutex);
+          owner->completionsOpen = false;
+        });
+    state.completions.Unref(env);
+    state.completionsOpen = true;
+  }
+
+  Pool &pool = GetPool();
+  Lane &lane = GetLane(pool, priority);
+  {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    // Each queued worker has claimed one idle thread's wakeup, even if that
+    // thread hasn't run yet: spawn unless an unclaimed idle thread remains,
+    // or a burst would wait on one thread while the lane has room for more.
+    if (lane.queue.size() >= lane.idle &&
+        lane.threads < MaxThreads(lane, priority)) {
+      try {
+        std::thread(PoolThread, priority).detach();
+        lane.threads++;
+        if (pool.threads++ == 0) {
+          PinModule();
+          std::atexit(DrainOnExit);
+        }
+      } catch (const std::system_error &e) {
+        DEBUG_LOG("[Pool] cannot start a thread: %s", e.what());
+        if (lane.threads == 0) {
+          delete this;
+          throw Napi::Error::New(env, std::string("fs-metadata: ") + e.what());
+        }
+      }
+    }
+    lane.queue.push_back(this);
+  }
+  lane.ready.notify_one();
+  // Pending work keeps the process alive, as libuv work did.
+  if (state.pending++ == 0) {
+    state.completions.Ref(env);
+  }
+}
+
+void SafeAsyncWorker::Run() {
+#if defined(FS_METADATA_TEST_HOOKS)
+  if (InjectedHang().count() > 0) {
+    std::this_thread::sleep_for(InjectedHang());
+  }
+#endif
+  try {
+    Execute();
+  } catch (const std::exception &e) {
+    SetError(e.what());
+  } catch (...) {
+    SetError("Unknown native error");
+  }
+}
+
+void SafeAsyncWorker::Complete(Napi::Env env) {
+  std::unique_ptr<SafeAsyncWorker> self(this);
+  ShutdownState &state = *shutdownState_;
+  if (--state.pending == 0) {
+    state.completions.Unref(env);
+  }
+  if (IsShuttingDown()) {
+    return;
+  }
+  try {
+    Napi::HandleScope scope(env);
+    if (hasError_) {
+      OnError(Napi::Error::New(env, error_));
+    } else {
+      OnOK();
+    }
+  } catch (...) { // NOLINT(bugprone-empty-catch)
+    // Deliberate: see SafeResolve in shutdown.h.
+  }
+}
+
+void CancelQueuedWork(const ShutdownState *state) {
+  Pool &pool = GetPool();
+  std::vector<SafeAsyncWorker *> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    for (auto &lane : pool.lanes) {
+      for (auto it = lane.queue.begin(); it != lane.queue.end();) {
+        if ((*it)->State().get() == state) {
+          cancelled.push_back(*it);
+          it = lane.queue.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+  }
+  DEBUG_LOG("[Pool] cancelled %zu queued workers", cancelled.size());
+  for (auto *worker : cancelled) {
+    delete worker;
+  }
+}
+
+} // namespace FSMeta
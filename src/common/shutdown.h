@@ -14,11 +14,19 @@
 // The flag is stored as napi instance data so worker threads (each their own
 // env) don't poison the main env's flag when they tear down.
 //
+// SafeAsyncWorker::Execute() runs on this module's own thread pool (see
+// shutdown.cpp) rather than libuv's. Node waits for every in-flight libuv
+// work request before tearing an env down (worker.terminate()), and joins
+// libuv's threads on process.exit(), so a single probe stuck on a dead mount
+// used to stall both. Now teardown drops work that hasn't started, and
+// abandons work that has: its result is discarded if it ever finishes.
+//
 
 #pragma once
 
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <napi.h>
 #include <string>
 
@@ -26,8 +34,46 @@ namespace FSMeta {
 
 struct ShutdownState {
   std::atomic<bool> shuttingDown{false};
+
+  // Finished workers go back to the env's JS thread through `completions`,
+  // created by the first SafeAsyncWorker::Queue(). Its finalizer clears
+  // `completionsOpen` at env teardown; pool threads check it, under `mutex`,
+  // before each call.
+  std::mutex mutex;
+  Napi::ThreadSafeFunction completions;
+  bool completionsOpen = false;
+  size_t pending = 0; // JS thread only: keeps the event loop alive while > 0
 };
 
+// Drops every SafeAsyncWorker of `state`'s env still waiting for a pool
+// thread. JS thread only. Defined in shutdown.cpp.
+void CancelQueuedWork(const ShutdownState *state);
+
+// Scheduling class of a SafeAsyncWorker. Background work runs on its own pool
+// threads, with idle I/O priority and a higher nice value, so sweeps don't
+// compete with the app's own disk I/O. Only those threads are
+// re-prioritized: libuv's are shared with the rest of Node.
+enum class WorkPriority { Normal, Background };
+
+// Reads the optional `priority` option: "normal" (the default) or
+// "background".
+inline WorkPriority WorkPriorityFromObject(const Napi::Object &obj) {
+  if (!obj.Has("priority") || obj.Get("priority").IsUndefined()) {
+    return WorkPriority::Normal;
+  }
+  Napi::Value value = obj.Get("priority");
+  const std::string priority =
+      value.IsString() ? value.As<Napi::String>().Utf8Value() : "";
+  if (priority == "normal") {
+    return WorkPriority::Normal;
+  }
+  if (priority == "background") {
+    return WorkPriority::Background;
+  }
+  throw Napi::TypeError::New(obj.Env(),
+                             "priority must be \"normal\" or \"background\"");
+}
+
 struct ModuleInstanceData {
   std::shared_ptr<ShutdownState> shutdownState =
       std::make_shared<ShutdownState>();
@@ -63,12 +109,13 @@ inline bool IsShuttingDown(const std::shared_ptr<ShutdownState> &state) {
 
 // Env cleanup hook: flips the shutdown flag during normal environment teardown
 // (node::FreeEnvironment) so in-flight SafeAsyncWorkers short-circuit instead
-// of touching napi as the env is destroyed. A named function (not a lambda) so
-// the instance-data finalizer can pass the same function pointer to
-// napi_remove_env_cleanup_hook.
+// of touching napi as the env is destroyed, and drops queued ones before they
+// start. A named function (not a lambda) so the instance-data finalizer can
+// pass the same function pointer to napi_remove_env_cleanup_hook.
 inline void ShutdownFlagHook(void *arg) {
   auto *data = static_cast<ModuleInstanceData *>(arg);
   data->shutdownState->shuttingDown.store(true, std::memory_order_release);
+  CancelQueuedWork(data->shutdownState.get());
 }
 
 // Registers per-env shutdown state, a cleanup hook that flips the flag, and an
@@ -93,6 +140,9 @@ inline void EnsureShutdownHook(napi_env env) {
         // Remove before freeing; no-op if the hook already ran during a normal
         // FreeEnvironment teardown.
         napi_remove_env_cleanup_hook(env, ShutdownFlagHook, d);
+        // The hook may not have run (see above): queued work must still go.
+        d->shutdownState->shuttingDown.store(true, std::memory_order_release);
+        CancelQueuedWork(d->shutdownState.get());
         delete d;
       },
       nullptr);
@@ -129,56 +179,57 @@ inline void SafeReject(const Napi::Promise::Deferred &deferred,
   }
 }
 
-class SafeAsyncWorker : public Napi::AsyncWorker {
+// Base for the addon's async work: Execute() runs on a pool thread, then
+// OnOK() or OnError() on the JS thread, unless the env is tearing down. The
+// interface mirrors Napi::AsyncWorker's. Exceptions from Execute() become
+// SetError(); errors during completion are swallowed (see SafeResolve above).
+class SafeAsyncWorker {
 public:
-  void OnExecute(Napi::Env /*env*/) override {
-    try {
-      Execute();
-    } catch (const std::exception &e) {
-      SetError(e.what());
-    } catch (...) {
-      SetError("Unknown native error");
+  virtual ~SafeAsyncWorker() = default;
+
+  SafeAsyncWorker(const SafeAsyncWorker &) = delete;
+  SafeAsyncWorker &operator=(const SafeAsyncWorker &) = delete;
+
+  // JS thread. Takes ownership of `this`, which is deleted after completion
+  // (or by CancelQueuedWork()). Throws Napi::Error, having deleted `this`, if
+  // no pool thread can be started.
+  void Queue(WorkPriority priority = WorkPriority::Normal);
+
+  // Pool thread: Execute(), then hand `this` to the JS thread.
+  void Run();
+
+  // JS thread, from the completions ThreadSafeFunction.
+  void Complete(Napi::Env env);
+
+  const std::shared_ptr<ShutdownState> &State() const { return shutdownState_; }
+
+protected:
+  explicit SafeAsyncWorker(Napi::Env env)
+      : env_(env), shutdownState_(GetShutdownState(env)) {
+    if (shutdownState_ == nullptr) {
+      // No instance data (test harness, etc.): a flag that never flips.
+      shutdownState_ = std::make_shared<ShutdownState>();
     }
   }
 
-  void OnWorkComplete(Napi::Env env, napi_status status) override {
-    if (IsShuttingDown()) {
-      Destroy();
-      return;
-    }
+  virtual void Execute() = 0;
+  virtual void OnOK() {}
+  virtual void OnError(const Napi::Error & /*error*/) {}
 
-    try {
-      // node-addon-api treats every non-cancelled status alike. Preserve the
-      // stronger behavior this wrapper historically provided: a failed async
-      // work status must reject even when Execute() did not set an error.
-      if (status != napi_ok && status != napi_cancelled) {
-        Napi::HandleScope scope(env);
-        OnError(Napi::Error::New(env));
-        Destroy();
-        return;
-      }
-
-      // Keep node-addon-api's error storage and completion behavior as the
-      // single source of truth. The qualified call still dispatches the
-      // virtual OnOK/OnError implementations in concrete workers.
-      Napi::AsyncWorker::OnWorkComplete(env, status);
-    } catch (...) { // NOLINT(bugprone-empty-catch)
-      // Deliberate: env teardown can make value construction, handle scopes,
-      // or deferred resolution fail. The JS promise is no longer observable,
-      // and an escaping C++ exception here would abort the process. Destroy()
-      // is needed because node-addon-api could not reach its final cleanup.
-      Destroy();
-    }
+  void SetError(const std::string &error) {
+    error_ = error;
+    hasError_ = true;
   }
 
-protected:
-  explicit SafeAsyncWorker(Napi::Env env)
-      : Napi::AsyncWorker(env), shutdownState_(GetShutdownState(env)) {}
+  Napi::Env Env() const { return Napi::Env(env_); }
 
   bool IsShuttingDown() const { return FSMeta::IsShuttingDown(shutdownState_); }
 
 private:
+  napi_env env_;
   std::shared_ptr<ShutdownState> shutdownState_;
+  std::string error_;
+  bool hasError_ = false;
 };
 
 } // namespace FSMeta
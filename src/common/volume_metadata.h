@@ -1,18 +1,43 @@
 // src/common/volume_metadata.h
 #pragma once
+#include "./arena.h"
+#include "./shutdown.h"
 #include "./volume_utils.h"
 #include <cstdint>
+#include <cstring> // for memcpy()
 #include <napi.h>
 #include <string>
+#include <string_view>
 
 namespace FSMeta {
+// String fields are NUL-terminated views into `strings`, so parsing one
+// probe's options (getAllVolumeMetadata() parses one per volume) costs a
+// single allocation rather than one per field, and workers take the options
+// by move rather than copying each string again. Move-only.
 struct VolumeMetadataOptions {
-  std::string mountPoint;    // Required mount point path
-  uint32_t timeoutMs = 5000; // Optional timeout with default
-  std::string device;        // Optional device path
-  std::string fstype; // Optional filesystem type (gates btrfs-only probes)
+  std::string_view mountPoint = ""; // Required mount point path
+  uint32_t timeoutMs = 5000;        // Optional timeout with default
+  std::string_view device = "";     // Optional device path
+  // Optional filesystem type (gates btrfs-only probes)
+  std::string_view fstype = "";
+  uint64_t subvolid = 0; // Optional btrfs subvolid= from the mount table
   bool skipNetworkVolumes =
       false; // Skip detailed info for network volumes to avoid blocking
+  bool includeQuota = false; // Read quota limits (Linux only)
+  // Directory whose quota to read (default mountPoint)
+  std::string_view quotaPath = "";
+  WorkPriority priority = WorkPriority::Normal; // Pool lane for the probe
+
+  // Room for a typical mount point, device and fstype in one block.
+  Arena strings{kStringsBlockSize};
+
+  // Copies `value` into `strings`, NUL-terminated.
+  std::string_view Copy(std::string_view value) {
+    char *out = strings.Allocate(value.size() + 1);
+    memcpy(out, value.data(), value.size());
+    out[value.size()] = '\0';
+    return {out, value.size()};
+  }
 
   static VolumeMetadataOptions FromObject(const Napi::Object &obj) {
     VolumeMetadataOptions options;
@@ -21,7 +46,7 @@ struct VolumeMetadataOptions {
     if (!obj.Has("mountPoint") || !obj.Get("mountPoint").IsString()) {
       throw Napi::TypeError::New(obj.Env(), "String expected for mountPoint");
     }
-    options.mountPoint = obj.Get("mountPoint").As<Napi::String>();
+    options.mountPoint = options.CopyString(obj.Get("mountPoint"));
     if (options.mountPoint.empty()) {
       throw Napi::TypeError::New(obj.Env(), "mountPoint cannot be empty");
     }
@@ -40,18 +65,55 @@ struct VolumeMetadataOptions {
       options.timeoutMs = static_cast<uint32_t>(timeoutMs);
     }
     if (obj.Has("device")) {
-      options.device = obj.Get("device").As<Napi::String>();
+      options.device = options.CopyString(obj.Get("device"));
     }
     if (obj.Has("fstype") && obj.Get("fstype").IsString()) {
-      options.fstype = obj.Get("fstype").As<Napi::String>();
+      options.fstype = options.CopyString(obj.Get("fstype"));
+    }
+    if (obj.Has("subvolid") && obj.Get("subvolid").IsNumber()) {
+      const double subvolid =
+          obj.Get("subvolid").As<Napi::Number>().DoubleValue();
+      // Ids are positive integers; anything else falls back to the ioctl.
+      if (subvolid >= 1 && subvolid <= 9007199254740991.0) {
+        options.subvolid = static_cast<uint64_t>(subvolid);
+      }
     }
     if (obj.Has("skipNetworkVolumes")) {
       options.skipNetworkVolumes =
           obj.Get("skipNetworkVolumes").As<Napi::Boolean>().Value();
     }
 
+    if (obj.Has("includeQuota") && obj.Get("includeQuota").IsBoolean()) {
+      options.includeQuota =
+          obj.Get("includeQuota").As<Napi::Boolean>().Value();
+    }
+    if (obj.Has("quotaPath") && obj.Get("quotaPath").IsString()) {
+      options.quotaPath = options.CopyString(obj.Get("quotaPath"));
+    }
+    options.priority = WorkPriorityFromObject(obj);
+
     return options;
   }
+
+private:
+  static constexpr size_t kStringsBlockSize = 256;
+
+  // Copies a JS string straight into `strings`, with no std::string in
+  // between. Throws Napi::Error if `value` isn't a string.
+  std::string_view CopyString(const Napi::Value &value) {
+    const napi_env env = value.Env();
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) !=
+        napi_ok) {
+      throw Napi::Error::New(env);
+    }
+    char *out = strings.Allocate(length + 1);
+    if (napi_get_value_string_utf8(env, value, out, length + 1, &length) !=
+        napi_ok) {
+      throw Napi::Error::New(env);
+    }
+    return {out, length};
+  }
 };
 
 // Volume metadata structure
@@ -61,8 +123,11 @@ struct VolumeMetadata {
   double size = 0.0;
   double used = 0.0;
   double available = 0.0;
+  double inodes = 0.0;     // f_files; 0 if the filesystem doesn't report it
+  double inodesFree = 0.0; // f_ffree
   std::string uuid;
   std::string subvolumeUuid; // btrfs per-subvolume UUID (Linux only)
+  std::string subvolumeParentUuid; // btrfs snapshot origin (Linux only)
   std::string fsid;          // statfs f_fsid, hex (Linux; quick zfs dataset id)
   std::string mountFrom;
   std::string mountName;
@@ -74,6 +139,10 @@ struct VolumeMetadata {
   bool isSystemVolume = false;
   bool isReadOnly = false;
   std::string volumeRole;
+  std::string quotaType; // "project", "user" or "qgroup" (Linux only)
+  double quotaLimit = 0.0;
+  double quotaUsed = 0.0;
+  double quotaAvailable = 0.0;
   std::string error;
 
   Napi::Object ToObject(Napi::Env env) const {
@@ -97,6 +166,13 @@ struct VolumeMetadata {
     result.Set("used", Napi::Number::New(env, used));
     result.Set("available", Napi::Number::New(env, available));
 
+    // btrfs, vfat and most network filesystems report f_files = 0: omit
+    // rather than claim a volume with no inodes left.
+    if (inodes > 0) {
+      result.Set("inodes", Napi::Number::New(env, inodes));
+      result.Set("inodesFree", Napi::Number::New(env, inodesFree));
+    }
+
     // More string fields
     if (!uuid.empty()) {
       result.Set("uuid", Napi::String::New(env, uuid));
@@ -110,6 +186,12 @@ struct VolumeMetadata {
       result.Set("subvolumeUuid", Napi::String::New(env, subvolumeUuid));
     }
 
+    // Only present on btrfs snapshots.
+    if (!subvolumeParentUuid.empty()) {
+      result.Set("subvolumeParentUuid",
+                 Napi::String::New(env, subvolumeParentUuid));
+    }
+
     // Only present where f_fsid is a useful identity signal (currently zfs),
     // though ZFS may remap it to resolve an active collision.
     if (!fsid.empty()) {
@@ -160,6 +242,14 @@ struct VolumeMetadata {
       result.Set("volumeRole", Napi::String::New(env, volumeRole));
     }
 
+    // Only present when includeQuota found a limit.
+    if (!quotaType.empty()) {
+      result.Set("quotaType", Napi::String::New(env, quotaType));
+      result.Set("quotaLimit", Napi::Number::New(env, quotaLimit));
+      result.Set("quotaUsed", Napi::Number::New(env, quotaUsed));
+      result.Set("quotaAvailable", Napi::Number::New(env, quotaAvailable));
+    }
+
     return result;
   }
 };
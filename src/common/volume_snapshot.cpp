@@ -0,0 +1,78 @@
+// src/common/volume_snapshot.cpp
+
+#include "volume_snapshot.h"
+#include "debug_log.h"
+
+namespace FSMeta {
+
+Napi::Value DecodeVolumeSnapshot(const Napi::CallbackInfo &info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsTypedArray() ||
+      info[0].As<Napi::TypedArray>().TypedArrayType() !=
+          napi_uint8_array) {
+    throw Napi::TypeError::New(env, "Uint8Array or Buffer expected");
+  }
+  // Read in place: the array stays reachable through info for the whole call.
+  auto bytes = info[0].As<Napi::Uint8Array>();
+  return DecodeVolumeSnapshotBytes(env, bytes.Data(), bytes.ByteLength());
+}
+
+Napi::Array DecodeVolumeSnapshotBytes(Napi::Env env, const uint8_t *data,
+                                      size_t size) {
+  try {
+    VolumeSnapshotReader reader(data, size);
+    DEBUG_LOG("[DecodeVolumeSnapshot] %zu bytes, %zu strings, %llu volumes",
+              size, reader.StringCount(),
+              static_cast<unsigned long long>(reader.size()));
+
+    // Interned strings repeat across volumes (fstype, status, ...): convert
+    // each table entry to a JS string at most once.
+    std::vector<Napi::Value> strings(reader.StringCount());
+    auto jsString = [&](uint32_t index) {
+      const std::string_view s = reader.String(index);
+      if (strings[index].IsEmpty()) {
+        strings[index] = Napi::String::New(env, s.data(), s.size());
+      }
+      return strings[index];
+    };
+
+    auto result = Napi::Array::New(env, reader.size());
+    Napi::Object volume;
+    reader.Visit(
+        [&](uint64_t index) {
+          volume = Napi::Object::New(env);
+          result.Set(static_cast<uint32_t>(index), volume);
+        },
+        [&](size_t field, const SnapshotValue &value) {
+          const char *name = kSnapshotFields[field].name;
+          switch (kSnapshotFields[field].kind) {
+          case SnapshotFieldKind::String:
+            volume.Set(name, jsString(value.string));
+            break;
+          case SnapshotFieldKind::Number:
+            volume.Set(name, Napi::Number::New(env, value.number));
+            break;
+          case SnapshotFieldKind::Boolean:
+            volume.Set(name, Napi::Boolean::New(env, value.boolean));
+            break;
+          case SnapshotFieldKind::Error:
+            if (value.errorName < 0) {
+              volume.Set(name, jsString(value.string));
+            } else {
+              const std::string_view message = reader.String(value.string);
+              auto error = Napi::Error::New(
+                  env, std::string(message.data(), message.size()));
+              error.Value().Set(
+                  "name", jsString(static_cast<uint32_t>(value.errorName)));
+              volume.Set(name, error.Value());
+            }
+            break;
+          }
+        });
+    return result;
+  } catch (const FSException &e) {
+    throw Napi::Error::New(env, e.what());
+  }
+}
+
+} // namespace FSMeta
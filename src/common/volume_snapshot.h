@@ -0,0 +1,240 @@
+// src/common/volume_snapshot.h
+//
+// Zero-copy reader for the binary snapshots written by encodeVolumeSnapshot()
+// (src/volume_snapshot.ts documents the layout). Strings are string_views
+// into the caller's buffer, which must outlive the reader.
+
+#pragma once
+#include "./error_utils.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // for memcpy()
+#include <iterator> // for std::size()
+#include <napi.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace FSMeta {
+
+enum class SnapshotFieldKind : uint8_t { String, Number, Boolean, Error };
+
+struct SnapshotField {
+  const char *name;
+  SnapshotFieldKind kind;
+};
+
+// Wire order. Keep in sync with Fields in src/volume_snapshot.ts.
+inline constexpr SnapshotField kSnapshotFields[] = {
+    {"mountPoint", SnapshotFieldKind::String},
+    {"fstype", SnapshotFieldKind::String},
+    {"status", SnapshotFieldKind::String},
+    {"isSystemVolume", SnapshotFieldKind::Boolean},
+    {"volumeRole", SnapshotFieldKind::String},
+    {"subvol", SnapshotFieldKind::String},
+    {"subvolid", SnapshotFieldKind::Number},
+    {"isSnapshot", SnapshotFieldKind::Boolean},
+    {"snapshotOrigin", SnapshotFieldKind::String},
+    {"isReadOnly", SnapshotFieldKind::Boolean},
+    {"error", SnapshotFieldKind::Error},
+    {"label", SnapshotFieldKind::String},
+    {"size", SnapshotFieldKind::Number},
+    {"used", SnapshotFieldKind::Number},
+    {"available", SnapshotFieldKind::Number},
+    {"inodes", SnapshotFieldKind::Number},
+    {"inodesFree", SnapshotFieldKind::Number},
+    {"mountFrom", SnapshotFieldKind::String},
+    {"mountName", SnapshotFieldKind::String},
+    {"uuid", SnapshotFieldKind::String},
+    {"subvolumeUuid", SnapshotFieldKind::String},
+    {"subvolumeParentUuid", SnapshotFieldKind::String},
+    {"fsid", SnapshotFieldKind::String},
+    {"zfsDatasetGuid", SnapshotFieldKind::String},
+    {"zfsPoolGuid", SnapshotFieldKind::String},
+    {"zfsObjsetId", SnapshotFieldKind::String},
+    {"quotaType", SnapshotFieldKind::String},
+    {"quotaLimit", SnapshotFieldKind::Number},
+    {"quotaUsed", SnapshotFieldKind::Number},
+    {"quotaAvailable", SnapshotFieldKind::Number},
+    {"uri", SnapshotFieldKind::String},
+    {"protocol", SnapshotFieldKind::String},
+    {"remote", SnapshotFieldKind::Boolean},
+    {"remoteUser", SnapshotFieldKind::String},
+    {"remoteHost", SnapshotFieldKind::String},
+    {"remoteShare", SnapshotFieldKind::String},
+};
+inline constexpr size_t kSnapshotFieldCount = std::size(kSnapshotFields);
+inline constexpr uint8_t kSnapshotVersion = 1;
+
+struct SnapshotValue {
+  uint32_t string = 0;    // String: table index; Error: the message's
+  int64_t errorName = -1; // Error: table index of the name, or -1 for a
+                          // plain-string error
+  double number = 0.0;
+  bool boolean = false;
+};
+
+class VolumeSnapshotReader {
+public:
+  // Parses the header and string table. Throws FSException for truncated or
+  // unsupported input, and for delta snapshots, which need their base.
+  VolumeSnapshotReader(const uint8_t *data, size_t size)
+      : data_(data), size_(size) {
+    static constexpr uint8_t kMagic[] = {'F', 'S', 'M', 'S'};
+    for (uint8_t b : kMagic) {
+      if (Byte() != b) {
+        throw FSException("not a volume snapshot");
+      }
+    }
+    const uint8_t version = Byte();
+    if (version != kSnapshotVersion) {
+      throw FSException("unsupported volume snapshot version " +
+                        std::to_string(version));
+    }
+    if ((Byte() & kFlagDelta) != 0) {
+      throw FSException("delta snapshots need their base");
+    }
+    const uint64_t count = Varint();
+    // Every string takes at least its length byte: bounds the reserve().
+    if (count > size_ - pos_) {
+      throw FSException("volume snapshot is truncated");
+    }
+    strings_.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+      const uint64_t length = Varint();
+      Need(length);
+      strings_.emplace_back(reinterpret_cast<const char *>(data_ + pos_),
+                            length);
+      pos_ += length;
+    }
+    volumes_ = Varint();
+    // Likewise every volume takes at least its field bitset: bounds the
+    // array decoders allocate from size().
+    if (volumes_ > (size_ - pos_) / kBitsetBytes) {
+      throw FSException("volume snapshot is truncated");
+    }
+    body_ = pos_;
+  }
+
+  uint64_t size() const { return volumes_; }
+
+  std::string_view String(uint32_t index) const {
+    if (index >= strings_.size()) {
+      throw FSException("volume snapshot string " + std::to_string(index) +
+                        " is missing");
+    }
+    return strings_[index];
+  }
+
+  size_t StringCount() const { return strings_.size(); }
+
+  // Decodes every volume in order: onVolume(index) before each volume's
+  // fields, then onField(field index, value) for each field present.
+  template <typename OnVolume, typename OnField>
+  void Visit(OnVolume &&onVolume, OnField &&onField) {
+    pos_ = body_;
+    for (uint64_t v = 0; v < volumes_; v++) {
+      onVolume(v);
+      Need(kBitsetBytes);
+      const uint8_t *bits = data_ + pos_;
+      pos_ += kBitsetBytes;
+      for (size_t f = 0; f < kSnapshotFieldCount; f++) {
+        if ((bits[f / 8] & (1u << (f % 8))) == 0) {
+          continue;
+        }
+        SnapshotValue value;
+        switch (kSnapshotFields[f].kind) {
+        case SnapshotFieldKind::String:
+          value.string = StringIndex();
+          break;
+        case SnapshotFieldKind::Number:
+          value.number = Number();
+          break;
+        case SnapshotFieldKind::Boolean:
+          value.boolean = Byte() != 0;
+          break;
+        case SnapshotFieldKind::Error: {
+          const uint32_t name = StringIndex();
+          value.errorName = name == 0 ? -1 : static_cast<int64_t>(name) - 1;
+          value.string = StringIndex();
+          break;
+        }
+        }
+        onField(f, value);
+      }
+    }
+  }
+
+private:
+  static constexpr uint8_t kFlagDelta = 1;
+  static constexpr size_t kBitsetBytes = (kSnapshotFieldCount + 7) / 8;
+
+  void Need(uint64_t n) const {
+    if (n > size_ - pos_) {
+      throw FSException("volume snapshot is truncated");
+    }
+  }
+
+  uint8_t Byte() {
+    Need(1);
+    return data_[pos_++];
+  }
+
+  uint64_t Varint() {
+    uint64_t n = 0;
+    for (int shift = 0; shift < 63; shift += 7) {
+      const uint8_t b = Byte();
+      n |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (b < 0x80) {
+        return n;
+      }
+    }
+    throw FSException("volume snapshot has an invalid varint");
+  }
+
+  uint32_t StringIndex() {
+    const uint64_t index = Varint();
+    if (index > UINT32_MAX) {
+      throw FSException("volume snapshot string index is out of range");
+    }
+    return static_cast<uint32_t>(index);
+  }
+
+  // Doubled zigzag varint; an odd value escapes to a little-endian float64.
+  double Number() {
+    const uint64_t u = Varint();
+    if ((u & 1) != 0) {
+      Need(8);
+      // Assembled little-endian, whatever the host byte order.
+      uint64_t bits = 0;
+      for (int i = 7; i >= 0; i--) {
+        bits = (bits << 8) | data_[pos_ + i];
+      }
+      pos_ += 8;
+      double d;
+      memcpy(&d, &bits, sizeof(d));
+      return d;
+    }
+    const uint64_t z = u >> 1;
+    return (z & 1) == 0 ? static_cast<double>(z >> 1)
+                        : -static_cast<double>((z >> 1) + 1);
+  }
+
+  const uint8_t *data_;
+  size_t size_;
+  size_t pos_ = 0;
+  size_t body_ = 0;
+  uint64_t volumes_ = 0;
+  std::vector<std::string_view> strings_;
+};
+
+// decodeVolumeSnapshot(bytes): the full snapshot as an array of plain
+// objects, read straight out of the caller's Buffer or Uint8Array.
+Napi::Value DecodeVolumeSnapshot(const Napi::CallbackInfo &info);
+
+// The same, from `size` bytes at `data`, which must stay unchanged for the
+// call. Throws a JS Error for malformed input.
+Napi::Array DecodeVolumeSnapshotBytes(Napi::Env env, const uint8_t *data,
+                                      size_t size);
+
+} // namespace FSMeta
@@ -69,10 +69,10 @@ static std::string CFStringToString(CFStringRef cfString) {
 
 class GetVolumeMetadataWorker : public MetadataWorkerBase {
 public:
-  GetVolumeMetadataWorker(const std::string &mountPoint,
-                          const VolumeMetadataOptions &options,
+  GetVolumeMetadataWorker(VolumeMetadataOptions &&options,
                           const Napi::Promise::Deferred &deferred)
-      : MetadataWorkerBase(mountPoint, deferred), options_(options) {}
+      : MetadataWorkerBase(options.mountPoint, deferred),
+        options_(std::move(options)) {}
 
   void Execute() override {
     DEBUG_LOG("[GetVolumeMetadataWorker] Executing for mount point: %s",
@@ -191,6 +191,8 @@ private:
     metadata.size = static_cast<double>(totalSize);
     metadata.available = static_cast<double>(availableSize);
     metadata.used = static_cast<double>(usedSize);
+    metadata.inodes = static_cast<double>(vfs.f_files);
+    metadata.inodesFree = static_cast<double>(vfs.f_ffree);
 
     metadata.fstype = fs.f_fstypename;
     metadata.mountFrom = fs.f_mntfromname;
@@ -381,9 +383,9 @@ Napi::Value GetVolumeMetadata(const Napi::CallbackInfo &info) {
   auto options = VolumeMetadataOptions::FromObject(info[0].As<Napi::Object>());
 
   auto deferred = Napi::Promise::Deferred::New(env);
-  auto *worker =
-      new GetVolumeMetadataWorker(options.mountPoint, options, deferred);
-  worker->Queue();
+  const WorkPriority priority = options.priority;
+  auto *worker = new GetVolumeMetadataWorker(std::move(options), deferred);
+  worker->Queue(priority);
   return deferred.Promise();
 }
 
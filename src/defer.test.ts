@@ -1,6 +1,6 @@
 // src/defer.test.ts
 
-import { defer } from "./defer";
+import { defer, deferFields } from "./defer";
 
 describe("defer", () => {
   it("should compute value only on first access", () => {
@@ -79,3 +79,51 @@ describe("defer", () => {
     expect(new Test().deferred()).toBe("test");
   });
 });
+
+describe("deferFields", () => {
+  it("computes each field once, on first read", () => {
+    const calls: string[] = [];
+    const obj = deferFields<{ a: number; b: string[] }>({
+      a: () => {
+        calls.push("a");
+        return 1;
+      },
+      b: () => {
+        calls.push("b");
+        return ["x"];
+      },
+    });
+
+    expect(calls).toEqual([]);
+    expect(obj.a).toBe(1);
+    expect(calls).toEqual(["a"]);
+    expect(obj.b).toBe(obj.b);
+    expect(calls).toEqual(["a", "b"]);
+  });
+
+  it("spreads and compares like a plain object", () => {
+    const obj = deferFields<{ a: number; b: boolean }>({
+      a: () => 1,
+      b: () => false,
+    });
+    expect(Object.keys(obj)).toEqual(["a", "b"]);
+    expect({ ...obj }).toEqual({ a: 1, b: false });
+  });
+
+  it("stays writable, before and after the first read", () => {
+    const calls: string[] = [];
+    const obj = deferFields<{ a: number; b: number }>({
+      a: () => {
+        calls.push("a");
+        return 1;
+      },
+      b: () => 2,
+    });
+    obj.a = 10;
+    expect(obj.b).toBe(2);
+    obj.b = 20;
+    expect({ ...obj }).toEqual({ a: 10, b: 20 });
+    expect(Object.keys(obj)).toEqual(["a", "b"]);
+    expect(calls).toEqual([]);
+  });
+});
@@ -28,3 +28,33 @@ export function defer<T>(thunk: () => T): Defer<T> {
 
   return fn;
 }
+
+/**
+ * Creates an object whose fields are each computed once, on first read, and
+ * cached: later reads return the same value, so arrays keep their identity.
+ * The fields are enumerable accessors, so the object spreads and compares
+ * like a plain one, and stay writable: assigning one replaces it with a plain
+ * data property, and its thunk never runs.
+ * @param thunks One function per field, returning its value
+ */
+export function deferFields<T extends object>(thunks: {
+  [K in keyof T]: () => T[K];
+}): T {
+  const result = {} as T;
+  for (const key of Object.keys(thunks) as (keyof T)[]) {
+    Object.defineProperty(result, key, {
+      enumerable: true,
+      configurable: true,
+      get: defer(thunks[key]),
+      set(value: T[keyof T]) {
+        Object.defineProperty(this, key, {
+          value,
+          enumerable: true,
+          configurable: true,
+          writable: true,
+        });
+      },
+    });
+  }
+  return result;
+}
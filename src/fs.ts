@@ -1,6 +1,12 @@
 // src/fs.ts
 
-import { type PathLike, type StatOptions, Stats, statSync } from "node:fs";
+import {
+  opendirSync,
+  type PathLike,
+  type StatOptions,
+  Stats,
+  statSync,
+} from "node:fs";
 import { opendir, stat } from "node:fs/promises";
 import { join, resolve } from "node:path";
 import { withTimeout } from "./async";
@@ -55,6 +61,21 @@ export async function findAncestorDir(
   return parent === dir ? undefined : findAncestorDir(parent, file);
 }
 
+/**
+ * Synchronous {@link findAncestorDir}.
+ */
+export function findAncestorDirSync(
+  dir: string,
+  file: string,
+): string | undefined {
+  dir = resolve(dir);
+  if (statSync(join(dir, file), { throwIfNoEntry: false })?.isFile()) {
+    return dir;
+  }
+  const parent = resolve(dir, "..");
+  return parent === dir ? undefined : findAncestorDirSync(parent, file);
+}
+
 export function existsSync(path: string): boolean {
   return statSync(path, { throwIfNoEntry: false }) != null;
 }
@@ -78,3 +99,13 @@ async function _canReaddir(dir: string): Promise<true> {
   await (await opendir(dir)).close();
   return true;
 }
+
+/**
+ * Synchronous {@link canReaddir}, without a timeout.
+ *
+ * @throws {Error} if `dir` does not exist or is not a directory or cannot be read.
+ */
+export function canReaddirSync(dir: string): true {
+  opendirSync(dir).closeSync();
+  return true;
+}
@@ -114,8 +114,8 @@ describe("compileGlob", () => {
   });
 
   // Test cache overflow
-  test("clears cache when it exceeds 256 entries", () => {
-    // Generate 260 unique patterns to trigger cache clear
+  test("evicts from the cache when it exceeds 256 entries", () => {
+    // Generate 260 unique patterns to trigger eviction
     const patterns = [];
     for (let i = 0; i < 260; i++) {
       patterns.push([`file${i}.txt`]);
@@ -126,7 +126,7 @@ describe("compileGlob", () => {
       expect(regex.test(`file${i}.txt`)).toBe(true);
     });
 
-    // Cache should still work after clearing
+    // Cache should still work after evicting
     const regex = compileGlob(["test.txt"]);
     expect(regex.test("test.txt")).toBe(true);
   });
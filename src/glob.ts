@@ -1,9 +1,16 @@
 // src/glob.ts
 
+import { createManagedCache } from "./cache_manager";
 import { isWindows } from "./platform";
 import { isNotBlank } from "./string";
 
-const cache = new Map<string, RegExp>();
+// Keyed by both the caller's and the sorted pattern list. JavaScript strings
+// are up to two bytes per character; a compiled RegExp costs a few times its
+// source.
+const cache = createManagedCache<string, RegExp>("compileGlob", {
+  cost: (key, re) => 2 * key.length + 8 * re.source.length,
+  maxEntries: 256,
+});
 
 /**
  * Compiles an array of glob patterns into a single regular expression.
@@ -44,11 +51,6 @@ export function compileGlob(
   }
 
   const result = _compileGlob(sorted);
-  if (cache.size > 256) {
-    // avoid unbounded memory usage
-    cache.clear();
-  }
-
   cache.set(patternsKey, result);
   cache.set(sortedKey, result);
   return result;
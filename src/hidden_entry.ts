@@ -0,0 +1,73 @@
+// src/hidden_entry.ts
+//
+// The hidden-file API alone, published as "@photostructure/fs-metadata/hidden".
+// Importing it skips the volume and mount-table modules entirely, and on Linux
+// and macOS its calls never load the native addon.
+
+import type { HideMethod, SetHiddenResult } from "./hidden";
+import {
+  getHiddenMetadataImpl,
+  isHiddenImpl,
+  isHiddenRecursiveImpl,
+  setHiddenImpl,
+} from "./hidden";
+import { nativeFn } from "./native_loader";
+import type { HiddenMetadata } from "./types/hidden_metadata";
+
+export type { HiddenMetadata, HideMethod, SetHiddenResult };
+
+/**
+ * Check if a file or directory is hidden.
+ *
+ * Note that `path` may be _effectively_ hidden if any of the ancestor
+ * directories are hidden: use {@link isHiddenRecursive} to check for this.
+ *
+ * @param pathname Path to file or directory
+ * @returns Promise resolving to boolean indicating hidden state
+ */
+export function isHidden(pathname: string): Promise<boolean> {
+  return isHiddenImpl(pathname, nativeFn);
+}
+
+/**
+ * Check if a file or directory is hidden, or if any of its ancestor
+ * directories are hidden.
+ *
+ * @param pathname Path to file or directory
+ * @returns Promise resolving to boolean indicating hidden state
+ */
+export function isHiddenRecursive(pathname: string): Promise<boolean> {
+  return isHiddenRecursiveImpl(pathname, nativeFn);
+}
+
+/**
+ * Get detailed metadata about the hidden state of a file or directory.
+ *
+ * @param pathname Path to file or directory
+ * @returns Promise resolving to metadata about the hidden state
+ */
+export function getHiddenMetadata(pathname: string): Promise<HiddenMetadata> {
+  return getHiddenMetadataImpl(pathname, nativeFn);
+}
+
+/**
+ * Set the hidden state of a file or directory
+ *
+ * @param pathname Path to file or directory
+ * @param hidden - Whether the item should be hidden (true) or visible (false)
+ * @param method Method to use for hiding the file or directory. The default
+ * is "auto", which is "dotPrefix" on Linux and macOS, and "systemFlag" on
+ * Windows. "all" will attempt to use all relevant methods for the current
+ * operating system.
+ * @returns Promise resolving the final name of the file or directory (as it
+ * will change on POSIX systems), and the action(s) taken.
+ * @throws {Error} If the file doesn't exist, permissions are insufficient, or
+ * the requested method is unsupported
+ */
+export function setHidden(
+  pathname: string,
+  hidden: boolean,
+  method: HideMethod = "auto",
+): Promise<SetHiddenResult> {
+  return setHiddenImpl(pathname, hidden, method, nativeFn);
+}
@@ -1,18 +1,36 @@
 // src/index.ts
 
-import NodeGypBuild from "node-gyp-build";
-import { debug, debugLogContext, isDebugEnabled } from "./debuglog";
-import { defer } from "./defer";
-import { _dirname } from "./dirname";
-import { findAncestorDir } from "./fs";
+import {
+  CacheMaxBytesDefault,
+  CacheMaxFdsDefault,
+  getCacheStatsImpl,
+  setCacheBudgetImpl,
+} from "./cache_manager";
 import type { HideMethod, SetHiddenResult } from "./hidden";
+import type { GetBlockDevicesOptions } from "./linux/block_devices";
+import { getBlockDevicesImpl } from "./linux/block_devices";
+import { getBtrfsSubvolumesImpl } from "./linux/btrfs_subvolumes";
+import type { MtabVolumeMetadata } from "./linux/mtab";
+import type {
+  SharedVolumeCache,
+  SharedVolumeCacheOptions,
+} from "./linux/shared_volume_cache";
 import {
-  getHiddenMetadataImpl,
-  isHiddenImpl,
-  isHiddenRecursiveImpl,
-  setHiddenImpl,
-} from "./hidden";
+  createSharedVolumeCacheImpl,
+  SharedVolumeCacheLeaseMsDefault,
+  SharedVolumeCacheMaxAgeMsDefault,
+  SharedVolumeCacheSizeBytesDefault,
+  unlinkSharedVolumeCacheImpl,
+} from "./linux/shared_volume_cache";
+import type {
+  BlockDeviceEvent,
+  BlockDeviceWatcher,
+  BlockDeviceWatcherOptions,
+  RemovableMediaEvent,
+} from "./linux/uevent_monitor";
+import { watchBlockDevicesImpl } from "./linux/uevent_monitor";
 import { getMountPointForPathImpl } from "./mount_point_for_path";
+import { nativeFn, nativeSyncFn } from "./native_loader";
 import {
   getTimeoutMsDefault,
   IncludeSystemVolumesDefault,
@@ -20,84 +38,111 @@ import {
   NetworkFsTypesDefault,
   OptionsDefault,
   optionsWithDefaults,
+  PriorityDefault,
   SkipNetworkVolumesDefault,
   SystemFsTypesDefault,
   SystemPathPatternsDefault,
 } from "./options";
 import type { StringEnum, StringEnumKeys, StringEnumType } from "./string_enum";
 import type { SystemVolumeConfig } from "./system_volume";
+import type {
+  BlockDevice,
+  BlockDeviceClass,
+  BlockDeviceFilter,
+  BlockTransport,
+} from "./types/block_device";
+import type { BtrfsSubvolume } from "./types/btrfs_subvolume";
+import type { CacheBudget, CacheStats } from "./types/cache";
+import type { CapacityTrend } from "./types/capacity_trend";
 import type { HiddenMetadata } from "./types/hidden_metadata";
 import type { MountPoint } from "./types/mount_point";
-import { NativeBindings } from "./types/native_bindings";
-import type { Options, ResolvedOptions } from "./types/options";
+import type { Options, ProbePriority, ResolvedOptions } from "./types/options";
+import type { SharedVolumeCacheEntry } from "./types/shared_volume_cache_entry";
 import type { VolumeMetadata } from "./types/volume_metadata";
+import type {
+  VolumeHealthChange,
+  VolumeHealthMonitor,
+  VolumeHealthMonitorOptions,
+  VolumeHealthMonitorStats,
+} from "./volume_health_monitor";
+import { createVolumeHealthMonitorImpl } from "./volume_health_monitor";
 import type { VolumeHealthStatus } from "./volume_health_status";
 import { VolumeHealthStatuses } from "./volume_health_status";
 import {
   getAllVolumeMetadataImpl,
+  getVolumeMetadataForFdImpl,
   getVolumeMetadataForPathImpl,
   getVolumeMetadataImpl,
 } from "./volume_metadata";
+import type {
+  ProgressiveVolumeMetadata,
+  ProgressiveVolumeMetadataOptions,
+} from "./volume_metadata_progressive";
+import { getAllVolumeMetadataProgressiveImpl } from "./volume_metadata_progressive";
+import type { SyncOptions } from "./volume_metadata_sync";
+import {
+  getMountPointForPathSyncImpl,
+  getVolumeMetadataSyncImpl,
+} from "./volume_metadata_sync";
 import type { GetVolumeMountPointOptions } from "./volume_mount_points";
-import { getVolumeMountPointsImpl } from "./volume_mount_points";
+import type { VolumeProbe, VolumeProbeOptions } from "./volume_probe";
+import {
+  createVolumeProbeImpl,
+  VolumeProbeHistorySizeDefault,
+} from "./volume_probe";
+import type { VolumeSnapshotReader } from "./volume_snapshot";
+import {
+  decodeVolumeSnapshotImpl,
+  encodeVolumeSnapshot,
+  readVolumeSnapshot,
+  VolumeSnapshotVersion,
+} from "./volume_snapshot";
+import { viaPipelineWorker } from "./worker_pipeline";
 
 export type {
+  BlockDevice,
+  BlockDeviceClass,
+  BlockDeviceEvent,
+  BlockDeviceFilter,
+  BlockDeviceWatcher,
+  BlockDeviceWatcherOptions,
+  BlockTransport,
+  BtrfsSubvolume,
+  CacheBudget,
+  CacheStats,
+  CapacityTrend,
+  GetBlockDevicesOptions,
   GetVolumeMountPointOptions,
   HiddenMetadata,
   HideMethod,
   MountPoint,
+  MtabVolumeMetadata,
   Options,
+  ProbePriority,
+  ProgressiveVolumeMetadata,
+  ProgressiveVolumeMetadataOptions,
+  RemovableMediaEvent,
   ResolvedOptions,
   SetHiddenResult,
+  SharedVolumeCache,
+  SharedVolumeCacheEntry,
+  SharedVolumeCacheOptions,
   StringEnum,
   StringEnumKeys,
   StringEnumType,
+  SyncOptions,
   SystemVolumeConfig,
+  VolumeHealthChange,
+  VolumeHealthMonitor,
+  VolumeHealthMonitorOptions,
+  VolumeHealthMonitorStats,
   VolumeHealthStatus,
   VolumeMetadata,
+  VolumeProbe,
+  VolumeProbeOptions,
+  VolumeSnapshotReader,
 };
 
-const nativeFn = defer<Promise<NativeBindings>>(async () => {
-  const start = Date.now();
-  try {
-    const dirname = _dirname();
-    const dir = await findAncestorDir(dirname, "binding.gyp");
-    if (dir == null) {
-      throw new Error(
-        "Could not find bindings.gyp in any ancestor directory of " + dirname,
-      );
-    }
-    const bindings = NodeGypBuild(dir) as NativeBindings;
-    bindings.setDebugLogging(isDebugEnabled());
-    bindings.setDebugPrefix(debugLogContext() + ":native");
-    return bindings;
-  } catch (error) {
-    debug("Loading native bindings failed: %s", error);
-    throw error;
-  } finally {
-    debug(`Native bindings took %d ms to load`, Date.now() - start);
-  }
-});
-
-/**
- * List all active local and remote mount points on the system.
- *
- * Linux file bind mounts are omitted after target probing; explicit path
- * queries still resolve and inspect them. When `skipNetworkVolumes` is true,
- * remote targets are not touched, so entries whose target type cannot be
- * determined are retained.
- *
- * Note that on Windows, `timeoutMs` will be used **per system call** and not
- * for the entire operation.
- *
- * @param opts Optional filesystem operation settings to override default values
- */
-export function getVolumeMountPoints(
-  opts?: Partial<GetVolumeMountPointOptions>,
-): Promise<MountPoint[]> {
-  return getVolumeMountPointsImpl(optionsWithDefaults(opts), nativeFn);
-}
-
 /**
  * Get metadata for the volume at the given mount point.
  *
@@ -121,15 +166,188 @@ export function getVolumeMetadata(
       | "networkFsTypes"
       | "linuxMountTablePaths"
       | "includeZfsGuids"
+      | "includeQuota"
+      | "useWorkerThread"
     >
   >,
 ): Promise<VolumeMetadata> {
-  return getVolumeMetadataImpl(
+  return (
+    viaPipelineWorker<VolumeMetadata>(opts, "getVolumeMetadata", [
+      mountPoint,
+      opts,
+    ]) ??
+    getVolumeMetadataImpl(
+      { ...optionsWithDefaults(opts), mountPoint },
+      nativeFn,
+    )
+  );
+}
+
+/**
+ * Prepare a handle for polling one volume's metadata.
+ *
+ * Options are validated and defaulted once, and the full
+ * {@link getVolumeMetadata} pipeline runs once to capture the volume's
+ * identity (uuid, label, fstype, remote info, system-volume classification).
+ * {@link VolumeProbe.refresh} then re-reads only what changes while the
+ * volume stays mounted: space and quota, plus health status on macOS and
+ * Windows.
+ *
+ * On Linux the probe holds an open descriptor on the mount point, so each
+ * refresh is a single `fstatvfs()`. A held descriptor keeps the filesystem
+ * busy: `umount` without `-l` fails until you {@link VolumeProbe.close} it.
+ * Each refresh also lands in a fixed-size native history, from which
+ * {@link VolumeProbe.trend} estimates how soon space or inodes run out.
+ *
+ * @param mountPoint Must be a non-blank string
+ * @param opts Optional settings, applied to every refresh
+ */
+export function createVolumeProbe(
+  mountPoint: string,
+  opts?: Partial<
+    Pick<
+      Options,
+      | "timeoutMs"
+      | "skipNetworkVolumes"
+      | "networkFsTypes"
+      | "linuxMountTablePaths"
+      | "includeZfsGuids"
+      | "includeQuota"
+    >
+  > &
+    VolumeProbeOptions,
+): Promise<VolumeProbe> {
+  return createVolumeProbeImpl(
     { ...optionsWithDefaults(opts), mountPoint },
     nativeFn,
   );
 }
 
+/**
+ * List the btrfs subvolumes at or below the subvolume mounted at
+ * `mountPoint`, including unmounted ones such as snapshots.
+ *
+ * **Linux only**, and needs Linux 4.18 or later. Runs unprivileged:
+ * subvolumes the caller cannot traverse are omitted. Results are cached
+ * natively per filesystem, so later {@link getVolumeMetadata} calls resolve
+ * any of these subvolumes' identity without touching them again.
+ *
+ * @param mountPoint A btrfs mount point
+ * @param opts Optional settings
+ * @throws if `mountPoint` is not the root of a btrfs subvolume, if more than
+ * 65,536 subvolumes are found (those listed are still cached), or on other
+ * platforms
+ */
+export function getBtrfsSubvolumes(
+  mountPoint: string,
+  opts?: Partial<Pick<Options, "timeoutMs">>,
+): Promise<BtrfsSubvolume[]> {
+  return getBtrfsSubvolumesImpl(
+    mountPoint,
+    optionsWithDefaults(opts),
+    nativeFn,
+  );
+}
+
+/**
+ * Start a background service that re-checks every mounted volume's health on
+ * its own schedule, and emits `change` events only when a volume's status
+ * changes (say, from `healthy` to `timeout` or `disconnected`).
+ *
+ * Each check reads one directory entry on the addon's own threads, bounded
+ * by `timeoutMs`, in a pool of at most `maxConcurrency` checks shared by all
+ * volumes. A volume whose read is stuck isn't read again until that read
+ * settles: its later checks wait on the same read and report `timeout`
+ * meanwhile. Delays are jittered, and unhealthy volumes back off
+ * exponentially up to `maxBackoffMs`. The mount table is re-read every
+ * `mountTableIntervalMs`; volumes that disappear emit `removed`.
+ * {@link VolumeHealthMonitor.stats} reports what the monitor has cost so far.
+ *
+ * The monitor's timers never keep the process alive. Call
+ * {@link VolumeHealthMonitor.close} to stop it.
+ *
+ * @param opts Optional schedule and mount-point filtering settings
+ */
+export function createVolumeHealthMonitor(
+  opts?: Partial<VolumeHealthMonitorOptions>,
+): VolumeHealthMonitor {
+  return createVolumeHealthMonitorImpl(opts ?? {}, nativeFn);
+}
+
+/**
+ * Listen for kernel block-device events: `insert` and `eject` when removable
+ * devices (or their media) come and go, and `uevent` for every add, remove
+ * or change.
+ *
+ * While any watcher is open, {@link getVolumeMetadata} caches each block
+ * device's `uuid` and `label` natively and skips blkid on later calls; every
+ * event for a device drops its entry, so identity never goes stale. (udev
+ * re-announces a device as `change` after `mkfs` or a relabel; without udev,
+ * as in many containers, those edits go unseen.) In a network namespace
+ * owned by another user namespace, as in rootless containers, the kernel
+ * sends no block events, so nothing is cached there.
+ *
+ * **Linux only.** The listener never keeps the process alive. Call
+ * {@link BlockDeviceWatcher.close} to stop it.
+ *
+ * @param opts Optional settings
+ * @throws on other platforms, or if the kernel uevent socket cannot be opened
+ */
+export function watchBlockDevices(
+  opts?: Partial<BlockDeviceWatcherOptions>,
+): Promise<BlockDeviceWatcher> {
+  return watchBlockDevicesImpl(opts ?? {}, nativeFn);
+}
+
+/**
+ * List block devices, mounted or not, with their filesystem type, uuid and
+ * label: much like `lsblk -f`, for offering volumes to mount.
+ *
+ * Devices are read from sysfs, and identity from udev's database. Devices
+ * udev hasn't described (as in containers without udev) fall back to
+ * libblkid's cache, and then, with `probe` (the default), to reading the
+ * device, which usually needs root. Those reads go one partition at a time
+ * on each disk, and to at most `maxConcurrency` disks at once.
+ *
+ * To refresh incrementally, pass the devices that changed as `devices`,
+ * say from {@link watchBlockDevices} events. While a watcher is open,
+ * libblkid results are also cached natively until their device changes.
+ *
+ * **Linux only.**
+ *
+ * @param opts Optional settings
+ * @throws on other platforms
+ */
+export function getBlockDevices(
+  opts?: Partial<GetBlockDevicesOptions>,
+): Promise<BlockDevice[]> {
+  return getBlockDevicesImpl(opts ?? {}, nativeFn);
+}
+
+/**
+ * Size, hit, miss and eviction counters for every cache this module keeps,
+ * JavaScript and native, so {@link setCacheBudget} can be tuned from data.
+ */
+export function getCacheStats(): Promise<CacheStats[]> {
+  return getCacheStatsImpl(nativeFn);
+}
+
+/**
+ * Bound the memory and file descriptors this module's caches may hold.
+ * Omitted limits are unchanged; defaults are {@link CacheMaxBytesDefault}
+ * and {@link CacheMaxFdsDefault}.
+ *
+ * `maxBytes` bounds the JavaScript caches together, and separately the
+ * native caches together. Within each, the least recently used entry of any
+ * cache is evicted first, and a lower limit evicts at once.
+ *
+ * @param budget Limits to change
+ * @throws {TypeError} unless each given limit is a non-negative integer
+ */
+export function setCacheBudget(budget: Partial<CacheBudget>): Promise<void> {
+  return setCacheBudgetImpl(budget, nativeFn);
+}
+
 /**
  * Get metadata for the volume that contains the given file or directory path.
  *
@@ -151,16 +369,56 @@ export function getVolumeMetadataForPath(
       | "skipNetworkVolumes"
       | "networkFsTypes"
       | "includeZfsGuids"
+      | "includeQuota"
+      | "useWorkerThread"
     >
   >,
 ): Promise<VolumeMetadata> {
-  return getVolumeMetadataForPathImpl(
-    pathname,
-    optionsWithDefaults(opts),
-    nativeFn,
+  return (
+    viaPipelineWorker<VolumeMetadata>(opts, "getVolumeMetadataForPath", [
+      pathname,
+      opts,
+    ]) ??
+    getVolumeMetadataForPathImpl(pathname, optionsWithDefaults(opts), nativeFn)
   );
 }
 
+/**
+ * Get metadata for the volume behind a file descriptor you already hold open,
+ * such as a file being written.
+ *
+ * Cheaper than {@link getVolumeMetadataForPath}: no `realpath()`, `stat()`,
+ * mount enumeration or `open()`. The descriptor's mount id (`statx()`'s
+ * `STATX_MNT_ID`, Linux 5.8+, or `/proc/self/fdinfo` before that) is looked
+ * up in a cached `/proc/self/mountinfo` that is only re-read after something
+ * is mounted or unmounted, and space, identity and quota are read through
+ * a duplicate of the descriptor.
+ *
+ * **Linux only.** `status` is always `healthy`: holding the descriptor is
+ * the health check.
+ *
+ * @param fd An open file descriptor, e.g. from `fs.open()` or
+ * `FileHandle.fd`
+ * @param opts Optional settings
+ * @throws on other platforms, or if `fd` is not open
+ */
+export function getVolumeMetadataForFd(
+  fd: number,
+  opts?: Partial<
+    Pick<
+      Options,
+      | "timeoutMs"
+      | "includeZfsGuids"
+      | "includeQuota"
+      | "networkFsTypes"
+      | "systemFsTypes"
+      | "systemPathPatterns"
+    >
+  >,
+): Promise<VolumeMetadata> {
+  return getVolumeMetadataForFdImpl(fd, optionsWithDefaults(opts), nativeFn);
+}
+
 /**
  * Get the mount point path for an arbitrary file or directory path.
  *
@@ -192,16 +450,72 @@ export function getMountPointForPath(
       | "mountPoints"
       | "skipNetworkVolumes"
       | "networkFsTypes"
+      | "useWorkerThread"
     >
   >,
 ): Promise<string> {
-  return getMountPointForPathImpl(
-    pathname,
-    optionsWithDefaults(opts),
-    nativeFn,
+  return (
+    viaPipelineWorker<string>(opts, "getMountPointForPath", [pathname, opts]) ??
+    getMountPointForPathImpl(pathname, optionsWithDefaults(opts), nativeFn)
   );
 }
 
+/**
+ * Synchronous {@link getVolumeMetadata}, for startup code and CLI tools that
+ * cannot await.
+ *
+ * **Linux only.** The mount table is read from `/proc` to prove the volume is
+ * local before anything touches it: network volumes are refused (or, with
+ * {@link Options.skipNetworkVolumes}, returned with only mount table fields
+ * and `status: "unknown"`), as are mount points missing from the mount table.
+ * There is no timeout: a wedged local disk will still block the event loop.
+ *
+ * ZFS GUIDs are not fetched. Other platforms throw.
+ *
+ * @param mountPoint Must be a non-blank string
+ * @param opts Optional settings
+ */
+export function getVolumeMetadataSync(
+  mountPoint: string,
+  opts?: Partial<SyncOptions>,
+): VolumeMetadata {
+  return getVolumeMetadataSyncImpl({ ...opts, mountPoint }, nativeSyncFn);
+}
+
+/**
+ * Decode a snapshot from {@link encodeVolumeSnapshot}. Full snapshots are
+ * decoded by the native module, reading `bytes` in place; deltas need the
+ * `base` they were encoded against.
+ *
+ * @param bytes Snapshot bytes; not modified
+ * @param opts.base Required for delta snapshots
+ * @throws {TypeError} if the bytes aren't a supported snapshot, or a delta's
+ * `base` is missing or wrong
+ */
+export function decodeVolumeSnapshot(
+  bytes: Uint8Array,
+  opts: { base?: readonly VolumeMetadata[] } = {},
+): VolumeMetadata[] {
+  return decodeVolumeSnapshotImpl(bytes, opts, nativeSyncFn);
+}
+
+/**
+ * Synchronous {@link getMountPointForPath}.
+ *
+ * **Linux only.** Throws rather than touching a path that lies on a network
+ * volume, either as given or after symlink resolution. Remote mount points
+ * elsewhere are never statted. There is no timeout. Other platforms throw.
+ *
+ * @param pathname Path to any file or directory
+ * @param opts Optional settings
+ */
+export function getMountPointForPathSync(
+  pathname: string,
+  opts?: Partial<SyncOptions>,
+): string {
+  return getMountPointForPathSyncImpl(pathname, opts ?? {});
+}
+
 /**
  * Retrieves metadata for all mounted volumes with optional filtering and
  * concurrency control.
@@ -222,74 +536,109 @@ export function getMountPointForPath(
 export function getAllVolumeMetadata(
   opts?: Partial<Options> & { includeSystemVolumes?: boolean },
 ): Promise<VolumeMetadata[]> {
-  return getAllVolumeMetadataImpl(optionsWithDefaults(opts), nativeFn);
+  return (
+    viaPipelineWorker<VolumeMetadata[]>(opts, "getAllVolumeMetadata", [
+      opts,
+    ]) ?? getAllVolumeMetadataImpl(optionsWithDefaults(opts), nativeFn)
+  );
 }
 
 /**
- * Check if a file or directory is hidden.
+ * {@link getAllVolumeMetadata} in two phases, so a UI can show every volume
+ * before the slowest probe finishes.
+ *
+ * Resolves as soon as the mount points are listed, with a shallow result per
+ * volume in {@link ProgressiveVolumeMetadata.volumes}. On Linux these come
+ * from the mount table alone, with no I/O on the volumes. Each volume's
+ * complete metadata (space, identity, health) is then emitted as `refined`,
+ * in whatever order the probes finish, and `done` follows with the same list
+ * {@link getAllVolumeMetadata} would return. That list comes from the same
+ * health check, so it can omit shallow results such as file bind mounts, and
+ * it skips unhealthy volumes the same way.
  *
- * Note that `path` may be _effectively_ hidden if any of the ancestor
- * directories are hidden: use {@link isHiddenRecursive} to check for this.
+ * Always runs on the calling thread: `useWorkerThread` is ignored.
  *
- * @param pathname Path to file or directory
- * @returns Promise resolving to boolean indicating hidden state
+ * @param opts Same as {@link getAllVolumeMetadata}. `timeoutMs` bounds
+ * listing the mount points, and then each volume's probe.
  */
-export function isHidden(pathname: string): Promise<boolean> {
-  return isHiddenImpl(pathname, nativeFn);
+export function getAllVolumeMetadataProgressive(
+  opts?: ProgressiveVolumeMetadataOptions,
+): Promise<ProgressiveVolumeMetadata> {
+  return getAllVolumeMetadataProgressiveImpl(opts ?? {}, nativeFn);
 }
 
 /**
- * Check if a file or directory is hidden, or if any of its ancestor
- * directories are hidden.
+ * A cache of {@link getAllVolumeMetadata} shared by every process on the host
+ * that opens the same `name`, such as the workers of a Node `cluster`: one
+ * process probes the volumes and the rest read its result.
+ *
+ * The result lives in a POSIX shared-memory segment,
+ * `/dev/shm/fs-metadata-<name>`, as an {@link encodeVolumeSnapshot} snapshot
+ * of every volume's mount info, identity and most recent space figures.
+ * Reading it takes no locks and no syscalls: readers copy it out under a
+ * seqlock and retry if a publish raced them. When it's older than
+ * `maxAgeMs`, whichever process takes the segment's lease refreshes it,
+ * while the others keep returning the previous result.
+ *
+ * Processes must share a pid namespace, so that a dead lease holder can be
+ * detected. `opts` apply to this process's refreshes: give every process the
+ * same ones. The segment outlives every process that opened it: see
+ * {@link unlinkSharedVolumeCache}.
  *
- * @param pathname Path to file or directory
- * @returns Promise resolving to boolean indicating hidden state
+ * **Linux only.** Other platforms throw.
+ *
+ * @param opts `name` is required; the rest are as for
+ * {@link getAllVolumeMetadata}
  */
-export function isHiddenRecursive(pathname: string): Promise<boolean> {
-  return isHiddenRecursiveImpl(pathname, nativeFn);
+export function createSharedVolumeCache(
+  opts: SharedVolumeCacheOptions &
+    Partial<Options> & { includeSystemVolumes?: boolean },
+): Promise<SharedVolumeCache> {
+  return createSharedVolumeCacheImpl(opts, nativeFn);
 }
 
 /**
- * Get detailed metadata about the hidden state of a file or directory.
+ * Remove the segment behind {@link createSharedVolumeCache}. Processes that
+ * still have it open keep using their mapping; the next to open the name
+ * creates a new, empty segment.
+ *
+ * **Linux only.**
  *
- * @param pathname Path to file or directory
- * @returns Promise resolving to metadata about the hidden state
+ * @returns false if there was no such segment
  */
-export function getHiddenMetadata(pathname: string): Promise<HiddenMetadata> {
-  return getHiddenMetadataImpl(pathname, nativeFn);
+export function unlinkSharedVolumeCache(name: string): Promise<boolean> {
+  return unlinkSharedVolumeCacheImpl(name, nativeFn);
 }
 
-/**
- * Set the hidden state of a file or directory
- *
- * @param pathname Path to file or directory
- * @param hidden - Whether the item should be hidden (true) or visible (false)
- * @param method Method to use for hiding the file or directory. The default
- * is "auto", which is "dotPrefix" on Linux and macOS, and "systemFlag" on
- * Windows. "all" will attempt to use all relevant methods for the current
- * operating system.
- * @returns Promise resolving the final name of the file or directory (as it
- * will change on POSIX systems), and the action(s) taken.
- * @throws {Error} If the file doesn't exist, permissions are insufficient, or
- * the requested method is unsupported
- */
-export function setHidden(
-  pathname: string,
-  hidden: boolean,
-  method: HideMethod = "auto",
-): Promise<SetHiddenResult> {
-  return setHiddenImpl(pathname, hidden, method, nativeFn);
-}
+// Also published on their own, as the "./hidden" and "./mount-points"
+// subpath exports, for consumers that want a lighter import.
+export {
+  getHiddenMetadata,
+  isHidden,
+  isHiddenRecursive,
+  setHidden,
+} from "./hidden_entry";
+export { getVolumeMountPoints } from "./mount_points_entry";
 
 export {
+  CacheMaxBytesDefault,
+  CacheMaxFdsDefault,
+  encodeVolumeSnapshot,
   getTimeoutMsDefault,
   IncludeSystemVolumesDefault,
   LinuxMountTablePathsDefault,
   NetworkFsTypesDefault,
   OptionsDefault,
   optionsWithDefaults,
+  PriorityDefault,
+  readVolumeSnapshot,
+  SharedVolumeCacheLeaseMsDefault,
+  SharedVolumeCacheMaxAgeMsDefault,
+  SharedVolumeCacheSizeBytesDefault,
   SkipNetworkVolumesDefault,
   SystemFsTypesDefault,
   SystemPathPatternsDefault,
   VolumeHealthStatuses,
+  VolumeProbeHistorySizeDefault,
+  VolumeSnapshotVersion,
 };
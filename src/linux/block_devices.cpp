@@ -0,0 +1,192 @@
+// src/linux/block_devices.cpp
+//
+// Filesystem identity (TYPE, UUID, LABEL) of block devices that may not be
+// mounted, for getBlockDevices() (see src/linux/block_devices.ts). The
+// TypeScript side already read udev's database; this is the fallback for
+// devices udev hasn't described. Cheapest first: DeviceIdentityCache, then
+// libblkid's cache file, and only then (opt-in) a probe that reads the
+// device itself.
+
+#include "../common/debug_log.h"
+#include "../common/shutdown.h"
+#include "blkid_cache.h"
+#include "fs_meta.h"
+#include "uevent_monitor.h"
+#include <memory>
+#include <string_view>
+#include <sys/stat.h>
+#include <vector>
+
+namespace FSMeta {
+
+namespace {
+
+struct BlockDeviceIdentity {
+  bool found = false;
+  DeviceIdentity identity;
+};
+
+// Copies TYPE, UUID and LABEL from `dev`'s tags. Returns false without a
+// TYPE: blkid knows the device but found no filesystem on it.
+bool ReadTags(blkid_dev dev, DeviceIdentity &out) {
+  blkid_tag_iterate iter = blkid_tag_iterate_begin(dev);
+  if (iter == nullptr) {
+    return false;
+  }
+  const char *type = nullptr;
+  const char *value = nullptr;
+  while (blkid_tag_next(iter, &type, &value) == 0) {
+    const std::string_view tag(type);
+    if (tag == "TYPE") {
+      out.fstype = value;
+    } else if (tag == "UUID") {
+      out.uuid = value;
+    } else if (tag == "LABEL") {
+      out.label = value;
+    }
+  }
+  blkid_tag_iterate_end(iter);
+  return !out.fstype.empty();
+}
+
+class GetBlockDeviceIdentitiesWorker : public SafeAsyncWorker {
+public:
+  GetBlockDeviceIdentitiesWorker(std::vector<std::string> devices, bool probe,
+                                 const Napi::Promise::Deferred &deferred)
+      : SafeAsyncWorker(deferred.Env()), devices_(std::move(devices)),
+        probe_(probe), deferred_(deferred) {}
+
+  void Execute() override {
+    if (IsShuttingDown()) {
+      SetError("fs-metadata: shutdown in progress");
+      return;
+    }
+    results_.resize(devices_.size());
+    // One libblkid cache for the batch: the devices of one disk are handed
+    // over together, and probed one after another.
+    std::unique_ptr<BlkidCache> cache;
+    for (size_t i = 0; i < devices_.size(); i++) {
+      if (IsShuttingDown()) {
+        return;
+      }
+      const std::string &device = devices_[i];
+      struct stat st {};
+      if (device.rfind("/dev/", 0) != 0 || stat(device.c_str(), &st) != 0 ||
+          !S_ISBLK(st.st_mode)) {
+        continue;
+      }
+      auto &result = results_[i];
+      uint64_t epoch = 0;
+      // Entries stored by getVolumeMetadata() carry no fstype.
+      if (DeviceIdentityCache::Lookup(st.st_rdev, result.identity, epoch) &&
+          !result.identity.fstype.empty()) {
+        result.found = true;
+        continue;
+      }
+      result.identity = {};
+      bool verified = false;
+      try {
+        if (cache == nullptr) {
+          cache = std::make_unique<BlkidCache>();
+        }
+        // BLKID_DEV_FIND only consults the cache file; BLKID_DEV_NORMAL
+        // verifies against (and so reads) the device, which usually needs
+        // root.
+        blkid_dev dev = blkid_get_dev(cache->get(), device.c_str(),
+                                      BLKID_DEV_FIND);
+        result.found = dev != nullptr && ReadTags(dev, result.identity);
+        if (!result.found && probe_) {
+          result.identity = {};
+          dev = blkid_get_dev(cache->get(), device.c_str(), BLKID_DEV_NORMAL);
+          result.found = dev != nullptr && ReadTags(dev, result.identity);
+          verified = result.found;
+        }
+      } catch (const std::exception &e) {
+        DEBUG_LOG("[GetBlockDeviceIdentities] blkid error for %s: %s",
+                  device.c_str(), e.what());
+        continue;
+      }
+      DEBUG_LOG("[GetBlockDeviceIdentities] %s: %s", device.c_str(),
+                result.found ? result.identity.fstype.c_str() : "(none)");
+      // The cache file may predate a mkfs, and getVolumeMetadata() trusts
+      // DeviceIdentityCache over blkid: only cache what was read from the
+      // device itself.
+      if (verified) {
+        DeviceIdentityCache::Store(st.st_rdev, epoch, result.identity);
+      }
+    }
+  }
+
+  void OnOK() override {
+    Napi::HandleScope scope(Env());
+    auto env = Env();
+    auto result = Napi::Array::New(env, results_.size());
+    for (size_t i = 0; i < results_.size(); i++) {
+      const auto &ea = results_[i];
+      if (!ea.found) {
+        result.Set(static_cast<uint32_t>(i), env.Null());
+        continue;
+      }
+      auto obj = Napi::Object::New(env);
+      obj.Set("fstype", Napi::String::New(env, ea.identity.fstype));
+      if (!ea.identity.uuid.empty()) {
+        obj.Set("uuid", Napi::String::New(env, ea.identity.uuid));
+      }
+      if (!ea.identity.label.empty()) {
+        obj.Set("label", Napi::String::New(env, ea.identity.label));
+      }
+      result.Set(static_cast<uint32_t>(i), obj);
+    }
+    SafeResolve(deferred_, result);
+  }
+
+  void OnError(const Napi::Error &error) override {
+    Napi::HandleScope scope(Env());
+    SafeReject(deferred_, error.Value());
+  }
+
+private:
+  std::vector<std::string> devices_;
+  bool probe_;
+  Napi::Promise::Deferred deferred_;
+  std::vector<BlockDeviceIdentity> results_;
+};
+
+} // namespace
+
+Napi::Value GetBlockDeviceIdentities(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "Expected options object with devices");
+  }
+  auto options = info[0].As<Napi::Object>();
+  Napi::Value devicesValue = options.Get("devices");
+  if (!devicesValue.IsArray()) {
+    throw Napi::TypeError::New(env, "devices must be an array of strings");
+  }
+  auto array = devicesValue.As<Napi::Array>();
+  std::vector<std::string> devices;
+  devices.reserve(array.Length());
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    Napi::Value device = array.Get(i);
+    if (!device.IsString()) {
+      throw Napi::TypeError::New(env, "devices must be an array of strings");
+    }
+    devices.push_back(device.As<Napi::String>().Utf8Value());
+  }
+  Napi::Value probe = options.Get("probe");
+  if (!probe.IsUndefined() && !probe.IsBoolean()) {
+    throw Napi::TypeError::New(env, "probe must be a boolean");
+  }
+
+  const WorkPriority priority = WorkPriorityFromObject(options);
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto *worker = new GetBlockDeviceIdentitiesWorker(
+      std::move(devices), probe.IsBoolean() && probe.As<Napi::Boolean>(),
+      deferred);
+  worker->Queue(priority);
+  return deferred.Promise();
+}
+
+} // namespace FSMeta
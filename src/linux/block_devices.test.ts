@@ -0,0 +1,274 @@
+// src/linux/block_devices.test.ts
+//
+// getBlockDevices() over a fake sysfs tree, udev database and mount table,
+// with a mock native addon standing in for libblkid.
+
+import { mkdir, mkdtemp, rm, symlink, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { describePlatform } from "../test-utils/platform";
+import type { BlockDeviceIdentity } from "../types/block_device";
+import type { NativeBindings } from "../types/native_bindings";
+import { getBlockDevicesImpl, parseUdevData } from "./block_devices";
+
+describe("parseUdevData()", () => {
+  it("reads E: properties and ignores other records", () => {
+    const props = parseUdevData(
+      [
+        "S:disk/by-uuid/1234-ABCD",
+        "W:12",
+        "E:ID_FS_TYPE=vfat",
+        "E:ID_FS_LABEL_ENC=MY\\x20CARD",
+        "E:EMPTY=",
+        "",
+      ].join("\n"),
+    );
+    expect([...props]).toEqual([
+      ["ID_FS_TYPE", "vfat"],
+      ["ID_FS_LABEL_ENC", "MY\\x20CARD"],
+      ["EMPTY", ""],
+    ]);
+  });
+});
+
+describePlatform("linux")("getBlockDevicesImpl()", () => {
+  let root: string;
+  let sysfsRoot: string;
+  let udevDataDir: string;
+  let mtab: string;
+  let batches: string[][];
+  let blkid: Record<string, BlockDeviceIdentity>;
+
+  const native = {
+    classifyBlockDevices: async (devices: string[]) =>
+      devices.map((device) =>
+        device.startsWith("/dev/sdb")
+          ? { major: 8, minor: 16, removable: true, transport: "usb" }
+          : null,
+      ),
+    getBlockDeviceIdentities: async ({ devices }: { devices: string[] }) => {
+      batches.push(devices);
+      return devices.map((ea) => blkid[ea] ?? null);
+    },
+  } as unknown as NativeBindings;
+
+  async function addDevice(
+    name: string,
+    devicePath: string,
+    attrs: Record<string, string>,
+  ) {
+    const dir = join(sysfsRoot, "devices", devicePath);
+    await mkdir(dir, { recursive: true });
+    for (const [attr, value] of Object.entries(attrs)) {
+      await writeFile(join(dir, attr), value + "\n");
+    }
+    await symlink(dir, join(sysfsRoot, "class", "block", name));
+  }
+
+  async function addUdev(key: string, props: Record<string, string>) {
+    const lines = Object.entries(props).map(([k, v]) => `E:${k}=${v}`);
+    await writeFile(join(udevDataDir, "b" + key), lines.join("\n") + "\n");
+  }
+
+  function list(opts: object = {}) {
+    return getBlockDevicesImpl(
+      { sysfsRoot, udevDataDir, linuxMountTablePaths: [mtab], ...opts },
+      () => native,
+    );
+  }
+
+  beforeEach(async () => {
+    root = await mkdtemp(join(tmpdir(), "fs-metadata-blockdev-"));
+    sysfsRoot = join(root, "sys");
+    udevDataDir = join(root, "udev");
+    mtab = join(root, "mounts");
+    batches = [];
+    blkid = {};
+    await mkdir(join(sysfsRoot, "class", "block"), { recursive: true });
+    await mkdir(udevDataDir);
+    await writeFile(mtab, "/dev/sda1 / ext4 rw 0 0\nproc /proc proc rw 0 0\n");
+
+    await addDevice("sda", "sda", {
+      dev: "8:0",
+      size: "2000",
+      removable: "0",
+      ro: "0",
+    });
+    await addDevice("sda1", "sda/sda1", {
+      dev: "8:1",
+      size: "1000",
+      ro: "0",
+      partition: "1",
+    });
+    await addDevice("sda2", "sda/sda2", {
+      dev: "8:2",
+      size: "900",
+      ro: "0",
+      partition: "2",
+    });
+    await addDevice("sdb", "sdb", {
+      dev: "8:16",
+      size: "4000",
+      removable: "1",
+      ro: "0",
+    });
+    await addDevice("sdb1", "sdb/sdb1", {
+      dev: "8:17",
+      size: "3900",
+      ro: "1",
+      partition: "1",
+    });
+    // Unattached: omitted.
+    await addDevice("loop0", "virtual/block/loop0", {
+      dev: "7:0",
+      size: "0",
+      ro: "0",
+    });
+  });
+
+  afterEach(async () => {
+    await rm(root, { recursive: true, force: true });
+  });
+
+  it("lists disks and partitions with udev identity", async () => {
+    await addUdev("8:0", { ID_PART_TABLE_TYPE: "gpt" });
+    await addUdev("8:1", { ID_FS_TYPE: "ext4", ID_FS_UUID: "root-uuid" });
+    await addUdev("8:2", { ID_FS_TYPE: "swap" });
+    await addUdev("8:16", { ID_PART_TABLE_TYPE: "dos" });
+    await addUdev("8:17", {
+      ID_FS_TYPE: "vfat",
+      ID_FS_UUID: "1234-ABCD",
+      ID_FS_LABEL: "MY_CARD",
+      ID_FS_LABEL_ENC: "MY\\x20CARD",
+    });
+
+    expect(await list()).toEqual([
+      {
+        device: "/dev/sda",
+        major: 8,
+        minor: 0,
+        type: "disk",
+        size: 2000 * 512,
+        readOnly: false,
+        removable: false,
+        mountPoints: [],
+      },
+      {
+        device: "/dev/sda1",
+        major: 8,
+        minor: 1,
+        type: "partition",
+        disk: "/dev/sda",
+        size: 1000 * 512,
+        readOnly: false,
+        removable: false,
+        fstype: "ext4",
+        uuid: "root-uuid",
+        mountPoints: ["/"],
+      },
+      {
+        device: "/dev/sda2",
+        major: 8,
+        minor: 2,
+        type: "partition",
+        disk: "/dev/sda",
+        size: 900 * 512,
+        readOnly: false,
+        removable: false,
+        fstype: "swap",
+        mountPoints: [],
+      },
+      {
+        device: "/dev/sdb",
+        major: 8,
+        minor: 16,
+        type: "disk",
+        size: 4000 * 512,
+        readOnly: false,
+        removable: true,
+        transport: "usb",
+        mountPoints: [],
+      },
+      {
+        device: "/dev/sdb1",
+        major: 8,
+        minor: 17,
+        type: "partition",
+        disk: "/dev/sdb",
+        size: 3900 * 512,
+        readOnly: true,
+        removable: true,
+        transport: "usb",
+        fstype: "vfat",
+        uuid: "1234-ABCD",
+        label: "MY CARD",
+        mountPoints: [],
+      },
+    ]);
+    // udev described every device, so libblkid was never asked:
+    expect(batches).toEqual([]);
+  });
+
+  it("falls back to libblkid one batch per disk", async () => {
+    await addUdev("8:1", { ID_FS_TYPE: "ext4" });
+    blkid["/dev/sdb1"] = { fstype: "exfat", label: "CAMERA" };
+
+    const devices = await list();
+    // Batch order depends on scheduling:
+    expect(batches.map((ea) => [...ea].sort()).sort()).toEqual([
+      ["/dev/sda", "/dev/sda2"],
+      ["/dev/sdb", "/dev/sdb1"],
+    ]);
+    const sdb1 = devices.find((ea) => ea.device === "/dev/sdb1");
+    expect(sdb1?.fstype).toBe("exfat");
+    expect(sdb1?.label).toBe("CAMERA");
+    expect(devices.find((ea) => ea.device === "/dev/sda2")?.fstype).toBe(
+      undefined,
+    );
+  });
+
+  it("lists only the requested devices", async () => {
+    await addUdev("8:17", { ID_FS_TYPE: "vfat" });
+    const devices = await list({ devices: ["/dev/sdb1"] });
+    expect(devices.map((ea) => ea.device)).toEqual(["/dev/sdb1"]);
+    expect(devices[0]?.fstype).toBe("vfat");
+    expect(batches).toEqual([]);
+  });
+
+  it("passes priority to libblkid", async () => {
+    const priorities: unknown[] = [];
+    const recording = {
+      ...native,
+      getBlockDeviceIdentities: async (o: { priority?: string }) => {
+        priorities.push(o.priority);
+        return [];
+      },
+    } as unknown as NativeBindings;
+    await getBlockDevicesImpl(
+      {
+        sysfsRoot,
+        udevDataDir,
+        linuxMountTablePaths: [mtab],
+        devices: ["/dev/sdb1"],
+        priority: "background",
+      },
+      () => recording,
+    );
+    expect(priorities).toEqual(["background"]);
+  });
+
+  it("omits identity when libblkid fails", async () => {
+    const failing = {
+      ...native,
+      getBlockDeviceIdentities: async () => {
+        throw new Error("EACCES");
+      },
+    } as unknown as NativeBindings;
+    const devices = await getBlockDevicesImpl(
+      { sysfsRoot, udevDataDir, linuxMountTablePaths: [mtab] },
+      () => failing,
+    );
+    expect(devices).toHaveLength(5);
+    expect(devices.every((ea) => ea.fstype == null)).toBe(true);
+  });
+});
@@ -0,0 +1,372 @@
+// src/linux/block_devices.ts
+
+import { readdir, readFile, realpath, stat } from "node:fs/promises";
+import { basename, dirname, join } from "node:path";
+import { uniq } from "../array";
+import { mapConcurrent, validateTimeoutMs, withTimeout } from "../async";
+import { debug } from "../debuglog";
+import { compactValues, isObject, omit } from "../object";
+import { optionsWithDefaults, validatePriority } from "../options";
+import { isLinux } from "../platform";
+import { decodeUdevEscapes } from "../string";
+import type {
+  BlockDevice,
+  BlockDeviceClass,
+  BlockDeviceFilter,
+  BlockDeviceIdentity,
+} from "../types/block_device";
+import type { NativeBindingsFn } from "../types/native_bindings";
+import type { Options } from "../types/options";
+import { getLinuxMountEntries } from "./mount_points";
+import type { MountEntry } from "./mtab";
+import { readSysfsNumber } from "./uevent_monitor";
+
+/**
+ * Throws a TypeError unless `filter` is a usable
+ * {@link Options.blockDeviceFilter}.
+ */
+export function validateBlockDeviceFilter(filter: unknown): BlockDeviceFilter {
+  if (!isObject(filter)) {
+    throw new TypeError("blockDeviceFilter must be an object");
+  }
+  const { removable, transports } = filter as BlockDeviceFilter;
+  if (removable != null && typeof removable !== "boolean") {
+    throw new TypeError("blockDeviceFilter.removable must be a boolean");
+  }
+  if (
+    transports != null &&
+    !(
+      Array.isArray(transports) &&
+      transports.every((ea) => typeof ea === "string")
+    )
+  ) {
+    throw new TypeError("blockDeviceFilter.transports must be string[]");
+  }
+  return filter as BlockDeviceFilter;
+}
+
+/**
+ * A device matches if it's removable (when `filter.removable` is true) or on
+ * one of `filter.transports`. With neither, every block device matches.
+ */
+export function matchesBlockDeviceFilter(
+  device: BlockDeviceClass | null | undefined,
+  filter: BlockDeviceFilter,
+): boolean {
+  if (device == null) return false;
+  const wantRemovable = filter.removable === true;
+  if (!wantRemovable && filter.transports == null) return true;
+  return (
+    (wantRemovable && device.removable) ||
+    (device.transport != null &&
+      filter.transports?.includes(device.transport) === true)
+  );
+}
+
+/**
+ * The mount table entries whose device matches `filter`. Each distinct
+ * device is classified once, natively, from sysfs: no mounted volume is
+ * touched.
+ */
+export async function filterMountEntriesByBlockDevice(
+  entries: MountEntry[],
+  filter: BlockDeviceFilter,
+  nativeFn: NativeBindingsFn,
+): Promise<MountEntry[]> {
+  const native = await nativeFn();
+  if (native.classifyBlockDevices == null) {
+    throw new Error(
+      "blockDeviceFilter is not available in these native bindings",
+    );
+  }
+  const devices = uniq(
+    entries.map((ea) => ea.fs_spec).filter((ea) => ea.startsWith("/dev/")),
+  );
+  const classes = await native.classifyBlockDevices(devices);
+  const byDevice = new Map<string, BlockDeviceClass | null>();
+  devices.forEach((device, i) => byDevice.set(device, classes[i] ?? null));
+  const result = entries.filter((ea) =>
+    matchesBlockDeviceFilter(byDevice.get(ea.fs_spec), filter),
+  );
+  debug(
+    "[filterMountEntriesByBlockDevice] %d of %d mounts (%d devices) match %o",
+    result.length,
+    entries.length,
+    devices.length,
+    filter,
+  );
+  return result;
+}
+
+export interface GetBlockDevicesOptions
+  extends Pick<
+    Options,
+    "timeoutMs" | "maxConcurrency" | "linuxMountTablePaths" | "priority"
+  > {
+  /**
+   * Only list these devices (device nodes or symlinks to them, like
+   * `/dev/disk/by-id/...`), say the `device` of a {@link BlockDeviceEvent}.
+   * Lists every block device if omitted.
+   */
+  devices?: string[];
+
+  /**
+   * Read devices that neither udev nor libblkid's cache has identified. This
+   * usually needs root; without it, those devices have no `fstype`.
+   * Defaults to true.
+   */
+  probe: boolean;
+
+  /**
+   * Where sysfs is mounted. Defaults to "/sys".
+   */
+  sysfsRoot: string;
+
+  /**
+   * udev's device database. Defaults to "/run/udev/data".
+   */
+  udevDataDir: string;
+}
+
+export const GetBlockDevicesDefaults = {
+  probe: true,
+  sysfsRoot: "/sys",
+  udevDataDir: "/run/udev/data",
+} as const;
+
+/**
+ * The `E:` properties of one udev database record.
+ */
+export function parseUdevData(content: string): Map<string, string> {
+  const result = new Map<string, string>();
+  for (const line of content.split("\n")) {
+    if (!line.startsWith("E:")) continue;
+    const eq = line.indexOf("=");
+    if (eq > 2) result.set(line.slice(2, eq), line.slice(eq + 1));
+  }
+  return result;
+}
+
+/**
+ * The filesystem identity udev recorded for `major:minor`, `null` if udev
+ * recorded the device but found no filesystem on it, or undefined if udev
+ * has no record (no udev, as in many containers, or not yet processed).
+ */
+async function readUdevIdentity(
+  key: string,
+  udevDataDir: string,
+): Promise<BlockDeviceIdentity | null | undefined> {
+  let props: Map<string, string>;
+  try {
+    props = parseUdevData(await readFile(join(udevDataDir, "b" + key), "utf8"));
+  } catch {
+    return;
+  }
+  const fstype = props.get("ID_FS_TYPE");
+  if (fstype == null || fstype === "") return null;
+  const uuid = props.get("ID_FS_UUID");
+  const labelEnc = props.get("ID_FS_LABEL_ENC");
+  const label =
+    labelEnc == null ? props.get("ID_FS_LABEL") : decodeUdevEscapes(labelEnc);
+  return {
+    fstype,
+    ...(uuid == null || uuid === "" ? {} : { uuid }),
+    ...(label == null || label === "" ? {} : { label }),
+  };
+}
+
+type SysfsBlockDevice = Omit<
+  BlockDevice,
+  "removable" | "transport" | "mountPoints"
+> & {
+  key: string;
+  removable: boolean;
+};
+
+/**
+ * Reads `/sys/class/block/<name>`. Undefined for devices that have gone
+ * away, and for empty ones (unattached loop devices, card readers without
+ * a card).
+ */
+async function readSysfsBlockDevice(
+  name: string,
+  sysfsRoot: string,
+): Promise<SysfsBlockDevice | undefined> {
+  const link = join(sysfsRoot, "class", "block", name);
+  let key: string;
+  let dir: string;
+  try {
+    key = (await readFile(join(link, "dev"), "utf8")).trim();
+    dir = await realpath(link);
+  } catch {
+    return;
+  }
+  const [major, minor] = key.split(":").map((ea) => parseInt(ea, 10));
+  const sectors = await readSysfsNumber(join(dir, "size"));
+  if (major == null || minor == null || sectors == null || sectors === 0) {
+    return;
+  }
+  const isPartition = await stat(join(dir, "partition")).then(
+    () => true,
+    () => false,
+  );
+  // A partition's `removable` is its disk's, and its disk its parent
+  // directory.
+  const removable =
+    (await readSysfsNumber(join(dir, "removable"))) ??
+    (await readSysfsNumber(join(dirname(dir), "removable")));
+  return {
+    key,
+    device: "/dev/" + name,
+    major,
+    minor,
+    type: isPartition ? "partition" : "disk",
+    ...(isPartition ? { disk: "/dev/" + basename(dirname(dir)) } : {}),
+    // sysfs sizes are always in 512-byte sectors:
+    size: sectors * 512,
+    readOnly: (await readSysfsNumber(join(dir, "ro"))) === 1,
+    removable: removable === 1,
+  };
+}
+
+/**
+ * The /dev/<name> nodes of the mounted block devices, mapped to their
+ * mount points.
+ */
+async function mountPointsByDevice(
+  opts: Pick<Options, "linuxMountTablePaths">,
+): Promise<Map<string, string[]>> {
+  const result = new Map<string, string[]>();
+  let entries: MountEntry[];
+  try {
+    entries = await getLinuxMountEntries(opts);
+  } catch (error) {
+    debug("[getBlockDevices] mount table unreadable: %s", error);
+    return result;
+  }
+  await Promise.all(
+    entries
+      .filter((ea) => ea.fs_spec.startsWith("/dev/"))
+      .map(async (ea) => {
+        // /dev/mapper/* and /dev/disk/by-*/* are symlinks to the node:
+        const device = await realpath(ea.fs_spec).catch(() => ea.fs_spec);
+        result.set(device, [...(result.get(device) ?? []), ea.fs_file]);
+      }),
+  );
+  return result;
+}
+
+/**
+ * The sysfs names of `devices`, resolving symlinks.
+ */
+async function blockDeviceNames(devices: string[]): Promise<string[]> {
+  return uniq(
+    await Promise.all(
+      devices.map(async (ea) =>
+        basename(await realpath(ea).catch(() => ea)),
+      ),
+    ),
+  );
+}
+
+export async function getBlockDevicesImpl(
+  opts: Partial<GetBlockDevicesOptions>,
+  nativeFn: NativeBindingsFn,
+): Promise<BlockDevice[]> {
+  const desc = "getBlockDevices()";
+  if (!isLinux) {
+    throw new Error(`${desc} is only supported on Linux`);
+  }
+  const o = optionsWithDefaults<GetBlockDevicesOptions>({
+    ...GetBlockDevicesDefaults,
+    ...compactValues(opts),
+  });
+  const timeoutMs = validateTimeoutMs(o.timeoutMs, desc);
+  validatePriority(o.priority, desc);
+  const native = await nativeFn();
+  if (
+    native.classifyBlockDevices == null ||
+    native.getBlockDeviceIdentities == null
+  ) {
+    throw new Error(`${desc} is not available in these native bindings`);
+  }
+  const getIdentities = native.getBlockDeviceIdentities;
+
+  const names =
+    o.devices == null
+      ? await readdir(join(o.sysfsRoot, "class", "block"))
+      : await blockDeviceNames(o.devices);
+  const [sysfs, mounts] = await Promise.all([
+    Promise.all(names.map((ea) => readSysfsBlockDevice(ea, o.sysfsRoot))),
+    mountPointsByDevice(o),
+  ]);
+  const devices = sysfs.filter((ea) => ea != null);
+  const classes = await native.classifyBlockDevices(
+    devices.map((ea) => ea.device),
+  );
+
+  // udev has already probed every device it has seen: its database is the
+  // cheapest source, and authoritative even when it found no filesystem.
+  const identities = new Map<string, BlockDeviceIdentity | null>();
+  await Promise.all(
+    devices.map(async (ea) => {
+      const identity = await readUdevIdentity(ea.key, o.udevDataDir);
+      if (identity !== undefined) identities.set(ea.device, identity);
+    }),
+  );
+
+  // The rest go to libblkid, one native call per disk: a disk's partitions
+  // are read one after another rather than contending for one spindle, and
+  // at most maxConcurrency disks at once.
+  const byDisk = new Map<string, string[]>();
+  for (const ea of devices) {
+    if (identities.has(ea.device)) continue;
+    const disk = ea.disk ?? ea.device;
+    byDisk.set(disk, [...(byDisk.get(disk) ?? []), ea.device]);
+  }
+  await mapConcurrent({
+    items: [...byDisk.values()],
+    maxConcurrency: o.maxConcurrency,
+    fn: async (group) => {
+      try {
+        const results = await withTimeout({
+          desc: `${desc}: ${group.join(", ")}`,
+          timeoutMs,
+          promise: getIdentities({
+            devices: group,
+            probe: o.probe,
+            priority: o.priority,
+          }),
+        });
+        group.forEach((device, i) =>
+          identities.set(device, results[i] ?? null),
+        );
+      } catch (error) {
+        debug("[getBlockDevices] %s: %s", group.join(", "), error);
+      }
+    },
+  });
+
+  const result = devices.map((ea, i): BlockDevice => {
+    const cls = classes[i];
+    return {
+      ...omit(ea, "key"),
+      ...(cls == null
+        ? {}
+        : {
+            removable: cls.removable,
+            ...(cls.transport == null ? {} : { transport: cls.transport }),
+          }),
+      ...identities.get(ea.device),
+      mountPoints: mounts.get(ea.device) ?? [],
+    };
+  });
+  debug(
+    "[getBlockDevices] %d devices, %d probed natively",
+    result.length,
+    [...byDisk.values()].flat().length,
+  );
+  return result.sort((a, b) =>
+    a.device.localeCompare(b.device, "en", { numeric: true }),
+  );
+}
@@ -0,0 +1,321 @@
+// src/linux/block_topology.cpp
+//
+// Removable flag and transport of block devices, from sysfs alone: nothing
+// here opens a device or touches a mounted filesystem, so classifying every
+// mount costs one stat() of its /dev node and, on a cache miss, a few sysfs
+// reads. Those run on the addon's pool, not the JS thread: sysfs is cheap,
+// but a few hundred devices are still a few thousand syscalls. See
+// src/linux/block_devices.ts.
+
+#include "block_topology.h"
+#include "../common/debug_log.h"
+#include "../common/shutdown.h"
+#include "fs_meta.h"
+#include <climits> // for PATH_MAX
+#include <cstdio>  // for fopen(), fscanf()
+#include <cstdlib> // for realpath()
+#include <dirent.h>
+#include <string_view>
+#include <sys/stat.h>
+#include <sys/sysmacros.h> // for major(), minor()
+#include <vector>
+
+namespace FSMeta {
+
+std::mutex BlockTopologyCache::mutex_;
+LruCache<dev_t, BlockTopology> BlockTopologyCache::entries_(
+    [](const BlockTopology &topology) { return topology.transport.size(); });
+uint64_t BlockTopologyCache::epoch_ = 0;
+int BlockTopologyCache::listeners_ = 0;
+
+bool BlockTopologyCache::Lookup(dev_t dev, BlockTopology &out,
+                                uint64_t &epoch) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch = epoch_;
+  if (listeners_ == 0) {
+    entries_.CountMiss();
+    return false;
+  }
+  return entries_.Get(dev, out);
+}
+
+void BlockTopologyCache::Store(dev_t dev, uint64_t epoch,
+                               const BlockTopology &topology) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (listeners_ > 0 && epoch == epoch_) {
+    entries_.Put(dev, topology);
+  }
+}
+
+void BlockTopologyCache::Invalidate(dev_t dev) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch_++;
+  entries_.Erase(dev);
+}
+
+void BlockTopologyCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch_++;
+  entries_.Clear();
+}
+
+CacheStats BlockTopologyCache::Stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.Stats("blockTopology");
+}
+
+void BlockTopologyCache::AddListener() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  listeners_++;
+}
+
+void BlockTopologyCache::RemoveListener() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (--listeners_ == 0) {
+    epoch_++;
+    entries_.Clear();
+  }
+}
+
+namespace {
+
+const bool kTopologyStatsRegistered =
+    CacheBudget::Register(&BlockTopologyCache::Stats);
+
+// dm-crypt on LVM on a USB disk is three levels deep; anything deeper is
+// reported as "virtual".
+constexpr int kMaxStackDepth = 4;
+
+struct TransportRule {
+  std::string_view needle;
+  const char *transport;
+};
+
+// Matched against the resolved sysfs device path, in order: a USB card
+// reader's disk also sits below a SCSI host, and virtio-scsi below virtio.
+constexpr TransportRule kTransportRules[] = {
+    {"/usb", "usb"},
+    {"/firewire", "firewire"},
+    {"/mmc_host/", "mmc"},
+    {"/nvme", "nvme"},
+    {"/virtio", "virtio"},
+    {"/ata", "ata"},
+    {"/devices/virtual/block/loop", "loop"},
+    {"/devices/virtual/", "virtual"},
+    {"/host", "scsi"},
+};
+
+bool ReadFlagFile(const std::string &path, bool &value) {
+  FILE *f = fopen(path.c_str(), "re");
+  if (f == nullptr) {
+    return false;
+  }
+  int n = 0;
+  const bool ok = fscanf(f, "%d", &n) == 1;
+  fclose(f);
+  if (ok) {
+    value = n != 0;
+  }
+  return ok;
+}
+
+bool ResolvePath(const std::string &path, std::string &resolved) {
+  char buf[PATH_MAX];
+  if (realpath(path.c_str(), buf) == nullptr) {
+    return false;
+  }
+  resolved = buf;
+  return true;
+}
+
+// The one device below a dm or md device, if there is exactly one.
+bool SingleSlave(const std::string &dir, std::string &slave) {
+  DIR *d = opendir((dir + "/slaves").c_str());
+  if (d == nullptr) {
+    return false;
+  }
+  int count = 0;
+  while (const dirent *entry = readdir(d)) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    slave = entry->d_name;
+    count++;
+  }
+  closedir(d);
+  return count == 1;
+}
+
+// `sysfs` is the resolved sysfs mount point, and `dir` a resolved device
+// directory below it. Rules only see the part below `sysfs`.
+void Classify(const std::string &sysfs, const std::string &dir, int depth,
+              BlockTopology &out) {
+  out.transport.clear();
+  const std::string_view path = std::string_view(dir).substr(sysfs.size());
+  for (const auto &rule : kTransportRules) {
+    if (path.find(rule.needle) != std::string_view::npos) {
+      out.transport = rule.transport;
+      break;
+    }
+  }
+
+  std::string slave, slaveDir;
+  if (out.transport == "virtual" && depth < kMaxStackDepth &&
+      SingleSlave(dir, slave) &&
+      ResolvePath(sysfs + "/class/block/" + slave, slaveDir) &&
+      slaveDir.rfind(sysfs + "/", 0) == 0) {
+    Classify(sysfs, slaveDir, depth + 1, out);
+    return;
+  }
+
+  // Partitions have no `removable` of their own: their disk is the parent
+  // directory.
+  bool removable = false;
+  if (!ReadFlagFile(dir + "/removable", removable)) {
+    ReadFlagFile(dir.substr(0, dir.rfind('/')) + "/removable", removable);
+  }
+  out.removable = removable;
+}
+
+// `key` is "MAJ:MIN".
+bool ReadBlockTopologyAt(const std::string &sysfs, const std::string &key,
+                         BlockTopology &out) {
+  std::string dir;
+  if (!ResolvePath(sysfs + "/dev/block/" + key, dir) ||
+      dir.rfind(sysfs + "/", 0) != 0) {
+    return false;
+  }
+  Classify(sysfs, dir, 0, out);
+  return true;
+}
+
+struct DeviceClass {
+  bool found = false;
+  dev_t dev = 0;
+  BlockTopology topology;
+};
+
+class ClassifyBlockDevicesWorker : public SafeAsyncWorker {
+public:
+  ClassifyBlockDevicesWorker(std::vector<std::string> devices,
+                             const Napi::Promise::Deferred &deferred)
+      : SafeAsyncWorker(deferred.Env()), devices_(std::move(devices)),
+        deferred_(deferred) {}
+
+  void Execute() override {
+    if (IsShuttingDown()) {
+      SetError("fs-metadata: shutdown in progress");
+      return;
+    }
+    results_.resize(devices_.size());
+    for (size_t i = 0; i < devices_.size(); i++) {
+      if (IsShuttingDown()) {
+        return;
+      }
+      const std::string &path = devices_[i];
+      // Only device nodes: stat()ing anything else (a remote "host:/export",
+      // or a mount source that's a directory) could touch a filesystem.
+      struct stat st {};
+      if (path.rfind("/dev/", 0) != 0 || stat(path.c_str(), &st) != 0 ||
+          !S_ISBLK(st.st_mode)) {
+        continue;
+      }
+      auto &result = results_[i];
+      uint64_t epoch = 0;
+      if (!BlockTopologyCache::Lookup(st.st_rdev, result.topology, epoch)) {
+        if (!ReadBlockTopology(st.st_rdev, result.topology)) {
+          DEBUG_LOG("[ClassifyBlockDevices] no sysfs entry for %s",
+                    path.c_str());
+          continue;
+        }
+        BlockTopologyCache::Store(st.st_rdev, epoch, result.topology);
+      }
+      result.found = true;
+      result.dev = st.st_rdev;
+    }
+  }
+
+  void OnOK() override {
+    Napi::HandleScope scope(Env());
+    auto env = Env();
+    auto result = Napi::Array::New(env, results_.size());
+    for (size_t i = 0; i < results_.size(); i++) {
+      const auto &ea = results_[i];
+      if (!ea.found) {
+        result.Set(static_cast<uint32_t>(i), env.Null());
+        continue;
+      }
+      auto obj = Napi::Object::New(env);
+      obj.Set("major", Napi::Number::New(env, major(ea.dev)));
+      obj.Set("minor", Napi::Number::New(env, minor(ea.dev)));
+      obj.Set("removable", Napi::Boolean::New(env, ea.topology.removable));
+      if (!ea.topology.transport.empty()) {
+        obj.Set("transport", Napi::String::New(env, ea.topology.transport));
+      }
+      result.Set(static_cast<uint32_t>(i), obj);
+    }
+    SafeResolve(deferred_, result);
+  }
+
+  void OnError(const Napi::Error &error) override {
+    Napi::HandleScope scope(Env());
+    SafeReject(deferred_, error.Value());
+  }
+
+private:
+  std::vector<std::string> devices_;
+  Napi::Promise::Deferred deferred_;
+  std::vector<DeviceClass> results_;
+};
+
+} // namespace
+
+bool ReadBlockTopology(dev_t dev, BlockTopology &out) {
+  return ReadBlockTopologyAt(
+      "/sys", std::to_string(major(dev)) + ":" + std::to_string(minor(dev)),
+      out);
+}
+
+Napi::Value ClassifyBlockDevices(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsArray()) {
+    throw Napi::TypeError::New(env, "Expected an array of device paths");
+  }
+  auto array = info[0].As<Napi::Array>();
+  std::vector<std::string> devices;
+  devices.reserve(array.Length());
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    // Anything but a string resolves to null, as paths outside /dev do.
+    Napi::Value device = array.Get(i);
+    devices.push_back(device.IsString() ? device.As<Napi::String>().Utf8Value()
+                                        : std::string());
+  }
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto *worker = new ClassifyBlockDevicesWorker(std::move(devices), deferred);
+  worker->Queue();
+  return deferred.Promise();
+}
+
+#if defined(FS_METADATA_TEST_HOOKS)
+Napi::Value ClassifySysfsBlockDeviceForTest(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 2 || !info[0].IsString() || !info[1].IsString()) {
+    throw Napi::TypeError::New(env, "Expected sysfsRoot and \"MAJ:MIN\"");
+  }
+  std::string sysfs;
+  BlockTopology topology;
+  if (!ResolvePath(info[0].As<Napi::String>(), sysfs) ||
+      !ReadBlockTopologyAt(sysfs, info[1].As<Napi::String>(), topology)) {
+    return env.Null();
+  }
+  auto obj = Napi::Object::New(env);
+  obj.Set("removable", Napi::Boolean::New(env, topology.removable));
+  if (!topology.transport.empty()) {
+    obj.Set("transport", Napi::String::New(env, topology.transport));
+  }
+  return obj;
+}
+#endif
+
+} // namespace FSMeta
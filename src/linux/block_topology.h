@@ -0,0 +1,49 @@
+// src/linux/block_topology.h
+
+#pragma once
+#include "../common/cache_budget.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <sys/types.h> // for dev_t
+
+namespace FSMeta {
+
+struct BlockTopology {
+  bool removable = false; // the disk's sysfs `removable` flag
+  // Bus the disk hangs off: "usb", "mmc", "nvme", "ata", "scsi", "virtio",
+  // "firewire", "loop", or "virtual" for other kernel-made devices (dm, md,
+  // zram). Empty if the sysfs path matches none of them.
+  std::string transport;
+};
+
+// Classifies the block device `dev` from /sys/dev/block/MAJ:MIN. A partition
+// reports its disk's `removable`. Device-mapper and md devices with a single
+// underlying device (LUKS on a USB stick) report that device's class. Returns
+// false if sysfs has no such device.
+bool ReadBlockTopology(dev_t dev, BlockTopology &out);
+
+// Process-wide cache of ReadBlockTopology() results. Like DeviceIdentityCache
+// (src/linux/uevent_monitor.h), entries are only kept while a uevent monitor
+// that receives block uevents is listening, and each block uevent drops its
+// device's entry.
+class BlockTopologyCache {
+public:
+  static bool Lookup(dev_t dev, BlockTopology &out, uint64_t &epoch);
+  static void Store(dev_t dev, uint64_t epoch, const BlockTopology &topology);
+  static void Invalidate(dev_t dev);
+  static void Clear();
+
+  static void AddListener();
+  static void RemoveListener();
+
+  static CacheStats Stats();
+
+private:
+  static std::mutex mutex_;
+  static LruCache<dev_t, BlockTopology> entries_;
+  static uint64_t epoch_;
+  static int listeners_;
+};
+
+} // namespace FSMeta
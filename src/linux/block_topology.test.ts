@@ -0,0 +1,163 @@
+// src/linux/block_topology.test.ts
+//
+// The native sysfs classifier behind blockDeviceFilter and getBlockDevices(),
+// run against a fixture sysfs tree through a hook only Debug and
+// `FS_METADATA_TEST_HOOKS=1` builds export.
+
+import { mkdir, mkdtemp, rm, symlink, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { dirname, join, relative } from "node:path";
+import { nativeSyncFn } from "../native_loader";
+import { describePlatform } from "../test-utils/platform";
+import type { NativeBindings } from "../types/native_bindings";
+
+function classifier(): NativeBindings["classifySysfsBlockDeviceForTest"] {
+  try {
+    return nativeSyncFn().classifySysfsBlockDeviceForTest;
+  } catch {
+    return undefined;
+  }
+}
+
+const classify = classifier();
+
+const describeOrSkip =
+  classify == null ? describe.skip : describePlatform("linux");
+
+// Disks as the kernel lays them out: the device directory, its `removable`
+// flag (partitions have none), and the "MAJ:MIN" /sys/dev/block links to.
+const Pci = "devices/pci0000:00";
+const UsbDisk = `${Pci}/0000:00:14.0/usb2/2-1/2-1:1.0/host6/target6:0:0/6:0:0:0/block/sdb`;
+const SataDisk = `${Pci}/0000:00:17.0/ata1/host0/target0:0:0/0:0:0:0/block/sda`;
+const NvmeDisk = `${Pci}/0000:00:1d.0/0000:3d:00.0/nvme/nvme0/nvme0n1`;
+const VirtioDisk = `${Pci}/0000:00:04.0/virtio1/block/vda`;
+const ScsiDisk = `${Pci}/0000:00:10.0/host2/target2:0:0/2:0:0:0/block/sdc`;
+const Virtual = "devices/virtual/block";
+
+interface FixtureDevice {
+  name: string;
+  dir: string;
+  majMin: string;
+  removable?: boolean;
+  slaves?: string[];
+}
+
+const Devices: FixtureDevice[] = [
+  { name: "sdb", dir: UsbDisk, majMin: "8:16", removable: true },
+  { name: "sdb1", dir: `${UsbDisk}/sdb1`, majMin: "8:17" },
+  { name: "sda", dir: SataDisk, majMin: "8:0", removable: false },
+  { name: "sda1", dir: `${SataDisk}/sda1`, majMin: "8:1" },
+  { name: "sdc", dir: ScsiDisk, majMin: "8:32", removable: false },
+  { name: "nvme0n1", dir: NvmeDisk, majMin: "259:0", removable: false },
+  {
+    name: "nvme0n1p2",
+    dir: `${NvmeDisk}/nvme0n1p2`,
+    majMin: "259:2",
+  },
+  { name: "vda", dir: VirtioDisk, majMin: "253:0", removable: false },
+  {
+    name: "loop0",
+    dir: `${Virtual}/loop0`,
+    majMin: "7:0",
+    removable: false,
+  },
+  {
+    name: "zram0",
+    dir: `${Virtual}/zram0`,
+    majMin: "252:0",
+    removable: false,
+  },
+  // LUKS on the USB stick's partition:
+  {
+    name: "dm-0",
+    dir: `${Virtual}/dm-0`,
+    majMin: "254:0",
+    removable: false,
+    slaves: ["sdb1"],
+  },
+  // LVM on that:
+  {
+    name: "dm-1",
+    dir: `${Virtual}/dm-1`,
+    majMin: "254:1",
+    removable: false,
+    slaves: ["dm-0"],
+  },
+  // RAID 1 across two disks, and a degraded one with one left:
+  {
+    name: "md0",
+    dir: `${Virtual}/md0`,
+    majMin: "9:0",
+    removable: false,
+    slaves: ["sda1", "nvme0n1p2"],
+  },
+  {
+    name: "md1",
+    dir: `${Virtual}/md1`,
+    majMin: "9:1",
+    removable: false,
+    slaves: ["nvme0n1p2"],
+  },
+];
+
+describeOrSkip("native sysfs block device classifier", () => {
+  let sysfs: string;
+
+  async function link(target: string, path: string) {
+    await mkdir(dirname(path), { recursive: true });
+    await symlink(relative(dirname(path), target), path);
+  }
+
+  beforeAll(async () => {
+    sysfs = await mkdtemp(join(tmpdir(), "fs-metadata-sysfs-"));
+    for (const ea of Devices) {
+      const dir = join(sysfs, ea.dir);
+      await mkdir(dir, { recursive: true });
+      if (ea.removable != null) {
+        await writeFile(join(dir, "removable"), ea.removable ? "1\n" : "0\n");
+      }
+      await link(dir, join(sysfs, "dev", "block", ea.majMin));
+      await link(dir, join(sysfs, "class", "block", ea.name));
+    }
+    for (const ea of Devices) {
+      for (const slave of ea.slaves ?? []) {
+        await link(
+          join(sysfs, "class", "block", slave),
+          join(sysfs, ea.dir, "slaves", slave),
+        );
+      }
+    }
+  });
+
+  afterAll(async () => {
+    await rm(sysfs, { recursive: true, force: true });
+  });
+
+  it.each([
+    ["a USB disk", "8:16", { removable: true, transport: "usb" }],
+    ["its partition", "8:17", { removable: true, transport: "usb" }],
+    ["a SATA disk", "8:0", { removable: false, transport: "ata" }],
+    ["its partition", "8:1", { removable: false, transport: "ata" }],
+    ["a plain SCSI disk", "8:32", { removable: false, transport: "scsi" }],
+    ["an NVMe namespace", "259:0", { removable: false, transport: "nvme" }],
+    ["its partition", "259:2", { removable: false, transport: "nvme" }],
+    ["a virtio disk", "253:0", { removable: false, transport: "virtio" }],
+    ["a loop device", "7:0", { removable: false, transport: "loop" }],
+    ["zram", "252:0", { removable: false, transport: "virtual" }],
+    ["dm-crypt on USB", "254:0", { removable: true, transport: "usb" }],
+    ["LVM on dm-crypt on USB", "254:1", { removable: true, transport: "usb" }],
+    ["md across two disks", "9:0", { removable: false, transport: "virtual" }],
+    ["md on one disk", "9:1", { removable: false, transport: "nvme" }],
+  ])("classifies %s (%s)", (_desc, majMin, expected) => {
+    expect(classify?.(sysfs, majMin)).toEqual(expected);
+  });
+
+  it("returns null for a device sysfs doesn't list", () => {
+    expect(classify?.(sysfs, "8:48")).toBe(null);
+  });
+
+  it("ignores links that leave the sysfs tree", async () => {
+    await link("/", join(sysfs, "dev", "block", "1:1"));
+    expect(classify?.(sysfs, "1:1")).toBe(null);
+  });
+});
@@ -3,6 +3,7 @@
 // Integration coverage for the btrfs subvolume discriminators:
 //   - mount-option tier: `subvol` / `subvolid` on MountPoint (from /proc mounts)
 //   - ioctl tier: `subvolumeUuid` on VolumeMetadata (BTRFS_IOC_GET_SUBVOL_INFO)
+//   - enumeration: getBtrfsSubvolumes() (GET_SUBVOL_ROOTREF + INO_LOOKUP_USER)
 //
 // These assertions are btrfs-host-specific by nature. On non-btrfs hosts (the
 // typical CI runner is ext4/overlay), the btrfs-only tests no-op and only the
@@ -10,7 +11,11 @@
 // `/` and `/home` are subvolumes of one filesystem), the full distinctness
 // checks run.
 
-import { getVolumeMetadata, getVolumeMountPoints } from "../index";
+import {
+  getBtrfsSubvolumes,
+  getVolumeMetadata,
+  getVolumeMountPoints,
+} from "../index";
 import { describePlatform } from "../test-utils/platform";
 import type { MountPoint } from "../types/mount_point";
 import type { VolumeMetadata } from "../types/volume_metadata";
@@ -102,4 +107,35 @@ describePlatform("linux")("btrfs subvolumes", () => {
       }
     }
   });
+
+  it("rejects enumeration of a non-btrfs mount point", async () => {
+    await expect(getBtrfsSubvolumes("/proc")).rejects.toThrow();
+  });
+
+  it("enumerates each mount's own subvolume first", async () => {
+    if (btrfs.length === 0) {
+      console.log("[btrfs-subvolume.test] no btrfs mounts on host; skipping");
+      return;
+    }
+    for (const mp of btrfs) {
+      let subvolumes;
+      try {
+        subvolumes = await getBtrfsSubvolumes(mp.mountPoint);
+      } catch (error) {
+        // Pre-4.18 kernels and builds without the ioctls can't enumerate.
+        console.log("[btrfs-subvolume.test] enumeration unavailable:", error);
+        return;
+      }
+      const [self] = subvolumes;
+      expect(self?.path).toBe("");
+      expect(self?.uuid).toMatch(CANONICAL_UUID);
+      if (mp.subvolid != null) expect(self?.id).toBe(mp.subvolid);
+      const md = await getVolumeMetadata(mp.mountPoint);
+      if (md.subvolumeUuid != null) expect(self?.uuid).toBe(md.subvolumeUuid);
+      for (const sv of subvolumes.slice(1)) {
+        expect(sv.path.length).toBeGreaterThan(0);
+        expect(sv.parentId).toBeGreaterThan(0);
+      }
+    }
+  });
 });
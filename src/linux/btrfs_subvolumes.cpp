@@ -0,0 +1,516 @@
+// src/linux/btrfs_subvolumes.cpp
+
+#include "btrfs_subvolumes.h"
+#include "../common/debug_log.h"
+#include "../common/error_utils.h"
+#include "../common/fd_guard.h"
+#include "../common/shutdown.h"
+#include "fs_meta.h"
+#include <cerrno>
+#include <cstdio>  // for snprintf()
+#include <cstring> // for memset(), strerror()
+#include <fcntl.h> // for openat(), O_CLOEXEC, O_DIRECTORY, O_NOFOLLOW
+#include <memory>
+#include <sys/stat.h> // for fstat()
+#include <unordered_map>
+#include <unistd.h> // for dup()
+
+// The UAPI header <linux/btrfs.h> is present on glibc distros
+// (linux-libc-dev) and on Alpine when the linux-headers package is
+// installed, but may be absent in minimal build-from-source environments,
+// and older copies lack the Linux 4.18 ioctls. Without them the module still
+// compiles: subvolumeUuid stays undefined, and enumeration is unavailable.
+#if defined(__has_include)
+#if __has_include(<linux/btrfs.h>)
+#include <linux/btrfs.h>
+#include <sys/ioctl.h>
+#if defined(BTRFS_IOC_GET_SUBVOL_ROOTREF) &&                                    \
+    defined(BTRFS_IOC_INO_LOOKUP_USER) && defined(BTRFS_IOC_GET_SUBVOL_INFO)
+#define FSMETA_HAVE_BTRFS_ENUM 1
+#endif
+#endif
+#endif
+
+namespace FSMeta {
+
+std::mutex BtrfsSubvolumeCache::mutex_;
+
+std::string FormatBtrfsUuid(const uint8_t *u) {
+  bool zero = true;
+  for (int i = 0; i < 16; i++) {
+    if (u[i] != 0) {
+      zero = false;
+      break;
+    }
+  }
+  if (zero) {
+    return "";
+  }
+  char uuid_str[37]; // 36 chars + NUL
+  snprintf(uuid_str, sizeof(uuid_str),
+           "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x"
+           "%02x%02x",
+           u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7], u[8], u[9], u[10],
+           u[11], u[12], u[13], u[14], u[15]);
+  return uuid_str;
+}
+
+#ifdef FSMETA_HAVE_BTRFS_ENUM
+
+namespace {
+
+// The inode number of every btrfs subvolume's root directory.
+constexpr ino_t kSubvolumeRootIno = 256;
+
+// Upper bound on one enumeration, so a pathological filesystem cannot pin a
+// worker thread (or the cache's memory) indefinitely.
+constexpr size_t kMaxSubvolumes = 65536;
+
+struct FilesystemEntry {
+  std::mutex mutex;
+  std::unordered_map<uint64_t, BtrfsSubvolume> subvolumes;
+  size_t bytes = 0;      // charged to CacheBudget
+  bool evicted = false;  // dropped from Filesystems(): charge nothing more
+  uint64_t lastUsed = 0; // CacheBudget tick; guarded by the cache's mutex_
+};
+
+CacheCounters &Counters() {
+  static CacheCounters counters;
+  return counters;
+}
+
+std::unordered_map<std::string, std::shared_ptr<FilesystemEntry>> &
+Filesystems() {
+  static std::unordered_map<std::string, std::shared_ptr<FilesystemEntry>>
+      filesystems;
+  return filesystems;
+}
+
+bool GetFsid(int fd, std::string &fsid) {
+  struct btrfs_ioctl_fs_info_args fs_info;
+  memset(&fs_info, 0, sizeof(fs_info));
+  if (ioctl(fd, BTRFS_IOC_FS_INFO, &fs_info) < 0) {
+    DEBUG_LOG("[BtrfsSubvolumeCache] BTRFS_IOC_FS_INFO failed: %s",
+              strerror(errno));
+    return false;
+  }
+  fsid = FormatBtrfsUuid(fs_info.fsid);
+  return !fsid.empty();
+}
+
+bool GetSubvolInfo(int fd, BtrfsSubvolume &out) {
+  struct btrfs_ioctl_get_subvol_info_args info;
+  memset(&info, 0, sizeof(info));
+  // NOTE: on success this ioctl returns a POSITIVE value (observed: 1), not
+  // 0, so only a negative return indicates failure.
+  if (ioctl(fd, BTRFS_IOC_GET_SUBVOL_INFO, &info) < 0) {
+    return false;
+  }
+  out.id = info.treeid;
+  out.parentId = info.parent_id;
+  out.generation = info.generation;
+  out.uuid = FormatBtrfsUuid(info.uuid);
+  out.parentUuid = FormatBtrfsUuid(info.parent_uuid);
+  out.receivedUuid = FormatBtrfsUuid(info.received_uuid);
+  return true;
+}
+
+// A child found by ROOTREF but not yet opened. Holding the parent's fd (not
+// the child's) means open fds grow with nesting depth, not with the number
+// of siblings: thousands of snapshots under one directory cost one fd.
+struct PendingSubvolume {
+  std::shared_ptr<FdGuard> parentFd;
+  uint64_t id = 0;              // as listed by ROOTREF
+  std::string relativeToParent; // as returned by INO_LOOKUP_USER
+  std::string path;             // relative to the walk's root
+};
+
+// Appends the children of the subvolume open at `fd` to `stack`.
+void PushChildren(const std::shared_ptr<FdGuard> &fd, const std::string &path,
+                  std::vector<PendingSubvolume> &stack) {
+  struct btrfs_ioctl_get_subvol_rootref_args rootref;
+  memset(&rootref, 0, sizeof(rootref));
+  for (;;) {
+    const int rc = ioctl(fd->get(), BTRFS_IOC_GET_SUBVOL_ROOTREF, &rootref);
+    // EOVERFLOW: the buffer filled and more children remain.
+    const bool more = rc < 0 && errno == EOVERFLOW;
+    if (rc < 0 && !more) {
+      DEBUG_LOG("[BtrfsSubvolumeCache] ROOTREF failed under '%s': %s",
+                path.c_str(), strerror(errno));
+      return;
+    }
+    for (uint8_t i = 0; i < rootref.num_items; i++) {
+      struct btrfs_ioctl_ino_lookup_user_args lookup;
+      memset(&lookup, 0, sizeof(lookup));
+      lookup.dirid = rootref.rootref[i].dirid;
+      lookup.treeid = rootref.rootref[i].treeid;
+      // Fails with EACCES when a directory on the way is not traversable.
+      if (ioctl(fd->get(), BTRFS_IOC_INO_LOOKUP_USER, &lookup) < 0) {
+        DEBUG_LOG("[BtrfsSubvolumeCache] skipping subvolume %llu: %s",
+                  static_cast<unsigned long long>(lookup.treeid),
+                  strerror(errno));
+        continue;
+      }
+      std::string rel = lookup.path;
+      if (!rel.empty() && rel.back() != '/') {
+        rel += '/';
+      }
+      rel += lookup.name;
+      stack.push_back(
+          {fd, lookup.treeid, rel, path.empty() ? rel : path + "/" + rel});
+    }
+    if (!more || rootref.num_items == 0) {
+      return;
+    }
+    rootref.min_treeid = rootref.rootref[rootref.num_items - 1].treeid + 1;
+  }
+}
+
+// Depth-first walk of every subvolume at or below the subvolume root `rootFd`
+// (borrowed, not closed), on filesystem `fsid`. Sets `truncated` if it
+// stopped at kMaxSubvolumes.
+std::vector<BtrfsSubvolume> Walk(int rootFd, const std::string &fsid,
+                                 bool &truncated) {
+  struct stat st;
+  if (fstat(rootFd, &st) != 0 || st.st_ino != kSubvolumeRootIno) {
+    throw FSException("Not the root of a btrfs subvolume");
+  }
+
+  BtrfsSubvolume root;
+  if (!GetSubvolInfo(rootFd, root)) {
+    throw FSException(
+        CreateDetailedErrorMessage("BTRFS_IOC_GET_SUBVOL_INFO", errno));
+  }
+  std::vector<BtrfsSubvolume> result{root};
+
+  auto rootGuard = std::make_shared<FdGuard>(dup(rootFd));
+  if (!rootGuard->isValid()) {
+    throw FSException(CreateDetailedErrorMessage("dup", errno));
+  }
+  std::vector<PendingSubvolume> stack;
+  PushChildren(rootGuard, "", stack);
+  rootGuard.reset();
+
+  truncated = false;
+  while (!stack.empty()) {
+    if (result.size() >= kMaxSubvolumes) {
+      DEBUG_LOG("[BtrfsSubvolumeCache] stopping at %zu subvolumes",
+                result.size());
+      truncated = true;
+      break;
+    }
+    PendingSubvolume child = std::move(stack.back());
+    stack.pop_back();
+
+    const int fd =
+        openat(child.parentFd->get(), child.relativeToParent.c_str(),
+               O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    child.parentFd.reset();
+    if (fd < 0) {
+      DEBUG_LOG("[BtrfsSubvolumeCache] open '%s' failed: %s",
+                child.path.c_str(), strerror(errno));
+      continue;
+    }
+    auto guard = std::make_shared<FdGuard>(fd);
+    // The path was resolved before it was opened: a rename, or a mount over
+    // it, in between would cache the wrong identity under this id.
+    BtrfsSubvolume subvolume;
+    std::string childFsid;
+    if (!GetSubvolInfo(fd, subvolume) || subvolume.id != child.id ||
+        !GetFsid(fd, childFsid) || childFsid != fsid) {
+      DEBUG_LOG("[BtrfsSubvolumeCache] '%s' is no longer subvolume %llu",
+                child.path.c_str(), static_cast<unsigned long long>(child.id));
+      continue;
+    }
+    subvolume.path = child.path;
+    result.push_back(std::move(subvolume));
+    PushChildren(guard, child.path, stack);
+  }
+
+  return result;
+}
+
+std::shared_ptr<FilesystemEntry> EntryFor(const std::string &fsid,
+                                          std::mutex &mutex) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  auto &entry = Filesystems()[fsid];
+  if (entry == nullptr) {
+    entry = std::make_shared<FilesystemEntry>();
+  }
+  entry->lastUsed = CacheBudget::NextTick();
+  return entry;
+}
+
+size_t SubvolumeCost(const BtrfsSubvolume &subvolume) {
+  return sizeof(BtrfsSubvolume) + 4 * sizeof(void *) + subvolume.path.size() +
+         subvolume.uuid.size() + subvolume.parentUuid.size() +
+         subvolume.receivedUuid.size();
+}
+
+// Caller holds entry.mutex.
+void Insert(FilesystemEntry &entry, const BtrfsSubvolume &subvolume) {
+  // Keep the first-seen path's frame of reference; identity fields are the
+  // same either way.
+  if (entry.subvolumes.emplace(subvolume.id, subvolume).second &&
+      !entry.evicted) {
+    const size_t cost = SubvolumeCost(subvolume);
+    entry.bytes += cost;
+    CacheBudget::AddBytes(cost);
+  }
+}
+
+// The filesystem to evict next, or end(): the least recently used that
+// holds anything. Caller holds the cache's mutex_.
+std::unordered_map<std::string, std::shared_ptr<FilesystemEntry>>::iterator
+OldestFilesystem() {
+  auto &filesystems = Filesystems();
+  auto oldest = filesystems.end();
+  for (auto it = filesystems.begin(); it != filesystems.end(); ++it) {
+    if (it->second->bytes > 0 &&
+        (oldest == filesystems.end() ||
+         it->second->lastUsed < oldest->second->lastUsed)) {
+      oldest = it;
+    }
+  }
+  return oldest;
+}
+
+} // namespace
+
+bool BtrfsSubvolumeCache::Lookup(const std::string &fsid, int fd, uint64_t id,
+                                 BtrfsSubvolume &out) {
+  std::shared_ptr<FilesystemEntry> entry;
+  if (!fsid.empty() && id != 0) {
+    entry = EntryFor(fsid, mutex_);
+    {
+      const std::lock_guard<std::mutex> lock(entry->mutex);
+      auto hit = entry->subvolumes.find(id);
+      if (hit != entry->subvolumes.end()) {
+        Counters().hits++;
+        out = hit->second;
+        return true;
+      }
+    }
+    Counters().misses++;
+  }
+
+  // Miss: read just this subvolume. Walking from here could visit thousands
+  // of unmounted snapshots, which a single-volume probe must not pay for.
+  if (!GetSubvolInfo(fd, out)) {
+    return false;
+  }
+  // `fsid` came from the mount's device: only cache under it once `fd` is
+  // confirmed to be on that filesystem.
+  std::string fdFsid;
+  if (entry == nullptr || out.id != id || !GetFsid(fd, fdFsid) ||
+      fdFsid != fsid) {
+    return true;
+  }
+  {
+    const std::lock_guard<std::mutex> lock(entry->mutex);
+    Insert(*entry, out);
+  }
+  CacheBudget::EvictOverBudget();
+  return true;
+}
+
+std::vector<BtrfsSubvolume> BtrfsSubvolumeCache::Enumerate(int fd) {
+  std::string fsid;
+  if (!GetFsid(fd, fsid)) {
+    throw FSException("Not a btrfs filesystem");
+  }
+  bool truncated = false;
+  auto result = Walk(fd, fsid, truncated);
+  auto entry = EntryFor(fsid, mutex_);
+  {
+    const std::lock_guard<std::mutex> lock(entry->mutex);
+    for (const auto &subvolume : result) {
+      Insert(*entry, subvolume);
+    }
+  }
+  CacheBudget::EvictOverBudget();
+  // What was found is still cached: each identity is correct on its own.
+  if (truncated) {
+    throw FSException("More than " + std::to_string(kMaxSubvolumes) +
+                      " btrfs subvolumes; stopped listing");
+  }
+  return result;
+}
+
+uint64_t BtrfsSubvolumeCache::OldestTick() {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return CacheBudget::Evictable::kNoEntries;
+  }
+  auto oldest = OldestFilesystem();
+  return oldest == Filesystems().end() ? CacheBudget::Evictable::kNoEntries
+                                       : oldest->second->lastUsed;
+}
+
+// The filesystem just used is fair game too, once it is the oldest left:
+// its caller already has its results, and an enumeration too large for the
+// budget must not stay cached over it.
+bool BtrfsSubvolumeCache::TryEvictOldest() {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return false;
+  }
+  auto victim = OldestFilesystem();
+  if (victim == Filesystems().end()) {
+    return false;
+  }
+  {
+    const std::lock_guard<std::mutex> entryLock(victim->second->mutex);
+    victim->second->evicted = true;
+    CacheBudget::SubtractBytes(victim->second->bytes);
+    victim->second->bytes = 0;
+  }
+  DEBUG_LOG("[BtrfsSubvolumeCache] evicting filesystem %s",
+            victim->first.c_str());
+  Filesystems().erase(victim);
+  Counters().evictions++;
+  return true;
+}
+
+CacheStats BtrfsSubvolumeCache::Stats() {
+  CacheStats stats;
+  stats.name = "btrfsSubvolumes";
+  {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto &[fsid, entry] : Filesystems()) {
+      const std::lock_guard<std::mutex> entryLock(entry->mutex);
+      stats.entries += entry->subvolumes.size();
+      stats.bytes += entry->bytes;
+    }
+  }
+  stats.hits = Counters().hits.load();
+  stats.misses = Counters().misses.load();
+  stats.evictions = Counters().evictions.load();
+  return stats;
+}
+
+#else // !FSMETA_HAVE_BTRFS_ENUM
+
+bool BtrfsSubvolumeCache::Lookup(const std::string & /*fsid*/, int /*fd*/,
+                                 uint64_t /*id*/, BtrfsSubvolume & /*out*/) {
+  errno = ENOTTY;
+  return false;
+}
+
+std::vector<BtrfsSubvolume> BtrfsSubvolumeCache::Enumerate(int /*fd*/) {
+  throw FSException("btrfs subvolume enumeration is unavailable in this build");
+}
+
+uint64_t BtrfsSubvolumeCache::OldestTick() {
+  return CacheBudget::Evictable::kNoEntries;
+}
+
+bool BtrfsSubvolumeCache::TryEvictOldest() { return false; }
+
+CacheStats BtrfsSubvolumeCache::Stats() {
+  CacheStats stats;
+  stats.name = "btrfsSubvolumes";
+  return stats;
+}
+
+#endif
+
+namespace {
+
+const bool kSubvolumeStatsRegistered =
+    CacheBudget::Register(&BtrfsSubvolumeCache::Stats);
+
+// Lets CacheBudget weigh whole filesystems against other caches' entries.
+class FilesystemEvictor : public CacheBudget::Evictable {
+public:
+  uint64_t OldestTick() override { return BtrfsSubvolumeCache::OldestTick(); }
+  bool TryEvictOldest() override {
+    return BtrfsSubvolumeCache::TryEvictOldest();
+  }
+};
+
+FilesystemEvictor filesystemEvictor;
+const bool kSubvolumesEvictable =
+    CacheBudget::RegisterEvictable(&filesystemEvictor);
+
+class GetBtrfsSubvolumesWorker : public SafeAsyncWorker {
+public:
+  GetBtrfsSubvolumesWorker(const std::string &mountPoint,
+                           const Napi::Promise::Deferred &deferred)
+      : SafeAsyncWorker(deferred.Env()), mountPoint_(mountPoint),
+        deferred_(deferred) {}
+
+  void Execute() override {
+    if (IsShuttingDown()) {
+      SetError("fs-metadata: shutdown in progress");
+      return;
+    }
+    try {
+      std::string validated;
+      bool is_directory = true;
+      FdGuard fd(OpenMountPoint(mountPoint_, validated, is_directory));
+      if (!is_directory) {
+        throw FSException("Not a directory: " + validated);
+      }
+      subvolumes_ = BtrfsSubvolumeCache::Enumerate(fd.get());
+      DEBUG_LOG("[GetBtrfsSubvolumes] %zu subvolumes at or below %s",
+                subvolumes_.size(), validated.c_str());
+    } catch (const std::exception &e) {
+      DEBUG_LOG("[GetBtrfsSubvolumes] error: %s", e.what());
+      SetError(e.what());
+    }
+  }
+
+  void OnOK() override {
+    Napi::HandleScope scope(Env());
+    auto env = Env();
+    auto result = Napi::Array::New(env, subvolumes_.size());
+    for (size_t i = 0; i < subvolumes_.size(); i++) {
+      const auto &sv = subvolumes_[i];
+      auto obj = Napi::Object::New(env);
+      obj.Set("id", Napi::Number::New(env, static_cast<double>(sv.id)));
+      obj.Set("parentId",
+              Napi::Number::New(env, static_cast<double>(sv.parentId)));
+      obj.Set("generation",
+              Napi::Number::New(env, static_cast<double>(sv.generation)));
+      obj.Set("path", Napi::String::New(env, sv.path));
+      obj.Set("uuid", Napi::String::New(env, sv.uuid));
+      if (!sv.parentUuid.empty()) {
+        obj.Set("parentUuid", Napi::String::New(env, sv.parentUuid));
+      }
+      if (!sv.receivedUuid.empty()) {
+        obj.Set("receivedUuid", Napi::String::New(env, sv.receivedUuid));
+      }
+      result.Set(static_cast<uint32_t>(i), obj);
+    }
+    SafeResolve(deferred_, result);
+  }
+
+  void OnError(const Napi::Error &error) override {
+    Napi::HandleScope scope(Env());
+    SafeReject(deferred_, error.Value());
+  }
+
+private:
+  std::string mountPoint_;
+  Napi::Promise::Deferred deferred_;
+  std::vector<BtrfsSubvolume> subvolumes_;
+};
+
+} // namespace
+
+Napi::Value GetBtrfsSubvolumes(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "Expected options object with mountPoint");
+  }
+  auto options = VolumeMetadataOptions::FromObject(info[0].As<Napi::Object>());
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto *worker =
+      new GetBtrfsSubvolumesWorker(std::string(options.mountPoint), deferred);
+  worker->Queue();
+  return deferred.Promise();
+}
+
+} // namespace FSMeta
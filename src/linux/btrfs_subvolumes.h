@@ -0,0 +1,71 @@
+// src/linux/btrfs_subvolumes.h
+
+#pragma once
+#include "../common/cache_budget.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace FSMeta {
+
+struct BtrfsSubvolume {
+  uint64_t id = 0;
+  uint64_t parentId = 0;   // containing subvolume; 0 for the top level
+  uint64_t generation = 0; // as of the enumeration that found it
+  std::string path;        // relative to the walk's root; "" for the root
+  std::string uuid;
+  std::string parentUuid;   // snapshot origin; empty if not a snapshot
+  std::string receivedUuid; // `btrfs receive` source; empty otherwise
+};
+
+// Canonical lowercase hyphenated UUID, or "" for the all-zero UUID btrfs
+// uses to mean "none".
+std::string FormatBtrfsUuid(const uint8_t *uuid);
+
+// Process-wide cache of btrfs subvolume id -> identity, one map per
+// filesystem (keyed by fsid, the filesystem UUID blkid reports).
+//
+// Subvolume ids are never reused within a filesystem and a subvolume's
+// uuid/parent_uuid/received_uuid never change, so entries never go stale.
+// Enumerate() fills the map for a whole subtree in one pass, and Lookup()
+// with each subvolume it reads; a hit then resolves a mount's subvolid=
+// without touching the subvolume. Nothing is cached until its id, and the
+// fsid of the fd it was read through, are confirmed.
+//
+// Enumeration is unprivileged (Linux >= 4.18): BTRFS_IOC_GET_SUBVOL_ROOTREF
+// lists a subvolume's children, BTRFS_IOC_INO_LOOKUP_USER resolves each to a
+// path, and BTRFS_IOC_GET_SUBVOL_INFO reads it. Subvolumes the caller cannot
+// traverse are skipped.
+//
+// Filesystems count against CacheBudget as a whole: when the native caches
+// exceed it, a filesystem's map is dropped once it is the least recently
+// used entry of any native cache, even if it was just filled.
+class BtrfsSubvolumeCache {
+public:
+  // Finds subvolume `id` on filesystem `fsid` (as already known to the
+  // caller, so a hit costs no syscalls). On a miss, or with no `fsid` or
+  // `id`, reads the subvolume `fd` is in instead, and caches it only if it
+  // is `id` on `fsid`: it never walks. Either way `out` is the subvolume
+  // found, so the caller needn't read it again. False, with errno set, only
+  // if BTRFS_IOC_GET_SUBVOL_INFO failed.
+  static bool Lookup(const std::string &fsid, int fd, uint64_t id,
+                     BtrfsSubvolume &out);
+
+  // Enumerates every subvolume at or below the subvolume root `fd`, merging
+  // the results into the cache. Throws FSException if `fd` is not the root
+  // of a btrfs subvolume, or if it holds more subvolumes than one
+  // enumeration lists (those it did list are still cached).
+  static std::vector<BtrfsSubvolume> Enumerate(int fd);
+
+  static CacheStats Stats();
+
+  // CacheBudget::Evictable, over whole filesystems.
+  static uint64_t OldestTick();
+  static bool TryEvictOldest();
+
+private:
+  static std::mutex mutex_;
+};
+
+} // namespace FSMeta
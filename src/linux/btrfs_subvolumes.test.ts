@@ -0,0 +1,85 @@
+// src/linux/btrfs_subvolumes.test.ts
+
+import { mkdir, mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { optionsWithDefaults } from "../options";
+import { describePlatform } from "../test-utils/platform";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindings,
+} from "../types/native_bindings";
+import type { Options } from "../types/options";
+import {
+  getAllVolumeMetadataImpl,
+  getVolumeMetadataImpl,
+} from "../volume_metadata";
+
+describePlatform("linux")("btrfs subvolumes (Linux)", () => {
+  let dir: string;
+  let mtabPath: string;
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-btrfs-"));
+    mtabPath = join(dir, "mtab");
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  it("never walks subvolumes to list volumes", async () => {
+    const mounts = Array.from({ length: 8 }, (_, i) => join(dir, "m" + i));
+    await Promise.all(mounts.map((ea) => mkdir(ea, { recursive: true })));
+    await writeFile(
+      mtabPath,
+      mounts
+        .map((ea, i) => `/dev/sdz2 ${ea} btrfs rw,subvolid=${256 + i} 0 0`)
+        .join("\n") + "\n",
+    );
+    let probes = 0;
+    let walks = 0;
+    const native = {
+      getBtrfsSubvolumes: async () => {
+        walks++;
+        return [];
+      },
+      getVolumeMetadata: async () => {
+        probes++;
+        return { size: 1, used: 0, available: 1 };
+      },
+    } as unknown as NativeBindings;
+    await getAllVolumeMetadataImpl(
+      optionsWithDefaults({
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: true,
+      }),
+      () => native,
+    );
+    expect(probes).toBe(mounts.length);
+    expect(walks).toBe(0);
+  });
+
+  it("passes subvolid from the mount table to the native probe", async () => {
+    await writeFile(
+      mtabPath,
+      `/dev/sdz2 ${dir} btrfs rw,subvolid=257,subvol=/@home 0 0\n`,
+    );
+    let seen: GetVolumeMetadataOptions | undefined;
+    const native = {
+      getVolumeMetadata: async (o: GetVolumeMetadataOptions) => {
+        seen = o;
+        return { size: 1, used: 0, available: 1 };
+      },
+    } as unknown as NativeBindings;
+    await getVolumeMetadataImpl(
+      optionsWithDefaults<GetVolumeMetadataOptions & Options>({
+        mountPoint: dir,
+        linuxMountTablePaths: [mtabPath],
+      }),
+      () => native,
+    );
+    expect(seen?.subvolid).toBe(257);
+    expect(seen?.fstype).toBe("btrfs");
+  });
+});
@@ -0,0 +1,31 @@
+// src/linux/btrfs_subvolumes.ts
+
+import { validateTimeoutMs, withTimeout } from "../async";
+import { isLinux } from "../platform";
+import { isNotBlank } from "../string";
+import type { BtrfsSubvolume } from "../types/btrfs_subvolume";
+import type { NativeBindingsFn } from "../types/native_bindings";
+import type { Options } from "../types/options";
+
+export async function getBtrfsSubvolumesImpl(
+  mountPoint: string,
+  opts: Pick<Options, "timeoutMs">,
+  nativeFn: NativeBindingsFn,
+): Promise<BtrfsSubvolume[]> {
+  const desc = "getBtrfsSubvolumes()";
+  if (!isLinux) {
+    throw new Error(`${desc} is only supported on Linux`);
+  }
+  if (!isNotBlank(mountPoint)) {
+    throw new TypeError(`${desc}: invalid mountPoint: ${mountPoint}`);
+  }
+  const native = await nativeFn();
+  if (native.getBtrfsSubvolumes == null) {
+    throw new Error(`${desc} is not available in these native bindings`);
+  }
+  return withTimeout({
+    desc,
+    timeoutMs: validateTimeoutMs(opts.timeoutMs, desc),
+    promise: native.getBtrfsSubvolumes({ mountPoint }),
+  });
+}
@@ -1,6 +1,6 @@
 // src/linux/dev_disk.ts
 
-import { Dirent } from "node:fs";
+import { Dirent, readdirSync, readlinkSync } from "node:fs";
 import { readdir, readlink } from "node:fs/promises";
 import { join, resolve } from "node:path";
 import { debug } from "../debuglog";
@@ -44,6 +44,30 @@ export async function getLabelFromDevDisk(devicePath: string) {
   }
 }
 
+/**
+ * Synchronous {@link getUuidFromDevDisk}, for the sync API fast path.
+ */
+export function getUuidFromDevDiskSync(devicePath: string) {
+  try {
+    return getBasenameLinkedToSync("/dev/disk/by-uuid", resolve(devicePath));
+  } catch (error) {
+    debug("[getUuidFromDevDiskSync] failed: " + error);
+    return;
+  }
+}
+
+/**
+ * Synchronous {@link getLabelFromDevDisk}, for the sync API fast path.
+ */
+export function getLabelFromDevDiskSync(devicePath: string) {
+  try {
+    return getBasenameLinkedToSync("/dev/disk/by-label", resolve(devicePath));
+  } catch (error) {
+    debug("[getLabelFromDevDiskSync] failed: " + error);
+    return;
+  }
+}
+
 // only exposed for tests
 export async function getBasenameLinkedTo(
   linkDir: string,
@@ -75,3 +99,24 @@ async function* readLinks(
     }
   }
 }
+
+function getBasenameLinkedToSync(
+  linkDir: string,
+  linkPath: string,
+): string | undefined {
+  for (const dirent of readdirSync(linkDir, { withFileTypes: true })) {
+    if (!dirent.isSymbolicLink()) continue;
+    try {
+      const linkTarget = resolve(
+        linkDir,
+        readlinkSync(join(linkDir, dirent.name)),
+      );
+      if (linkTarget === linkPath) {
+        return decodeUdevEscapes(dirent.name);
+      }
+    } catch {
+      // Ignore errors
+    }
+  }
+  return;
+}
@@ -0,0 +1,98 @@
+// src/linux/fs_meta.h
+
+#pragma once
+#include "../common/volume_metadata.h"
+#include <napi.h>
+#include <string>
+
+namespace FSMeta {
+
+// Synchronous variant of GetVolumeMetadata(): runs the same probe on the
+// calling JS thread. Only the TypeScript sync API calls this, and only after
+// the mount table has shown the volume to be local.
+Napi::Value GetVolumeMetadataSync(const Napi::CallbackInfo &info);
+
+// Validates `mountPoint` and opens it (O_PATH for file bind mounts). Returns
+// an fd the caller owns; throws FSException.
+int OpenMountPoint(const std::string &mountPoint, std::string &validatedPath,
+                   bool &isDirectory);
+
+// fstatvfs() into metadata.size/used/available. Throws FSException.
+void ReadVolumeSpace(int fd, const std::string &path, VolumeMetadata &metadata);
+
+// Everything ProbeVolume() does after open(): space, blkid identity, btrfs
+// and zfs identifiers, and (opt-in) quota. `fd` is any descriptor on the
+// volume; `path` is only used in messages. Throws FSException.
+void ProbeOpenVolume(int fd, const std::string &path, bool isDirectory,
+                     const VolumeMetadataOptions &options,
+                     VolumeMetadata &metadata);
+
+// Resolves a caller-held descriptor to its mount via statx(STATX_MNT_ID) and
+// MountInfoCache, then runs ProbeOpenVolume() on it. Resolves to the
+// metadata plus {mountPoint, mountOptions, mountRoot}.
+Napi::Value GetVolumeMetadataForFd(const Napi::CallbackInfo &info);
+
+// Prepared probe handles (see src/volume_probe.ts): open() resolves to an
+// External holding the mount point's fd, refresh() re-reads space and quota
+// through it, close() releases it.
+Napi::Value OpenVolumeProbe(const Napi::CallbackInfo &info);
+Napi::Value RefreshVolumeProbe(const Napi::CallbackInfo &info);
+Napi::Value GetVolumeProbeTrend(const Napi::CallbackInfo &info);
+Napi::Value CloseVolumeProbe(const Napi::CallbackInfo &info);
+
+// Enumerates the btrfs subvolumes at or below a mounted subvolume root and
+// primes BtrfsSubvolumeCache with them. Resolves to an array of
+// {id, parentId, generation, path, uuid, parentUuid?, receivedUuid?}.
+Napi::Value GetBtrfsSubvolumes(const Napi::CallbackInfo &info);
+
+// Starts listening for kernel block uevents (see uevent_monitor.h). Takes a
+// callback that receives {action, major, minor, devname?, devtype?, seqnum,
+// diskMediaChange?, diskEjectRequest?} per event, {action: "overflow"} after
+// lost events, and {action: "error", error} before stopping on failure.
+// Returns an External handle for StopUeventMonitor().
+Napi::Value StartUeventMonitor(const Napi::CallbackInfo &info);
+Napi::Value StopUeventMonitor(const Napi::CallbackInfo &info);
+
+#if defined(FS_METADATA_TEST_HOOKS)
+// Test-only (see binding.gyp): splits a string into lines and parses each as
+// MountInfoCache does. Returns, per line, {mountId, root, mountPoint, fstype,
+// source, mountOptions}, or null for a line it rejects.
+Napi::Value ParseMountInfoForTest(const Napi::CallbackInfo &info);
+#endif
+
+// Resolves, for each device path, to {major, minor, removable, transport?}
+// from sysfs (see block_topology.h), or null for anything that isn't a block
+// device node under /dev.
+Napi::Value ClassifyBlockDevices(const Napi::CallbackInfo &info);
+
+#if defined(FS_METADATA_TEST_HOOKS)
+// Test-only: classifies "MAJ:MIN" as ClassifyBlockDevices() does, but from a
+// sysfs tree at the given root. Returns {removable, transport?}, or null if
+// the tree has no such device.
+Napi::Value ClassifySysfsBlockDeviceForTest(const Napi::CallbackInfo &info);
+#endif
+
+// Takes {devices: string[], probe?: boolean}. Resolves, per device path, to
+// {fstype, uuid?, label?} from DeviceIdentityCache or libblkid's cache file,
+// or, with `probe`, by reading the device; null where none of those identify
+// a filesystem. Only identities read from the device are kept in
+// DeviceIdentityCache. Devices are handled in order on one worker thread, so
+// pass one disk's partitions per call. See src/linux/block_devices.cpp.
+Napi::Value GetBlockDeviceIdentities(const Napi::CallbackInfo &info);
+
+// A host-wide cache of the last getAllVolumeMetadata() result, in a named
+// shared-memory segment (see src/linux/shared_volume_cache.cpp). open() maps
+// it, creating it at {name, sizeBytes} if needed, and returns an External.
+// read() copies the latest snapshot out under a seqlock and resolves to
+// {volumes, generation, publishedAt, ageMs}, or null before the first
+// publish. Only the process holding the lease may publish(handle, bytes).
+// All synchronous.
+Napi::Value OpenSharedVolumeCache(const Napi::CallbackInfo &info);
+Napi::Value ReadSharedVolumeCache(const Napi::CallbackInfo &info);
+Napi::Value TryAcquireSharedVolumeCacheLease(const Napi::CallbackInfo &info);
+Napi::Value ReleaseSharedVolumeCacheLease(const Napi::CallbackInfo &info);
+Napi::Value PublishSharedVolumeCache(const Napi::CallbackInfo &info);
+Napi::Value CloseSharedVolumeCache(const Napi::CallbackInfo &info);
+Napi::Value UnlinkSharedVolumeCache(const Napi::CallbackInfo &info);
+
+} // namespace FSMeta
@@ -1,24 +1,67 @@
 // src/linux/mount_points.ts
+import { readFileSync } from "node:fs";
 import { readFile } from "node:fs/promises";
 import { debug } from "../debuglog";
 import { toError, WrappedError } from "../error";
 import { optionsWithDefaults } from "../options";
 import { type MountPoint } from "../types/mount_point";
 import type { Options } from "../types/options";
-import { MountEntry, mountEntryToMountPoint, parseMtab } from "./mtab";
+import {
+  MountEntry,
+  mountEntryToMountPoint,
+  parseMtab,
+  zfsSnapshotDataset,
+} from "./mtab";
 
+/**
+ * @param filterEntries Narrows the parsed mount table before it's converted
+ * (see {@link Options.blockDeviceFilter}). Every entry is still used to find
+ * ZFS snapshot origins.
+ */
 export async function getLinuxMountPoints(
   opts?: Pick<Options, "linuxMountTablePaths">,
+  filterEntries?: (entries: MountEntry[]) => Promise<MountEntry[]>,
 ): Promise<MountPoint[]> {
   const o = optionsWithDefaults(opts);
   let cause: Error | undefined;
   for (const input of o.linuxMountTablePaths) {
     try {
-      const mtabContent = await readFile(input, "utf8");
-      const results = parseMtab(mtabContent)
-        .map((ea) => mountEntryToMountPoint(ea))
-        .filter((ea) => ea != null);
+      const entries = parseMtab(await readFile(input, "utf8"));
+      const keep =
+        filterEntries == null || entries.length === 0
+          ? undefined
+          : new Set(await filterEntries(entries));
+      const results = toMountPoints(entries, keep);
       debug("[getLinuxMountPoints] %s mount points: %o", input, results);
+      // A filter may legitimately match nothing: only an empty table means
+      // "try the next one".
+      if (results.length > 0 || (keep != null && entries.length > 0)) {
+        return results;
+      }
+    } catch (error) {
+      cause ??= toError(error);
+    }
+  }
+
+  throw new WrappedError(
+    `Failed to find any mount points (tried: ${JSON.stringify(o.linuxMountTablePaths)})`,
+    { cause },
+  );
+}
+
+/**
+ * Synchronous {@link getLinuxMountPoints}. Reading the mount table never
+ * touches the mounted volumes, so this cannot block on a dead network mount.
+ */
+export function getLinuxMountPointsSync(
+  opts?: Pick<Options, "linuxMountTablePaths">,
+): MountPoint[] {
+  const o = optionsWithDefaults(opts);
+  let cause: Error | undefined;
+  for (const input of o.linuxMountTablePaths) {
+    try {
+      const results = toMountPoints(parseMtab(readFileSync(input, "utf8")));
+      debug("[getLinuxMountPointsSync] %s mount points: %o", input, results);
       if (results.length > 0) {
         return results;
       }
@@ -33,6 +76,38 @@ export async function getLinuxMountPoints(
   );
 }
 
+function toMountPoints(
+  entries: MountEntry[],
+  keep?: Set<MountEntry>,
+): MountPoint[] {
+  // ZFS snapshots mounted outside `.zfs/snapshot/` are grouped under
+  // wherever their origin dataset is mounted.
+  const datasetMountPoints = new Map<string, string>();
+  for (const ea of entries) {
+    if (
+      ea.fs_vfstype === "zfs" &&
+      zfsSnapshotDataset(ea.fs_spec, ea.fs_vfstype) == null &&
+      !datasetMountPoints.has(ea.fs_spec)
+    ) {
+      datasetMountPoints.set(ea.fs_spec, ea.fs_file);
+    }
+  }
+  const results: MountPoint[] = [];
+  for (const ea of entries) {
+    if (keep != null && !keep.has(ea)) continue;
+    const mp = mountEntryToMountPoint(ea);
+    if (mp == null) continue;
+    if (mp.isSnapshot && mp.snapshotOrigin == null) {
+      const dataset = zfsSnapshotDataset(ea.fs_spec, ea.fs_vfstype);
+      const origin =
+        dataset == null ? undefined : datasetMountPoints.get(dataset);
+      if (origin != null) mp.snapshotOrigin = origin;
+    }
+    results.push(mp);
+  }
+  return results;
+}
+
 export async function getLinuxMtabMetadata(
   mountPoint: string,
   opts?: Pick<Options, "linuxMountTablePaths">,
@@ -57,3 +132,54 @@ export async function getLinuxMtabMetadata(
     caughtError,
   );
 }
+
+/**
+ * Synchronous {@link getLinuxMtabMetadata}.
+ */
+export function getLinuxMtabMetadataSync(
+  mountPoint: string,
+  opts?: Pick<Options, "linuxMountTablePaths">,
+): MountEntry {
+  let caughtError: Error | undefined;
+  const inputs = optionsWithDefaults(opts).linuxMountTablePaths;
+  for (const input of inputs) {
+    try {
+      for (const ea of parseMtab(readFileSync(input, "utf8"))) {
+        if (ea.fs_file === mountPoint) {
+          return ea;
+        }
+      }
+    } catch (error) {
+      caughtError ??= toError(error);
+    }
+  }
+
+  throw new WrappedError(
+    `Failed to find mount point ${mountPoint} in an linuxMountTablePaths (tried: ${JSON.stringify(inputs)})`,
+    { cause: caughtError },
+  );
+}
+
+/**
+ * Every entry of the first readable, non-empty mount table. Unlike
+ * {@link getLinuxMountPoints}, entries keep their device (`fs_spec`).
+ */
+export async function getLinuxMountEntries(
+  opts?: Pick<Options, "linuxMountTablePaths">,
+): Promise<MountEntry[]> {
+  let cause: Error | undefined;
+  const inputs = optionsWithDefaults(opts).linuxMountTablePaths;
+  for (const input of inputs) {
+    try {
+      const entries = parseMtab(await readFile(input, "utf8"));
+      if (entries.length > 0) return entries;
+    } catch (error) {
+      cause ??= toError(error);
+    }
+  }
+
+  throw new WrappedError(
+    `Failed to find any mount points (tried: ${JSON.stringify(inputs)})`,
+    { cause },
+  );
+}
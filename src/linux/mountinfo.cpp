@@ -0,0 +1,291 @@
+// src/linux/mountinfo.cpp
+
+#include "mountinfo.h"
+#include "../common/debug_log.h"
+#include "fs_meta.h"
+#include <cerrno>
+#include <charconv> // for std::from_chars()
+#include <cstring>  // for strerror()
+#include <fcntl.h>  // for open(), O_CLOEXEC, O_RDONLY
+#include <poll.h>
+#include <unistd.h> // for pread()
+
+namespace FSMeta {
+
+std::mutex MountInfoCache::mutex_;
+FdGuard MountInfoCache::fd_(-1);
+bool MountInfoCache::holdsFd_ = false;
+std::shared_ptr<const MountInfoSnapshot> MountInfoCache::snapshot_;
+size_t MountInfoCache::bytes_ = 0;
+CacheCounters MountInfoCache::counters_;
+
+namespace {
+
+bool IsOctalEscape(std::string_view field, size_t i) {
+  return field[i] == '\\' && i + 3 < field.size() && field[i + 1] >= '0' &&
+         field[i + 1] <= '3' && field[i + 2] >= '0' && field[i + 2] <= '7' &&
+         field[i + 3] >= '0' && field[i + 3] <= '7';
+}
+
+// Writes the unescaped `field` to `out`, which must have room for
+// field.size() bytes. Returns the unescaped length.
+size_t UnescapeTo(std::string_view field, char *out) {
+  size_t n = 0;
+  for (size_t i = 0; i < field.size(); i++) {
+    if (IsOctalEscape(field, i)) {
+      out[n++] = static_cast<char>((field[i + 1] - '0') * 64 +
+                                   (field[i + 2] - '0') * 8 +
+                                   (field[i + 3] - '0'));
+      i += 3;
+    } else {
+      out[n++] = field[i];
+    }
+  }
+  return n;
+}
+
+// Most fields have no escapes: view those in place.
+std::string_view UnescapeInto(std::string_view field, Arena &arena) {
+  if (field.find('\\') == std::string_view::npos) {
+    return field;
+  }
+  char *out = arena.Allocate(field.size());
+  return {out, UnescapeTo(field, out)};
+}
+
+// Splits on single spaces, as the kernel writes them.
+class FieldReader {
+public:
+  explicit FieldReader(std::string_view line) : rest_(line) {}
+
+  bool Next(std::string_view &field) {
+    if (rest_.empty()) {
+      return false;
+    }
+    const size_t end = rest_.find(' ');
+    field = rest_.substr(0, end);
+    rest_ = end == std::string_view::npos ? std::string_view()
+                                          : rest_.substr(end + 1);
+    return true;
+  }
+
+private:
+  std::string_view rest_;
+};
+
+// "36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw"
+bool ParseMountInfoLine(std::string_view line, Arena &arena,
+                        MountInfoEntry &out) {
+  FieldReader in(line);
+  std::string_view mountId, parentId, devno, root, mountPoint, mountOptions;
+  if (!(in.Next(mountId) && in.Next(parentId) && in.Next(devno) &&
+        in.Next(root) && in.Next(mountPoint) && in.Next(mountOptions))) {
+    return false;
+  }
+  const char *end = mountId.data() + mountId.size();
+  if (std::from_chars(mountId.data(), end, out.mountId).ptr != end) {
+    return false;
+  }
+  // Optional fields ("shared:1", "master:2", ...) run up to a lone "-".
+  std::string_view field;
+  while (in.Next(field) && field != "-") {
+  }
+  std::string_view fstype, source, superOptions;
+  if (field != "-" || !in.Next(fstype) || !in.Next(source)) {
+    return false;
+  }
+  in.Next(superOptions);
+  out.root = UnescapeInto(root, arena);
+  out.mountPoint = UnescapeInto(mountPoint, arena);
+  out.fstype = fstype;
+  out.source = UnescapeInto(source, arena);
+  out.mountOptions = superOptions.empty()
+                         ? mountOptions
+                         : arena.Join(mountOptions, ',', superOptions);
+  return true;
+}
+
+const bool kMountInfoStatsRegistered =
+    CacheBudget::Register(&MountInfoCache::Stats);
+const bool kMountInfoFdRegistered =
+    CacheBudget::RegisterFdHolder(&MountInfoCache::ReleaseFd);
+
+} // namespace
+
+#if defined(FS_METADATA_TEST_HOOKS)
+Napi::Value ParseMountInfoForTest(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    throw Napi::TypeError::New(env, "String expected for content");
+  }
+  const std::string content = info[0].As<Napi::String>();
+  auto toString = [&env](std::string_view s) {
+    return Napi::String::New(env, s.data(), s.size());
+  };
+  Arena arena;
+  auto result = Napi::Array::New(env);
+  std::string_view rest(content);
+  while (!rest.empty()) {
+    const size_t eol = rest.find('\n');
+    const std::string_view line = rest.substr(0, eol);
+    rest = eol == std::string_view::npos ? std::string_view()
+                                         : rest.substr(eol + 1);
+    MountInfoEntry entry;
+    Napi::Value value = env.Null();
+    if (ParseMountInfoLine(line, arena, entry)) {
+      auto obj = Napi::Object::New(env);
+      obj.Set("mountId", static_cast<double>(entry.mountId));
+      obj.Set("root", toString(entry.root));
+      obj.Set("mountPoint", toString(entry.mountPoint));
+      obj.Set("fstype", toString(entry.fstype));
+      obj.Set("source", toString(entry.source));
+      obj.Set("mountOptions", toString(entry.mountOptions));
+      value = obj;
+    }
+    result.Set(result.Length(), value);
+  }
+  return result;
+}
+#endif
+
+std::string MountInfoCache::Unescape(std::string_view field) {
+  std::string out(field.size(), '\0');
+  out.resize(UnescapeTo(field, out.data()));
+  return out;
+}
+
+MountInfoSnapshot::MountInfoSnapshot(std::string content)
+    : content_(std::move(content)) {
+  std::string_view rest(content_);
+  while (!rest.empty()) {
+    const size_t eol = rest.find('\n');
+    const std::string_view line = rest.substr(0, eol);
+    rest = eol == std::string_view::npos ? std::string_view()
+                                         : rest.substr(eol + 1);
+    MountInfoEntry entry;
+    if (ParseMountInfoLine(line, arena_, entry)) {
+      entries_.emplace(entry.mountId, std::move(entry));
+    }
+  }
+}
+
+const MountInfoEntry *MountInfoSnapshot::Find(uint64_t mountId) const {
+  auto it = entries_.find(mountId);
+  return it == entries_.end() ? nullptr : &it->second;
+}
+
+size_t MountInfoSnapshot::bytes() const {
+  return sizeof(*this) + content_.capacity() + arena_.BytesReserved() +
+         entries_.size() * (sizeof(MountInfoEntry) + 4 * sizeof(void *));
+}
+
+std::shared_ptr<const MountInfoSnapshot> MountInfoCache::ReloadLocked() {
+  if (!fd_.isValid()) {
+    const int fd = open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      DEBUG_LOG("[MountInfoCache] open failed: %s", strerror(errno));
+      return nullptr;
+    }
+    fd_ = FdGuard(fd);
+  }
+
+  // seq_file reads must start at offset 0 to see a consistent snapshot.
+  // Read straight into the buffer the snapshot will own and view.
+  constexpr size_t kChunk = 64 * 1024;
+  std::string content;
+  size_t offset = 0;
+  for (;;) {
+    content.resize(offset + kChunk);
+    const ssize_t n = pread(fd_.get(), content.data() + offset, kChunk,
+                            static_cast<off_t>(offset));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      DEBUG_LOG("[MountInfoCache] read failed: %s", strerror(errno));
+      DropLocked();
+      return nullptr;
+    }
+    if (n == 0) {
+      break;
+    }
+    offset += static_cast<size_t>(n);
+  }
+  content.resize(offset);
+  content.shrink_to_fit();
+
+  // Lookups still holding the previous snapshot keep it alive. The snapshot
+  // is all or nothing, so rather than join the shared byte total (where no
+  // other cache's eviction could shrink it), it's kept only if it alone fits
+  // in maxBytes, and only with a descriptor slot to tell when it goes stale.
+  auto snapshot = std::make_shared<const MountInfoSnapshot>(std::move(content));
+  DEBUG_LOG("[MountInfoCache] loaded %zu mounts", snapshot->size());
+  if (snapshot->bytes() <= CacheBudget::MaxBytes() &&
+      (holdsFd_ || (holdsFd_ = CacheBudget::TryAcquireFd()))) {
+    snapshot_ = snapshot;
+    bytes_ = snapshot->bytes();
+  } else {
+    DropLocked();
+  }
+  return snapshot;
+}
+
+void MountInfoCache::DropLocked() {
+  fd_ = FdGuard(-1);
+  if (holdsFd_) {
+    holdsFd_ = false;
+    CacheBudget::ReleaseFd();
+  }
+  snapshot_.reset();
+  bytes_ = 0;
+}
+
+void MountInfoCache::ReleaseFd() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  DropLocked();
+}
+
+CacheStats MountInfoCache::Stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  CacheStats stats;
+  stats.name = "mountInfo";
+  stats.entries = snapshot_ == nullptr ? 0 : snapshot_->size();
+  stats.bytes = bytes_;
+  stats.fds = fd_.isValid() ? 1 : 0;
+  stats.hits = counters_.hits.load();
+  stats.misses = counters_.misses.load();
+  return stats;
+}
+
+bool MountInfoCache::Lookup(uint64_t mountId, MountInfoEntry &out) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::shared_ptr<const MountInfoSnapshot> snapshot = snapshot_;
+  bool fresh = false;
+  if (snapshot == nullptr || bytes_ > CacheBudget::MaxBytes()) {
+    fresh = true;
+  } else {
+    // The poll itself acknowledges the change.
+    pollfd pfd = {fd_.get(), POLLPRI, 0};
+    fresh = poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLPRI | POLLERR)) != 0;
+  }
+  if (fresh && !(snapshot = ReloadLocked())) {
+    return false;
+  }
+  const MountInfoEntry *found = snapshot->Find(mountId);
+  if (found == nullptr && !fresh) {
+    if (!(snapshot = ReloadLocked())) {
+      return false;
+    }
+    fresh = true;
+    found = snapshot->Find(mountId);
+  }
+  (fresh ? counters_.misses : counters_.hits)++;
+  if (found == nullptr) {
+    return false;
+  }
+  out = *found;
+  out.snapshot = std::move(snapshot);
+  return true;
+}
+
+} // namespace FSMeta
@@ -0,0 +1,87 @@
+// src/linux/mountinfo.h
+
+#pragma once
+#include "../common/arena.h"
+#include "../common/cache_budget.h"
+#include "../common/fd_guard.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace FSMeta {
+
+class MountInfoSnapshot;
+
+// Fields are views into a MountInfoSnapshot. Entries returned by
+// MountInfoCache::Lookup() hold a reference to it, so they stay valid after
+// the cache moves on to a newer snapshot.
+struct MountInfoEntry {
+  uint64_t mountId = 0;
+  std::string_view root;       // path of the mount's root within its fs
+  std::string_view mountPoint; // as seen from this process
+  std::string_view fstype;
+  std::string_view source;       // mtab's fs_spec: device, dataset or remote
+  std::string_view mountOptions; // per-mount options, then the superblock's
+  std::shared_ptr<const MountInfoSnapshot> snapshot;
+};
+
+// One read of /proc/self/mountinfo, parsed in place. Fields view the raw
+// text where they can; unescaped paths and joined options live in an arena.
+// Immutable once built, and freed in one go with its last reference.
+class MountInfoSnapshot {
+public:
+  explicit MountInfoSnapshot(std::string content);
+
+  // Entries here have no `snapshot`: MountInfoCache::Lookup() sets it.
+  const MountInfoEntry *Find(uint64_t mountId) const;
+  size_t size() const { return entries_.size(); }
+
+  // Heap bytes held, for CacheBudget accounting.
+  size_t bytes() const;
+
+private:
+  const std::string content_;
+  Arena arena_;
+  std::unordered_map<uint64_t, MountInfoEntry> entries_;
+};
+
+// Process-wide snapshot of /proc/self/mountinfo, keyed by mount id.
+//
+// The file is kept open: the kernel flags it POLLPRI whenever this mount
+// namespace changes, so a Lookup() with nothing mounted or unmounted since the
+// last read costs one poll() and a hash probe. A miss also re-reads, in case a
+// mount raced the poll.
+//
+// Holding the descriptor takes one slot of CacheBudget's fd budget, and the
+// snapshot is kept only while it does and fits in CacheBudget::MaxBytes() by
+// itself. Otherwise the file is closed after each read and every Lookup()
+// re-reads it. Its bytes don't count toward the total the other caches share.
+class MountInfoCache {
+public:
+  static bool Lookup(uint64_t mountId, MountInfoEntry &out);
+
+  static CacheStats Stats();
+
+  // Closes the descriptor and drops the snapshot, for CacheBudget::SetMaxFds().
+  static void ReleaseFd();
+
+  // Decodes mountinfo's \ooo octal escapes (space, tab, newline, backslash).
+  static std::string Unescape(std::string_view field);
+
+private:
+  // The new snapshot, whether or not it's kept; null if the read failed.
+  static std::shared_ptr<const MountInfoSnapshot> ReloadLocked();
+  static void DropLocked();
+
+  static std::mutex mutex_;
+  static FdGuard fd_;
+  static bool holdsFd_; // fd_ has a CacheBudget slot
+  static std::shared_ptr<const MountInfoSnapshot> snapshot_;
+  static size_t bytes_;
+  static CacheCounters counters_;
+};
+
+} // namespace FSMeta
@@ -0,0 +1,107 @@
+// src/linux/mountinfo.test.ts
+//
+// The native mountinfo parser behind getVolumeMetadataForFd(), through a
+// hook only Debug and `FS_METADATA_TEST_HOOKS=1` builds export.
+
+import { nativeSyncFn } from "../native_loader";
+import { describePlatform } from "../test-utils/platform";
+import type { NativeBindings } from "../types/native_bindings";
+
+function parser(): NativeBindings["parseMountInfoForTest"] {
+  try {
+    return nativeSyncFn().parseMountInfoForTest;
+  } catch {
+    return undefined;
+  }
+}
+
+const parse = parser();
+
+const describeOrSkip =
+  parse == null ? describe.skip : describePlatform("linux");
+
+describeOrSkip("native mountinfo parser", () => {
+  const parseLine = (line: string) => parse?.(line)[0];
+
+  it("parses the kernel's documented example", () => {
+    expect(
+      parseLine(
+        "36 35 98:0 /mnt1 /mnt/parent rw,noatime master:1 - ext3 /dev/root rw,errors=continue",
+      ),
+    ).toEqual({
+      mountId: 36,
+      root: "/mnt1",
+      mountPoint: "/mnt/parent",
+      fstype: "ext3",
+      source: "/dev/root",
+      mountOptions: "rw,noatime,rw,errors=continue",
+    });
+  });
+
+  it.each([
+    ["no optional fields", "37 1 0:5 / /a rw - tmpfs tmpfs rw"],
+    ["one", "37 1 0:5 / /a rw shared:1 - tmpfs tmpfs rw"],
+    [
+      "several",
+      "37 1 0:5 / /a rw shared:1 master:2 propagate_from:3 unbindable - tmpfs tmpfs rw",
+    ],
+  ])("skips %s optional fields", (_, line) => {
+    expect(parseLine(line)).toMatchObject({
+      mountPoint: "/a",
+      fstype: "tmpfs",
+      source: "tmpfs",
+      mountOptions: "rw,rw",
+    });
+  });
+
+  it("decodes octal escapes in paths and sources", () => {
+    expect(
+      parseLine(
+        "38 1 0:5 /r\\134oot /mnt/with\\040space\\012and\\011tab rw - cifs //host/a\\040b rw",
+      ),
+    ).toMatchObject({
+      root: "/r\\oot",
+      mountPoint: "/mnt/with space\nand\ttab",
+      source: "//host/a b",
+    });
+  });
+
+  it("keeps backslashes that don't start a valid escape", () => {
+    expect(
+      parseLine("39 1 0:5 / /x\\400\\9 rw - ext4 /dev/sda1\\04 rw"),
+    ).toMatchObject({ mountPoint: "/x\\400\\9", source: "/dev/sda1\\04" });
+  });
+
+  it("uses the mount's options alone without superblock options", () => {
+    expect(parseLine("40 1 0:5 / /b ro,nosuid - proc proc")).toMatchObject({
+      mountOptions: "ro,nosuid",
+    });
+  });
+
+  it.each([
+    ["too few fields", "43 1 0:5"],
+    ["no separator", "41 1 0:5 / /b rw ext4 /dev/sda rw"],
+    ["no fstype", "41 1 0:5 / /b rw -"],
+    ["no source", "41 1 0:5 / /b rw - ext4"],
+    ["a non-numeric mount id", "x 1 0:5 / /b rw - ext4 /dev/sda rw"],
+    ["a partly numeric mount id", "4x 1 0:5 / /b rw - ext4 /dev/sda rw"],
+  ])("rejects %s", (_, line) => {
+    expect(parse?.(line)).toEqual([null]);
+  });
+
+  it("parses each line on its own", () => {
+    const result = parse?.(
+      [
+        "1 0 0:1 / / rw - ext4 /dev/sda1 rw",
+        "garbage",
+        "2 1 0:2 / /proc rw - proc proc rw",
+        "",
+      ].join("\n"),
+    );
+    expect(result?.map((ea) => ea?.mountPoint ?? null)).toEqual([
+      "/",
+      null,
+      "/proc",
+    ]);
+  });
+});
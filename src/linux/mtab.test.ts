@@ -4,6 +4,7 @@ import {
   mountEntryToMountPoint,
   mountEntryToPartialVolumeMetadata,
   parseMtab,
+  zfsSnapshotDataset,
 } from "./mtab";
 
 describe("mtab", () => {
@@ -509,6 +510,52 @@ tmpfs /run tmpfs rw,nosuid,nodev,mode=755 0 0
     });
   });
 
+  describe("snapshots", () => {
+    const snapshotMtab = `
+tank/home /home zfs rw,xattr,posixacl 0 0
+tank/home@daily-1 /home/.zfs/snapshot/daily-1 zfs ro,relatime 0 0
+tank/home@daily-2 /mnt/restore zfs ro,relatime 0 0
+/dev/md2 /volume1/photos/#snapshot btrfs ro,subvolid=300,subvol=/@syno 0 0
+/dev/sda1 /srv/snapshot ext4 rw 0 0
+`;
+
+    it("detects snapshots and path-derived origins", () => {
+      const [home, auto, manual, syno, plain] = parseMtab(snapshotMtab).map(
+        (e) => mountEntryToMountPoint(e),
+      );
+      expect(home).not.toHaveProperty("isSnapshot");
+      expect(auto).toMatchObject({
+        isSnapshot: true,
+        snapshotOrigin: "/home",
+      });
+      // Origin needs the whole table; see getLinuxMountPoints()
+      expect(manual).toMatchObject({ isSnapshot: true });
+      expect(manual).not.toHaveProperty("snapshotOrigin");
+      expect(syno).toMatchObject({
+        isSnapshot: true,
+        snapshotOrigin: "/volume1/photos",
+      });
+      expect(plain).not.toHaveProperty("isSnapshot");
+    });
+
+    it("marks snapshots in partial volume metadata", () => {
+      const [, auto] = parseMtab(snapshotMtab).map((e) =>
+        mountEntryToPartialVolumeMetadata(e, {}),
+      );
+      expect(auto).toMatchObject({
+        mountFrom: "tank/home@daily-1",
+        isSnapshot: true,
+        snapshotOrigin: "/home",
+      });
+    });
+
+    it("only treats @ as a snapshot separator on zfs", () => {
+      expect(zfsSnapshotDataset("tank/a@b", "zfs")).toBe("tank/a");
+      expect(zfsSnapshotDataset("tank/a", "zfs")).toBeUndefined();
+      expect(zfsSnapshotDataset("user@host:/x", "fuse.sshfs")).toBeUndefined();
+    });
+  });
+
   describe("mountEntryToMountPoint()", () => {
     it("should set isReadOnly from mount options", () => {
       expect(
@@ -85,6 +85,48 @@ function parseSubvolInfo(
   return result;
 }
 
+/**
+ * Snapshot directory segments: ZFS's automount control directory, and the
+ * `#snapshot` directories of Synology shares and Kubernetes snapshot tooling.
+ * The path before the segment is the snapshot's origin.
+ */
+const SnapshotPathPattern = /\/(?:\.zfs\/snapshot|#snapshot)(?:\/|$)/;
+
+/**
+ * The dataset a ZFS snapshot source (`pool/fs@snap`) was taken from, or
+ * undefined if `fs_spec` is not a ZFS snapshot.
+ */
+export function zfsSnapshotDataset(
+  fs_spec: string,
+  fstype: string | undefined,
+): string | undefined {
+  if (fstype !== "zfs") return;
+  const at = fs_spec.indexOf("@");
+  return at > 0 ? fs_spec.slice(0, at) : undefined;
+}
+
+/**
+ * Detects snapshot mounts from the mount table alone. The origin is derived
+ * from the mount path when it sits under a snapshot directory; ZFS
+ * snapshots mounted elsewhere get their origin from the whole table (see
+ * `getLinuxMountPoints()`).
+ */
+function parseSnapshotInfo(entry: MountEntry): {
+  isSnapshot?: true;
+  snapshotOrigin?: string;
+} {
+  const match = SnapshotPathPattern.exec(entry.fs_file);
+  if (match != null) {
+    return {
+      isSnapshot: true,
+      snapshotOrigin: entry.fs_file.slice(0, match.index) || "/",
+    };
+  }
+  return zfsSnapshotDataset(entry.fs_spec, entry.fs_vfstype) == null
+    ? {}
+    : { isSnapshot: true };
+}
+
 export function mountEntryToMountPoint(
   entry: MountEntry,
 ): MountPoint | undefined {
@@ -97,6 +139,7 @@ export function mountEntryToMountPoint(
         fstype,
         isReadOnly: isReadOnlyMount(entry.fs_mntops),
         ...parseSubvolInfo(entry.fs_mntops, entry.fs_vfstype),
+        ...parseSnapshotInfo(entry),
       };
 }
 
@@ -122,6 +165,7 @@ export function mountEntryToPartialVolumeMetadata(
     isSystemVolume: isSystemVolume(entry.fs_file, entry.fs_vfstype, options),
     isReadOnly: isReadOnlyMount(entry.fs_mntops),
     ...parseSubvolInfo(entry.fs_mntops, entry.fs_vfstype),
+    ...parseSnapshotInfo(entry),
     ...remoteInfo,
     // The spec alone can miss remote mounts — a network fstype with an
     // unparseable source (e.g. 9p's "svc", or davfs's https:// URI) must
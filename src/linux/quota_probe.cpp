@@ -0,0 +1,222 @@
+// src/linux/quota_probe.cpp
+#include "quota_probe.h"
+#include "../common/debug_log.h"
+#include <cerrno>
+#include <cinttypes> // for SCNu64
+#include <cstdio>    // for fopen(), fscanf(), snprintf()
+#include <cstring>   // for memset(), strerror()
+#include <linux/fs.h> // for FS_IOC_FSGETXATTR, struct fsxattr
+#include <sys/ioctl.h>
+#include <sys/quota.h> // for quotactl(), QCMD, Q_GETQUOTA, struct dqblk
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// See the matching guard in btrfs_subvolumes.cpp.
+#if defined(__has_include)
+#if __has_include(<linux/btrfs.h>)
+#include <linux/btrfs.h> // BTRFS_IOC_FS_INFO, BTRFS_IOC_INO_LOOKUP
+#define FSMETA_HAVE_BTRFS 1
+#endif
+#endif
+
+// Older glibc and musl headers predate project quotas.
+#ifndef PRJQUOTA
+#define PRJQUOTA 2
+#endif
+
+#ifdef FSMETA_HAVE_BTRFS
+#ifndef BTRFS_FIRST_FREE_OBJECTID
+#define BTRFS_FIRST_FREE_OBJECTID 256ULL
+#endif
+#endif
+
+namespace FSMeta {
+
+namespace {
+
+// Quota block limits are in fixed 1 KiB units, regardless of the
+// filesystem's block size (QIF_DQBLKSIZE in <linux/quota.h>).
+constexpr uint64_t kQuotaBlockSize = 1024;
+
+struct QuotaCandidate {
+  const char *type = nullptr;
+  uint64_t limit = 0;
+  uint64_t used = 0;
+
+  uint64_t Available() const { return limit > used ? limit - used : 0; }
+};
+
+void Consider(QuotaCandidate &best, const QuotaCandidate &candidate) {
+  if (candidate.limit == 0) {
+    return; // no limit configured
+  }
+  if (best.type == nullptr || candidate.Available() < best.Available()) {
+    best = candidate;
+  }
+}
+
+bool IsQuotactlFsType(std::string_view fstype) {
+  return fstype == "ext2" || fstype == "ext3" || fstype == "ext4" ||
+         fstype == "xfs";
+}
+
+// Q_GETQUOTA via quotactl_fd(2) (Linux >= 5.14) when the headers know it,
+// so we need not resolve the mount's block device. Falls back to
+// quotactl(2) on the mount table device.
+bool GetQuota(int fd, std::string_view device, int type, uint32_t id,
+              struct dqblk &dq) {
+  memset(&dq, 0, sizeof(dq));
+#ifdef SYS_quotactl_fd
+  if (syscall(SYS_quotactl_fd, fd, QCMD(Q_GETQUOTA, type), id, &dq) == 0) {
+    return true;
+  }
+  if (errno != ENOSYS) {
+    // ESRCH: quotas of this type are off. EPERM: project quotas need
+    // CAP_SYS_ADMIN.
+    DEBUG_LOG("[ProbeQuota] quotactl_fd(type %d, id %u) failed: %s", type, id,
+              strerror(errno));
+    return false;
+  }
+#else
+  (void)fd;
+#endif
+  if (device.empty() || device[0] != '/') {
+    return false;
+  }
+  if (quotactl(QCMD(Q_GETQUOTA, type), device.data(), static_cast<int>(id),
+               reinterpret_cast<caddr_t>(&dq)) == 0) {
+    return true;
+  }
+  DEBUG_LOG("[ProbeQuota] quotactl(%s, type %d, id %u) failed: %s",
+            device.data(), type, id, strerror(errno));
+  return false;
+}
+
+QuotaCandidate FromDqblk(const char *type, const struct dqblk &dq) {
+  QuotaCandidate result;
+  result.type = type;
+  if ((dq.dqb_valid & QIF_BLIMITS) != 0) {
+    // The soft limit may be exceeded during the grace period, so it only
+    // counts when no hard limit is set.
+    const uint64_t blocks =
+        dq.dqb_bhardlimit != 0 ? dq.dqb_bhardlimit : dq.dqb_bsoftlimit;
+    if (!WouldOverflow(blocks, kQuotaBlockSize)) {
+      result.limit = blocks * kQuotaBlockSize;
+    }
+  }
+  if ((dq.dqb_valid & QIF_SPACE) != 0) {
+    result.used = dq.dqb_curspace;
+  }
+  return result;
+}
+
+#ifdef FSMETA_HAVE_BTRFS
+bool ReadU64File(const char *path, uint64_t &value) {
+  FILE *f = fopen(path, "re");
+  if (f == nullptr) {
+    return false;
+  }
+  const bool ok = fscanf(f, "%" SCNu64, &value) == 1;
+  fclose(f);
+  return ok;
+}
+
+// btrfs qgroup limits live in the quota tree, which only
+// BTRFS_IOC_TREE_SEARCH (CAP_SYS_ADMIN) can read. Linux >= 5.9 mirrors each
+// level-0 qgroup in sysfs, readable by anyone; both ioctls used to find it
+// are unprivileged.
+bool GetBtrfsQgroup(int fd, QuotaCandidate &result) {
+  struct btrfs_ioctl_fs_info_args fs_info;
+  memset(&fs_info, 0, sizeof(fs_info));
+  if (ioctl(fd, BTRFS_IOC_FS_INFO, &fs_info) < 0) {
+    DEBUG_LOG("[ProbeQuota] BTRFS_IOC_FS_INFO failed: %s", strerror(errno));
+    return false;
+  }
+
+  // treeid 0 + the subvolume root's objectid asks for the id of the
+  // subvolume containing fd; this form needs no privileges (Linux >= 4.18).
+  struct btrfs_ioctl_ino_lookup_args lookup;
+  memset(&lookup, 0, sizeof(lookup));
+  lookup.objectid = BTRFS_FIRST_FREE_OBJECTID;
+  if (ioctl(fd, BTRFS_IOC_INO_LOOKUP, &lookup) < 0) {
+    DEBUG_LOG("[ProbeQuota] BTRFS_IOC_INO_LOOKUP failed: %s",
+              strerror(errno));
+    return false;
+  }
+
+  const unsigned char *u = fs_info.fsid;
+  char dir[128];
+  snprintf(dir, sizeof(dir),
+           "/sys/fs/btrfs/%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-"
+           "%02x%02x%02x%02x%02x%02x/qgroups/0_%llu",
+           u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7], u[8], u[9], u[10],
+           u[11], u[12], u[13], u[14], u[15],
+           static_cast<unsigned long long>(lookup.treeid));
+
+  char path[160];
+  snprintf(path, sizeof(path), "%s/max_referenced", dir);
+  if (!ReadU64File(path, result.limit)) {
+    DEBUG_LOG("[ProbeQuota] no qgroup at %s (quotas disabled?)", dir);
+    return false;
+  }
+  snprintf(path, sizeof(path), "%s/referenced", dir);
+  if (!ReadU64File(path, result.used)) {
+    return false;
+  }
+  result.type = "qgroup";
+  return true;
+}
+#endif
+
+} // namespace
+
+void ProbeQuota(int fd, const std::string &path, std::string_view fstype,
+                std::string_view device, VolumeMetadata &metadata) {
+  QuotaCandidate best;
+
+  if (IsQuotactlFsType(fstype)) {
+    struct dqblk dq;
+
+#ifdef FS_IOC_FSGETXATTR
+    // Project 0 is the default for files never assigned to a project.
+    struct fsxattr fsx;
+    memset(&fsx, 0, sizeof(fsx));
+    if (ioctl(fd, FS_IOC_FSGETXATTR, &fsx) == 0 && fsx.fsx_projid != 0) {
+      DEBUG_LOG("[ProbeQuota] %s is in project %u", path.c_str(),
+                fsx.fsx_projid);
+      if (GetQuota(fd, device, PRJQUOTA, fsx.fsx_projid, dq)) {
+        Consider(best, FromDqblk("project", dq));
+      }
+    }
+#endif
+
+    // Unprivileged callers may always read their own user quota.
+    if (GetQuota(fd, device, USRQUOTA, geteuid(), dq)) {
+      Consider(best, FromDqblk("user", dq));
+    }
+  }
+
+#ifdef FSMETA_HAVE_BTRFS
+  if (fstype == "btrfs") {
+    QuotaCandidate qgroup;
+    if (GetBtrfsQgroup(fd, qgroup)) {
+      Consider(best, qgroup);
+    }
+  }
+#endif
+
+  if (best.type == nullptr) {
+    DEBUG_LOG("[ProbeQuota] no quota limits apply to %s", path.c_str());
+    return;
+  }
+
+  metadata.quotaType = best.type;
+  metadata.quotaLimit = static_cast<double>(best.limit);
+  metadata.quotaUsed = static_cast<double>(best.used);
+  metadata.quotaAvailable = static_cast<double>(best.Available());
+  DEBUG_LOG("[ProbeQuota] %s quota for %s: {limit: %.3f GB, used: %.3f GB}",
+            best.type, path.c_str(), metadata.quotaLimit / 1e9,
+            metadata.quotaUsed / 1e9);
+}
+
+} // namespace FSMeta
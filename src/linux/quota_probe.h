@@ -0,0 +1,19 @@
+// src/linux/quota_probe.h
+// Not quota.h: with -Isrc that name would shadow <linux/quota.h>.
+#pragma once
+#include "../common/volume_metadata.h"
+#include <string>
+#include <string_view>
+
+namespace FSMeta {
+
+// Fills metadata.quota* with the most restrictive quota the kernel accounts
+// for the directory open at `fd`: its ext4/xfs project quota, the calling
+// user's quota, or its btrfs qgroup limit. Each lookup is O(1) and
+// best-effort: quotas that are disabled, unsupported, or need privileges we
+// lack are skipped and leave the fields unset. `device` must be
+// NUL-terminated, as VolumeMetadataOptions' strings are.
+void ProbeQuota(int fd, const std::string &path, std::string_view fstype,
+                std::string_view device, VolumeMetadata &metadata);
+
+} // namespace FSMeta
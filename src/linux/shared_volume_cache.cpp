@@ -0,0 +1,459 @@
+// src/linux/shared_volume_cache.cpp
+//
+// A named POSIX shared-memory segment, /dev/shm/fs-metadata-<name>, holding
+// the latest encodeVolumeSnapshot() payload for every process on the host
+// that opens the same name (see src/linux/shared_volume_cache.ts).
+//
+// Publishing is serialized by a lease: one 64-bit word holding the holder's
+// pid and expiry, claimed by compare-and-swap. It belongs to the handle that
+// claimed it, not just the process: another handle (or worker_thread) in the
+// same process can neither claim it again nor release it. A lease can lapse
+// mid-publish, so each publish also claims `writer` before it touches the
+// payload. `seq` is a seqlock: odd while a publish is copying in, and bumped
+// again when it's done. Readers copy the payload out and retry if `seq` moved
+// under them, so after open() they take no locks and make no syscalls, and
+// never hold up a publish.
+//
+// The segment is never resized: its creator sets the size, and everyone else
+// maps what's there. Shrinking a segment that another process has mapped
+// would SIGBUS it. For the same reason its pages are allocated up front: a
+// sparse tmpfs file would SIGBUS the first publish that touched a page
+// /dev/shm (or the memory cgroup) had no room for.
+//
+// /dev/shm is world-writable, so a segment someone else created could carry
+// a lease that never lapses, or bytes meant to be decoded: only segments
+// owned by this user and private to it are used.
+
+#include "../common/debug_log.h"
+#include "../common/error_utils.h"
+#include "../common/fd_guard.h"
+#include "../common/volume_snapshot.h"
+#include "fs_meta.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal> // for kill()
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace FSMeta {
+
+namespace {
+
+// Guards against type confusion, as in volume_probe.cpp.
+constexpr uint32_t kSharedCacheHandleMagic = 0x73766368; // "svch"
+
+// The first word of an initialized segment: "FSMC", then the layout version.
+constexpr uint64_t kSegmentMagic = 0x46534d4300000001ULL;
+
+constexpr size_t kHeaderBytes = 128;
+constexpr uint64_t kMaxSegmentBytes = 1ULL << 30;
+constexpr size_t kMaxNameLength = 200;
+
+// Pids fit in 22 bits (PID_MAX_LIMIT); the rest of a lease word is its
+// expiry in CLOCK_MONOTONIC milliseconds, which is system-wide.
+constexpr int kLeasePidBits = 22;
+constexpr uint64_t kLeasePidMask = (1ULL << kLeasePidBits) - 1;
+
+// A reader only retries while a publish is copying in, which takes
+// microseconds. Past this, it reports a miss rather than wait.
+constexpr int kMaxReadAttempts = 64;
+
+// How long open() waits for another process that just created the segment
+// to size it.
+constexpr auto kCreateWait = std::chrono::seconds(1);
+
+// Lives at the start of the mapping, so every field is a lock-free atomic:
+// those are address-free, and work across processes.
+struct SegmentHeader {
+  std::atomic<uint64_t> magic;
+  // (expiry << kLeasePidBits) | pid of the refreshing process; 0 when free.
+  std::atomic<uint64_t> lease;
+  // Pid of the process publishing now, or 0. Claimed by compare-and-swap
+  // before `seq` turns odd, and cleared after it turns even, so only one
+  // publish copies in at a time; one whose process died can be taken over.
+  std::atomic<uint64_t> writer;
+  // Kept off the lease's cache line: lease traffic shouldn't slow readers.
+  alignas(64) std::atomic<uint64_t> seq;
+  std::atomic<uint64_t> length;
+  std::atomic<uint64_t> publishedMonotonicMs;
+  std::atomic<uint64_t> publishedAtMs;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+static_assert(sizeof(SegmentHeader) <= kHeaderBytes);
+
+struct SharedCacheHandle {
+  uint32_t magic = kSharedCacheHandleMagic;
+  std::string shmName;
+  // Null once closed.
+  void *base = nullptr;
+  size_t size = 0;
+  // Reused by every read, so a steady-state read doesn't allocate.
+  std::vector<uint8_t> scratch;
+  // The lease word this handle stored when it claimed the lease, or 0. Only
+  // a lease still holding exactly this word is this handle's.
+  uint64_t leaseWord = 0;
+
+  // Also on garbage collection: a lease never outlives its handle.
+  ~SharedCacheHandle() { Unmap(); }
+
+  // A no-op unless this handle claimed the lease, and nobody has taken it
+  // since.
+  void ReleaseLease() {
+    uint64_t word = leaseWord;
+    if (word != 0 && base != nullptr) {
+      Header().lease.compare_exchange_strong(word, 0,
+                                             std::memory_order_acq_rel);
+    }
+    leaseWord = 0;
+  }
+
+  void Unmap() {
+    ReleaseLease();
+    if (base != nullptr) {
+      munmap(base, size);
+      base = nullptr;
+    }
+  }
+
+  SegmentHeader &Header() const { return *static_cast<SegmentHeader *>(base); }
+  uint8_t *Payload() const {
+    return static_cast<uint8_t *>(base) + kHeaderBytes;
+  }
+  size_t Capacity() const { return size - kHeaderBytes; }
+};
+
+SharedCacheHandle *UnwrapHandle(const Napi::CallbackInfo &info) {
+  if (info.Length() < 1 || !info[0].IsExternal()) {
+    throw Napi::TypeError::New(info.Env(),
+                               "Expected a shared volume cache handle");
+  }
+  auto *handle = info[0].As<Napi::External<SharedCacheHandle>>().Data();
+  if (handle == nullptr || handle->magic != kSharedCacheHandleMagic) {
+    throw Napi::TypeError::New(info.Env(),
+                               "Expected a shared volume cache handle");
+  }
+  return handle;
+}
+
+SharedCacheHandle *UnwrapOpenHandle(const Napi::CallbackInfo &info) {
+  auto *handle = UnwrapHandle(info);
+  if (handle->base == nullptr) {
+    throw Napi::Error::New(info.Env(), "Shared volume cache is closed");
+  }
+  return handle;
+}
+
+// Both clocks are vDSO calls on Linux: no syscall.
+uint64_t NowMs(clockid_t clock) {
+  timespec ts{};
+  clock_gettime(clock, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000 +
+         static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+}
+
+uint64_t SelfPid() { return static_cast<uint64_t>(getpid()); }
+
+bool IsAlive(uint64_t pid) {
+  return pid != 0 &&
+         (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+}
+
+// "/fs-metadata-<name>", for a name of letters, digits, '.', '_' and '-'.
+std::string ShmName(const Napi::Env &env, const Napi::Value &value) {
+  if (!value.IsString()) {
+    throw Napi::TypeError::New(env, "name must be a string");
+  }
+  const std::string name = value.As<Napi::String>().Utf8Value();
+  bool valid = !name.empty() && name.size() <= kMaxNameLength &&
+               name != "." && name != "..";
+  for (const char c : name) {
+    valid = valid && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                      (c >= '0' && c <= '9') || c == '.' || c == '_' ||
+                      c == '-');
+  }
+  if (!valid) {
+    throw Napi::TypeError::New(
+        env, "name must be 1 to 200 letters, digits, '.', '_' or '-'");
+  }
+  return "/fs-metadata-" + name;
+}
+
+// Opens, or creates and sizes, the segment. Returns the fd, and the
+// segment's size in `size`.
+int OpenSegment(const std::string &shmName, uint64_t sizeBytes,
+                uint64_t &size) {
+  // O_EXCL decides which process sizes a new segment.
+  int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd >= 0) {
+    FdGuard guard(fd);
+    // Returns the error rather than setting errno.
+    const int error = posix_fallocate(fd, 0, static_cast<off_t>(sizeBytes));
+    if (error != 0) {
+      shm_unlink(shmName.c_str());
+      throw FSException(
+          CreatePathErrorMessage("posix_fallocate", shmName, error));
+    }
+    size = sizeBytes;
+    return guard.release();
+  }
+  if (errno != EEXIST) {
+    throw FSException(CreatePathErrorMessage("shm_open", shmName, errno));
+  }
+  fd = shm_open(shmName.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    throw FSException(CreatePathErrorMessage("shm_open", shmName, errno));
+  }
+  FdGuard guard(fd);
+  const auto deadline = std::chrono::steady_clock::now() + kCreateWait;
+  for (;;) {
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+      throw FSException(CreatePathErrorMessage("fstat", shmName, errno));
+    }
+    if (st.st_uid != geteuid() || (st.st_mode & 077) != 0) {
+      throw FSException("Shared volume cache " + shmName +
+                        " is not private to this user; refusing to use it");
+    }
+    if (st.st_size > 0) {
+      size = static_cast<uint64_t>(st.st_size);
+      break;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      throw FSException("Shared volume cache " + shmName +
+                        " was never sized; unlink it and retry");
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (size <= kHeaderBytes || size > kMaxSegmentBytes) {
+    throw FSException("Shared volume cache " + shmName +
+                      " has an invalid size");
+  }
+  return guard.release();
+}
+
+} // namespace
+
+Napi::Value OpenSharedVolumeCache(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "Expected an options object");
+  }
+  auto options = info[0].As<Napi::Object>();
+  const std::string shmName = ShmName(env, options.Get("name"));
+  const Napi::Value sizeValue = options.Get("sizeBytes");
+  const double sizeBytes =
+      sizeValue.IsNumber() ? sizeValue.As<Napi::Number>().DoubleValue() : 0;
+  if (!(sizeBytes > static_cast<double>(kHeaderBytes) &&
+        sizeBytes <= static_cast<double>(kMaxSegmentBytes))) {
+    throw Napi::RangeError::New(env, "sizeBytes is out of range");
+  }
+
+  auto handle = std::make_unique<SharedCacheHandle>();
+  handle->shmName = shmName;
+  try {
+    uint64_t size = 0;
+    FdGuard fd(OpenSegment(shmName, static_cast<uint64_t>(sizeBytes), size));
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd.get(), 0);
+    if (base == MAP_FAILED) {
+      throw FSException(CreatePathErrorMessage("mmap", shmName, errno));
+    }
+    handle->base = base;
+    handle->size = static_cast<size_t>(size);
+  } catch (const FSException &e) {
+    throw Napi::Error::New(env, e.what());
+  }
+
+  // A new segment is all zeroes, which is already a valid empty cache.
+  uint64_t magic = 0;
+  if (!handle->Header().magic.compare_exchange_strong(magic, kSegmentMagic) &&
+      magic != kSegmentMagic) {
+    throw Napi::Error::New(env, "Shared volume cache " + shmName +
+                                    " has an incompatible layout");
+  }
+  DEBUG_LOG("[SharedVolumeCache] opened %s (%zu bytes)", shmName.c_str(),
+            handle->size);
+  return Napi::External<SharedCacheHandle>::New(
+      env, handle.release(),
+      [](Napi::Env /*env*/, SharedCacheHandle *h) { delete h; });
+}
+
+Napi::Value ReadSharedVolumeCache(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  auto *handle = UnwrapOpenHandle(info);
+  SegmentHeader &header = handle->Header();
+
+  for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+    const uint64_t begin = header.seq.load(std::memory_order_acquire);
+    if (begin == 0) {
+      return env.Null(); // never published
+    }
+    if (begin % 2 != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    const uint64_t length = header.length.load(std::memory_order_relaxed);
+    if (length > handle->Capacity()) {
+      continue; // torn
+    }
+    handle->scratch.resize(length);
+    memcpy(handle->scratch.data(), handle->Payload(), length);
+    const uint64_t publishedMonotonicMs =
+        header.publishedMonotonicMs.load(std::memory_order_relaxed);
+    const uint64_t publishedAtMs =
+        header.publishedAtMs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header.seq.load(std::memory_order_relaxed) != begin) {
+      continue;
+    }
+
+    const uint64_t now = NowMs(CLOCK_MONOTONIC);
+    auto result = Napi::Object::New(env);
+    result.Set("volumes", DecodeVolumeSnapshotBytes(
+                              env, handle->scratch.data(), length));
+    result.Set("generation",
+               Napi::Number::New(env, static_cast<double>(begin / 2)));
+    result.Set("publishedAt",
+               Napi::Number::New(env, static_cast<double>(publishedAtMs)));
+    result.Set("ageMs",
+               Napi::Number::New(env, static_cast<double>(
+                                          now > publishedMonotonicMs
+                                              ? now - publishedMonotonicMs
+                                              : 0)));
+    return result;
+  }
+  DEBUG_LOG("[SharedVolumeCache] no stable read of %s",
+            handle->shmName.c_str());
+  return env.Null();
+}
+
+Napi::Value TryAcquireSharedVolumeCacheLease(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  auto *handle = UnwrapOpenHandle(info);
+  if (info.Length() < 2 || !info[1].IsNumber() ||
+      !(info[1].As<Napi::Number>().DoubleValue() >= 1)) {
+    throw Napi::TypeError::New(env, "leaseMs must be a positive number");
+  }
+  const auto leaseMs =
+      static_cast<uint64_t>(info[1].As<Napi::Number>().DoubleValue());
+  std::atomic<uint64_t> &lease = handle->Header().lease;
+  const uint64_t pid = SelfPid();
+  const uint64_t now = NowMs(CLOCK_MONOTONIC);
+
+  uint64_t current = lease.load(std::memory_order_acquire);
+  const uint64_t holder = current & kLeasePidMask;
+  // Never renewed: a live lease is busy even to its own process. Free once
+  // expired, or once its holder has died.
+  const bool available = current == 0 ||
+                         (current >> kLeasePidBits) <= now ||
+                         (holder != pid && !IsAlive(holder));
+  const uint64_t word = ((now + leaseMs) << kLeasePidBits) | pid;
+  const bool acquired =
+      available &&
+      lease.compare_exchange_strong(current, word, std::memory_order_acq_rel);
+  if (acquired) {
+    handle->leaseWord = word;
+    if (current != 0) {
+      DEBUG_LOG("[SharedVolumeCache] %s lease taken from pid %llu",
+                handle->shmName.c_str(),
+                static_cast<unsigned long long>(holder));
+    }
+  }
+  return Napi::Boolean::New(env, acquired);
+}
+
+Napi::Value ReleaseSharedVolumeCacheLease(const Napi::CallbackInfo &info) {
+  UnwrapOpenHandle(info)->ReleaseLease();
+  return info.Env().Undefined();
+}
+
+Napi::Value PublishSharedVolumeCache(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  auto *handle = UnwrapOpenHandle(info);
+  if (info.Length() < 2 || !info[1].IsTypedArray() ||
+      info[1].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+    throw Napi::TypeError::New(env, "Uint8Array or Buffer expected");
+  }
+  auto bytes = info[1].As<Napi::Uint8Array>();
+  if (bytes.ByteLength() > handle->Capacity()) {
+    throw Napi::RangeError::New(
+        env, "Snapshot of " + std::to_string(bytes.ByteLength()) +
+                 " bytes doesn't fit in " + handle->shmName + " (" +
+                 std::to_string(handle->Capacity()) + " bytes)");
+  }
+
+  SegmentHeader &header = handle->Header();
+  const uint64_t pid = SelfPid();
+  if (handle->leaseWord == 0 ||
+      header.lease.load(std::memory_order_acquire) != handle->leaseWord) {
+    return Napi::Boolean::New(env, false);
+  }
+  // A live writer may be another handle in this process, or a publish that
+  // outlived its lease: either way, its copy isn't done.
+  uint64_t writer = header.writer.load(std::memory_order_acquire);
+  if (writer != 0 && IsAlive(writer)) {
+    return Napi::Boolean::New(env, false);
+  }
+  if (!header.writer.compare_exchange_strong(writer, pid,
+                                             std::memory_order_acq_rel)) {
+    return Napi::Boolean::New(env, false);
+  }
+  // The lease may have lapsed, and been claimed, since it was checked.
+  if (header.lease.load(std::memory_order_acquire) != handle->leaseWord) {
+    header.writer.store(0, std::memory_order_release);
+    return Napi::Boolean::New(env, false);
+  }
+  // Odd only if the last writer died mid-copy.
+  const uint64_t seq = header.seq.load(std::memory_order_relaxed);
+  const uint64_t begin = seq % 2 == 0 ? seq + 1 : seq + 2;
+  header.seq.store(begin, std::memory_order_relaxed);
+  // Nothing below may become visible before `seq` turns odd.
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(handle->Payload(), bytes.Data(), bytes.ByteLength());
+  header.length.store(bytes.ByteLength(), std::memory_order_relaxed);
+  header.publishedMonotonicMs.store(NowMs(CLOCK_MONOTONIC),
+                                    std::memory_order_relaxed);
+  header.publishedAtMs.store(NowMs(CLOCK_REALTIME),
+                             std::memory_order_relaxed);
+  header.seq.store(begin + 1, std::memory_order_release);
+  header.writer.store(0, std::memory_order_release);
+  DEBUG_LOG("[SharedVolumeCache] published %zu bytes to %s",
+            bytes.ByteLength(), handle->shmName.c_str());
+  return Napi::Boolean::New(env, true);
+}
+
+Napi::Value CloseSharedVolumeCache(const Napi::CallbackInfo &info) {
+  auto *handle = UnwrapHandle(info);
+  if (handle->base != nullptr) {
+    DEBUG_LOG("[SharedVolumeCache] closing %s", handle->shmName.c_str());
+    handle->Unmap();
+  }
+  return info.Env().Undefined();
+}
+
+Napi::Value UnlinkSharedVolumeCache(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  const std::string shmName =
+      ShmName(env, info.Length() < 1 ? env.Undefined() : info[0]);
+  if (shm_unlink(shmName.c_str()) == 0) {
+    return Napi::Boolean::New(env, true);
+  }
+  if (errno == ENOENT) {
+    return Napi::Boolean::New(env, false);
+  }
+  throw Napi::Error::New(
+      env, CreatePathErrorMessage("shm_unlink", shmName, errno));
+}
+
+} // namespace FSMeta
@@ -0,0 +1,356 @@
+// src/linux/shared_volume_cache.test.ts
+//
+// The lease and freshness policy, against an in-memory stand-in for the
+// shared segment (each test's `other` is a second process contending for the
+// same segment), then the native segment itself.
+
+import { chmod, mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { delay } from "../async";
+import { nativeFn } from "../native_loader";
+import { randomLetters } from "../random";
+import { describePlatform } from "../test-utils/platform";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindings,
+  NativeSharedVolumeCacheHandle,
+} from "../types/native_bindings";
+import type { SharedVolumeCacheEntry } from "../types/shared_volume_cache_entry";
+import type { VolumeMetadata } from "../types/volume_metadata";
+import { encodeVolumeSnapshot, readVolumeSnapshot } from "../volume_snapshot";
+import {
+  createSharedVolumeCacheImpl,
+  type SharedVolumeCacheOptions,
+} from "./shared_volume_cache";
+
+describePlatform("linux")("createSharedVolumeCache (Linux)", () => {
+  let dir: string;
+  let mtabPath: string;
+  let probed: string[];
+  // The segment: what was last published, and who holds the lease.
+  let entry: SharedVolumeCacheEntry | null;
+  let leaseHolder: string | undefined;
+  let publishes: number;
+
+  const mockNativeFn = (self: string) => () =>
+    ({
+      getVolumeMetadata: async (o: GetVolumeMetadataOptions) => {
+        probed.push(o.mountPoint);
+        return { size: 100, used: 50, available: 50, uuid: "1234" };
+      },
+      openSharedVolumeCache: () => ({}),
+      readSharedVolumeCache: () => entry,
+      tryAcquireSharedVolumeCacheLease: () => {
+        // Never renewed, as natively:
+        if (leaseHolder != null) return false;
+        leaseHolder = self;
+        return true;
+      },
+      releaseSharedVolumeCacheLease: () => {
+        if (leaseHolder === self) leaseHolder = undefined;
+      },
+      publishSharedVolumeCache: (_handle: unknown, bytes: Uint8Array) => {
+        if (leaseHolder !== self) return false;
+        publishes++;
+        entry = {
+          volumes: [...readVolumeSnapshot(bytes)],
+          generation: publishes,
+          publishedAt: Date.now(),
+          ageMs: 0,
+        };
+        return true;
+      },
+      closeSharedVolumeCache: () => {
+        if (leaseHolder === self) leaseHolder = undefined;
+      },
+    }) as unknown as NativeBindings;
+
+  function create(
+    opts: Partial<SharedVolumeCacheOptions> = {},
+    self = "self",
+  ) {
+    return createSharedVolumeCacheImpl(
+      {
+        name: "test",
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: true,
+        ...opts,
+      },
+      mockNativeFn(self),
+    );
+  }
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-shared-cache-"));
+    mtabPath = join(dir, "mtab");
+    await writeFile(mtabPath, `/dev/sdz1 ${dir} ext4 rw,relatime 0 0\n`);
+  });
+
+  beforeEach(() => {
+    probed = [];
+    entry = null;
+    leaseHolder = undefined;
+    publishes = 0;
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  it("probes and publishes when nothing is cached", async () => {
+    const cache = await create();
+    const volumes = await cache.getAllVolumeMetadata();
+    expect(probed).toEqual([dir]);
+    expect(volumes.map((ea) => ea.mountPoint)).toEqual([dir]);
+    expect(publishes).toBe(1);
+    expect(cache.read()?.volumes[0]).toMatchObject({
+      mountPoint: dir,
+      size: 100,
+      uuid: "1234",
+    });
+    // The lease is given up as soon as the result is published:
+    expect(leaseHolder).toBeUndefined();
+    cache.close();
+  });
+
+  it("returns a fresh result without probing", async () => {
+    const cache = await create();
+    await cache.getAllVolumeMetadata();
+    probed = [];
+    const other = await create({}, "other");
+    expect((await other.getAllVolumeMetadata())[0]?.mountPoint).toBe(dir);
+    expect(probed).toEqual([]);
+    expect(publishes).toBe(1);
+    cache.close();
+    other.close();
+  });
+
+  it("refreshes a stale result under the lease", async () => {
+    const cache = await create({ maxAgeMs: 1000 });
+    await cache.getAllVolumeMetadata();
+    if (entry != null) entry.ageMs = 1001;
+    probed = [];
+    await cache.getAllVolumeMetadata();
+    expect(probed).toEqual([dir]);
+    expect(publishes).toBe(2);
+    cache.close();
+  });
+
+  it("shares one refresh between concurrent callers", async () => {
+    const cache = await create();
+    const sibling = await create();
+    const results = await Promise.all([
+      cache.getAllVolumeMetadata(),
+      cache.getAllVolumeMetadata(),
+      sibling.getAllVolumeMetadata(),
+    ]);
+    expect(probed).toEqual([dir]);
+    expect(publishes).toBe(1);
+    expect(results[1]).toBe(results[0]);
+    expect(results[2]).toBe(results[0]);
+    expect(leaseHolder).toBeUndefined();
+    cache.close();
+    sibling.close();
+  });
+
+  it("serves a stale result while another process refreshes", async () => {
+    const cache = await create({ maxAgeMs: 1000 });
+    await cache.getAllVolumeMetadata();
+    if (entry != null) entry.ageMs = 5000;
+    leaseHolder = "other";
+    probed = [];
+    expect((await cache.getAllVolumeMetadata())[0]?.mountPoint).toBe(dir);
+    expect(probed).toEqual([]);
+    expect(publishes).toBe(1);
+    cache.close();
+  });
+
+  it("waits for another process's first publish", async () => {
+    const cache = await create();
+    const other = await create({}, "other");
+    leaseHolder = "other";
+    const pending = cache.getAllVolumeMetadata();
+    await delay(60);
+    expect(publishes).toBe(0);
+    // The other process finishes its refresh:
+    leaseHolder = undefined;
+    await other.getAllVolumeMetadata();
+    probed = [];
+    expect((await pending)[0]?.mountPoint).toBe(dir);
+    expect(probed).toEqual([]);
+    expect(publishes).toBe(1);
+    cache.close();
+    other.close();
+  });
+
+  it("releases the lease on close()", async () => {
+    const cache = await create();
+    leaseHolder = "self";
+    cache.close();
+    cache.close();
+    expect(leaseHolder).toBeUndefined();
+    expect(() => cache.read()).toThrow(/closed/);
+    await expect(cache.getAllVolumeMetadata()).rejects.toThrow(/closed/);
+  });
+
+  it("rejects invalid options", async () => {
+    await expect(create({ name: "" })).rejects.toThrow(TypeError);
+    await expect(create({ name: "../etc" })).rejects.toThrow(TypeError);
+    await expect(create({ name: ".." })).rejects.toThrow(TypeError);
+    await expect(create({ sizeBytes: 10 })).rejects.toThrow(/sizeBytes/);
+    await expect(create({ leaseMs: 0 })).rejects.toThrow(/leaseMs/);
+    await expect(create({ leaseMs: 2 ** 42 })).rejects.toThrow(/leaseMs/);
+    await expect(create({ maxAgeMs: 1.5 })).rejects.toThrow(/maxAgeMs/);
+  });
+});
+
+// The real segment: two handles in this process contend exactly as two
+// processes would, since the lease belongs to the handle that claimed it.
+describePlatform("linux")("shared volume cache segment (native)", () => {
+  let native: NativeBindings;
+  let name: string;
+  const handles: NativeSharedVolumeCacheHandle[] = [];
+
+  const volumes = [
+    { mountPoint: "/", fstype: "ext4", size: 100, used: 40, available: 60 },
+    { mountPoint: "/mnt/nfs", remote: true, error: new Error("EIO") },
+  ] as VolumeMetadata[];
+
+  function open(sizeBytes = 64 * 1024) {
+    const handle = required(native.openSharedVolumeCache)({ name, sizeBytes });
+    handles.push(handle);
+    return handle;
+  }
+
+  function required<T>(fn: T | undefined): T {
+    if (fn == null) throw new Error("missing native binding");
+    return fn;
+  }
+
+  beforeAll(async () => {
+    native = await nativeFn();
+  });
+
+  beforeEach(() => {
+    name = `test-${process.pid}-${randomLetters(8)}`;
+  });
+
+  afterEach(() => {
+    for (const ea of handles.splice(0)) native.closeSharedVolumeCache?.(ea);
+    native.unlinkSharedVolumeCache?.(name);
+  });
+
+  it("round-trips a publish to another handle", () => {
+    const writer = open();
+    const reader = open();
+    expect(native.readSharedVolumeCache?.(reader)).toBeNull();
+    expect(native.tryAcquireSharedVolumeCacheLease?.(writer, 10_000)).toBe(
+      true,
+    );
+    expect(
+      native.publishSharedVolumeCache?.(writer, encodeVolumeSnapshot(volumes)),
+    ).toBe(true);
+    const entry = native.readSharedVolumeCache?.(reader);
+    expect(entry?.generation).toBe(1);
+    expect(entry?.ageMs).toBeGreaterThanOrEqual(0);
+    expect(entry?.ageMs).toBeLessThan(10_000);
+    expect(Math.abs((entry?.publishedAt ?? 0) - Date.now())).toBeLessThan(
+      10_000,
+    );
+    expect(entry?.volumes[0]).toEqual(volumes[0]);
+    expect(entry?.volumes[1]).toMatchObject({ mountPoint: "/mnt/nfs" });
+    expect((entry?.volumes[1]?.error as Error).message).toBe("EIO");
+  });
+
+  it("gives the lease to one handle at a time", () => {
+    const a = open();
+    const b = open();
+    const bytes = encodeVolumeSnapshot(volumes);
+    expect(native.tryAcquireSharedVolumeCacheLease?.(a, 10_000)).toBe(true);
+    // Never renewed, even by its holder:
+    expect(native.tryAcquireSharedVolumeCacheLease?.(a, 10_000)).toBe(false);
+    expect(native.tryAcquireSharedVolumeCacheLease?.(b, 10_000)).toBe(false);
+    // Only the holder may publish or release:
+    expect(native.publishSharedVolumeCache?.(b, bytes)).toBe(false);
+    native.releaseSharedVolumeCacheLease?.(b);
+    expect(native.tryAcquireSharedVolumeCacheLease?.(b, 10_000)).toBe(false);
+    native.releaseSharedVolumeCacheLease?.(a);
+    expect(native.publishSharedVolumeCache?.(a, bytes)).toBe(false);
+    expect(native.tryAcquireSharedVolumeCacheLease?.(b, 10_000)).toBe(true);
+    expect(native.publishSharedVolumeCache?.(b, bytes)).toBe(true);
+  });
+
+  it("frees an expired lease", async () => {
+    const a = open();
+    const b = open();
+    expect(native.tryAcquireSharedVolumeCacheLease?.(a, 1)).toBe(true);
+    await delay(20);
+    expect(native.tryAcquireSharedVolumeCacheLease?.(b, 10_000)).toBe(true);
+    // a's lease was taken over: it may no longer publish.
+    expect(
+      native.publishSharedVolumeCache?.(a, encodeVolumeSnapshot(volumes)),
+    ).toBe(false);
+  });
+
+  it("rejects a snapshot that doesn't fit", () => {
+    const handle = open(4096);
+    expect(native.tryAcquireSharedVolumeCacheLease?.(handle, 10_000)).toBe(
+      true,
+    );
+    const big = Array.from({ length: 200 }, (_, i) => ({
+      mountPoint: `/mnt/volume-${i}-${randomLetters(16)}`,
+    }));
+    expect(() =>
+      native.publishSharedVolumeCache?.(handle, encodeVolumeSnapshot(big)),
+    ).toThrow(RangeError);
+  });
+
+  it("keeps the creator's size", () => {
+    open(8192);
+    const bytes = encodeVolumeSnapshot(
+      Array.from({ length: 400 }, (_, i) => ({
+        mountPoint: `/mnt/volume-${i}-${randomLetters(16)}`,
+      })),
+    );
+    const later = open(1024 * 1024);
+    expect(native.tryAcquireSharedVolumeCacheLease?.(later, 10_000)).toBe(
+      true,
+    );
+    expect(() => native.publishSharedVolumeCache?.(later, bytes)).toThrow(
+      RangeError,
+    );
+  });
+
+  it("refuses a segment others can write", async () => {
+    await writeFile(`/dev/shm/fs-metadata-${name}`, Buffer.alloc(8192), {
+      mode: 0o666,
+    });
+    await chmod(`/dev/shm/fs-metadata-${name}`, 0o666);
+    expect(() => open()).toThrow(/not private/);
+  });
+
+  it("validates names and sizes", () => {
+    for (const bad of ["", "..", "a/b", "x".repeat(201)]) {
+      expect(() =>
+        native.openSharedVolumeCache?.({ name: bad, sizeBytes: 8192 }),
+      ).toThrow(TypeError);
+    }
+    expect(() =>
+      native.openSharedVolumeCache?.({ name, sizeBytes: 16 }),
+    ).toThrow(RangeError);
+  });
+
+  it("unlinks a segment", () => {
+    native.closeSharedVolumeCache?.(open());
+    expect(native.unlinkSharedVolumeCache?.(name)).toBe(true);
+    expect(native.unlinkSharedVolumeCache?.(name)).toBe(false);
+  });
+
+  it("throws after close", () => {
+    const handle = open();
+    native.closeSharedVolumeCache?.(handle);
+    native.closeSharedVolumeCache?.(handle);
+    expect(() => native.readSharedVolumeCache?.(handle)).toThrow(/closed/);
+  });
+});
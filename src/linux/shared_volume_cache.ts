@@ -0,0 +1,310 @@
+// src/linux/shared_volume_cache.ts
+
+import { delay } from "../async";
+import { debug } from "../debuglog";
+import { optionsWithDefaults } from "../options";
+import { isLinux } from "../platform";
+import type {
+  NativeBindings,
+  NativeBindingsFn,
+  NativeSharedVolumeCacheHandle,
+} from "../types/native_bindings";
+import type { Options } from "../types/options";
+import type { SharedVolumeCacheEntry } from "../types/shared_volume_cache_entry";
+import type { VolumeMetadata } from "../types/volume_metadata";
+import { DayMs, KiB, MiB, MinuteMs, SecondMs } from "../units";
+import { getAllVolumeMetadataImpl } from "../volume_metadata";
+import { encodeVolumeSnapshot } from "../volume_snapshot";
+
+/**
+ * Settings specific to {@link createSharedVolumeCache}.
+ */
+export interface SharedVolumeCacheOptions {
+  /**
+   * Names the segment, `/dev/shm/fs-metadata-<name>`: processes share
+   * results only if they use the same name. 1 to 200 letters, digits, `.`,
+   * `_` or `-`. Required.
+   */
+  name: string;
+
+  /**
+   * Size of the segment, if this process creates it. Snapshots that don't
+   * fit aren't shared, so every process falls back to probing for itself.
+   * A segment that already exists keeps its size.
+   *
+   * @see {@link SharedVolumeCacheSizeBytesDefault}
+   */
+  sizeBytes?: number;
+
+  /**
+   * Results published less than this long ago are returned without probing
+   * anything.
+   *
+   * @see {@link SharedVolumeCacheMaxAgeMsDefault}
+   */
+  maxAgeMs?: number;
+
+  /**
+   * How long a refreshing process holds the lease. If it dies or hangs,
+   * another process takes over after this long (or at once, if it died).
+   * Should comfortably exceed one {@link getAllVolumeMetadata} call. At most
+   * one day.
+   *
+   * @see {@link SharedVolumeCacheLeaseMsDefault}
+   */
+  leaseMs?: number;
+}
+
+/**
+ * Default value for {@link SharedVolumeCacheOptions.sizeBytes}: room for
+ * thousands of volumes. The segment is allocated in full when it's created,
+ * so a full `/dev/shm` fails then rather than on a later publish.
+ */
+export const SharedVolumeCacheSizeBytesDefault = 4 * MiB;
+
+/**
+ * Default value for {@link SharedVolumeCacheOptions.maxAgeMs}.
+ */
+export const SharedVolumeCacheMaxAgeMsDefault = 30 * SecondMs;
+
+/**
+ * Default value for {@link SharedVolumeCacheOptions.leaseMs}.
+ */
+export const SharedVolumeCacheLeaseMsDefault = 2 * MinuteMs;
+
+/**
+ * A host-wide cache of {@link getAllVolumeMetadata}. See
+ * {@link createSharedVolumeCache}.
+ */
+export interface SharedVolumeCache {
+  readonly name: string;
+
+  /**
+   * The latest published result, however old, or undefined if nothing has
+   * been published yet. Synchronous: copies the snapshot out of shared
+   * memory without locks or syscalls, and decodes it.
+   *
+   * @throws if the cache is closed
+   */
+  read(): SharedVolumeCacheEntry | undefined;
+
+  /**
+   * The published result if it's younger than `maxAgeMs`. Otherwise, one
+   * process (whichever takes the lease) runs {@link getAllVolumeMetadata}
+   * and publishes the result, while the others return the stale result, or,
+   * if nothing has been published yet, wait for the first. Concurrent calls
+   * in the refreshing process share its one refresh.
+   *
+   * @throws if the cache is closed
+   */
+  getAllVolumeMetadata(): Promise<VolumeMetadata[]>;
+
+  /**
+   * Release the lease, if held, and unmap the segment. The segment itself
+   * persists until {@link unlinkSharedVolumeCache}. Idempotent.
+   */
+  close(): void;
+}
+
+// Letters, digits, ".", "_" and "-", as the native side also checks.
+const NamePattern = /^[\w.-]{1,200}$/;
+
+// How often a process with nothing to return checks for the first publish.
+const FirstPublishPollMs = 25;
+
+// Refreshes in flight in this thread, by name. Concurrent callers, and other
+// caches open on the same name, share one rather than each taking the lease.
+const refreshes = new Map<string, Promise<VolumeMetadata[]>>();
+
+const MinSizeBytes = 4 * KiB;
+const MaxSizeBytes = 1024 * MiB;
+
+type SharedCacheBindings = Required<
+  Pick<
+    NativeBindings,
+    | "openSharedVolumeCache"
+    | "readSharedVolumeCache"
+    | "tryAcquireSharedVolumeCacheLease"
+    | "releaseSharedVolumeCacheLease"
+    | "publishSharedVolumeCache"
+    | "closeSharedVolumeCache"
+  >
+>;
+
+function validateName(name: unknown, desc: string): string {
+  if (
+    typeof name !== "string" ||
+    !NamePattern.test(name) ||
+    name === "." ||
+    name === ".."
+  ) {
+    throw new TypeError(`${desc}: invalid name: ${JSON.stringify(name)}`);
+  }
+  return name;
+}
+
+function validateNumber(
+  desc: string,
+  key: string,
+  value: number | undefined,
+  fallback: number,
+  min: number,
+  max = Number.MAX_SAFE_INTEGER,
+): number {
+  const n = value ?? fallback;
+  if (!Number.isInteger(n) || n < min || n > max) {
+    throw new TypeError(
+      `${desc}: ${key} must be an integer from ${min} to ${max}, but got ` +
+        JSON.stringify(value),
+    );
+  }
+  return n;
+}
+
+async function sharedCacheBindings(
+  nativeFn: NativeBindingsFn,
+  desc: string,
+): Promise<SharedCacheBindings> {
+  const native = await nativeFn();
+  if (
+    native.openSharedVolumeCache == null ||
+    native.readSharedVolumeCache == null ||
+    native.tryAcquireSharedVolumeCacheLease == null ||
+    native.releaseSharedVolumeCacheLease == null ||
+    native.publishSharedVolumeCache == null ||
+    native.closeSharedVolumeCache == null
+  ) {
+    throw new Error(`${desc} is not available in these native bindings`);
+  }
+  return native as SharedCacheBindings;
+}
+
+export async function createSharedVolumeCacheImpl(
+  opts: SharedVolumeCacheOptions &
+    Partial<Options> & { includeSystemVolumes?: boolean },
+  nativeFn: NativeBindingsFn,
+): Promise<SharedVolumeCache> {
+  const desc = "createSharedVolumeCache()";
+  if (!isLinux) {
+    throw new Error(`${desc} is only supported on Linux`);
+  }
+  const name = validateName(opts.name, desc);
+  const sizeBytes = validateNumber(
+    desc,
+    "sizeBytes",
+    opts.sizeBytes,
+    SharedVolumeCacheSizeBytesDefault,
+    MinSizeBytes,
+    MaxSizeBytes,
+  );
+  const maxAgeMs = validateNumber(
+    desc,
+    "maxAgeMs",
+    opts.maxAgeMs,
+    SharedVolumeCacheMaxAgeMsDefault,
+    0,
+  );
+  const leaseMs = validateNumber(
+    desc,
+    "leaseMs",
+    opts.leaseMs,
+    SharedVolumeCacheLeaseMsDefault,
+    1,
+    DayMs,
+  );
+  const o = optionsWithDefaults(opts);
+  const native = await sharedCacheBindings(nativeFn, desc);
+  const handle: NativeSharedVolumeCacheHandle = native.openSharedVolumeCache({
+    name,
+    sizeBytes,
+  });
+  let closed = false;
+
+  function assertOpen(method: string) {
+    if (closed) {
+      throw new Error(`SharedVolumeCache.${method}: ${name} is closed`);
+    }
+  }
+
+  // Called with the lease held; always gives it up.
+  async function refresh(): Promise<VolumeMetadata[]> {
+    try {
+      const volumes = await getAllVolumeMetadataImpl(o, nativeFn);
+      if (!closed) {
+        try {
+          const published = native.publishSharedVolumeCache(
+            handle,
+            encodeVolumeSnapshot(volumes),
+          );
+          debug(
+            "[SharedVolumeCache] %s: %s %d volumes",
+            name,
+            published ? "published" : "lost the lease before publishing",
+            volumes.length,
+          );
+        } catch (error) {
+          // Too big for the segment: still this caller's result.
+          debug("[SharedVolumeCache] %s: publish failed: %s", name, error);
+        }
+      }
+      return volumes;
+    } finally {
+      if (!closed) native.releaseSharedVolumeCacheLease(handle);
+    }
+  }
+
+  return {
+    name,
+    read() {
+      assertOpen("read()");
+      return native.readSharedVolumeCache(handle) ?? undefined;
+    },
+    async getAllVolumeMetadata() {
+      for (;;) {
+        assertOpen("getAllVolumeMetadata()");
+        const entry = native.readSharedVolumeCache(handle);
+        if (entry != null && entry.ageMs <= maxAgeMs) {
+          return entry.volumes;
+        }
+        const inFlight = refreshes.get(name);
+        if (inFlight != null) {
+          return inFlight;
+        }
+        if (native.tryAcquireSharedVolumeCacheLease(handle, leaseMs)) {
+          const promise = refresh().finally(() => {
+            if (refreshes.get(name) === promise) refreshes.delete(name);
+          });
+          refreshes.set(name, promise);
+          return promise;
+        }
+        // Another process is refreshing: serve what it last published, or
+        // wait for its first publish (or for its lease to lapse).
+        if (entry != null) {
+          return entry.volumes;
+        }
+        await delay(FirstPublishPollMs);
+      }
+    },
+    close() {
+      if (closed) return;
+      closed = true;
+      native.closeSharedVolumeCache(handle);
+    },
+  };
+}
+
+export async function unlinkSharedVolumeCacheImpl(
+  name: string,
+  nativeFn: NativeBindingsFn,
+): Promise<boolean> {
+  const desc = "unlinkSharedVolumeCache()";
+  if (!isLinux) {
+    throw new Error(`${desc} is only supported on Linux`);
+  }
+  validateName(name, desc);
+  const native = await nativeFn();
+  if (native.unlinkSharedVolumeCache == null) {
+    throw new Error(`${desc} is not available in these native bindings`);
+  }
+  return native.unlinkSharedVolumeCache(name);
+}
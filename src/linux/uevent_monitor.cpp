@@ -0,0 +1,468 @@
+// src/linux/uevent_monitor.cpp
+//
+// Kernel block-device uevents over NETLINK_KOBJECT_UEVENT. A monitor owns a
+// netlink socket and a thread that waits on it; each block uevent drops the
+// device's entry from DeviceIdentityCache and BlockTopologyCache and is
+// forwarded to JS through a ThreadSafeFunction. See
+// src/linux/uevent_monitor.ts.
+
+#include "uevent_monitor.h"
+#include "../common/debug_log.h"
+#include "../common/error_utils.h"
+#include "../common/fd_guard.h"
+#include "block_topology.h"
+#include "fs_meta.h"
+#include <atomic>
+#include <cerrno>
+#include <charconv> // for std::from_chars()
+#include <cstring>  // for strnlen()
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <linux/nsfs.h> // for NS_GET_USERNS
+#include <memory>
+#include <poll.h>
+#include <string_view>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h> // for makedev()
+#include <thread>
+#include <vector>
+
+namespace FSMeta {
+
+std::mutex DeviceIdentityCache::mutex_;
+LruCache<dev_t, DeviceIdentity> DeviceIdentityCache::entries_(
+    [](const DeviceIdentity &identity) {
+      return identity.uuid.size() + identity.label.size() +
+             identity.fstype.size();
+    });
+uint64_t DeviceIdentityCache::epoch_ = 0;
+int DeviceIdentityCache::listeners_ = 0;
+
+bool DeviceIdentityCache::Lookup(dev_t dev, DeviceIdentity &out,
+                                 uint64_t &epoch) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch = epoch_;
+  if (listeners_ == 0) {
+    entries_.CountMiss();
+    return false;
+  }
+  return entries_.Get(dev, out);
+}
+
+void DeviceIdentityCache::Store(dev_t dev, uint64_t epoch,
+                                const DeviceIdentity &identity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (listeners_ > 0 && epoch == epoch_) {
+    entries_.Put(dev, identity);
+  }
+}
+
+void DeviceIdentityCache::Invalidate(dev_t dev) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch_++;
+  entries_.Erase(dev);
+}
+
+void DeviceIdentityCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  epoch_++;
+  entries_.Clear();
+}
+
+CacheStats DeviceIdentityCache::Stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.Stats("deviceIdentity");
+}
+
+void DeviceIdentityCache::AddListener() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  listeners_++;
+}
+
+void DeviceIdentityCache::RemoveListener() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Entries are only trustworthy while someone is listening; a later monitor
+  // starts from empty.
+  if (--listeners_ == 0) {
+    epoch_++;
+    entries_.Clear();
+  }
+}
+
+namespace {
+
+const bool kIdentityStatsRegistered =
+    CacheBudget::Register(&DeviceIdentityCache::Stats);
+
+// Guards against type confusion: any External reaching StopUeventMonitor()
+// from JS is cast to this type.
+constexpr uint32_t kUeventMonitorMagic = 0x7565766d; // "uevm"
+
+// The kernel multicast group; group 2 carries udev's re-broadcasts, in
+// libudev's own format.
+constexpr uint32_t kKernelUeventGroup = 1;
+
+// PROC_USER_INIT_INO: the inode of the initial user namespace, fixed since
+// Linux 3.8.
+constexpr ino_t kInitUserNamespaceIno = 0xEFFFFFFD;
+
+// Block devices aren't tagged with a network namespace, and since Linux 4.18
+// the kernel only broadcasts such uevents to network namespaces owned by the
+// initial user namespace. Elsewhere (rootless containers, user-namespace
+// remapping) the socket binds fine but never hears a block event, so silence
+// can't be taken to mean that nothing changed.
+bool ReceivesBlockUevents() {
+  FdGuard net(open("/proc/self/ns/net", O_RDONLY | O_CLOEXEC));
+  if (!net.isValid()) {
+    DEBUG_LOG("[UeventMonitor] open /proc/self/ns/net failed: %s",
+              strerror(errno));
+    return false;
+  }
+  const int owner = ioctl(net.get(), NS_GET_USERNS);
+  if (owner < 0) {
+    const int error = errno;
+    DEBUG_LOG("[UeventMonitor] NS_GET_USERNS failed: %s", strerror(error));
+    // ENOTTY: Linux < 4.9, which also predates the filtering. EPERM: the
+    // owner is outside our user namespace, so it's some other one.
+    return error == ENOTTY;
+  }
+  FdGuard userns(owner);
+  struct stat st{};
+  return fstat(userns.get(), &st) == 0 && st.st_ino == kInitUserNamespaceIno;
+}
+
+// A uevent's environment is capped at 2 KiB (UEVENT_BUFFER_SIZE).
+constexpr size_t kUeventMessageSize = 8192;
+
+// Best effort: a burst (a USB hub with many partitions) can otherwise
+// overflow the default buffer, which costs a full cache flush.
+constexpr int kUeventReceiveBuffer = 1024 * 1024;
+
+struct UeventMessage {
+  std::string action; // add, remove, change, move, ...; or overflow, error
+  std::string devname;
+  std::string devtype; // disk or partition
+  std::string error;
+  unsigned int major = 0;
+  unsigned int minor = 0;
+  uint64_t seqnum = 0;
+  bool diskMediaChange = false;
+  bool diskEjectRequest = false;
+};
+
+template <typename T> bool ParseNumber(std::string_view s, T &out) {
+  auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+  return ec == std::errc() && end == s.data() + s.size();
+}
+
+// Parses "<action>@<devpath>\0KEY=value\0...". Returns false for anything
+// that is not a block device uevent with a device number.
+bool ParseUevent(const char *buf, size_t len, UeventMessage &out) {
+  const size_t header = strnlen(buf, len);
+  if (header == len || memchr(buf, '@', header) == nullptr) {
+    return false;
+  }
+  bool isBlock = false;
+  bool haveMajor = false;
+  bool haveMinor = false;
+  const char *p = buf + header + 1;
+  const char *end = buf + len;
+  while (p < end) {
+    const size_t n = strnlen(p, end - p);
+    const std::string_view entry(p, n);
+    p += n + 1;
+    const size_t eq = entry.find('=');
+    if (eq == std::string_view::npos) {
+      continue;
+    }
+    const std::string_view key = entry.substr(0, eq);
+    const std::string_view value = entry.substr(eq + 1);
+    if (key == "ACTION") {
+      out.action = value;
+    } else if (key == "SUBSYSTEM") {
+      isBlock = value == "block";
+    } else if (key == "DEVNAME") {
+      out.devname = value;
+    } else if (key == "DEVTYPE") {
+      out.devtype = value;
+    } else if (key == "MAJOR") {
+      haveMajor = ParseNumber(value, out.major);
+    } else if (key == "MINOR") {
+      haveMinor = ParseNumber(value, out.minor);
+    } else if (key == "SEQNUM") {
+      ParseNumber(value, out.seqnum);
+    } else if (key == "DISK_MEDIA_CHANGE") {
+      out.diskMediaChange = value == "1";
+    } else if (key == "DISK_EJECT_REQUEST") {
+      out.diskEjectRequest = value == "1";
+    }
+  }
+  return isBlock && haveMajor && haveMinor && !out.action.empty();
+}
+
+void DeliverUevent(Napi::Env env, Napi::Function callback,
+                   UeventMessage *raw) {
+  std::unique_ptr<UeventMessage> msg(raw);
+  // env is null when queued calls are dropped during teardown.
+  if (env == nullptr) {
+    return;
+  }
+  try {
+    auto event = Napi::Object::New(env);
+    event.Set("action", Napi::String::New(env, msg->action));
+    if (!msg->error.empty()) {
+      event.Set("error", Napi::String::New(env, msg->error));
+    }
+    if (!msg->devname.empty()) {
+      event.Set("devname", Napi::String::New(env, msg->devname));
+    }
+    if (!msg->devtype.empty()) {
+      event.Set("devtype", Napi::String::New(env, msg->devtype));
+    }
+    if (msg->action != "overflow" && msg->action != "error") {
+      event.Set("major", Napi::Number::New(env, msg->major));
+      event.Set("minor", Napi::Number::New(env, msg->minor));
+      event.Set("seqnum", Napi::Number::New(env, double(msg->seqnum)));
+    }
+    if (msg->diskMediaChange) {
+      event.Set("diskMediaChange", Napi::Boolean::New(env, true));
+    }
+    if (msg->diskEjectRequest) {
+      event.Set("diskEjectRequest", Napi::Boolean::New(env, true));
+    }
+    callback.Call({event});
+  } catch (const Napi::Error &e) {
+    // A throwing listener surfaces as an uncaught exception, as it would
+    // from any other event source.
+    e.ThrowAsJavaScriptException();
+  }
+}
+
+struct UeventMonitor {
+  FdGuard sock{-1};
+  FdGuard wake{-1};
+  Napi::ThreadSafeFunction tsfn;
+  std::thread thread;
+  std::atomic<bool> stopped{false};
+  // Whether this monitor keeps DeviceIdentityCache and BlockTopologyCache
+  // enabled; see ReceivesBlockUevents().
+  bool feedsCaches = false;
+
+  void AddCacheListeners() {
+    if (feedsCaches) {
+      DeviceIdentityCache::AddListener();
+      BlockTopologyCache::AddListener();
+    }
+  }
+
+  void RemoveCacheListeners() {
+    if (feedsCaches) {
+      DeviceIdentityCache::RemoveListener();
+      BlockTopologyCache::RemoveListener();
+    }
+  }
+
+  void Stop() {
+    if (!stopped.exchange(true)) {
+      const uint64_t one = 1;
+      if (write(wake.get(), &one, sizeof(one)) < 0) {
+        DEBUG_LOG("[UeventMonitor] wake write failed: %s", strerror(errno));
+      }
+    }
+  }
+
+  // Returns false once JS can no longer receive events.
+  bool Post(std::unique_ptr<UeventMessage> msg) {
+    const napi_status status = tsfn.NonBlockingCall(msg.get(), DeliverUevent);
+    if (status != napi_ok) {
+      return false;
+    }
+    msg.release();
+    return true;
+  }
+
+  bool PostError(const char *operation, int error) {
+    auto msg = std::make_unique<UeventMessage>();
+    msg->action = "error";
+    msg->error = CreateDetailedErrorMessage(operation, error);
+    DEBUG_LOG("[UeventMonitor] %s", msg->error.c_str());
+    return Post(std::move(msg));
+  }
+
+  // Drains the socket. Returns false when the monitor should stop.
+  bool Receive(std::vector<char> &buf) {
+    for (;;) {
+      sockaddr_nl from{};
+      socklen_t fromlen = sizeof(from);
+      const ssize_t n =
+          recvfrom(sock.get(), buf.data(), buf.size(), MSG_DONTWAIT,
+                   reinterpret_cast<sockaddr *>(&from), &fromlen);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+          return true;
+        }
+        if (errno == ENOBUFS) {
+          // Events were dropped, so any cached identity may be stale.
+          DEBUG_LOG("[UeventMonitor] receive buffer overflow");
+          DeviceIdentityCache::Clear();
+          BlockTopologyCache::Clear();
+          auto msg = std::make_unique<UeventMessage>();
+          msg->action = "overflow";
+          if (!Post(std::move(msg))) {
+            return false;
+          }
+          continue;
+        }
+        PostError("recvfrom", errno);
+        return false;
+      }
+      // Only the kernel sends from port 0; ignore anything else that
+      // reaches the group.
+      if (from.nl_pid != 0) {
+        continue;
+      }
+      auto msg = std::make_unique<UeventMessage>();
+      if (!ParseUevent(buf.data(), static_cast<size_t>(n), *msg)) {
+        continue;
+      }
+      DEBUG_LOG("[UeventMonitor] %s %u:%u %s", msg->action.c_str(),
+                msg->major, msg->minor, msg->devname.c_str());
+      DeviceIdentityCache::Invalidate(makedev(msg->major, msg->minor));
+      BlockTopologyCache::Invalidate(makedev(msg->major, msg->minor));
+      if (!Post(std::move(msg))) {
+        return false;
+      }
+    }
+  }
+
+  void Run() {
+    std::vector<char> buf(kUeventMessageSize);
+    bool running = true;
+    while (running) {
+      pollfd fds[2] = {{sock.get(), POLLIN, 0}, {wake.get(), POLLIN, 0}};
+      if (poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        PostError("poll", errno);
+        break;
+      }
+      if (fds[1].revents != 0) {
+        break;
+      }
+      if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+        PostError("poll", EIO);
+        break;
+      }
+      running = Receive(buf);
+    }
+    DEBUG_LOG("[UeventMonitor] stopped");
+    RemoveCacheListeners();
+    tsfn.Release();
+  }
+};
+
+struct UeventMonitorHandle {
+  uint32_t magic = kUeventMonitorMagic;
+  std::shared_ptr<UeventMonitor> monitor;
+};
+
+int OpenUeventSocket() {
+  const int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                        NETLINK_KOBJECT_UEVENT);
+  if (fd < 0) {
+    throw FSException(CreateDetailedErrorMessage("socket", errno));
+  }
+  FdGuard guard(fd);
+  const int rcvbuf = kUeventReceiveBuffer;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  sockaddr_nl addr{};
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = kKernelUeventGroup;
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+    throw FSException(CreateDetailedErrorMessage("bind", errno));
+  }
+  return guard.release();
+}
+
+} // namespace
+
+Napi::Value StartUeventMonitor(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsFunction()) {
+    throw Napi::TypeError::New(env, "Expected a callback function");
+  }
+
+  auto monitor = std::make_shared<UeventMonitor>();
+  try {
+    monitor->sock = FdGuard(OpenUeventSocket());
+    const int wake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake < 0) {
+      throw FSException(CreateDetailedErrorMessage("eventfd", errno));
+    }
+    monitor->wake = FdGuard(wake);
+  } catch (const FSException &e) {
+    throw Napi::Error::New(env, e.what());
+  }
+
+  // The finalizer runs once the thread has released the function (or the
+  // env is tearing down), and holds the last reference the thread needs.
+  monitor->tsfn = Napi::ThreadSafeFunction::New(
+      env, info[0].As<Napi::Function>(), "fs-metadata uevent monitor", 0, 1,
+      [monitor](Napi::Env /*env*/) {
+        monitor->Stop();
+        if (monitor->thread.joinable()) {
+          monitor->thread.join();
+        }
+      });
+  // Listening alone must not keep the event loop alive.
+  monitor->tsfn.Unref(env);
+
+  // The socket is already bound, so nothing between here and the thread's
+  // first poll() can be missed. Where block uevents never arrive, the caches
+  // stay off and every lookup reads blkid and sysfs again.
+  monitor->feedsCaches = ReceivesBlockUevents();
+  if (!monitor->feedsCaches) {
+    DEBUG_LOG("[UeventMonitor] block uevents don't reach this network "
+              "namespace; not caching device identity or topology");
+  }
+  monitor->AddCacheListeners();
+  try {
+    monitor->thread = std::thread([raw = monitor.get()] { raw->Run(); });
+  } catch (const std::system_error &e) {
+    monitor->RemoveCacheListeners();
+    monitor->tsfn.Release();
+    throw Napi::Error::New(env, std::string("uevent monitor: ") + e.what());
+  }
+  DEBUG_LOG("[UeventMonitor] started");
+
+  auto *handle = new UeventMonitorHandle();
+  handle->monitor = monitor;
+  return Napi::External<UeventMonitorHandle>::New(
+      env, handle, [](Napi::Env /*env*/, UeventMonitorHandle *h) {
+        // Collected without stopUeventMonitor():
+        h->monitor->Stop();
+        delete h;
+      });
+}
+
+Napi::Value StopUeventMonitor(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsExternal()) {
+    throw Napi::TypeError::New(env, "Expected a uevent monitor handle");
+  }
+  auto *handle = info[0].As<Napi::External<UeventMonitorHandle>>().Data();
+  if (handle == nullptr || handle->magic != kUeventMonitorMagic) {
+    throw Napi::TypeError::New(env, "Expected a uevent monitor handle");
+  }
+  handle->monitor->Stop();
+  return env.Undefined();
+}
+
+} // namespace FSMeta
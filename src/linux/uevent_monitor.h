@@ -0,0 +1,50 @@
+// src/linux/uevent_monitor.h
+
+#pragma once
+#include "../common/cache_budget.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <sys/types.h> // for dev_t
+
+namespace FSMeta {
+
+struct DeviceIdentity {
+  std::string uuid;
+  std::string label;
+  std::string fstype; // only set by getBlockDevices() (block_devices.cpp)
+};
+
+// Process-wide cache of block device number -> libblkid UUID and LABEL (and
+// TYPE, for devices listed by getBlockDevices()).
+//
+// A filesystem's identity only changes when its device does (mkfs, tune2fs,
+// media swap), and the kernel announces each of those with a block uevent.
+// So the cache holds entries indefinitely, but only while at least one
+// UeventMonitor is listening: with no listener, Lookup() always misses and
+// Store() is a no-op. Monitors in a network namespace that block uevents
+// don't reach (rootless containers) don't count as listeners. Each uevent
+// drops its device's entry; a receive-buffer overflow (lost events) drops
+// them all. Entries count against CacheBudget.
+class DeviceIdentityCache {
+public:
+  // Sets `epoch` whether or not it hits; pass it back to Store() so a blkid
+  // read that raced an invalidation is discarded.
+  static bool Lookup(dev_t dev, DeviceIdentity &out, uint64_t &epoch);
+  static void Store(dev_t dev, uint64_t epoch, const DeviceIdentity &identity);
+  static void Invalidate(dev_t dev);
+  static void Clear();
+
+  static void AddListener();
+  static void RemoveListener();
+
+  static CacheStats Stats();
+
+private:
+  static std::mutex mutex_;
+  static LruCache<dev_t, DeviceIdentity> entries_;
+  static uint64_t epoch_;
+  static int listeners_;
+};
+
+} // namespace FSMeta
@@ -0,0 +1,221 @@
+// src/linux/uevent_monitor.test.ts
+
+import { once } from "node:events";
+import { mkdirSync, symlinkSync } from "node:fs";
+import { mkdir, mkdtemp, rm, symlink, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { describePlatform } from "../test-utils/platform";
+import type {
+  NativeBindings,
+  NativeUevent,
+  NativeUeventMonitorHandle,
+} from "../types/native_bindings";
+import type { BlockDeviceEvent, BlockDeviceWatcher } from "./uevent_monitor";
+import { readSysfsBlockInfo, watchBlockDevicesImpl } from "./uevent_monitor";
+
+describePlatform("linux")("watchBlockDevices()", () => {
+  let root: string;
+  let emit: (event: NativeUevent) => void;
+  let stops: number;
+  let watcher: BlockDeviceWatcher | undefined;
+  const handle = {} as NativeUeventMonitorHandle;
+
+  const native = {
+    startUeventMonitor: (cb: (event: NativeUevent) => void) => {
+      emit = cb;
+      return handle;
+    },
+    stopUeventMonitor: (h: NativeUeventMonitorHandle) => {
+      expect(h).toBe(handle);
+      stops++;
+    },
+  } as unknown as NativeBindings;
+
+  async function addDevice(
+    key: string,
+    devicePath: string,
+    attrs: Record<string, string>,
+  ) {
+    const dir = join(root, "devices", devicePath);
+    await mkdir(dir, { recursive: true });
+    for (const [name, value] of Object.entries(attrs)) {
+      await writeFile(join(dir, name), value + "\n");
+    }
+    await symlink(dir, join(root, "dev", "block", key));
+  }
+
+  async function start() {
+    watcher = await watchBlockDevicesImpl({ sysfsRoot: root }, () => native);
+    return watcher;
+  }
+
+  async function next(w: BlockDeviceWatcher, event: NativeUevent) {
+    const seen = once(w, "uevent") as Promise<[BlockDeviceEvent]>;
+    emit(event);
+    return (await seen)[0];
+  }
+
+  beforeEach(async () => {
+    root = await mkdtemp(join(tmpdir(), "fs-metadata-uevent-"));
+    await mkdir(join(root, "dev", "block"), { recursive: true });
+    stops = 0;
+    watcher = undefined;
+    await addDevice("8:0", "sda", { removable: "0", size: "1000" });
+    await addDevice("8:1", "sda/sda1", { size: "900" });
+    await addDevice("8:16", "sdb", { removable: "1", size: "2000" });
+    await addDevice("8:17", "sdb/sdb1", { size: "1900" });
+  });
+
+  afterEach(async () => {
+    watcher?.close();
+    await rm(root, { recursive: true, force: true });
+  });
+
+  it("reads a partition's removable flag from its disk", async () => {
+    expect(await readSysfsBlockInfo("8:17", root)).toEqual({
+      removable: true,
+      sizeSectors: 1900,
+    });
+    expect(await readSysfsBlockInfo("8:1", root)).toEqual({
+      removable: false,
+      sizeSectors: 900,
+    });
+    expect(await readSysfsBlockInfo("9:9", root)).toBeUndefined();
+  });
+
+  it("emits insert when a removable device arrives", async () => {
+    await addDevice("8:32", "sdc", { removable: "1", size: "4000" });
+    const w = await start();
+    const inserts: unknown[] = [];
+    w.on("insert", (ea) => inserts.push(ea));
+
+    const event = await next(w, {
+      action: "add",
+      major: 8,
+      minor: 32,
+      devname: "sdc",
+      devtype: "disk",
+      seqnum: 1,
+    });
+    expect(event).toEqual({
+      action: "add",
+      major: 8,
+      minor: 32,
+      device: "/dev/sdc",
+      devtype: "disk",
+      removable: true,
+    });
+    expect(inserts).toEqual([
+      { major: 8, minor: 32, device: "/dev/sdc", devtype: "disk" },
+    ]);
+  });
+
+  it("emits eject when a removable device that was present at start goes away", async () => {
+    const w = await start();
+    const ejects: unknown[] = [];
+    w.on("eject", (ea) => ejects.push(ea));
+
+    // sysfs is already gone when `remove` arrives:
+    await rm(join(root, "dev", "block", "8:17"));
+    await rm(join(root, "dev", "block", "8:1"));
+    await next(w, { action: "remove", major: 8, minor: 1, devname: "sda1" });
+    const event = await next(w, {
+      action: "remove",
+      major: 8,
+      minor: 17,
+      devname: "sdb1",
+      devtype: "partition",
+    });
+    expect(event.removable).toBe(true);
+    expect(ejects).toEqual([
+      { major: 8, minor: 17, device: "/dev/sdb1", devtype: "partition" },
+    ]);
+  });
+
+  it("starts the monitor before scanning sysfs", async () => {
+    // A device that appears between the two must be seen by one of them:
+    await rm(join(root, "dev", "block"), { recursive: true });
+    const late = {
+      ...native,
+      startUeventMonitor: (cb: (event: NativeUevent) => void) => {
+        mkdirSync(join(root, "dev", "block"));
+        symlinkSync(
+          join(root, "devices", "sdb"),
+          join(root, "dev", "block", "8:16"),
+        );
+        return native.startUeventMonitor?.(cb);
+      },
+    } as NativeBindings;
+    const w = await watchBlockDevicesImpl({ sysfsRoot: root }, () => late);
+    watcher = w;
+    const ejects: unknown[] = [];
+    w.on("eject", (ea) => ejects.push(ea));
+
+    await rm(join(root, "dev", "block", "8:16"));
+    await next(w, { action: "remove", major: 8, minor: 16, devname: "sdb" });
+    expect(ejects).toEqual([{ major: 8, minor: 16, device: "/dev/sdb" }]);
+  });
+
+  it("treats a media change to zero size as an eject", async () => {
+    const w = await start();
+    const kinds: string[] = [];
+    w.on("insert", () => kinds.push("insert"));
+    w.on("eject", () => kinds.push("eject"));
+
+    await writeFile(join(root, "devices", "sdb", "size"), "0\n");
+    await next(w, {
+      action: "change",
+      major: 8,
+      minor: 16,
+      devname: "sdb",
+      diskMediaChange: true,
+    });
+    await writeFile(join(root, "devices", "sdb", "size"), "2000\n");
+    const event = await next(w, {
+      action: "change",
+      major: 8,
+      minor: 16,
+      devname: "sdb",
+      diskMediaChange: true,
+    });
+    // A plain change (say, a relabel) is not a media event:
+    await next(w, { action: "change", major: 8, minor: 16, devname: "sdb" });
+
+    expect(event.diskMediaChange).toBe(true);
+    expect(kinds).toEqual(["eject", "insert"]);
+  });
+
+  it("forwards overflow, and stops on a native error", async () => {
+    const w = await start();
+    const overflow = once(w, "overflow");
+    emit({ action: "overflow" });
+    await overflow;
+
+    const error = once(w, "error") as Promise<[Error]>;
+    emit({ action: "error", error: "recvfrom failed: No buffer space" });
+    const [err] = await error;
+    expect(err.message).toMatch(/recvfrom failed/);
+    expect(stops).toBe(1);
+    w.close();
+    expect(stops).toBe(1);
+  });
+
+  it("close() is idempotent and drops later events", async () => {
+    const w = await start();
+    const events: unknown[] = [];
+    w.on("uevent", (ea) => events.push(ea));
+    w.close();
+    w.close();
+    emit({ action: "add", major: 8, minor: 16, devname: "sdb" });
+    await new Promise((resolve) => setImmediate(resolve));
+    expect(stops).toBe(1);
+    expect(events).toEqual([]);
+  });
+
+  it("fails without native support", async () => {
+    await expect(
+      watchBlockDevicesImpl({ sysfsRoot: root }, () => ({}) as NativeBindings),
+    ).rejects.toThrow(/not available/);
+  });
+});
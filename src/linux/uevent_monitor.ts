@@ -0,0 +1,250 @@
+// src/linux/uevent_monitor.ts
+
+import { EventEmitter } from "node:events";
+import { readdir, readFile, realpath } from "node:fs/promises";
+import { dirname, join } from "node:path";
+import { debug } from "../debuglog";
+import { toError } from "../error";
+import { isLinux } from "../platform";
+import type {
+  NativeBindingsFn,
+  NativeUevent,
+} from "../types/native_bindings";
+
+export interface BlockDeviceWatcherOptions {
+  /**
+   * Where sysfs is mounted. Defaults to "/sys".
+   */
+  sysfsRoot: string;
+}
+
+export const BlockDeviceWatcherDefaults = {
+  sysfsRoot: "/sys",
+} as const;
+
+/**
+ * One kernel uevent for a block device.
+ */
+export interface BlockDeviceEvent {
+  /**
+   * "add", "remove", "change", "move", ...
+   */
+  action: string;
+  major: number;
+  minor: number;
+  /**
+   * e.g. "/dev/sdb1"
+   */
+  device?: string;
+  /**
+   * "disk" or "partition"
+   */
+  devtype?: string;
+  /**
+   * From the device's (or, for a partition, its disk's) sysfs `removable`
+   * attribute, as last read.
+   */
+  removable: boolean;
+  diskMediaChange?: boolean;
+  diskEjectRequest?: boolean;
+}
+
+/**
+ * Emitted when media appears on, or disappears from, a removable device.
+ */
+export type RemovableMediaEvent = Pick<
+  BlockDeviceEvent,
+  "major" | "minor" | "device" | "devtype"
+>;
+
+type BlockDeviceWatcherEvents = {
+  uevent: [BlockDeviceEvent];
+  insert: [RemovableMediaEvent];
+  eject: [RemovableMediaEvent];
+  overflow: [];
+  error: [Error];
+};
+
+/**
+ * See {@link watchBlockDevices}.
+ *
+ * Events:
+ * - `uevent`: every block device {@link BlockDeviceEvent}
+ * - `insert`: a removable device (or its media) arrived
+ * - `eject`: a removable device (or its media) went away
+ * - `overflow`: events were lost; any identity the caller cached is suspect
+ * - `error`: the kernel socket failed and the watcher stopped (only emitted
+ *   if listened to)
+ */
+export interface BlockDeviceWatcher
+  extends EventEmitter<BlockDeviceWatcherEvents> {
+  /**
+   * Stop listening. Idempotent.
+   */
+  close(): void;
+}
+
+interface SysfsBlockInfo {
+  removable: boolean;
+  sizeSectors: number;
+}
+
+export async function readSysfsNumber(
+  path: string,
+): Promise<number | undefined> {
+  try {
+    const n = parseInt((await readFile(path, "utf8")).trim(), 10);
+    return Number.isFinite(n) ? n : undefined;
+  } catch {
+    return;
+  }
+}
+
+/**
+ * Reads `removable` and `size` for the block device `major:minor`. A
+ * partition has no `removable` of its own, so its disk's is used.
+ */
+export async function readSysfsBlockInfo(
+  key: string,
+  sysfsRoot: string,
+): Promise<SysfsBlockInfo | undefined> {
+  let dir: string;
+  try {
+    dir = await realpath(join(sysfsRoot, "dev", "block", key));
+  } catch {
+    return;
+  }
+  const removable =
+    (await readSysfsNumber(join(dir, "removable"))) ??
+    (await readSysfsNumber(join(dirname(dir), "removable")));
+  return {
+    removable: removable === 1,
+    sizeSectors: (await readSysfsNumber(join(dir, "size"))) ?? 0,
+  };
+}
+
+async function seedRemovable(
+  sysfsRoot: string,
+  into: Set<string>,
+): Promise<void> {
+  let keys: string[];
+  try {
+    keys = await readdir(join(sysfsRoot, "dev", "block"));
+  } catch (error) {
+    debug("[watchBlockDevices] cannot list block devices: %s", error);
+    return;
+  }
+  into.clear();
+  await Promise.all(
+    keys.map(async (key) => {
+      if ((await readSysfsBlockInfo(key, sysfsRoot))?.removable) {
+        into.add(key);
+      }
+    }),
+  );
+}
+
+export async function watchBlockDevicesImpl(
+  opts: Partial<BlockDeviceWatcherOptions>,
+  nativeFn: NativeBindingsFn,
+): Promise<BlockDeviceWatcher> {
+  const desc = "watchBlockDevices()";
+  if (!isLinux) {
+    throw new Error(`${desc} is only supported on Linux`);
+  }
+  const o: BlockDeviceWatcherOptions = {
+    ...BlockDeviceWatcherDefaults,
+    ...opts,
+  };
+  const native = await nativeFn();
+  if (native.startUeventMonitor == null || native.stopUeventMonitor == null) {
+    throw new Error(`${desc} is not available in these native bindings`);
+  }
+
+  const emitter = new EventEmitter<BlockDeviceWatcherEvents>();
+  // Devices known to be removable. sysfs is gone by the time `remove`
+  // arrives, so membership is remembered from a sysfs scan and from earlier
+  // events.
+  const removable = new Set<string>();
+  let closed = false;
+  // sysfs reads are async, so events are handled strictly in arrival order,
+  // after the initial scan (which starts once the monitor does, below):
+  let queue: Promise<void> = Promise.resolve();
+
+  async function handle(raw: NativeUevent) {
+    if (raw.action === "overflow") {
+      await seedRemovable(o.sysfsRoot, removable);
+      if (!closed) emitter.emit("overflow");
+      return;
+    }
+    if (raw.action === "error") {
+      debug("[watchBlockDevices] stopped: %s", raw.error);
+      close();
+      if (emitter.listenerCount("error") > 0) {
+        emitter.emit("error", new Error(`${desc}: ${raw.error}`));
+      }
+      return;
+    }
+    if (raw.major == null || raw.minor == null) return;
+    const key = `${raw.major}:${raw.minor}`;
+    const media: RemovableMediaEvent = {
+      major: raw.major,
+      minor: raw.minor,
+      ...(raw.devname == null ? {} : { device: `/dev/${raw.devname}` }),
+      ...(raw.devtype == null ? {} : { devtype: raw.devtype }),
+    };
+
+    let kind: "insert" | "eject" | undefined;
+    if (raw.action === "remove") {
+      if (removable.delete(key)) kind = "eject";
+    } else {
+      const info = await readSysfsBlockInfo(key, o.sysfsRoot);
+      if (info?.removable === true) {
+        removable.add(key);
+        if (raw.action === "add" && info.sizeSectors > 0) {
+          kind = "insert";
+        } else if (raw.diskMediaChange === true) {
+          kind = info.sizeSectors > 0 ? "insert" : "eject";
+        }
+      }
+    }
+    if (closed) return;
+
+    emitter.emit("uevent", {
+      action: raw.action,
+      ...media,
+      removable: removable.has(key) || kind === "eject",
+      ...(raw.diskMediaChange === true ? { diskMediaChange: true } : {}),
+      ...(raw.diskEjectRequest === true ? { diskEjectRequest: true } : {}),
+    });
+    if (kind != null) {
+      debug("[watchBlockDevices] %s %s", kind, media.device ?? key);
+      emitter.emit(kind, media);
+    }
+  }
+
+  const monitor = native.startUeventMonitor((event) => {
+    if (closed) return;
+    queue = queue
+      .then(() => handle(event))
+      .catch((error) => {
+        // A throwing listener surfaces as an uncaught exception:
+        queueMicrotask(() => {
+          throw toError(error);
+        });
+      });
+  });
+
+  function close() {
+    if (closed) return;
+    closed = true;
+    native.stopUeventMonitor?.(monitor);
+  }
+
+  // The socket is bound before the scan starts, so nothing between the two
+  // is missed. Events arrive on later ticks, so all of them queue behind it:
+  const seeded = seedRemovable(o.sysfsRoot, removable);
+  queue = seeded;
+  await seeded;
+  return Object.assign(emitter, { close });
+}
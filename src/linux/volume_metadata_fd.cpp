@@ -0,0 +1,181 @@
+// src/linux/volume_metadata_fd.cpp
+//
+// getVolumeMetadataForFd(): metadata for the volume behind a descriptor the
+// caller already holds. No path is resolved, stat()ed or opened: the mount
+// comes from the descriptor's mount id, and every probe runs on a dup() of it.
+
+#include "../common/debug_log.h"
+#include "../common/error_utils.h"
+#include "../common/fd_guard.h"
+#include "../common/metadata_worker.h"
+#include "fs_meta.h"
+#include "mountinfo.h"
+#include <cerrno>
+#include <charconv> // for std::from_chars()
+#include <climits>  // for INT_MAX
+#include <cmath>    // for std::floor()
+#include <cstdio>   // for snprintf()
+#include <cstdlib>  // for strtoull()
+#include <cstring>  // for strstr(), strerror()
+#include <fcntl.h>  // for fcntl(), F_DUPFD_CLOEXEC, F_GETFL, O_PATH
+#include <string_view>
+#include <sys/stat.h> // for statx(), fstat()
+#include <unistd.h>
+
+namespace FSMeta {
+
+namespace {
+
+// Linux < 5.8 (or headers predating STATX_MNT_ID): /proc/self/fdinfo has
+// reported mnt_id since 3.15.
+uint64_t ReadMountIdFromFdinfo(int fd) {
+  char path[64];
+  snprintf(path, sizeof(path), "/proc/self/fdinfo/%d", fd);
+  const int info_fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (info_fd < 0) {
+    throw FSException(CreatePathErrorMessage("open", path, errno));
+  }
+  FdGuard guard(info_fd);
+  char buf[512];
+  const ssize_t n = read(info_fd, buf, sizeof(buf) - 1);
+  if (n < 0) {
+    throw FSException(CreatePathErrorMessage("read", path, errno));
+  }
+  buf[n] = '\0';
+  const char *field = strstr(buf, "mnt_id:");
+  if (field == nullptr) {
+    throw FSException(std::string("no mnt_id in ") + path);
+  }
+  return strtoull(field + strlen("mnt_id:"), nullptr, 10);
+}
+
+uint64_t ReadMountId(int fd) {
+#ifdef STATX_MNT_ID
+  struct statx stx {};
+  // AT_STATX_DONT_SYNC: the mount id never needs a round trip to a network
+  // filesystem's server.
+  if (statx(fd, "", AT_EMPTY_PATH | AT_STATX_DONT_SYNC, STATX_MNT_ID, &stx) ==
+          0 &&
+      (stx.stx_mask & STATX_MNT_ID) != 0) {
+    return stx.stx_mnt_id;
+  }
+#endif
+  return ReadMountIdFromFdinfo(fd);
+}
+
+// btrfs's "subvolid=" from the combined mount options, or 0.
+uint64_t ParseSubvolid(std::string_view mountOptions) {
+  constexpr std::string_view key = "subvolid=";
+  size_t pos = 0;
+  while ((pos = mountOptions.find(key, pos)) != std::string_view::npos) {
+    if (pos == 0 || mountOptions[pos - 1] == ',') {
+      // A view, not NUL-terminated: parse within its bounds.
+      uint64_t id = 0;
+      const char *begin = mountOptions.data() + pos + key.size();
+      std::from_chars(begin, mountOptions.data() + mountOptions.size(), id);
+      return id;
+    }
+    pos += key.size();
+  }
+  return 0;
+}
+
+class FdMetadataWorker : public MetadataWorkerBase {
+public:
+  FdMetadataWorker(int fd, bool includeQuota,
+                   const Napi::Promise::Deferred &deferred)
+      : MetadataWorkerBase("", deferred), fd_(fd),
+        includeQuota_(includeQuota) {}
+
+  void Execute() override {
+    if (IsShuttingDown()) {
+      SetError("fs-metadata: shutdown in progress");
+      return;
+    }
+    try {
+      const uint64_t mount_id = ReadMountId(fd_.get());
+      if (!MountInfoCache::Lookup(mount_id, entry_)) {
+        throw FSException("mount " + std::to_string(mount_id) +
+                          " not found in /proc/self/mountinfo");
+      }
+      mountPoint = std::string(entry_.mountPoint);
+      DEBUG_LOG("[FdMetadataWorker] fd %d is on mount %llu (%s)", fd_.get(),
+                static_cast<unsigned long long>(mount_id), mountPoint.c_str());
+
+      // Directory-only ioctls (the btrfs subvolume probe) need a real,
+      // non-O_PATH directory descriptor.
+      struct stat st;
+      const int flags = fcntl(fd_.get(), F_GETFL);
+      const bool is_directory = fstat(fd_.get(), &st) == 0 &&
+                                S_ISDIR(st.st_mode) && flags >= 0 &&
+                                (flags & O_PATH) == 0;
+
+      VolumeMetadataOptions options;
+      options.mountPoint = options.Copy(entry_.mountPoint);
+      options.device = options.Copy(entry_.source);
+      options.fstype = options.Copy(entry_.fstype);
+      options.subvolid = ParseSubvolid(entry_.mountOptions);
+      options.includeQuota = includeQuota_;
+      metadata.fstype = entry_.fstype;
+      metadata.mountFrom = entry_.source;
+      ProbeOpenVolume(fd_.get(), mountPoint, is_directory, options, metadata);
+    } catch (const std::exception &e) {
+      DEBUG_LOG("[FdMetadataWorker] error: %s", e.what());
+      SetError(e.what());
+    }
+  }
+
+  void OnOK() override {
+    Napi::HandleScope scope(Env());
+    auto result = metadata.ToObject(Env());
+    result.Set("mountPoint", NewString(entry_.mountPoint));
+    result.Set("mountOptions", NewString(entry_.mountOptions));
+    result.Set("mountRoot", NewString(entry_.root));
+    SafeResolve(deferred_, result);
+  }
+
+private:
+  Napi::String NewString(std::string_view s) {
+    return Napi::String::New(Env(), s.data(), s.size());
+  }
+
+  FdGuard fd_;
+  bool includeQuota_;
+  MountInfoEntry entry_; // views into the snapshot it holds
+};
+
+} // namespace
+
+Napi::Value GetVolumeMetadataForFd(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "Expected options object with fd");
+  }
+  auto obj = info[0].As<Napi::Object>();
+  if (!obj.Has("fd") || !obj.Get("fd").IsNumber()) {
+    throw Napi::TypeError::New(env, "Expected options object with fd");
+  }
+  const double fd = obj.Get("fd").As<Napi::Number>().DoubleValue();
+  if (!(fd >= 0 && fd <= INT_MAX) || std::floor(fd) != fd) {
+    throw Napi::TypeError::New(env, "Invalid fd");
+  }
+  bool include_quota = false;
+  if (obj.Has("includeQuota") && obj.Get("includeQuota").IsBoolean()) {
+    include_quota = obj.Get("includeQuota").As<Napi::Boolean>().Value();
+  }
+
+  // The worker probes its own duplicate, so the caller may close theirs
+  // (or time out) while the probe is in flight.
+  const int dup_fd = fcntl(static_cast<int>(fd), F_DUPFD_CLOEXEC, 0);
+  if (dup_fd < 0) {
+    throw Napi::Error::New(
+        env, CreateDetailedErrorMessage("fcntl(F_DUPFD_CLOEXEC)", errno));
+  }
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto *worker = new FdMetadataWorker(dup_fd, include_quota, deferred);
+  worker->Queue();
+  return deferred.Promise();
+}
+
+} // namespace FSMeta
@@ -0,0 +1,212 @@
+// src/linux/volume_probe.cpp
+#include "../common/capacity_history.h"
+#include "../common/debug_log.h"
+#include "../common/error_utils.h"
+#include "../common/fd_guard.h"
+#include "../common/metadata_worker.h"
+#include "../common/shutdown.h"
+#include "fs_meta.h"
+#include "quota_probe.h"
+#include <cstdint>
+#include <memory>
+
+namespace FSMeta {
+
+namespace {
+
+// Guards against type confusion: any External reaching RefreshVolumeProbe()
+// or CloseVolumeProbe() from JS is cast to this type.
+constexpr uint32_t kVolumeProbeMagic = 0x76707262; // "vprb"
+
+struct VolumeProbeHandle {
+  uint32_t magic = kVolumeProbeMagic;
+  VolumeMetadataOptions options;
+  std::string validatedPath;
+  // Reset by close(). Each in-flight refresh holds its own reference, so the
+  // fd stays open until the last one finishes.
+  std::shared_ptr<FdGuard> fd;
+  // Every successful read through fd, newest last. Shared with in-flight
+  // refreshes, which record into it from the worker pool.
+  std::shared_ptr<CapacityHistory> history;
+};
+
+VolumeProbeHandle *UnwrapHandle(const Napi::CallbackInfo &info) {
+  if (info.Length() < 1 || !info[0].IsExternal()) {
+    throw Napi::TypeError::New(info.Env(), "Expected a volume probe handle");
+  }
+  auto *handle = info[0].As<Napi::External<VolumeProbeHandle>>().Data();
+  if (handle == nullptr || handle->magic != kVolumeProbeMagic) {
+    throw Napi::TypeError::New(info.Env(), "Expected a volume probe handle");
+  }
+  return handle;
+}
+
+class OpenVolumeProbeWorker : public SafeAsyncWorker {
+public:
+  OpenVolumeProbeWorker(VolumeMetadataOptions &&options, size_t historySize,
+                        const Napi::Promise::Deferred &deferred)
+      : SafeAsyncWorker(deferred.Env()), options_(std::move(options)),
+        historySize_(historySize), deferred_(deferred) {}
+
+  void Execute() override {
+    if (IsShuttingDown()) {
+      SetError("fs-metadata: shutdown in progress");
+      return;
+    }
+    try {
+      handle_ = std::make_unique<VolumeProbeHandle>();
+      // The handle outlives this worker, and its views into the options'
+      // strings go with it.
+      handle_->options = std::move(options_);
+      bool is_directory = true;
+      handle_->fd = std::make_shared<FdGuard>(
+          OpenMountPoint(std::string(handle_->options.mountPoint),
+                         handle_->validatedPath, is_directory));
+      DEBUG_LOG("[VolumeProbe] opened %s (fd %d)",
+                handle_->validatedPath.c_str(), handle_->fd->get());
+      // The first sample, so a trend is available after one refresh.
+      handle_->history = std::make_shared<CapacityHistory>(historySize_);
+      VolumeMetadata initial;
+      ReadVolumeSpace(handle_->fd->get(), handle_->validatedPath, initial);
+      handle_->history->Record(initial);
+    } catch (const std::exception &e) {
+      DEBUG_LOG("[VolumeProbe] open error: %s", e.what());
+      SetError(e.what());
+    }
+  }
+
+  void OnOK() override {
+    Napi::HandleScope scope(Env());
+    // The finalizer owns the handle once External::New succeeds. If the
+    // caller already gave up (timeout), GC closes the fd.
+    auto external = Napi::External<VolumeProbeHandle>::New(
+        Env(), handle_.get(),
+        [](Napi::Env /*env*/, VolumeProbeHandle *handle) { delete handle; });
+    handle_.release();
+    SafeResolve(deferred_, external);
+  }
+
+  void OnError(const Napi::Error &error) override {
+    Napi::HandleScope scope(Env());
+    SafeReject(deferred_, error.Value());
+  }
+
+private:
+  VolumeMetadataOptions options_;
+  size_t historySize_;
+  Napi::Promise::Deferred deferred_;
+  std::unique_ptr<VolumeProbeHandle> handle_;
+};
+
+// Re-runs only the dynamic stages through the held fd: no path validation,
+// open(), blkid or btrfs/zfs identity ioctls.
+class RefreshVolumeProbeWorker : public MetadataWorkerBase {
+public:
+  RefreshVolumeProbeWorker(const VolumeProbeHandle &handle,
+                           const Napi::Promise::Deferred &deferred)
+      : MetadataWorkerBase(handle.validatedPath, deferred), fd_(handle.fd),
+        history_(handle.history), fstype_(handle.options.fstype),
+        device_(handle.options.device),
+        includeQuota_(handle.options.includeQuota) {}
+
+  void Execute() override {
+    if (IsShuttingDown()) {
+      SetError("fs-metadata: shutdown in progress");
+      return;
+    }
+    try {
+      ReadVolumeSpace(fd_->get(), mountPoint, metadata);
+      history_->Record(metadata);
+      if (includeQuota_) {
+        ProbeQuota(fd_->get(), mountPoint, fstype_, device_, metadata);
+      }
+    } catch (const std::exception &e) {
+      DEBUG_LOG("[VolumeProbe] refresh error: %s", e.what());
+      SetError(e.what());
+    }
+  }
+
+private:
+  std::shared_ptr<FdGuard> fd_;
+  std::shared_ptr<CapacityHistory> history_;
+  std::string fstype_;
+  std::string device_;
+  bool includeQuota_;
+};
+
+} // namespace
+
+Napi::Value OpenVolumeProbe(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    throw Napi::TypeError::New(env, "Expected options object with mountPoint");
+  }
+  auto obj = info[0].As<Napi::Object>();
+  auto options = VolumeMetadataOptions::FromObject(obj);
+  size_t history_size = CapacityHistory::kDefaultCapacity;
+  if (obj.Has("historySize") && obj.Get("historySize").IsNumber()) {
+    const double size = obj.Get("historySize").As<Napi::Number>().DoubleValue();
+    if (!(size >= 2 && size <= CapacityHistory::kMaxCapacity)) {
+      throw Napi::TypeError::New(env, "historySize must be between 2 and 4096");
+    }
+    history_size = static_cast<size_t>(size);
+  }
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto *worker =
+      new OpenVolumeProbeWorker(std::move(options), history_size, deferred);
+  worker->Queue();
+  return deferred.Promise();
+}
+
+Napi::Value RefreshVolumeProbe(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  auto *handle = UnwrapHandle(info);
+  if (handle->fd == nullptr) {
+    throw Napi::Error::New(env, "Volume probe is closed");
+  }
+
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto *worker = new RefreshVolumeProbeWorker(*handle, deferred);
+  worker->Queue();
+  return deferred.Promise();
+}
+
+// Synchronous: the history is already in memory, so this is one lock and a
+// pass over at most kMaxCapacity samples. Still answers after close().
+Napi::Value GetVolumeProbeTrend(const Napi::CallbackInfo &info) {
+  auto env = info.Env();
+  auto *handle = UnwrapHandle(info);
+  const CapacityTrend trend = handle->history->Trend();
+
+  auto result = Napi::Object::New(env);
+  result.Set("samples",
+             Napi::Number::New(env, static_cast<double>(trend.samples)));
+  result.Set("spanSeconds", Napi::Number::New(env, trend.spanSeconds));
+  result.Set("used", Napi::Number::New(env, trend.used));
+  result.Set("available", Napi::Number::New(env, trend.available));
+  result.Set("bytesPerSecond", Napi::Number::New(env, trend.bytesPerSecond));
+  if (trend.secondsToFull >= 0) {
+    result.Set("secondsToFull", Napi::Number::New(env, trend.secondsToFull));
+  }
+  if (trend.hasInodes) {
+    result.Set("inodesFree", Napi::Number::New(env, trend.inodesFree));
+    result.Set("inodesPerSecond",
+               Napi::Number::New(env, trend.inodesPerSecond));
+    if (trend.secondsToInodesExhausted >= 0) {
+      result.Set("secondsToInodesExhausted",
+                 Napi::Number::New(env, trend.secondsToInodesExhausted));
+    }
+  }
+  return result;
+}
+
+Napi::Value CloseVolumeProbe(const Napi::CallbackInfo &info) {
+  auto *handle = UnwrapHandle(info);
+  DEBUG_LOG("[VolumeProbe] closing %s", handle->validatedPath.c_str());
+  handle->fd.reset();
+  return info.Env().Undefined();
+}
+
+} // namespace FSMeta
@@ -2,6 +2,11 @@ import { execFile } from "node:child_process";
 import { existsSync } from "node:fs";
 import { TimeoutError, withTimeout } from "../async";
 import { debug } from "../debuglog";
+import {
+  readZfsObjsetId,
+  readZfsPoolGuidKstat,
+  ZfsKstatRootDefault,
+} from "./zfs_kstat";
 
 const MaxUint64 = (1n << 64n) - 1n;
 const MaxOutputBytes = 4096;
@@ -22,6 +27,7 @@ export type ZfsCommandRunner = (
 export interface ZfsGuids {
   zfsDatasetGuid?: string;
   zfsPoolGuid?: string;
+  zfsObjsetId?: string;
 }
 
 /**
@@ -222,6 +228,10 @@ async function readPoolGuid(
 /**
  * Fetch the opt-in, authoritative ZFS GUID properties for a mounted dataset.
  *
+ * The objset id, and on recent OpenZFS the pool GUID, come from kstat files
+ * under `kstatRoot` without spawning anything. The CLI is only used for what
+ * kstats lack: always the dataset GUID, and the pool GUID on older releases.
+ *
  * Queries are shell-free. Failures degrade field-by-field to `undefined`, and
  * pool lookups are shared only while concurrent requests are in flight so an
  * explicit `zpool reguid` is visible to the next metadata call.
@@ -230,19 +240,33 @@ export async function getZfsGuids({
   dataset,
   timeoutMs,
   run = runZfsCommand,
+  kstatRoot = ZfsKstatRootDefault,
 }: {
   dataset: string;
   timeoutMs: number;
   run?: ZfsCommandRunner;
+  kstatRoot?: string;
 }): Promise<ZfsGuids> {
   const pool = poolName(dataset);
   if (pool == null) return {};
+
+  const [zfsObjsetId, rawPoolGuid] = await Promise.all([
+    readZfsObjsetId(pool, dataset, kstatRoot),
+    readZfsPoolGuidKstat(pool, kstatRoot),
+  ]);
+  const kstatPoolGuid =
+    rawPoolGuid == null ? undefined : parseZfsGuid(rawPoolGuid);
+  const kstat = {
+    ...(zfsObjsetId == null ? {} : { zfsObjsetId }),
+    ...(kstatPoolGuid == null ? {} : { zfsPoolGuid: kstatPoolGuid }),
+  };
+
   // The OpenZFS CLI requires the kernel control device. Containers can expose
   // host ZFS mounts without exposing /dev/zfs; avoid spawning commands that
   // cannot succeed in that common configuration.
   if (run === runZfsCommand && !existsSync("/dev/zfs")) {
     debug("[zfsGuids] skipping GUID queries because /dev/zfs is unavailable");
-    return {};
+    return kstat;
   }
 
   const [zfsDatasetGuid, zfsPoolGuid] = await Promise.all([
@@ -252,10 +276,11 @@ export async function getZfsGuids({
       timeoutMs,
       run,
     ),
-    readPoolGuid(pool, timeoutMs, run),
+    kstatPoolGuid ?? readPoolGuid(pool, timeoutMs, run),
   ]);
 
   return {
+    ...kstat,
     ...(zfsDatasetGuid == null ? {} : { zfsDatasetGuid }),
     ...(zfsPoolGuid == null ? {} : { zfsPoolGuid }),
   };
@@ -0,0 +1,110 @@
+// src/linux/zfs_kstat.test.ts
+
+import { mkdir, mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { getZfsGuids, type ZfsCommandRunner } from "./zfs_guids";
+import { parseKstatNamed, readZfsObjsetId } from "./zfs_kstat";
+
+function objsetKstat(dataset: string): string {
+  return [
+    "47 1 0x01 7 2160 6023033829 34542403826611",
+    "name                            type data",
+    `dataset_name                    7    ${dataset}`,
+    "writes                          4    12",
+    "nwritten                        4    4096",
+    "",
+  ].join("\n");
+}
+
+describe("zfs kstats", () => {
+  let root: string;
+  let pool: string;
+
+  beforeEach(async () => {
+    root = await mkdtemp(join(tmpdir(), "fs-metadata-kstat-"));
+    pool = join(root, "tank");
+    await mkdir(pool);
+    await writeFile(join(pool, "objset-0x36"), objsetKstat("tank"));
+    await writeFile(join(pool, "objset-0x10b"), objsetKstat("tank/my photos"));
+    await writeFile(join(pool, "state"), "ONLINE\n");
+  });
+
+  afterEach(async () => {
+    await rm(root, { recursive: true, force: true });
+  });
+
+  it("parses named kstats, keeping spaces in data", () => {
+    const parsed = parseKstatNamed(objsetKstat("tank/my photos"));
+    expect(parsed.get("dataset_name")).toBe("tank/my photos");
+    expect(parsed.get("writes")).toBe("12");
+    expect(parsed.has("name")).toBe(false);
+  });
+
+  it("resolves objset ids by dataset name", async () => {
+    expect(await readZfsObjsetId("tank", "tank", root)).toBe("54");
+    expect(await readZfsObjsetId("tank", "tank/my photos", root)).toBe("267");
+    expect(await readZfsObjsetId("tank", "tank/missing", root)).toBeUndefined();
+    expect(await readZfsObjsetId("nope", "nope", root)).toBeUndefined();
+  });
+
+  it("indexes the pool once for concurrent lookups", async () => {
+    await expect(
+      Promise.all([
+        readZfsObjsetId("tank", "tank", root),
+        readZfsObjsetId("tank", "tank/my photos", root),
+        readZfsObjsetId("tank", "tank/missing", root),
+      ]),
+    ).resolves.toEqual(["54", "267", undefined]);
+  });
+
+  it("notices a dataset that moved to a new objset", async () => {
+    expect(await readZfsObjsetId("tank", "tank/my photos", root)).toBe("267");
+    // zfs destroy + create:
+    await rm(join(pool, "objset-0x10b"));
+    await writeFile(join(pool, "objset-0x200"), objsetKstat("tank/my photos"));
+    expect(await readZfsObjsetId("tank", "tank/my photos", root)).toBe("512");
+  });
+
+  it("rescans on a miss only when the pool's objsets change", async () => {
+    expect(await readZfsObjsetId("tank", "tank/new", root)).toBeUndefined();
+    // Unchanged listing: the miss is trusted, so this edit goes unseen.
+    await writeFile(join(pool, "objset-0x36"), objsetKstat("tank/new"));
+    expect(await readZfsObjsetId("tank", "tank/new", root)).toBeUndefined();
+    // zfs create:
+    await writeFile(join(pool, "objset-0x300"), objsetKstat("tank/newer"));
+    expect(await readZfsObjsetId("tank", "tank/newer", root)).toBe("768");
+    expect(await readZfsObjsetId("tank", "tank/new", root)).toBe("54");
+  });
+
+  it("skips zpool when the pool GUID kstat exists", async () => {
+    await writeFile(join(pool, "guid"), "18446744073709551615\n");
+    const calls: string[] = [];
+    const run: ZfsCommandRunner = async (command) => {
+      calls.push(command);
+      return "123\n";
+    };
+    await expect(
+      getZfsGuids({
+        dataset: "tank/my photos",
+        timeoutMs: 1000,
+        run,
+        kstatRoot: root,
+      }),
+    ).resolves.toEqual({
+      zfsObjsetId: "267",
+      zfsPoolGuid: "18446744073709551615",
+      zfsDatasetGuid: "123",
+    });
+    expect(calls).toEqual(["zfs"]);
+  });
+
+  it("keeps kstat identity when the CLI fails", async () => {
+    const run: ZfsCommandRunner = async () => {
+      throw new Error("ENOENT");
+    };
+    await expect(
+      getZfsGuids({ dataset: "tank", timeoutMs: 1000, run, kstatRoot: root }),
+    ).resolves.toEqual({ zfsObjsetId: "54" });
+  });
+});
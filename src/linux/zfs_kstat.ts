@@ -0,0 +1,161 @@
+// src/linux/zfs_kstat.ts
+
+import { readdir, readFile } from "node:fs/promises";
+import { join } from "node:path";
+import { createManagedCache } from "../cache_manager";
+import { debug } from "../debuglog";
+import { MinuteMs } from "../units";
+
+/**
+ * Where OpenZFS publishes its per-pool kstats. Injectable for tests.
+ */
+export const ZfsKstatRootDefault = "/proc/spl/kstat/zfs";
+
+/**
+ * Parses a "named" kstat file: a header line, a `name type data` column
+ * header, then one `name type data` row per statistic. Data may contain
+ * spaces (dataset names can).
+ */
+export function parseKstatNamed(content: string): Map<string, string> {
+  const result = new Map<string, string>();
+  // lines[0] is the kstat header; lines[1] is "name type data"
+  for (const line of content.split("\n").slice(2)) {
+    const match = /^(\S+)\s+\d+\s+(.*)$/.exec(line);
+    if (match != null) result.set(match[1] as string, match[2] as string);
+  }
+  return result;
+}
+
+/**
+ * `objset-0x36` → "54". Objset ids are unsigned 64-bit, so this returns a
+ * decimal string, like the GUIDs.
+ */
+function objsetIdFromFilename(filename: string): string | undefined {
+  const match = /^objset-0x([0-9a-f]{1,16})$/i.exec(filename);
+  return match == null ? undefined : BigInt("0x" + match[1]).toString(10);
+}
+
+async function readObjsetDatasetName(
+  poolDir: string,
+  filename: string,
+): Promise<string | undefined> {
+  try {
+    const content = await readFile(join(poolDir, filename), "utf8");
+    return parseKstatNamed(content).get("dataset_name");
+  } catch {
+    return; // the objset was released, or kstats are unreadable
+  }
+}
+
+async function listObjsets(poolDir: string): Promise<string[] | undefined> {
+  try {
+    return (await readdir(poolDir))
+      .filter((ea) => objsetIdFromFilename(ea) != null)
+      .sort();
+  } catch (error) {
+    debug("[zfsKstat] cannot list %s: %s", poolDir, error);
+    return;
+  }
+}
+
+interface ObjsetIndex {
+  /** dataset name → objset kstat filename */
+  byName: Map<string, string>;
+  /** The objset filenames, sorted and joined, when the pool was indexed. */
+  listing: string;
+  indexedAtMs: number;
+}
+
+// How long a miss is trusted while the pool's objsets stay the same. A
+// rename keeps its objset, so only a rescan finds the new name.
+const MissTtlMs = MinuteMs;
+
+// pool dir → index of all its objsets. Hits are verified on every lookup:
+// destroying and recreating (or renaming) a dataset moves its name to a
+// different objset.
+const objsetIndexes = createManagedCache<string, ObjsetIndex>(
+  "zfsObjsetFiles",
+  {
+    cost: (poolDir, index) => {
+      let bytes = 2 * (poolDir.length + index.listing.length);
+      for (const [name, filename] of index.byName) {
+        bytes += 64 + 2 * (name.length + filename.length);
+      }
+      return bytes;
+    },
+  },
+);
+
+// Scans in flight, by pool dir: concurrent lookups on one pool share one.
+const scans = new Map<string, Promise<ObjsetIndex | undefined>>();
+
+async function scanPool(poolDir: string): Promise<ObjsetIndex | undefined> {
+  const filenames = await listObjsets(poolDir);
+  if (filenames == null) return;
+  const names = await Promise.all(
+    filenames.map((ea) => readObjsetDatasetName(poolDir, ea)),
+  );
+  const byName = new Map<string, string>();
+  filenames.forEach((filename, i) => {
+    const name = names[i];
+    if (name != null) byName.set(name, filename);
+  });
+  const index = {
+    byName,
+    listing: filenames.join("\n"),
+    indexedAtMs: Date.now(),
+  };
+  objsetIndexes.set(poolDir, index);
+  return index;
+}
+
+function indexPool(poolDir: string): Promise<ObjsetIndex | undefined> {
+  let scan = scans.get(poolDir);
+  if (scan == null) {
+    scan = scanPool(poolDir).finally(() => scans.delete(poolDir));
+    scans.set(poolDir, scan);
+  }
+  return scan;
+}
+
+/**
+ * Resolves a mounted dataset's objset id from
+ * `<root>/<pool>/objset-0x<id>` kstats, without the `zfs` command. A hit
+ * costs one file read. A miss lists the pool, and reads every objset (in
+ * one pass, shared by concurrent lookups) only if the list changed since
+ * the pool was last indexed, or a minute has passed.
+ */
+export async function readZfsObjsetId(
+  pool: string,
+  dataset: string,
+  root: string = ZfsKstatRootDefault,
+): Promise<string | undefined> {
+  const poolDir = join(root, pool);
+  const index = objsetIndexes.get(poolDir);
+  const cached = index?.byName.get(dataset);
+  if (cached != null) {
+    if ((await readObjsetDatasetName(poolDir, cached)) === dataset) {
+      return objsetIdFromFilename(cached);
+    }
+  } else if (index != null && Date.now() - index.indexedAtMs < MissTtlMs) {
+    const filenames = await listObjsets(poolDir);
+    if (filenames?.join("\n") === index.listing) return;
+  }
+  const found = (await indexPool(poolDir))?.byName.get(dataset);
+  return found == null ? undefined : objsetIdFromFilename(found);
+}
+
+/**
+ * Reads the raw pool GUID from `<root>/<pool>/guid`, which recent OpenZFS
+ * releases publish. Undefined when the file is absent.
+ */
+export async function readZfsPoolGuidKstat(
+  pool: string,
+  root: string = ZfsKstatRootDefault,
+): Promise<string | undefined> {
+  try {
+    return await readFile(join(root, pool, "guid"), "utf8");
+  } catch {
+    return;
+  }
+}
@@ -0,0 +1,38 @@
+// src/mount_points_entry.ts
+//
+// Mount point enumeration alone, published as
+// "@photostructure/fs-metadata/mount-points". On Linux the mount table is
+// parsed in JavaScript, so unless `blockDeviceFilter` is set, listing mount
+// points never loads the native addon.
+
+import { nativeFn } from "./native_loader";
+import { optionsWithDefaults } from "./options";
+import type { MountPoint } from "./types/mount_point";
+import type { GetVolumeMountPointOptions } from "./volume_mount_points";
+import { getVolumeMountPointsImpl } from "./volume_mount_points";
+import { viaPipelineWorker } from "./worker_pipeline";
+
+export type { GetVolumeMountPointOptions, MountPoint };
+
+/**
+ * List all active local and remote mount points on the system.
+ *
+ * Linux file bind mounts are omitted after target probing; explicit path
+ * queries still resolve and inspect them. When `skipNetworkVolumes` is true,
+ * remote targets are not touched, so entries whose target type cannot be
+ * determined are retained. Snapshot mounts are listed but not probed unless
+ * {@link Options.probeSnapshots} is true.
+ *
+ * Note that on Windows, `timeoutMs` will be used **per system call** and not
+ * for the entire operation.
+ *
+ * @param opts Optional filesystem operation settings to override default values
+ */
+export function getVolumeMountPoints(
+  opts?: Partial<GetVolumeMountPointOptions>,
+): Promise<MountPoint[]> {
+  return (
+    viaPipelineWorker<MountPoint[]>(opts, "getVolumeMountPoints", [opts]) ??
+    getVolumeMountPointsImpl(optionsWithDefaults(opts), nativeFn)
+  );
+}
@@ -0,0 +1,58 @@
+// src/native_loader.ts
+//
+// Loads the native addon on first use. Nothing here runs at import time:
+// consumers that only call JavaScript-backed APIs (isHidden on Linux and
+// macOS, Linux mount enumeration) never resolve node-gyp-build or dlopen the
+// addon.
+
+import { createRequire } from "node:module";
+import { join } from "node:path";
+import type NodeGypBuild from "node-gyp-build";
+import { debug, debugLogContext, isDebugEnabled } from "./debuglog";
+import { defer } from "./defer";
+import { _dirname } from "./dirname";
+import { findAncestorDir, findAncestorDirSync } from "./fs";
+import type { NativeBindings } from "./types/native_bindings";
+
+function loadBindings(dir: string | undefined): NativeBindings {
+  if (dir == null) {
+    throw new Error(
+      "Could not find bindings.gyp in any ancestor directory of " + _dirname(),
+    );
+  }
+  // Resolved from the package root, so the CJS and ESM builds (and jest)
+  // find the same node-gyp-build without a static import.
+  const nodeGypBuild = createRequire(join(dir, "package.json"))(
+    "node-gyp-build",
+  ) as typeof NodeGypBuild;
+  const bindings = nodeGypBuild(dir) as NativeBindings;
+  bindings.setDebugLogging(isDebugEnabled());
+  bindings.setDebugPrefix(debugLogContext() + ":native");
+  return bindings;
+}
+
+export const nativeFn = defer<Promise<NativeBindings>>(async () => {
+  const start = Date.now();
+  try {
+    return loadBindings(await findAncestorDir(_dirname(), "binding.gyp"));
+  } catch (error) {
+    debug("Loading native bindings failed: %s", error);
+    throw error;
+  } finally {
+    debug(`Native bindings took %d ms to load`, Date.now() - start);
+  }
+});
+
+// Used only by the *Sync() APIs. Shares the module that node-gyp-build
+// loads, so whichever loader runs first pays for it.
+export const nativeSyncFn = defer<NativeBindings>(() => {
+  const start = Date.now();
+  try {
+    return loadBindings(findAncestorDirSync(_dirname(), "binding.gyp"));
+  } catch (error) {
+    debug("Loading native bindings failed: %s", error);
+    throw error;
+  } finally {
+    debug(`Native bindings took %d ms to load`, Date.now() - start);
+  }
+});
@@ -5,6 +5,7 @@ import {
   getTimeoutMsDefault,
   OptionsDefault,
   optionsWithDefaults,
+  validatePriority,
 } from "./options";
 import type { Options } from "./types/options";
 
@@ -13,6 +14,21 @@ describe("options()", () => {
     const result = optionsWithDefaults();
     expect(result).toEqual(OptionsDefault);
     expect(result.includeZfsGuids).toBe(false);
+    expect(result.includeQuota).toBe(false);
+    expect(result.probeSnapshots).toBe(false);
+    expect(result.useWorkerThread).toBe(false);
+    expect(result.priority).toBe("normal");
+  });
+
+  it("should keep OptionsDefault fields writable", () => {
+    const timeoutMs = OptionsDefault.timeoutMs;
+    try {
+      OptionsDefault.timeoutMs = 1234;
+      expect(OptionsDefault.timeoutMs).toBe(1234);
+      expect(optionsWithDefaults().timeoutMs).toBe(1234);
+    } finally {
+      OptionsDefault.timeoutMs = timeoutMs;
+    }
   });
 
   it("should override timeoutMs when provided", () => {
@@ -35,6 +51,8 @@ describe("options()", () => {
     };
 
     expect(optionsWithDefaults(options).includeZfsGuids).toBe(false);
+    expect(optionsWithDefaults(options).includeQuota).toBe(false);
+    expect(optionsWithDefaults(options).probeSnapshots).toBe(false);
   });
 
   it("should override excludedFileSystemTypes when provided", () => {
@@ -107,3 +125,20 @@ describe("FS_METADATA_TIMEOUT_MS environment variable", () => {
     expect(getTimeoutMsDefault()).toBe(5000);
   });
 });
+
+describe("validatePriority()", () => {
+  it("defaults a missing priority", () => {
+    expect(validatePriority(undefined)).toBe("normal");
+    expect(validatePriority("background")).toBe("background");
+  });
+
+  it.each([["low"], [""], ["Background"], [1], [{}]])(
+    "rejects %j",
+    (priority) => {
+      expect(() => validatePriority(priority, "test()")).toThrow(
+        /test\(\): Expected priority to be "normal" or "background"/,
+      );
+      expect(() => validatePriority(priority)).toThrow(TypeError);
+    },
+  );
+});
@@ -2,9 +2,10 @@
 
 import { availableParallelism } from "node:os";
 import { env } from "node:process";
+import { deferFields } from "./defer";
 import { compactValues, isObject } from "./object";
 import { isWindows } from "./platform";
-import type { Options, ResolvedOptions } from "./types/options";
+import type { Options, ProbePriority, ResolvedOptions } from "./types/options";
 
 const DefaultTimeoutMs = 5_000;
 
@@ -236,22 +237,74 @@ export const SkipNetworkVolumesDefault = false;
  */
 export const IncludeZfsGuidsDefault = false;
 
+/**
+ * Default value for {@link Options.includeQuota}.
+ */
+export const IncludeQuotaDefault = false;
+
+/**
+ * Default value for {@link Options.probeSnapshots}.
+ */
+export const ProbeSnapshotsDefault = false;
+
+/**
+ * Default value for {@link Options.useWorkerThread}.
+ */
+export const UseWorkerThreadDefault = false;
+
+/**
+ * Default value for {@link Options.yieldBudgetMs}.
+ */
+export const YieldBudgetMsDefault = 10;
+
+/**
+ * Default value for {@link Options.priority}.
+ */
+export const PriorityDefault: ProbePriority = "normal";
+
+/**
+ * @returns `priority`, or {@link PriorityDefault} if it's missing
+ * @throws {TypeError} if it's neither `"normal"` nor `"background"`, before
+ * any probe starts
+ */
+export function validatePriority(
+  priority: unknown,
+  desc = "validatePriority()",
+): ProbePriority {
+  if (priority == null) return PriorityDefault;
+  if (priority === "normal" || priority === "background") return priority;
+  throw new TypeError(
+    desc +
+      ': Expected priority to be "normal" or "background", but got ' +
+      JSON.stringify(priority),
+  );
+}
+
 /**
  * Default {@link Options} object.
  *
+ * Each field is computed on first read, not at import: `timeoutMs` reads
+ * `FS_METADATA_TIMEOUT_MS` and `maxConcurrency` calls `availableParallelism()`
+ * only once something needs them.
+ *
  * @see {@link optionsWithDefaults} for creating an options object with default values
  */
-export const OptionsDefault: ResolvedOptions = {
-  timeoutMs: getTimeoutMsDefault(),
-  maxConcurrency: availableParallelism(),
-  systemPathPatterns: [...SystemPathPatternsDefault],
-  systemFsTypes: [...SystemFsTypesDefault],
-  linuxMountTablePaths: [...LinuxMountTablePathsDefault],
-  networkFsTypes: [...NetworkFsTypesDefault],
-  includeSystemVolumes: IncludeSystemVolumesDefault,
-  skipNetworkVolumes: SkipNetworkVolumesDefault,
-  includeZfsGuids: IncludeZfsGuidsDefault,
-} as const;
+export const OptionsDefault: ResolvedOptions = deferFields<ResolvedOptions>({
+  timeoutMs: getTimeoutMsDefault,
+  maxConcurrency: availableParallelism,
+  systemPathPatterns: () => [...SystemPathPatternsDefault],
+  systemFsTypes: () => [...SystemFsTypesDefault],
+  linuxMountTablePaths: () => [...LinuxMountTablePathsDefault],
+  networkFsTypes: () => [...NetworkFsTypesDefault],
+  includeSystemVolumes: () => IncludeSystemVolumesDefault,
+  skipNetworkVolumes: () => SkipNetworkVolumesDefault,
+  includeZfsGuids: () => IncludeZfsGuidsDefault,
+  includeQuota: () => IncludeQuotaDefault,
+  probeSnapshots: () => ProbeSnapshotsDefault,
+  useWorkerThread: () => UseWorkerThreadDefault,
+  yieldBudgetMs: () => YieldBudgetMsDefault,
+  priority: () => PriorityDefault,
+});
 
 /**
  * Create an {@link Options} object using default values from
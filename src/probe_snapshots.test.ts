@@ -0,0 +1,117 @@
+// src/probe_snapshots.test.ts
+//
+// Snapshot mounts must not be touched during enumeration unless
+// probeSnapshots is set: hosts can carry thousands of them.
+//
+// Uses a fake mount table whose snapshot mount points don't exist: a
+// directoryStatus() probe would mark them inaccessible, so an undefined
+// status proves the probe was skipped.
+
+import { mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { getLinuxMountPoints } from "./linux/mount_points";
+import { optionsWithDefaults } from "./options";
+import { describePlatform } from "./test-utils/platform";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindings,
+} from "./types/native_bindings";
+import type { Options } from "./types/options";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import { getAllVolumeMetadataImpl } from "./volume_metadata";
+import { getVolumeMountPointsImpl } from "./volume_mount_points";
+
+describePlatform("linux")("probeSnapshots (Linux)", () => {
+  let dir: string;
+  let mtabPath: string;
+  let autoSnap: string;
+  let manualSnap: string;
+
+  const probed: string[] = [];
+  const mockNativeFn = () =>
+    ({
+      getVolumeMetadata: async (o: GetVolumeMetadataOptions) => {
+        probed.push(o.mountPoint);
+        return { size: 100, used: 50, available: 50 };
+      },
+    }) as unknown as NativeBindings;
+
+  const opts = (overrides: Partial<Options>) =>
+    optionsWithDefaults({
+      linuxMountTablePaths: [mtabPath],
+      includeSystemVolumes: true,
+      ...overrides,
+    });
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-snapshots-"));
+    mtabPath = join(dir, "mtab");
+    autoSnap = join(dir, ".zfs", "snapshot", "daily-1");
+    manualSnap = join(dir, "restore");
+    await writeFile(
+      mtabPath,
+      [
+        `tank/data ${dir} zfs rw,xattr 0 0`,
+        `tank/data@daily-1 ${autoSnap} zfs ro 0 0`,
+        `tank/data@daily-2 ${manualSnap} zfs ro 0 0`,
+      ].join("\n") + "\n",
+    );
+  });
+
+  beforeEach(() => {
+    probed.length = 0;
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  it("groups snapshots under their origin's mount point", async () => {
+    const mps = await getLinuxMountPoints({ linuxMountTablePaths: [mtabPath] });
+    expect(mps.find((ea) => ea.mountPoint === autoSnap)).toMatchObject({
+      isSnapshot: true,
+      snapshotOrigin: dir,
+    });
+    expect(mps.find((ea) => ea.mountPoint === manualSnap)).toMatchObject({
+      isSnapshot: true,
+      snapshotOrigin: dir,
+    });
+    expect(mps.find((ea) => ea.mountPoint === dir)?.isSnapshot).toBeUndefined();
+  });
+
+  it("does not health-probe snapshots during enumeration", async () => {
+    const mps = await getVolumeMountPointsImpl(opts({}), mockNativeFn);
+    expect(mps.find((ea) => ea.mountPoint === dir)?.status).toBe("healthy");
+    for (const snap of [autoSnap, manualSnap]) {
+      expect(mps.find((ea) => ea.mountPoint === snap)?.status).toBeUndefined();
+    }
+
+    const all = await getVolumeMountPointsImpl(
+      opts({ probeSnapshots: true }),
+      mockNativeFn,
+    );
+    const snap = all.find((ea) => ea.mountPoint === autoSnap);
+    expect(snap?.status).toBeDefined();
+    expect(snap?.status).not.toBe("healthy");
+  });
+
+  it("returns mount-table-only metadata for snapshots", async () => {
+    const results = (await getAllVolumeMetadataImpl(
+      optionsWithDefaults({
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: true,
+      }),
+      mockNativeFn,
+    )) as (VolumeMetadata & { error?: Error })[];
+    expect(probed).toEqual([dir]);
+    const snap = results.find((ea) => ea.mountPoint === autoSnap);
+    expect(snap).toMatchObject({
+      fstype: "zfs",
+      isSnapshot: true,
+      snapshotOrigin: dir,
+    });
+    expect(snap?.error).toBeUndefined();
+    expect(snap?.size).toBeUndefined();
+  });
+});
@@ -0,0 +1,90 @@
+// src/shutdown.test.ts
+//
+// Teardown benchmark: with every native probe hung (see
+// FS_METADATA_INJECT_PROBE_HANG_MS in src/common/shutdown.cpp), neither
+// process.exit() nor worker.terminate() may wait for them. Each run is a
+// fresh process. Release builds don't compile the hang in, so this only runs
+// against a Debug or `FS_METADATA_TEST_HOOKS=1 npm run node-gyp-rebuild`
+// build.
+
+import { spawnSync } from "node:child_process";
+import { join } from "node:path";
+import { env } from "node:process";
+import { _dirname } from "./dirname";
+import { nativeSyncFn } from "./native_loader";
+import { isWindows } from "./platform";
+import {
+  getTestTimeout,
+  isAlpineLinux,
+  isEmulated,
+} from "./test-utils/test-timeout-config";
+
+const HangMs = 30_000;
+
+function hasTestHooks(): boolean {
+  try {
+    return nativeSyncFn().testHooks === true;
+  } catch {
+    return false;
+  }
+}
+
+// Process spawning is too slow under emulation; see debuglog.test.ts.
+const describeOrSkip =
+  (isEmulated() && isAlpineLinux()) || !hasTestHooks()
+    ? describe.skip
+    : describe;
+
+describeOrSkip("shutdown with hung probes (process spawning)", () => {
+  function runChild(mode: "exit" | "worker") {
+    const script = join(_dirname(), "test-utils", "hung-probe-child.ts");
+    const start = Date.now();
+    const result = spawnSync("npx", ["tsx", script, mode], {
+      env: {
+        ...env,
+        NODE_DEBUG: "",
+        FS_METADATA_INJECT_PROBE_HANG_MS: String(HangMs),
+      },
+      encoding: "utf8",
+      stdio: ["pipe", "pipe", "pipe"],
+      windowsHide: true,
+      shell: isWindows, // Windows needs shell for npx
+      timeout: getTestTimeout(HangMs),
+    });
+    const end = Date.now();
+    if (result.error != null) throw result.error;
+    if (result.status !== 0) {
+      throw new Error(
+        `hung-probe-child ${mode} exited with ${result.status}: ` +
+          result.stderr,
+      );
+    }
+    return { end, ...JSON.parse(result.stdout) } as {
+      end: number;
+      exitAt?: number;
+      teardownMs?: number;
+    };
+  }
+
+  it(
+    "process.exit() doesn't wait for hung probes",
+    () => {
+      const { end, exitAt } = runChild("exit");
+      // Includes npx's own exit, so only an upper bound:
+      const exitMs = end - (exitAt ?? 0);
+      console.log(`[shutdown] process.exit(): ${exitMs}ms`);
+      expect(exitMs).toBeLessThan(HangMs / 3);
+    },
+    getTestTimeout(HangMs * 2),
+  );
+
+  it(
+    "worker.terminate() doesn't wait for hung probes",
+    () => {
+      const { teardownMs } = runChild("worker");
+      console.log(`[shutdown] worker.terminate(): ${teardownMs?.toFixed(1)}ms`);
+      expect(teardownMs).toBeLessThan(HangMs / 3);
+    },
+    getTestTimeout(HangMs * 2),
+  );
+});
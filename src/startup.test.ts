@@ -0,0 +1,102 @@
+// src/startup.test.ts
+//
+// Startup benchmark: import-to-first-result time for each entry point, each
+// in a fresh process. Importing must not load the native addon, and the
+// JavaScript-backed calls (isHidden on POSIX, Linux mount enumeration) must
+// not load it at all.
+
+import { spawnSync } from "node:child_process";
+import { mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { env } from "node:process";
+import { _dirname } from "./dirname";
+import { isLinux, isWindows } from "./platform";
+import {
+  getTestTimeout,
+  isAlpineLinux,
+  isEmulated,
+} from "./test-utils/test-timeout-config";
+
+interface StartupResult {
+  importMs: number;
+  firstResultMs: number;
+  nativeLoadsAtImport: number;
+  nativeLoads: number;
+  result: unknown;
+}
+
+// Process spawning is too slow under emulation; see debuglog.test.ts.
+const describeOrSkip =
+  isEmulated() && isAlpineLinux() ? describe.skip : describe;
+
+describeOrSkip("startup (process spawning)", () => {
+  const Runs = 3;
+  let dir: string;
+  let dotfile: string;
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-startup-"));
+    dotfile = join(dir, ".hidden");
+    await writeFile(dotfile, "");
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  function runChild(entry: string): StartupResult {
+    const script = join(_dirname(), "test-utils", "startup-child.ts");
+    const result = spawnSync("npx", ["tsx", script, entry, dotfile], {
+      env: { ...env, NODE_DEBUG: "" },
+      encoding: "utf8",
+      stdio: ["pipe", "pipe", "pipe"],
+      windowsHide: true,
+      shell: isWindows, // Windows needs shell for npx
+      timeout: getTestTimeout(30_000),
+    });
+    if (result.error != null) throw result.error;
+    if (result.status !== 0) {
+      throw new Error(
+        `startup-child ${entry} exited with ${result.status}: ${result.stderr}`,
+      );
+    }
+    return JSON.parse(result.stdout) as StartupResult;
+  }
+
+  // Fastest of a few runs: the first pays for cold disk caches.
+  function bench(entry: string): StartupResult {
+    const results = Array.from({ length: Runs }, () => runChild(entry));
+    const fastest = results.reduce((a, b) =>
+      b.firstResultMs < a.firstResultMs ? b : a,
+    );
+    console.log(
+      `[startup] ${entry}: import ${fastest.importMs.toFixed(1)}ms, ` +
+        `first result ${fastest.firstResultMs.toFixed(1)}ms ` +
+        `(fastest of ${Runs})`,
+    );
+    return fastest;
+  }
+
+  it.each(["index", "hidden"])(
+    "%s: imports without the native addon",
+    (entry) => {
+      const result = bench(entry);
+      expect(result.nativeLoadsAtImport).toBe(0);
+      expect(result.result).toBe(true);
+      // Windows reads the hidden attribute natively.
+      if (!isWindows) expect(result.nativeLoads).toBe(0);
+    },
+    getTestTimeout(120_000),
+  );
+
+  (isLinux ? it : it.skip)(
+    "mount-points: lists mounts without the native addon (Linux)",
+    () => {
+      const result = bench("mount-points");
+      expect(result.nativeLoads).toBe(0);
+      expect(result.result).toBeGreaterThan(0);
+    },
+    getTestTimeout(120_000),
+  );
+});
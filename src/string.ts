@@ -69,7 +69,7 @@ export function sortByLocale(
   locales?: Intl.LocalesArgument,
   options?: Intl.CollatorOptions,
 ): string[] {
-  return arr.sort((a, b) => a.localeCompare(b, locales, options));
+  return arr.sort(new Intl.Collator(locales, options).compare);
 }
 
 /**
@@ -86,5 +86,8 @@ export function sortObjectsByLocale<T>(
   locales?: Intl.LocalesArgument,
   options?: Intl.CollatorOptions,
 ): T[] {
-  return arr.sort((a, b) => fn(a).localeCompare(fn(b), locales, options));
+  // One collator for the whole sort: localeCompare() with explicit locales or
+  // options sets up a new one for every comparison.
+  const { compare } = new Intl.Collator(locales, options);
+  return arr.sort((a, b) => compare(fn(a), fn(b)));
 }
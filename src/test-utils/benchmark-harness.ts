@@ -1,3 +1,4 @@
+import { monitorEventLoopDelay } from "node:perf_hooks";
 import { getTimingMultiplier } from "./test-timeout-config";
 
 export interface BenchmarkOptions {
@@ -30,6 +31,18 @@ export interface BenchmarkOptions {
    * Whether to log debug information (default: false)
    */
   debug?: boolean;
+
+  /**
+   * Sample event-loop delay while the timed iterations run, and report it in
+   * {@link BenchmarkResult.eventLoopDelay} (default: false)
+   */
+  measureEventLoopDelay?: boolean;
+}
+
+export interface EventLoopDelay {
+  meanMs: number;
+  p99Ms: number;
+  maxMs: number;
 }
 
 export interface BenchmarkResult {
@@ -52,6 +65,12 @@ export interface BenchmarkResult {
    * Whether the benchmark hit the timeout
    */
   timedOut: boolean;
+
+  /**
+   * Event-loop delay during the timed iterations, if
+   * {@link BenchmarkOptions.measureEventLoopDelay} was set
+   */
+  eventLoopDelay?: EventLoopDelay;
 }
 
 /**
@@ -76,6 +95,7 @@ export async function runAdaptiveBenchmark(
     minIterations = 5,
     maxIterations = 10_000,
     warmupIterations = 2,
+    measureEventLoopDelay = false,
   } = options;
 
   // Apply timing multiplier based on environment
@@ -120,6 +140,10 @@ export async function runAdaptiveBenchmark(
   });
 
   // Run the actual benchmark
+  const histogram = measureEventLoopDelay
+    ? monitorEventLoopDelay({ resolution: 1 })
+    : undefined;
+  histogram?.enable();
   const benchmarkStart = Date.now();
   let completedIterations = 0;
   let timedOut = false;
@@ -151,6 +175,7 @@ export async function runAdaptiveBenchmark(
     }
   } finally {
     if (timeoutHandle) clearTimeout(timeoutHandle);
+    histogram?.disable();
   }
 
   const totalDuration = Date.now() - benchmarkStart;
@@ -162,6 +187,14 @@ export async function runAdaptiveBenchmark(
     avgIterationMs: avgIterationTime,
     timedOut,
   };
+  if (histogram != null) {
+    // The histogram records nanoseconds.
+    result.eventLoopDelay = {
+      meanMs: histogram.mean / 1e6,
+      p99Ms: histogram.percentile(99) / 1e6,
+      maxMs: histogram.max / 1e6,
+    };
+  }
 
   // Benchmark results debug info removed to prevent console logging issues
 
@@ -0,0 +1,86 @@
+// src/test-utils/hung-probe-child.ts
+//
+// Starts native work that never finishes (FS_METADATA_INJECT_PROBE_HANG_MS
+// makes every probe sleep, in builds with test hooks), then times how long
+// teardown takes. Prints {teardownMs} as JSON. See src/shutdown.test.ts.
+//
+// Modes:
+//   exit:   probes on the main thread, then process.exit()
+//   worker: probes in a worker_thread, then worker.terminate()
+
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { performance } from "node:perf_hooks";
+import { Worker } from "node:worker_threads";
+import { _dirname } from "../dirname";
+import { findAncestorDirSync } from "../fs";
+
+// More than the native pool has threads, so some are still queued.
+const Probes = 12;
+const SettleMs = 300;
+
+function delay(ms: number) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+async function main() {
+  const mode = process.argv[2];
+  const mountPoint = tmpdir();
+
+  if (mode === "exit") {
+    const { getVolumeMetadata } = await import("../index");
+    for (let i = 0; i < Probes; i++) {
+      getVolumeMetadata(mountPoint, { timeoutMs: 100 }).catch(() => undefined);
+    }
+    await delay(SettleMs);
+    // process.exit() can't report its own latency: the parent times us.
+    process.stdout.write(JSON.stringify({ exitAt: Date.now() }));
+    process.exit(0);
+  }
+
+  if (mode === "worker") {
+    const root = findAncestorDirSync(_dirname(), "binding.gyp");
+    if (root == null) throw new Error("binding.gyp not found");
+    const worker = new Worker(
+      `
+      const { createRequire } = require("node:module");
+      const { parentPort, workerData } = require("node:worker_threads");
+      const req = createRequire(workerData.packageJson);
+      const native = req("node-gyp-build")(workerData.root);
+      for (let i = 0; i < workerData.probes; i++) {
+        native
+          .getVolumeMetadata({ mountPoint: workerData.mountPoint })
+          .catch(() => undefined);
+      }
+      parentPort.postMessage("started");
+      `,
+      {
+        eval: true,
+        workerData: {
+          root,
+          packageJson: join(root, "package.json"),
+          mountPoint,
+          probes: Probes,
+        },
+      },
+    );
+    await new Promise((resolve, reject) => {
+      worker.once("message", resolve);
+      worker.once("error", reject);
+    });
+    await delay(SettleMs);
+    const start = performance.now();
+    await worker.terminate();
+    const teardownMs = performance.now() - start;
+    process.stdout.write(JSON.stringify({ teardownMs }));
+    process.exit(0);
+  }
+
+  throw new Error("Unknown mode: " + mode);
+}
+
+main().catch((err) => {
+  const errorMessage = err instanceof Error ? err.stack : String(err);
+  process.stderr.write(`Error in hung-probe-child: ${errorMessage}\n`);
+  process.exit(1);
+});
@@ -0,0 +1,27 @@
+// Pipeline worker for src/worker_pipeline.test.ts: runs
+// src/worker_pipeline_entry.ts from source, through tsx.
+//
+// PIPELINE_WORKER_MODE=crash exits with code 3 on the first request instead,
+// and PIPELINE_WORKER_MODE=timeout answers every request with a TimeoutError.
+/* eslint-disable @typescript-eslint/no-require-imports */
+/* eslint-disable no-undef */
+
+require("tsx/cjs");
+const { parentPort } = require("node:worker_threads");
+
+const mode = process.env.PIPELINE_WORKER_MODE;
+
+if (mode === "crash") {
+  parentPort.once("message", () => process.exit(3));
+} else if (mode === "timeout") {
+  const { TimeoutError } = require("../async.ts");
+  const { encodePipelineResult } = require("../worker_pipeline.ts");
+  parentPort.on("message", ({ id, method }) => {
+    const payload = encodePipelineResult(
+      new TimeoutError(`${method}(): timeout after 1ms`),
+    );
+    parentPort.postMessage({ id, ok: false, payload }, [payload.buffer]);
+  });
+} else {
+  require("../worker_pipeline_entry.ts");
+}
@@ -0,0 +1,83 @@
+// src/test-utils/soak-core.test.ts
+
+import { MiB } from "../units";
+import {
+  analyzeSoak,
+  detectTrend,
+  percentile,
+  type SoakSample,
+  toOpStats,
+} from "./soak-core";
+
+function sample(i: number, overrides: Partial<SoakSample> = {}): SoakSample {
+  return {
+    elapsedMs: i * 60_000,
+    rss: 100 * MiB,
+    heapUsed: 20 * MiB,
+    external: 2 * MiB,
+    fds: 30,
+    threads: 20,
+    ops: { getVolumeMetadata: toOpStats([1, 2, 3], 0) },
+    ...overrides,
+  };
+}
+
+describe("percentile()", () => {
+  it("uses the nearest rank", () => {
+    const sorted = Array.from({ length: 100 }, (_, i) => i + 1);
+    expect(percentile(sorted, 50)).toBe(50);
+    expect(percentile(sorted, 99)).toBe(99);
+    expect(percentile(sorted, 100)).toBe(100);
+    expect(percentile([7], 99)).toBe(7);
+    expect(percentile([], 50)).toBe(0);
+  });
+});
+
+describe("detectTrend()", () => {
+  const threshold = { minRelative: 0.1, minAbsolute: 5 };
+
+  it("flags steady growth", () => {
+    const values = Array.from({ length: 12 }, (_, i) => 100 + i * 3);
+    expect(detectTrend("x", values, threshold).flagged).toBe(true);
+  });
+
+  it("ignores a flat series with noise and one spike", () => {
+    const values = [100, 102, 99, 101, 160, 100, 98, 101, 100, 102, 99, 101];
+    expect(detectTrend("x", values, threshold).flagged).toBe(false);
+  });
+
+  it("ignores growth below either threshold", () => {
+    const small = Array.from({ length: 12 }, (_, i) => 1000 + i);
+    expect(detectTrend("x", small, threshold).flagged).toBe(false);
+  });
+
+  it("needs enough samples", () => {
+    expect(detectTrend("x", [1, 100, 200], threshold).flagged).toBe(false);
+  });
+});
+
+describe("analyzeSoak()", () => {
+  it("flags leaking descriptors and drifting latency only", () => {
+    const samples = Array.from({ length: 12 }, (_, i) =>
+      sample(i, {
+        fds: 30 + i,
+        ops: {
+          getVolumeMetadata: toOpStats([1, 2, 3 + i * 2], 0),
+        },
+      }),
+    );
+    const flagged = analyzeSoak(samples)
+      .filter((ea) => ea.flagged)
+      .map((ea) => ea.metric);
+    expect(flagged).toEqual(["fds", "getVolumeMetadata p99"]);
+  });
+
+  it("skips metrics the platform doesn't report", () => {
+    const samples = Array.from({ length: 12 }, (_, i) =>
+      sample(i, { threads: undefined }),
+    );
+    expect(analyzeSoak(samples).map((ea) => ea.metric)).not.toContain(
+      "threads",
+    );
+  });
+});
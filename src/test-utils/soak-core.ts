@@ -0,0 +1,204 @@
+// src/test-utils/soak-core.ts
+//
+// Measurement and trend detection for the soak benchmark (see
+// soak-runner.ts). Kept free of workload code so it can be unit tested.
+
+import { readdirSync, readFileSync } from "node:fs";
+import { platform } from "node:process";
+import { MiB } from "../units";
+
+/**
+ * One sampling window of the soak benchmark. Resource counts are read at the
+ * end of the window (after a GC, when exposed); latencies cover the window.
+ */
+export interface SoakSample {
+  elapsedMs: number;
+  rss: number;
+  heapUsed: number;
+  external: number;
+  /**
+   * Open descriptors. Undefined where the platform has no cheap way to count
+   * them (Windows).
+   */
+  fds?: number | undefined;
+  /**
+   * Threads in the process, native and V8 alike. Linux only.
+   */
+  threads?: number | undefined;
+  /**
+   * Per operation: call count, errors, and latency percentiles in ms.
+   */
+  ops: Record<string, OpStats>;
+}
+
+export interface OpStats {
+  count: number;
+  errors: number;
+  p50: number;
+  p90: number;
+  p99: number;
+  max: number;
+}
+
+export function countOpenFds(): number | undefined {
+  const dir =
+    platform === "linux"
+      ? "/proc/self/fd"
+      : platform === "darwin"
+        ? "/dev/fd"
+        : undefined;
+  if (dir == null) return undefined;
+  try {
+    // Less the descriptor readdirSync() itself holds open.
+    return readdirSync(dir).length - 1;
+  } catch {
+    return undefined;
+  }
+}
+
+export function countThreads(): number | undefined {
+  if (platform !== "linux") return undefined;
+  try {
+    const status = readFileSync("/proc/self/status", "utf8");
+    const m = /^Threads:\s+(\d+)/m.exec(status);
+    return m == null ? undefined : Number(m[1]);
+  } catch {
+    return undefined;
+  }
+}
+
+/**
+ * Nearest-rank percentile of `sorted` (ascending). 0 for no values.
+ */
+export function percentile(sorted: readonly number[], p: number): number {
+  if (sorted.length === 0) return 0;
+  const rank = Math.ceil((p / 100) * sorted.length) - 1;
+  return sorted[Math.min(sorted.length - 1, Math.max(0, rank))] ?? 0;
+}
+
+export function toOpStats(latenciesMs: number[], errors: number): OpStats {
+  const sorted = [...latenciesMs].sort((a, b) => a - b);
+  return {
+    count: sorted.length,
+    errors,
+    p50: percentile(sorted, 50),
+    p90: percentile(sorted, 90),
+    p99: percentile(sorted, 99),
+    max: sorted.at(-1) ?? 0,
+  };
+}
+
+function median(values: readonly number[]): number {
+  return percentile([...values].sort((a, b) => a - b), 50);
+}
+
+/**
+ * Least-squares slope of `values` against their index.
+ */
+export function slope(values: readonly number[]): number {
+  const n = values.length;
+  if (n < 2) return 0;
+  const xMean = (n - 1) / 2;
+  const yMean = values.reduce((sum, v) => sum + v, 0) / n;
+  let num = 0;
+  let den = 0;
+  values.forEach((v, i) => {
+    num += (i - xMean) * (v - yMean);
+    den += (i - xMean) ** 2;
+  });
+  return num / den;
+}
+
+export interface TrendThreshold {
+  /**
+   * Growth, as a fraction of the starting level, that counts as a trend.
+   */
+  minRelative: number;
+  /**
+   * ...and in the metric's own units, so noise on small values isn't one.
+   */
+  minAbsolute: number;
+}
+
+export interface Trend {
+  metric: string;
+  start: number;
+  end: number;
+  slopePerSample: number;
+  flagged: boolean;
+}
+
+/**
+ * The samples needed before a trend is judged at all.
+ */
+export const MinTrendSamples = 6;
+
+/**
+ * Compares the median of the first and last third of `values`, so one slow
+ * window or GC at either end can't flag a trend on its own. Flagged only when
+ * the growth exceeds both thresholds and the overall slope agrees.
+ */
+export function detectTrend(
+  metric: string,
+  values: readonly number[],
+  threshold: TrendThreshold,
+): Trend {
+  const third = Math.floor(values.length / 3);
+  const start = median(values.slice(0, third));
+  const end = median(values.slice(values.length - third));
+  const slopePerSample = slope(values);
+  const growth = end - start;
+  const flagged =
+    values.length >= MinTrendSamples &&
+    slopePerSample > 0 &&
+    growth > threshold.minAbsolute &&
+    growth > threshold.minRelative * Math.abs(start);
+  return { metric, start, end, slopePerSample, flagged };
+}
+
+export const SoakThresholds = {
+  rss: { minRelative: 0.1, minAbsolute: 16 * MiB },
+  heapUsed: { minRelative: 0.1, minAbsolute: 8 * MiB },
+  external: { minRelative: 0.1, minAbsolute: 8 * MiB },
+  fds: { minRelative: 0, minAbsolute: 4 },
+  threads: { minRelative: 0, minAbsolute: 2 },
+  latency: { minRelative: 0.5, minAbsolute: 2 },
+} as const satisfies Record<string, TrendThreshold>;
+
+/**
+ * Every trend across `samples`, which should exclude warm-up: resources, and
+ * p50 and p99 latency of each operation.
+ */
+export function analyzeSoak(samples: readonly SoakSample[]): Trend[] {
+  const trends: Trend[] = [];
+  for (const metric of ["rss", "heapUsed", "external"] as const) {
+    trends.push(
+      detectTrend(
+        metric,
+        samples.map((ea) => ea[metric]),
+        SoakThresholds[metric],
+      ),
+    );
+  }
+  for (const metric of ["fds", "threads"] as const) {
+    const values = samples.map((ea) => ea[metric]).filter((ea) => ea != null);
+    if (values.length === samples.length) {
+      trends.push(detectTrend(metric, values, SoakThresholds[metric]));
+    }
+  }
+  const ops = new Set(samples.flatMap((ea) => Object.keys(ea.ops)));
+  for (const op of ops) {
+    // Windows in which the op didn't run say nothing about its latency.
+    const ran = samples.filter((ea) => (ea.ops[op]?.count ?? 0) > 0);
+    for (const p of ["p50", "p99"] as const) {
+      trends.push(
+        detectTrend(
+          `${op} ${p}`,
+          ran.map((ea) => ea.ops[op]?.[p] ?? 0),
+          SoakThresholds.latency,
+        ),
+      );
+    }
+  }
+  return trends;
+}
@@ -0,0 +1,275 @@
+#!/usr/bin/env tsx
+
+/**
+ * Soak benchmark: polls the public APIs back to back for hours, against the
+ * real mount table and (on Linux) a large synthetic one, with worker_thread
+ * churn. Every sampling window it records RSS, V8 heap, open descriptors,
+ * thread count and per-operation latency percentiles, appended as JSON lines
+ * to `--out`. At the end, upward trends after warm-up fail the run.
+ *
+ * Slow leaks and latency drift only show up after hours of this; the
+ * memory checks in memory-test-core.ts run seconds-long workloads.
+ *
+ * Usage:
+ *   npm run check:soak -- --duration=8h --interval=5m
+ *   npm run check:soak -- --duration=2m --interval=10s   # smoke test
+ */
+
+import { appendFileSync, mkdirSync, writeFileSync } from "node:fs";
+import { mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { performance } from "node:perf_hooks";
+import { parseArgs } from "node:util";
+import { Worker } from "node:worker_threads";
+import { _dirname } from "../dirname";
+import { findAncestorDirSync } from "../fs";
+import {
+  getAllVolumeMetadata,
+  getAllVolumeMetadataProgressive,
+  getVolumeMetadata,
+  getVolumeMetadataForPath,
+  getVolumeMountPoints,
+  isHidden,
+} from "../index";
+import { isLinux } from "../platform";
+import { fmtBytes, HourMs, MinuteMs, SecondMs } from "../units";
+import {
+  analyzeSoak,
+  countOpenFds,
+  countThreads,
+  MinTrendSamples,
+  type SoakSample,
+  toOpStats,
+} from "./soak-core";
+
+// Enable garbage collection access
+declare const global: {
+  gc?: () => void;
+} & typeof globalThis;
+
+const isWindows = process.platform === "win32";
+const colors = {
+  RED: isWindows ? "" : "\x1b[31m",
+  GREEN: isWindows ? "" : "\x1b[32m",
+  BLUE: isWindows ? "" : "\x1b[34m",
+  RESET: isWindows ? "" : "\x1b[0m",
+};
+
+// Mount table entries in the synthetic table, and how many of them are real
+// directories the native probe can stat.
+const SyntheticMounts = 2_000;
+const SyntheticRealMounts = 50;
+
+// Fraction of the run treated as warm-up: caches filling and the heap
+// settling aren't leaks.
+const WarmupFraction = 0.2;
+
+function parseDuration(value: string): number {
+  const m = /^(\d+(?:\.\d+)?)(ms|s|m|h)?$/.exec(value.trim());
+  if (m == null) throw new Error("Invalid duration: " + value);
+  const unit = { ms: 1, s: SecondMs, m: MinuteMs, h: HourMs }[m[2] ?? "ms"];
+  return Number(m[1]) * (unit ?? 1);
+}
+
+async function writeSyntheticMountTable(root: string): Promise<string> {
+  const lines: string[] = [];
+  for (let i = 0; i < SyntheticMounts; i++) {
+    if (i < SyntheticRealMounts) {
+      const dir = join(root, `vol${i}`);
+      mkdirSync(dir, { recursive: true });
+      lines.push(`/dev/fake${i} ${dir} ext4 rw,relatime 0 0`);
+    } else if (i % 3 === 0) {
+      // Never probed with skipNetworkVolumes:
+      lines.push(`server${i}:/export ${join(root, `nfs${i}`)} nfs rw 0 0`);
+    } else {
+      // Missing mount points exercise the error paths:
+      lines.push(`/dev/gone${i} ${join(root, `gone${i}`)} xfs rw 0 0`);
+    }
+  }
+  const mtab = join(root, "mtab");
+  await writeFile(mtab, lines.join("\n") + "\n");
+  return mtab;
+}
+
+// Loads the addon in a fresh worker_thread, probes one volume, and exits:
+// exercises per-env init and teardown of the native module.
+function workerChurn(mountPoint: string): Promise<void> {
+  const root = findAncestorDirSync(_dirname(), "binding.gyp");
+  if (root == null) throw new Error("binding.gyp not found");
+  const worker = new Worker(
+    `
+    const { createRequire } = require("node:module");
+    const { workerData } = require("node:worker_threads");
+    const req = createRequire(workerData.packageJson);
+    const native = req("node-gyp-build")(workerData.root);
+    native.getVolumeMetadata({ mountPoint: workerData.mountPoint });
+    `,
+    {
+      eval: true,
+      workerData: {
+        root,
+        packageJson: join(root, "package.json"),
+        mountPoint,
+      },
+    },
+  );
+  return new Promise((resolve, reject) => {
+    worker.once("error", reject);
+    worker.once("exit", () => resolve());
+  });
+}
+
+async function main(): Promise<void> {
+  const { values } = parseArgs({
+    options: {
+      duration: { type: "string", default: "4h" },
+      interval: { type: "string", default: "1m" },
+      out: { type: "string" },
+    },
+  });
+  const durationMs = parseDuration(values.duration);
+  const intervalMs = parseDuration(values.interval);
+  const windows = Math.floor(durationMs / intervalMs);
+  const steadyWindows = windows - Math.floor(windows * WarmupFraction);
+  if (steadyWindows < MinTrendSamples) {
+    throw new Error(
+      `--duration=${values.duration} with --interval=${values.interval} ` +
+        `leaves ${steadyWindows} samples after warm-up, but trends need ` +
+        `at least ${MinTrendSamples}`,
+    );
+  }
+  const out =
+    values.out ?? join(tmpdir(), `fs-metadata-soak-${Date.now()}.jsonl`);
+
+  console.log(`${colors.BLUE}=== Soak Benchmark ===${colors.RESET}`);
+  console.log(`Platform: ${process.platform}, Node ${process.version}`);
+  console.log(
+    `Duration: ${values.duration}, sampling every ${values.interval}`,
+  );
+  console.log(`Samples: ${out}`);
+  if (!global.gc) {
+    console.log("(run with --expose-gc for steadier memory samples)");
+  }
+  const root = await mkdtemp(join(tmpdir(), "fs-metadata-soak-"));
+  const file = join(root, "file.txt");
+  await writeFile(file, "soak");
+  const mtab = isLinux ? await writeSyntheticMountTable(root) : undefined;
+  const synthetic = {
+    linuxMountTablePaths: mtab == null ? [] : [mtab],
+    includeSystemVolumes: true,
+    skipNetworkVolumes: true,
+  };
+
+  const ops: [string, () => Promise<unknown>][] = [
+    ["getVolumeMountPoints", () => getVolumeMountPoints()],
+    ["getVolumeMetadata", () => getVolumeMetadata(tmpdir())],
+    ["getVolumeMetadataForPath", () => getVolumeMetadataForPath(file)],
+    ["isHidden", () => isHidden(file)],
+    ["getAllVolumeMetadata", () => getAllVolumeMetadata()],
+    [
+      "getAllVolumeMetadataProgressive",
+      async () => (await getAllVolumeMetadataProgressive()).results,
+    ],
+    ["workerChurn", () => workerChurn(tmpdir())],
+  ];
+  if (mtab != null) {
+    ops.push(
+      [
+        "getVolumeMountPoints (synthetic)",
+        () => getVolumeMountPoints(synthetic),
+      ],
+      [
+        "getAllVolumeMetadata (synthetic)",
+        () => getAllVolumeMetadata(synthetic),
+      ],
+    );
+  }
+
+  writeFileSync(out, "");
+  const samples: SoakSample[] = [];
+  const start = performance.now();
+  let latencies = new Map<string, number[]>();
+  let errors = new Map<string, number>();
+  let windowEnd = start + intervalMs;
+
+  for (let i = 0; performance.now() - start < durationMs; i++) {
+    const [name, fn] = ops[i % ops.length] as (typeof ops)[number];
+    const t0 = performance.now();
+    try {
+      await fn();
+    } catch {
+      errors.set(name, (errors.get(name) ?? 0) + 1);
+    }
+    const list = latencies.get(name) ?? [];
+    list.push(performance.now() - t0);
+    latencies.set(name, list);
+
+    if (performance.now() >= windowEnd) {
+      global.gc?.();
+      const mem = process.memoryUsage();
+      const sample: SoakSample = {
+        elapsedMs: Math.round(performance.now() - start),
+        rss: mem.rss,
+        heapUsed: mem.heapUsed,
+        external: mem.external,
+        fds: countOpenFds(),
+        threads: countThreads(),
+        ops: Object.fromEntries(
+          [...latencies].map(([op, ms]) => [
+            op,
+            toOpStats(ms, errors.get(op) ?? 0),
+          ]),
+        ),
+      };
+      samples.push(sample);
+      appendFileSync(out, JSON.stringify(sample) + "\n");
+      console.log(
+        `[${(sample.elapsedMs / MinuteMs).toFixed(1)}m] ` +
+          `rss ${fmtBytes(sample.rss)}, heap ${fmtBytes(sample.heapUsed)}, ` +
+          `fds ${sample.fds ?? "?"}, threads ${sample.threads ?? "?"}`,
+      );
+      latencies = new Map();
+      errors = new Map();
+      windowEnd = performance.now() + intervalMs;
+    }
+  }
+
+  await rm(root, { recursive: true, force: true });
+
+  const steady = samples.slice(Math.floor(samples.length * WarmupFraction));
+  if (steady.length < MinTrendSamples) {
+    // Operations slower than the interval stretch the windows: with too few
+    // samples no trend can be flagged, so "no upward trends" would mean
+    // nothing.
+    console.log(
+      `\n${colors.RED}Only ${steady.length} samples after warm-up; ` +
+        `trends need at least ${MinTrendSamples}. Samples: ${out}` +
+        colors.RESET,
+    );
+    process.exit(1);
+  }
+  const trends = analyzeSoak(steady);
+  console.log(`\n${colors.BLUE}=== Trends after warm-up ===${colors.RESET}`);
+  for (const t of trends) {
+    const line = `${t.metric}: ${t.start.toFixed(1)} -> ${t.end.toFixed(1)}`;
+    console.log(
+      t.flagged ? `${colors.RED}✗ ${line}${colors.RESET}` : `  ${line}`,
+    );
+  }
+  const flagged = trends.filter((ea) => ea.flagged);
+  if (flagged.length > 0) {
+    console.log(
+      `\n${colors.RED}${flagged.length} upward trend(s). Samples: ${out}` +
+        colors.RESET,
+    );
+    process.exit(1);
+  }
+  console.log(`\n${colors.GREEN}No upward trends.${colors.RESET}`);
+  process.exit(0);
+}
+
+main().catch((error) => {
+  console.error(`${colors.RED}Unhandled error:${colors.RESET}`, error);
+  process.exit(1);
+});
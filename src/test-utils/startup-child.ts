@@ -0,0 +1,66 @@
+// src/test-utils/startup-child.ts
+//
+// Imports one entry point in a fresh process and calls it once. Prints
+// {importMs, firstResultMs, nativeLoads} as JSON. See src/startup.test.ts.
+
+import { performance } from "node:perf_hooks";
+
+type Entry = "index" | "hidden" | "mount-points";
+
+const Modules: Record<Entry, string> = {
+  index: "../index",
+  hidden: "../hidden_entry",
+  "mount-points": "../mount_points_entry",
+};
+
+interface EntryModule {
+  isHidden?: (pathname: string) => Promise<boolean>;
+  getVolumeMountPoints?: (opts?: object) => Promise<unknown[]>;
+}
+
+async function main() {
+  const entry = process.argv[2] as Entry;
+  const target = process.argv[3] ?? process.cwd();
+  if (!(entry in Modules)) {
+    throw new Error("Unknown entry point: " + entry);
+  }
+
+  // Counts native addons loaded, by any loader.
+  let nativeLoads = 0;
+  const dlopen = process.dlopen;
+  process.dlopen = (...args: Parameters<typeof process.dlopen>) => {
+    nativeLoads++;
+    return dlopen.apply(process, args);
+  };
+
+  const start = performance.now();
+  const mod = (await import(Modules[entry])) as EntryModule;
+  const importMs = performance.now() - start;
+  const nativeLoadsAtImport = nativeLoads;
+
+  const result =
+    entry === "mount-points"
+      ? (await mod.getVolumeMountPoints?.({ skipNetworkVolumes: true }))
+          ?.length
+      : await mod.isHidden?.(target);
+  const firstResultMs = performance.now() - start;
+
+  process.stdout.write(
+    JSON.stringify({
+      importMs,
+      firstResultMs,
+      nativeLoadsAtImport,
+      nativeLoads,
+      result,
+    }),
+  );
+}
+
+main().then(
+  () => process.exit(0),
+  (err) => {
+    const errorMessage = err instanceof Error ? err.stack : String(err);
+    process.stderr.write(`Error in startup-child: ${errorMessage}\n`);
+    process.exit(1);
+  },
+);
@@ -0,0 +1,108 @@
+// src/types/block_device.ts
+
+/**
+ * The bus a block device is attached through, as derived from its sysfs
+ * device path. `"loop"` is a loop device, and `"virtual"` any other device
+ * the kernel made up (device-mapper, md, zram) that isn't backed by exactly
+ * one other device.
+ */
+export type BlockTransport =
+  | "usb"
+  | "mmc"
+  | "nvme"
+  | "ata"
+  | "scsi"
+  | "virtio"
+  | "firewire"
+  | "loop"
+  | "virtual";
+
+/**
+ * How a block device is attached, from sysfs.
+ */
+export interface BlockDeviceClass {
+  major: number;
+  minor: number;
+
+  /**
+   * The disk's sysfs `removable` flag: set for card readers and optical
+   * drives, but often not for USB sticks and external disks, so check
+   * {@link transport} too.
+   */
+  removable: boolean;
+
+  /**
+   * Undefined if the device path matches no known bus. Device-mapper and md
+   * devices on top of a single device (such as LUKS on a USB stick) report
+   * that device's transport.
+   */
+  transport?: BlockTransport;
+}
+
+/**
+ * Restricts enumeration to volumes on matching block devices. See
+ * {@link Options.blockDeviceFilter}.
+ */
+export interface BlockDeviceFilter {
+  /**
+   * Match devices with removable media.
+   */
+  removable?: boolean;
+
+  /**
+   * Match devices attached through any of these buses.
+   */
+  transports?: BlockTransport[];
+}
+
+/**
+ * A block device, mounted or not, as listed by {@link getBlockDevices}.
+ */
+export interface BlockDevice extends BlockDeviceClass {
+  /**
+   * The device node, like `/dev/sdb1`.
+   */
+  device: string;
+
+  /**
+   * `"partition"`, or `"disk"` for any whole device: physical disks, and
+   * also device-mapper, md and loop devices.
+   */
+  type: "disk" | "partition";
+
+  /**
+   * For partitions, the disk's device node, like `/dev/sdb`.
+   */
+  disk?: string;
+
+  /**
+   * Size in bytes.
+   */
+  size: number;
+
+  readOnly: boolean;
+
+  /**
+   * Filesystem (or other content: `"swap"`, `"crypto_LUKS"`) found on the
+   * device. Undefined if there is none, or it could not be identified.
+   */
+  fstype?: string;
+
+  uuid?: string;
+
+  label?: string;
+
+  /**
+   * Where the device is mounted, from the mount table. Empty if it isn't.
+   */
+  mountPoints: string[];
+}
+
+/**
+ * The filesystem identity the native addon found on one block device.
+ */
+export interface BlockDeviceIdentity {
+  fstype: string;
+  uuid?: string;
+  label?: string;
+}
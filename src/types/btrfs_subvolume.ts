@@ -0,0 +1,45 @@
+// src/types/btrfs_subvolume.ts
+
+/**
+ * One btrfs subvolume, as enumerated by {@link getBtrfsSubvolumes}.
+ */
+export interface BtrfsSubvolume {
+  /**
+   * The subvolume id, as used by the `subvolid=` mount option. Unique and
+   * never reused within one filesystem.
+   */
+  id: number;
+
+  /**
+   * The id of the subvolume containing this one (5 for children of the
+   * top-level subvolume).
+   */
+  parentId: number;
+
+  /**
+   * The last transaction that modified this subvolume, as of enumeration.
+   */
+  generation: number;
+
+  /**
+   * Path relative to the mount point that was enumerated. The empty string
+   * for that mount point's own subvolume.
+   */
+  path: string;
+
+  /**
+   * The subvolume's UUID. See {@link VolumeMetadata.subvolumeUuid}.
+   */
+  uuid: string;
+
+  /**
+   * For snapshots, the UUID of the subvolume the snapshot was taken from.
+   */
+  parentUuid?: string;
+
+  /**
+   * For subvolumes created by `btrfs receive`, the UUID of the sent
+   * subvolume.
+   */
+  receivedUuid?: string;
+}
@@ -0,0 +1,35 @@
+// src/types/cache.ts
+
+/**
+ * Counters and size of one cache, from {@link getCacheStats}.
+ */
+export interface CacheStats {
+  name: string;
+  /** True for caches held by the native module. */
+  native: boolean;
+  entries: number;
+  /** Estimated memory held, in bytes. */
+  bytes: number;
+  /** File descriptors held open between calls. */
+  fds: number;
+  hits: number;
+  misses: number;
+  /** Entries dropped to stay within the budget. */
+  evictions: number;
+}
+
+/**
+ * Limits shared by every cache, set with {@link setCacheBudget}.
+ *
+ * `maxBytes` applies to the JavaScript caches together, and separately to the
+ * native caches together: within each, the least recently used entry of any
+ * cache is evicted first.
+ * The native mountinfo snapshot, which can't be partly evicted, is capped on
+ * its own instead: it's kept only if it alone fits in `maxBytes`. `maxFds`
+ * caps the descriptors native caches may keep open; beyond it they reopen
+ * files on every use instead. Lowering it closes held descriptors at once.
+ */
+export interface CacheBudget {
+  maxBytes: number;
+  maxFds: number;
+}
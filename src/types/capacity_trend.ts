@@ -0,0 +1,59 @@
+// src/types/capacity_trend.ts
+
+/**
+ * How fast a probed volume is filling, as returned by
+ * {@link VolumeProbe.trend}. Rates are least-squares fits over the probe's
+ * recent samples, so one noisy reading doesn't swing the estimate.
+ */
+export interface CapacityTrend {
+  /**
+   * Number of samples the estimates are based on: one from when the probe was
+   * created, plus one per successful refresh, up to the probe's
+   * `historySize`.
+   */
+  samples: number;
+
+  /**
+   * Seconds between the oldest and newest sample.
+   */
+  spanSeconds: number;
+
+  /**
+   * Used bytes at the newest sample.
+   */
+  used: number;
+
+  /**
+   * Available bytes at the newest sample.
+   */
+  available: number;
+
+  /**
+   * Growth of used space, in bytes per second. Negative while the volume is
+   * emptying; 0 with fewer than two samples.
+   */
+  bytesPerSecond: number;
+
+  /**
+   * Estimated seconds until {@link available} reaches zero at the current
+   * {@link bytesPerSecond}. Undefined unless the volume is filling.
+   */
+  secondsToFull?: number;
+
+  /**
+   * Free inodes at the newest sample. Undefined (as are the other inode
+   * fields) where the filesystem doesn't report inode counts.
+   */
+  inodesFree?: number;
+
+  /**
+   * Growth of used inodes, per second.
+   */
+  inodesPerSecond?: number;
+
+  /**
+   * Estimated seconds until {@link inodesFree} reaches zero. Undefined unless
+   * inode use is growing.
+   */
+  secondsToInodesExhausted?: number;
+}
@@ -88,6 +88,25 @@ export interface MountPoint {
    */
   subvolid?: number;
 
+  /**
+   * Linux only: true for snapshot mounts, detected from the mount table
+   * without touching the volume. Covers ZFS snapshots (a `pool/fs@snap`
+   * source, including those automounted under `.zfs/snapshot/`) and the
+   * `#snapshot` directories Synology and Kubernetes snapshot tooling mount.
+   *
+   * Enumeration leaves snapshot mounts unprobed unless
+   * {@link Options.probeSnapshots} is true, so their
+   * {@link MountPoint.status} stays undefined.
+   */
+  isSnapshot?: boolean;
+
+  /**
+   * For snapshot mounts, the mount point of the volume the snapshot was taken
+   * from, when that can be determined from the mount table. Group snapshots
+   * by this to keep thousands of them out of a volume list.
+   */
+  snapshotOrigin?: string;
+
   /**
    * Whether the volume is mounted read-only.
    *
@@ -1,7 +1,15 @@
 // src/types/native_bindings.ts
 
+import type {
+  BlockDeviceClass,
+  BlockDeviceIdentity,
+} from "./block_device";
+import type { BtrfsSubvolume } from "./btrfs_subvolume";
+import type { CacheBudget, CacheStats } from "./cache";
+import type { CapacityTrend } from "./capacity_trend";
 import type { MountPoint } from "./mount_point";
 import type { Options } from "./options";
+import type { SharedVolumeCacheEntry } from "./shared_volume_cache_entry";
 import type { VolumeMetadata } from "./volume_metadata";
 
 export interface NativeBindings {
@@ -18,6 +26,29 @@ export interface NativeBindings {
    */
   setDebugPrefix(prefix: string): void;
 
+  /**
+   * True only in Debug and `FS_METADATA_TEST_HOOKS=1` builds, which honor
+   * test-only fault injection such as `FS_METADATA_INJECT_PROBE_HANG_MS`.
+   * Release builds omit it.
+   */
+  testHooks?: boolean;
+
+  /**
+   * Test hooks only, on Linux: parses each line of `content` as the native
+   * mountinfo cache does, or returns null for a line it rejects.
+   */
+  parseMountInfoForTest?(content: string): (ParsedMountInfoLine | null)[];
+
+  /**
+   * Test hooks only, on Linux: classifies the block device `majMin`
+   * ("8:16") as {@link classifyBlockDevices} does, but from the sysfs tree
+   * at `sysfsRoot`. Null if the tree has no such device.
+   */
+  classifySysfsBlockDeviceForTest?(
+    sysfsRoot: string,
+    majMin: string,
+  ): Omit<BlockDeviceClass, "major" | "minor"> | null;
+
   /**
    * This is only available on macOS and Windows--Linux only hides files via
    * filename (if basename starts with a dot).
@@ -50,6 +81,181 @@ export interface NativeBindings {
    */
   getVolumeMetadata(options: GetVolumeMetadataOptions): Promise<VolumeMetadata>;
 
+  /**
+   * Decode a full (non-delta) snapshot from `encodeVolumeSnapshot()` straight
+   * out of `bytes`, without copying it. Synchronous.
+   */
+  decodeVolumeSnapshot?(bytes: Uint8Array): VolumeMetadata[];
+
+  /**
+   * Opens `path` as a directory and reads one entry, on the addon's own
+   * thread pool rather than libuv's. Rejects with a `code` (`ENOTCONN`,
+   * `EACCES`, ...) as node:fs would. No timeout: a read stuck on a dead mount
+   * stays pending.
+   */
+  canReaddir?(path: string): Promise<true>;
+
+  /**
+   * Sizes and counters of every native cache. Synchronous.
+   */
+  getNativeCacheStats?(): Omit<CacheStats, "native">[];
+
+  /**
+   * Budget for the native caches together. Omitted limits are unchanged.
+   * Throws a TypeError unless each given limit is a non-negative integer.
+   */
+  setNativeCacheBudget?(budget: Partial<CacheBudget>): void;
+
+  /**
+   * Linux only: {@link getVolumeMetadata} run synchronously on the calling
+   * thread, with no timeout. Only called for volumes the mount table reports
+   * as local.
+   */
+  getVolumeMetadataSync?(options: GetVolumeMetadataOptions): VolumeMetadata;
+
+  /**
+   * Linux only: metadata for the volume behind a descriptor the caller holds.
+   * The mount comes from the descriptor's mount id (statx `STATX_MNT_ID`)
+   * and a native /proc/self/mountinfo cache; every probe runs on a duplicate
+   * of `fd`. Also resolves the mount's options and its root within the
+   * filesystem.
+   */
+  getVolumeMetadataForFd?(
+    options: { fd: number } & Partial<Pick<Options, "includeQuota">>,
+  ): Promise<VolumeMetadata & { mountOptions: string; mountRoot: string }>;
+
+  /**
+   * Linux only: open and hold the mount point's descriptor for
+   * {@link refreshVolumeProbe}. Only `mountPoint`, `device`, `fstype`,
+   * `includeQuota` and `historySize` are read, once. The handle keeps the last
+   * `historySize` space samples (the first taken here) for
+   * {@link getVolumeProbeTrend}.
+   */
+  openVolumeProbe?(
+    options: GetVolumeMetadataOptions & { historySize?: number },
+  ): Promise<NativeVolumeProbeHandle>;
+
+  /**
+   * Linux only: re-read space (and quota, if the handle was opened with
+   * `includeQuota`) through the held descriptor. Identity fields are not
+   * populated.
+   */
+  refreshVolumeProbe?(handle: NativeVolumeProbeHandle): Promise<VolumeMetadata>;
+
+  /**
+   * Linux only: fill rates and time-to-full estimates from the handle's
+   * sample history. Synchronous, and still answers after close.
+   */
+  getVolumeProbeTrend?(handle: NativeVolumeProbeHandle): CapacityTrend;
+
+  /**
+   * Linux only: release the held descriptor. Later refreshes throw.
+   */
+  closeVolumeProbe?(handle: NativeVolumeProbeHandle): void;
+
+  /**
+   * Linux only: enumerate the btrfs subvolumes at or below the subvolume
+   * mounted at `mountPoint`, priming the native per-filesystem subvolume
+   * cache that {@link getVolumeMetadata} resolves `subvolid` through.
+   */
+  getBtrfsSubvolumes?(
+    options: Pick<GetVolumeMetadataOptions, "mountPoint">,
+  ): Promise<BtrfsSubvolume[]>;
+
+  /**
+   * Linux only: listen for kernel block-device uevents. While any monitor is
+   * running, {@link getVolumeMetadata} caches blkid identity per device
+   * number, and each event invalidates its device's entry. The native thread
+   * never keeps the event loop alive.
+   */
+  startUeventMonitor?(
+    callback: (event: NativeUevent) => void,
+  ): NativeUeventMonitorHandle;
+
+  /**
+   * Linux only: stop a monitor from {@link startUeventMonitor}. Idempotent.
+   */
+  stopUeventMonitor?(handle: NativeUeventMonitorHandle): void;
+
+  /**
+   * Linux only: classify each device node from sysfs, without opening it.
+   * Entries are null for anything that isn't a block device under `/dev`.
+   * Runs on a native worker thread; results are cached while a uevent
+   * monitor is running.
+   */
+  classifyBlockDevices?(
+    devices: string[],
+  ): Promise<(BlockDeviceClass | null)[]>;
+
+  /**
+   * Linux only: filesystem identity per device path, from the uevent-backed
+   * identity cache or libblkid's cache file, or (with `probe`) by reading
+   * the device. Entries are null where none of those identify a filesystem.
+   * Devices are handled one after another on a single worker thread.
+   */
+  getBlockDeviceIdentities?(
+    options: {
+      devices: string[];
+      probe?: boolean;
+    } & Partial<Pick<Options, "priority">>,
+  ): Promise<(BlockDeviceIdentity | null)[]>;
+
+  /**
+   * Linux only: map the shared-memory segment `/dev/shm/fs-metadata-<name>`,
+   * creating it with `sizeBytes` (header included) if it doesn't exist. An
+   * existing segment keeps its size. Synchronous, as are the other
+   * shared-cache calls.
+   */
+  openSharedVolumeCache?(options: {
+    name: string;
+    sizeBytes: number;
+  }): NativeSharedVolumeCacheHandle;
+
+  /**
+   * Linux only: decode the latest published snapshot, copied out under the
+   * segment's seqlock. No locks or syscalls. Null before the first publish,
+   * or if publishes kept racing the copy.
+   */
+  readSharedVolumeCache?(
+    handle: NativeSharedVolumeCacheHandle,
+  ): SharedVolumeCacheEntry | null;
+
+  /**
+   * Linux only: take, or renew, the segment's lease for `leaseMs`. Fails
+   * while another live process holds an unexpired lease.
+   */
+  tryAcquireSharedVolumeCacheLease?(
+    handle: NativeSharedVolumeCacheHandle,
+    leaseMs: number,
+  ): boolean;
+
+  /**
+   * Linux only: give up the lease, if this process holds it.
+   */
+  releaseSharedVolumeCacheLease?(handle: NativeSharedVolumeCacheHandle): void;
+
+  /**
+   * Linux only: replace the segment's snapshot with `bytes`, from
+   * `encodeVolumeSnapshot()`. False, and nothing written, unless this
+   * process holds the lease. Throws a RangeError if `bytes` doesn't fit.
+   */
+  publishSharedVolumeCache?(
+    handle: NativeSharedVolumeCacheHandle,
+    bytes: Uint8Array,
+  ): boolean;
+
+  /**
+   * Linux only: release the lease, if held, and unmap the segment. The
+   * segment itself persists. Idempotent.
+   */
+  closeSharedVolumeCache?(handle: NativeSharedVolumeCacheHandle): void;
+
+  /**
+   * Linux only: remove the named segment. Processes that have it mapped keep
+   * their mapping. False if there was none.
+   */
+  unlinkSharedVolumeCache?(name: string): boolean;
+
   /**
    * macOS only: lightweight mount point lookup using fstatfs().
    * Returns the f_mntonname for the given directory path without fetching
@@ -67,6 +273,77 @@ export type GetVolumeMetadataOptions = {
    * are not attempted on other filesystems.
    */
   fstype?: string;
-} & Partial<Pick<Options, "timeoutMs" | "skipNetworkVolumes">>;
+  /**
+   * btrfs `subvolid=` from the mount table. Lets the native Linux worker
+   * resolve the subvolume's identity from its per-filesystem cache.
+   */
+  subvolid?: number;
+  /**
+   * Linux only, with `includeQuota`: the directory whose quota to read, when
+   * it is not the mount point itself. Ignored unless it is on the same volume.
+   */
+  quotaPath?: string;
+} & Partial<
+  Pick<
+    Options,
+    "timeoutMs" | "skipNetworkVolumes" | "includeQuota" | "priority"
+  >
+>;
+
+/**
+ * Opaque native handle returned by {@link NativeBindings.openVolumeProbe}.
+ */
+export type NativeVolumeProbeHandle = { readonly __nativeVolumeProbe: never };
+
+/**
+ * Opaque native handle returned by
+ * {@link NativeBindings.openSharedVolumeCache}.
+ */
+export type NativeSharedVolumeCacheHandle = {
+  readonly __nativeSharedVolumeCache: never;
+};
+
+/**
+ * Delivered by {@link NativeBindings.startUeventMonitor}. `overflow` means
+ * events were lost (and the native identity cache was flushed); `error` is
+ * sent once, just before the monitor stops.
+ */
+export type NativeUevent = {
+  action: string;
+  major?: number;
+  minor?: number;
+  /**
+   * Relative to /dev, e.g. "sdb1".
+   */
+  devname?: string;
+  devtype?: string;
+  seqnum?: number;
+  diskMediaChange?: boolean;
+  diskEjectRequest?: boolean;
+  error?: string;
+};
+
+/**
+ * Opaque native handle returned by {@link NativeBindings.startUeventMonitor}.
+ */
+export type NativeUeventMonitorHandle = {
+  readonly __nativeUeventMonitor: never;
+};
+
+/**
+ * One line of `/proc/self/mountinfo`, from
+ * {@link NativeBindings.parseMountInfoForTest}, with octal escapes decoded
+ * and the superblock's options appended to the mount's.
+ */
+export type ParsedMountInfoLine = {
+  mountId: number;
+  root: string;
+  mountPoint: string;
+  fstype: string;
+  source: string;
+  mountOptions: string;
+};
 
 export type NativeBindingsFn = () => NativeBindings | Promise<NativeBindings>;
+
+export type NativeBindingsSyncFn = () => NativeBindings;
@@ -1,5 +1,6 @@
 // src/types/options.ts
 
+import type { BlockDeviceFilter } from "./block_device";
 import type { MountPoint } from "./mount_point";
 
 /**
@@ -32,6 +33,21 @@ export interface Options {
    * can match an entry with no path relationship to the target.
    */
   mountPoints?: MountPoint[];
+
+  /**
+   * Linux only: list (and, for {@link getAllVolumeMetadata}, probe) only
+   * volumes on block devices that are removable or attached through one of
+   * the given transports, such as `{ removable: true, transports: ["usb",
+   * "mmc"] }` for cameras, card readers and USB drives. `{}` matches every
+   * volume with a block device.
+   *
+   * Devices are classified from the mount table and sysfs before any volume
+   * is touched, so volumes that don't match (including every network and
+   * virtual filesystem) are never health-checked or probed.
+   *
+   * Other platforms reject this option.
+   */
+  blockDeviceFilter?: BlockDeviceFilter;
   /**
    * Timeout in milliseconds for filesystem operations.
    *
@@ -120,13 +136,92 @@ export interface Options {
    * {@link VolumeMetadata.zfsDatasetGuid} and
    * {@link VolumeMetadata.zfsPoolGuid}.
    *
+   * Also reads {@link VolumeMetadata.zfsObjsetId} (and, where OpenZFS
+   * publishes it, the pool GUID) from `/proc/spl/kstat/zfs`, which needs no
+   * subprocess.
+   *
    * Defaults to `false`. Enabling this adds subprocess overhead and requires
    * the OpenZFS command-line tools. Query failures leave the optional fields
    * undefined without failing the metadata request.
    */
   includeZfsGuids?: boolean;
+
+  /**
+   * On Linux, read the kernel's quota accounting for the volume (or, for
+   * {@link getVolumeMetadataForPath}, the given directory) and expose the
+   * most restrictive limit as {@link VolumeMetadata.quotaType},
+   * {@link VolumeMetadata.quotaLimit}, {@link VolumeMetadata.quotaUsed}, and
+   * {@link VolumeMetadata.quotaAvailable}.
+   *
+   * Covers ext4/xfs project quotas (which need `CAP_SYS_ADMIN` to read), the
+   * calling user's ext2/3/4/xfs quota, and btrfs qgroup limits (Linux >= 5.9).
+   * Each lookup is a single syscall or sysfs read, with no directory walks.
+   *
+   * Defaults to `false`. Quotas that are disabled, unsupported, or unreadable
+   * leave the fields undefined without failing the metadata request.
+   */
+  includeQuota?: boolean;
+
+  /**
+   * Health-probe and fetch metadata for snapshot mounts (see
+   * {@link MountPoint.isSnapshot}) during enumeration.
+   *
+   * Defaults to `false`: {@link getVolumeMountPoints} and
+   * {@link getAllVolumeMetadata} return snapshot mounts with only their
+   * mount-table fields, so the cost of a sweep doesn't grow with the number
+   * of snapshots. Asking for one snapshot by path, as with
+   * {@link getVolumeMetadata}, always probes it.
+   */
+  probeSnapshots?: boolean;
+
+  /**
+   * Run the JavaScript side of the call (mount table parsing, glob matching,
+   * health checks, sorting, and result assembly) in a private
+   * `worker_thread` shared by all calls, instead of on the calling thread.
+   * Results come back as a single transferred buffer, so the main event loop
+   * sees one message per call and its latency stays flat during large
+   * {@link getAllVolumeMetadata} sweeps.
+   *
+   * Defaults to `false`. The worker starts on first use and never keeps the
+   * process alive while idle. Falls back to the calling thread when the
+   * bundled worker script is unavailable (for example, when running from
+   * TypeScript sources). Errors cross the thread boundary with their `name`,
+   * `message`, and errno details, but not their stack.
+   */
+  useWorkerThread?: boolean;
+
+  /**
+   * Longest stretch, in milliseconds, that {@link getVolumeMountPoints} and
+   * {@link getAllVolumeMetadata} spend in synchronous post-processing
+   * (filtering, system-volume classification, de-duplication and result
+   * assembly) before yielding to the event loop. Only hosts with thousands of
+   * mounts come close.
+   *
+   * Defaults to `10`. `0` disables yielding.
+   */
+  yieldBudgetMs?: number;
+
+  /**
+   * Scheduling class for native probe work. `"background"` probes run on
+   * their own threads (at most two), with idle I/O priority and a higher
+   * nice value on Linux, background QoS on macOS, and background mode on
+   * Windows, so periodic sweeps don't compete with the app's own disk I/O.
+   * Expect them to take longer on a busy system. A thread stuck on a dead
+   * mount for more than 5 seconds is replaced rather than counted toward
+   * that limit.
+   *
+   * Defaults to `"normal"`. Applies to the metadata probes of
+   * {@link getVolumeMetadata} and {@link getAllVolumeMetadata}, and to
+   * {@link getBlockDevices}' libblkid reads.
+   */
+  priority?: ProbePriority;
 }
 
+/**
+ * See {@link Options.priority}.
+ */
+export type ProbePriority = "normal" | "background";
+
 /**
  * Options after defaults have been applied.
  *
@@ -134,4 +229,14 @@ export interface Options {
  * not a defaulted setting.
  */
 export type ResolvedOptions = Options &
-  Required<Pick<Options, "includeZfsGuids">>;
+  Required<
+    Pick<
+      Options,
+      | "includeZfsGuids"
+      | "includeQuota"
+      | "probeSnapshots"
+      | "useWorkerThread"
+      | "yieldBudgetMs"
+      | "priority"
+    >
+  >;
@@ -0,0 +1,31 @@
+// src/types/shared_volume_cache_entry.ts
+
+import type { VolumeMetadata } from "./volume_metadata";
+
+/**
+ * The latest result published to a shared volume cache, as returned by
+ * {@link SharedVolumeCache.read}.
+ */
+export interface SharedVolumeCacheEntry {
+  /**
+   * What {@link getAllVolumeMetadata} returned in the publishing process.
+   */
+  volumes: VolumeMetadata[];
+
+  /**
+   * Counts publishes to the segment since it was created: two reads with the
+   * same generation saw the same result.
+   */
+  generation: number;
+
+  /**
+   * When it was published, in milliseconds since the epoch.
+   */
+  publishedAt: number;
+
+  /**
+   * Milliseconds since it was published, by the monotonic clock, so it's
+   * immune to wall-clock changes.
+   */
+  ageMs: number;
+}
@@ -26,6 +26,21 @@ export interface VolumeMetadata extends RemoteInfo, MountPoint {
    */
   available?: number;
 
+  /**
+   * Total inodes (`statvfs` `f_files`), on Linux and macOS.
+   *
+   * Undefined where the filesystem doesn't have a fixed inode table to report,
+   * like btrfs, vfat and most network filesystems.
+   */
+  inodes?: number;
+
+  /**
+   * Free inodes (`statvfs` `f_ffree`). A volume with no free inodes rejects new
+   * files however much space is {@link available}. Present whenever
+   * {@link inodes} is.
+   */
+  inodesFree?: number;
+
   /**
    * Path to the device or service that the mountpoint is from.
    *
@@ -76,6 +91,13 @@ export interface VolumeMetadata extends RemoteInfo, MountPoint {
    */
   subvolumeUuid?: string;
 
+  /**
+   * On btrfs snapshots, the {@link subvolumeUuid} of the subvolume the
+   * snapshot was taken from (the subvolume's `parent_uuid`). Undefined for
+   * subvolumes that are not snapshots, and on other filesystems.
+   */
+  subvolumeParentUuid?: string;
+
   /**
    * A quick filesystem identifier read from `statfs(2)`'s `f_fsid`, rendered as
    * a 16-character lowercase hex string.
@@ -108,8 +130,47 @@ export interface VolumeMetadata extends RemoteInfo, MountPoint {
    * decimal string to avoid JavaScript precision loss.
    *
    * Linux ZFS only, and populated only when {@link Options.includeZfsGuids} is
-   * true and the external `zpool` command succeeds. An administrator can change
-   * this value explicitly with `zpool reguid`.
+   * true and either OpenZFS publishes `/proc/spl/kstat/zfs/<pool>/guid` or the
+   * external `zpool` command succeeds. An administrator can change this value
+   * explicitly with `zpool reguid`.
    */
   zfsPoolGuid?: string;
+
+  /**
+   * The ZFS objset id of the mounted dataset, as a decimal string: unique
+   * within its pool for the dataset's lifetime, but reassigned by
+   * `zfs send`/`receive`. Combine with {@link zfsPoolGuid} for a host-wide
+   * identity.
+   *
+   * Linux ZFS only, and populated only when {@link Options.includeZfsGuids} is
+   * true. Read from `/proc/spl/kstat/zfs/<pool>/objset-*`, so it needs
+   * neither the `zfs` command nor `/dev/zfs`.
+   */
+  zfsObjsetId?: string;
+
+  /**
+   * Which quota produced {@link quotaLimit}: an ext4/xfs `"project"` quota,
+   * the calling `"user"`'s quota, or a btrfs `"qgroup"`. When several apply,
+   * the one with the least space left wins.
+   *
+   * Linux only, and populated only when {@link Options.includeQuota} is true
+   * and a limit is set.
+   */
+  quotaType?: "project" | "user" | "qgroup";
+
+  /**
+   * Quota limit in bytes. See {@link quotaType}.
+   */
+  quotaLimit?: number;
+
+  /**
+   * Bytes charged against {@link quotaLimit}, from the kernel's accounting.
+   */
+  quotaUsed?: number;
+
+  /**
+   * Bytes left under {@link quotaLimit}. The space actually writable is the
+   * smaller of this and {@link available}.
+   */
+  quotaAvailable?: number;
 }
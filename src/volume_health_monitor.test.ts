@@ -0,0 +1,238 @@
+// src/volume_health_monitor.test.ts
+
+import { TimeoutError } from "./async";
+import { createVolumeHealthMonitor } from "./index";
+import type { MountPoint } from "./types/mount_point";
+import type {
+  VolumeHealthChange,
+  VolumeHealthMonitor,
+  VolumeHealthMonitorDeps,
+} from "./volume_health_monitor";
+import { createVolumeHealthMonitorImpl } from "./volume_health_monitor";
+import type { VolumeHealthStatus } from "./volume_health_status";
+
+// What each scripted status looks like to the directory read:
+const Failures: Partial<Record<VolumeHealthStatus, () => Error>> = {
+  timeout: () => new TimeoutError("timeout"),
+  inaccessible: () =>
+    Object.assign(new Error("inaccessible"), { code: "EACCES" }),
+  disconnected: () =>
+    Object.assign(new Error("disconnected"), { code: "ENOTCONN" }),
+  unknown: () => new Error("unknown"),
+};
+
+const nativeFn = () => {
+  throw new Error("native bindings must not be used");
+};
+
+function delay(ms: number) {
+  return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+async function until(predicate: () => boolean, timeoutMs = 2_000) {
+  const deadline = Date.now() + timeoutMs;
+  while (!predicate()) {
+    if (Date.now() > deadline) throw new Error("condition not met in time");
+    await delay(5);
+  }
+}
+
+describe("createVolumeHealthMonitor()", () => {
+  let monitor: VolumeHealthMonitor | undefined;
+  let mountPoints: MountPoint[];
+  let statuses: Map<string, VolumeHealthStatus[]>;
+  let probed: string[];
+
+  const start = (
+    overrides: Partial<VolumeHealthMonitorDeps> = {},
+    opts: Parameters<typeof createVolumeHealthMonitorImpl>[0] = {},
+  ) => {
+    const m = createVolumeHealthMonitorImpl(
+      {
+        intervalMs: 10,
+        jitter: 0,
+        maxBackoffMs: 40,
+        mountTableIntervalMs: 60_000,
+        ...opts,
+      },
+      nativeFn,
+      {
+        listMountPoints: async () => mountPoints,
+        // Each volume replays its scripted statuses, then stays healthy:
+        readdir: async (mountPoint) => {
+          probed.push(mountPoint);
+          const status = statuses.get(mountPoint)?.shift() ?? "healthy";
+          const failure = Failures[status];
+          if (failure != null) throw failure();
+          return true;
+        },
+        ...overrides,
+      },
+    );
+    monitor = m;
+    return m;
+  };
+
+  beforeEach(() => {
+    mountPoints = [{ mountPoint: "/a" }, { mountPoint: "/b" }];
+    statuses = new Map();
+    probed = [];
+  });
+
+  afterEach(() => {
+    monitor?.close();
+    monitor = undefined;
+  });
+
+  it("emits only status transitions", async () => {
+    statuses.set("/a", ["healthy", "timeout", "timeout", "healthy"]);
+    const m = start();
+    const changes: VolumeHealthChange[] = [];
+    m.on("change", (ea) => changes.push(ea));
+    await until(() => changes.length >= 2);
+    await until(() => probed.filter((ea) => ea === "/b").length >= 4);
+
+    expect(
+      changes.map(({ mountPoint, previous, status }) => ({
+        mountPoint,
+        previous,
+        status,
+      })),
+    ).toEqual([
+      { mountPoint: "/a", previous: "healthy", status: "timeout" },
+      { mountPoint: "/a", previous: "timeout", status: "healthy" },
+    ]);
+    expect(changes[0]?.error?.message).toBe("timeout");
+    expect(m.statuses()).toEqual(
+      new Map([
+        ["/a", "healthy"],
+        ["/b", "healthy"],
+      ]),
+    );
+    expect(m.stats().transitions).toBe(2);
+  });
+
+  it("reports a volume that is unhealthy on its first check", async () => {
+    statuses.set("/b", ["disconnected"]);
+    const m = start();
+    const changes: VolumeHealthChange[] = [];
+    m.on("change", (ea) => changes.push(ea));
+    await until(() => changes.length >= 1);
+    expect(changes[0]).toMatchObject({
+      mountPoint: "/b",
+      status: "disconnected",
+    });
+    expect(changes[0]?.previous).toBeUndefined();
+  });
+
+  it("backs off unhealthy volumes", async () => {
+    statuses.set("/a", Array<VolumeHealthStatus>(100).fill("inaccessible"));
+    start();
+    await delay(200);
+    const a = probed.filter((ea) => ea === "/a").length;
+    const b = probed.filter((ea) => ea === "/b").length;
+    // /a waits 10, 20, 40, 40... ms between checks; /b every 10 ms.
+    expect(a).toBeGreaterThan(1);
+    expect(a).toBeLessThan(b);
+  });
+
+  it("emits removed and stops checking unmounted volumes", async () => {
+    const m = start();
+    const removed: string[] = [];
+    m.on("removed", (ea) => removed.push(ea));
+    await until(() => probed.includes("/b"));
+    mountPoints = [{ mountPoint: "/a" }];
+    await m.refresh();
+    expect(removed).toEqual(["/b"]);
+    const before = probed.filter((ea) => ea === "/b").length;
+    await delay(50);
+    expect(probed.filter((ea) => ea === "/b").length).toBe(before);
+    expect(m.stats().volumes).toBe(1);
+    expect(m.stats().mountTableReads).toBe(2);
+  });
+
+  it("caps concurrent checks with a shared pool", async () => {
+    mountPoints = Array.from({ length: 12 }, (_, i) => ({
+      mountPoint: "/v" + i,
+    }));
+    let inFlight = 0;
+    let maxInFlight = 0;
+    const m = start(
+      {
+        readdir: async () => {
+          maxInFlight = Math.max(maxInFlight, ++inFlight);
+          await delay(5);
+          inFlight--;
+          return true;
+        },
+      },
+      { maxConcurrency: 3 },
+    );
+    await until(() => m.stats().checks >= 24);
+    expect(maxInFlight).toBeLessThanOrEqual(3);
+    expect(m.stats().queuedChecks).toBeGreaterThan(0);
+    expect(m.stats().totalCheckMs).toBeGreaterThan(0);
+  });
+
+  it("waits on a stuck read instead of starting another", async () => {
+    mountPoints = [{ mountPoint: "/stuck" }, { mountPoint: "/b" }];
+    let unstick: (() => void) | undefined;
+    const m = start(
+      {
+        readdir: (mountPoint) => {
+          probed.push(mountPoint);
+          return mountPoint === "/stuck" && unstick == null
+            ? new Promise<true>((resolve) => (unstick = () => resolve(true)))
+            : Promise.resolve(true);
+        },
+      },
+      // One slot: a stuck read must not keep holding it.
+      { maxConcurrency: 1, timeoutMs: 20 },
+    );
+    await until(() => m.stats().stuckChecks >= 2);
+    expect(m.statuses().get("/stuck")).toBe("timeout");
+    expect(probed.filter((ea) => ea === "/stuck")).toHaveLength(1);
+    expect(probed.filter((ea) => ea === "/b").length).toBeGreaterThan(2);
+
+    unstick?.();
+    await until(() => m.statuses().get("/stuck") === "healthy");
+    await until(() => probed.filter((ea) => ea === "/stuck").length >= 2);
+  });
+
+  it("surfaces mount table failures to error listeners", async () => {
+    const m = start({
+      listMountPoints: async () => {
+        throw new Error("EACCES");
+      },
+    });
+    const errors: Error[] = [];
+    m.on("error", (ea) => errors.push(ea));
+    await m.refresh();
+    expect(errors.map((ea) => ea.message)).toEqual(["EACCES"]);
+  });
+
+  it("stops on close()", async () => {
+    const m = start();
+    await until(() => probed.length >= 2);
+    m.close();
+    m.close();
+    const before = probed.length;
+    await delay(50);
+    expect(probed.length).toBe(before);
+  });
+
+  it("rejects invalid schedules", () => {
+    expect(() => createVolumeHealthMonitor({ intervalMs: 0 })).toThrow(
+      /intervalMs/,
+    );
+    expect(() => createVolumeHealthMonitor({ jitter: 2 })).toThrow(/jitter/);
+  });
+
+  it("monitors real mount points", async () => {
+    const m = createVolumeHealthMonitor({ intervalMs: 50 });
+    monitor = m;
+    await m.refresh();
+    await until(() => m.statuses().size > 0, 10_000);
+    expect(m.stats().volumes).toBeGreaterThan(0);
+  });
+});
@@ -0,0 +1,394 @@
+// src/volume_health_monitor.ts
+
+import { EventEmitter } from "node:events";
+import { performance } from "node:perf_hooks";
+import { validateTimeoutMs, withTimeout } from "./async";
+import { debug } from "./debuglog";
+import { toError } from "./error";
+import { isNumber } from "./number";
+import { optionsWithDefaults } from "./options";
+import { isRemoteFsType } from "./remote_info";
+import type { MountPoint } from "./types/mount_point";
+import type { NativeBindingsFn } from "./types/native_bindings";
+import type { Options } from "./types/options";
+import type {
+  DirectoryStatus,
+  VolumeHealthStatus,
+} from "./volume_health_status";
+import { directoryStatus, VolumeHealthStatuses } from "./volume_health_status";
+import type { GetVolumeMountPointOptions } from "./volume_mount_points";
+import { getVolumeMountPointsImpl } from "./volume_mount_points";
+
+export interface VolumeHealthMonitorOptions
+  extends Pick<
+    Options,
+    | "timeoutMs"
+    | "maxConcurrency"
+    | "linuxMountTablePaths"
+    | "systemPathPatterns"
+    | "systemFsTypes"
+    | "includeSystemVolumes"
+    | "skipNetworkVolumes"
+    | "networkFsTypes"
+    | "probeSnapshots"
+  > {
+  /**
+   * How often each healthy volume is re-checked. Defaults to 10 seconds.
+   */
+  intervalMs: number;
+
+  /**
+   * Each delay is randomized by up to this fraction either way, so volumes
+   * don't all get checked in the same tick. Defaults to 0.2.
+   */
+  jitter: number;
+
+  /**
+   * Unhealthy volumes are re-checked after `intervalMs`, doubling after each
+   * consecutive failure, up to this. Defaults to 5 minutes.
+   */
+  maxBackoffMs: number;
+
+  /**
+   * How often the shared mount table snapshot is re-read to pick up mounts
+   * and unmounts. Defaults to 30 seconds.
+   */
+  mountTableIntervalMs: number;
+}
+
+export const VolumeHealthMonitorDefaults = {
+  intervalMs: 10_000,
+  jitter: 0.2,
+  maxBackoffMs: 5 * 60_000,
+  mountTableIntervalMs: 30_000,
+} as const;
+
+/**
+ * Emitted by {@link VolumeHealthMonitor} when a volume's status changes.
+ */
+export interface VolumeHealthChange {
+  mountPoint: string;
+  /**
+   * Undefined on a volume's first check, which is only reported if the volume
+   * is not healthy.
+   */
+  previous?: VolumeHealthStatus;
+  status: VolumeHealthStatus;
+  /**
+   * The error behind an unhealthy status, if any.
+   */
+  error?: Error;
+}
+
+/**
+ * Counters for sizing {@link VolumeHealthMonitorOptions}. All are cumulative
+ * since the monitor was created, except `volumes` and `checksInFlight`.
+ */
+export interface VolumeHealthMonitorStats {
+  volumes: number;
+  checks: number;
+  transitions: number;
+  mountTableReads: number;
+  checksInFlight: number;
+  /**
+   * Checks that had to wait for a free slot in the `maxConcurrency` pool.
+   */
+  queuedChecks: number;
+  /**
+   * Checks that found the volume's previous read still stuck, and waited on
+   * it rather than starting another.
+   */
+  stuckChecks: number;
+  totalCheckMs: number;
+  maxCheckMs: number;
+}
+
+type VolumeHealthMonitorEvents = {
+  change: [VolumeHealthChange];
+  removed: [string];
+  error: [Error];
+};
+
+/**
+ * A background service that re-checks each volume on its own schedule. See
+ * {@link createVolumeHealthMonitor}.
+ *
+ * Events:
+ * - `change`: a {@link VolumeHealthChange}
+ * - `removed`: a mount point that disappeared from the mount table
+ * - `error`: the mount table could not be read (only emitted if listened to)
+ */
+export interface VolumeHealthMonitor
+  extends EventEmitter<VolumeHealthMonitorEvents> {
+  /**
+   * The most recent status of every checked volume.
+   */
+  statuses(): Map<string, VolumeHealthStatus>;
+
+  stats(): VolumeHealthMonitorStats;
+
+  /**
+   * Re-read the mount table now. Resolves once new volumes are scheduled.
+   */
+  refresh(): Promise<void>;
+
+  /**
+   * Stop all checks. Idempotent.
+   */
+  close(): void;
+}
+
+/**
+ * Injected by tests.
+ */
+export interface VolumeHealthMonitorDeps {
+  listMountPoints: () => Promise<MountPoint[]>;
+  /**
+   * Reads one entry of the directory, with no timeout of its own.
+   */
+  readdir: (mountPoint: string) => Promise<true>;
+}
+
+interface VolumeState {
+  mountPoint: string;
+  status?: VolumeHealthStatus;
+  failures: number;
+  timer?: NodeJS.Timeout;
+  /**
+   * The volume's read, until it settles. Outlives a timed-out check.
+   */
+  reading?: Promise<true>;
+}
+
+function startMonitor(
+  o: VolumeHealthMonitorOptions,
+  deps: VolumeHealthMonitorDeps,
+): VolumeHealthMonitor {
+  const emitter = new EventEmitter<VolumeHealthMonitorEvents>();
+  const volumes = new Map<string, VolumeState>();
+  const waiters: (() => void)[] = [];
+  const stats: VolumeHealthMonitorStats = {
+    volumes: 0,
+    checks: 0,
+    transitions: 0,
+    mountTableReads: 0,
+    checksInFlight: 0,
+    queuedChecks: 0,
+    stuckChecks: 0,
+    totalCheckMs: 0,
+    maxCheckMs: 0,
+  };
+  let mountTableTimer: NodeJS.Timeout | undefined;
+  let closed = false;
+
+  function delayFor(v: VolumeState): number {
+    const base =
+      v.failures === 0
+        ? o.intervalMs
+        : Math.min(
+            o.maxBackoffMs,
+            o.intervalMs * 2 ** Math.min(v.failures, 30),
+          );
+    const spread = base * o.jitter;
+    return Math.max(0, base - spread + Math.random() * 2 * spread);
+  }
+
+  function schedule(v: VolumeState, delayMs: number = delayFor(v)) {
+    v.timer = setTimeout(() => void check(v), delayMs).unref();
+  }
+
+  // The probe pool: at most maxConcurrency checks run at once, across all
+  // volumes.
+  async function acquire(): Promise<void> {
+    if (stats.checksInFlight >= o.maxConcurrency) {
+      stats.queuedChecks++;
+      await new Promise<void>((resolve) => waiters.push(resolve));
+    }
+    stats.checksInFlight++;
+  }
+
+  function release() {
+    stats.checksInFlight--;
+    waiters.shift()?.();
+  }
+
+  const isCurrent = (v: VolumeState) =>
+    !closed && volumes.get(v.mountPoint) === v;
+
+  function startRead(v: VolumeState): Promise<true> {
+    const reading = deps.readdir(v.mountPoint).finally(() => {
+      if (v.reading === reading) v.reading = undefined;
+    });
+    v.reading = reading;
+    return reading;
+  }
+
+  async function check(v: VolumeState) {
+    v.timer = undefined;
+    // A timed-out read still holds its thread. Rather than stack another
+    // behind it, wait on the same read again: that takes no thread and no
+    // pool slot, and its settling is how the volume recovers.
+    const stuck = v.reading;
+    if (stuck == null) await acquire();
+    let result: DirectoryStatus;
+    try {
+      if (!isCurrent(v)) return;
+      const start = performance.now();
+      if (stuck != null) stats.stuckChecks++;
+      const reading = stuck ?? startRead(v);
+      result = await directoryStatus(v.mountPoint, o.timeoutMs, (_, ms) =>
+        withTimeout({ desc: "canReaddir()", promise: reading, timeoutMs: ms }),
+      );
+      const elapsed = performance.now() - start;
+      stats.checks++;
+      stats.totalCheckMs += elapsed;
+      stats.maxCheckMs = Math.max(stats.maxCheckMs, elapsed);
+    } finally {
+      if (stuck == null) release();
+    }
+    if (!isCurrent(v)) return;
+
+    const previous = v.status;
+    const { status, error } = result;
+    v.status = status;
+    v.failures = status === VolumeHealthStatuses.healthy ? 0 : v.failures + 1;
+    if (
+      previous !== status &&
+      !(previous == null && status === VolumeHealthStatuses.healthy)
+    ) {
+      stats.transitions++;
+      debug(
+        "[VolumeHealthMonitor] %s: %s -> %s",
+        v.mountPoint,
+        previous,
+        status,
+      );
+      emitter.emit("change", {
+        mountPoint: v.mountPoint,
+        ...(previous == null ? {} : { previous }),
+        status,
+        ...(error == null ? {} : { error }),
+      });
+    }
+    schedule(v);
+  }
+
+  function sync(mountPoints: MountPoint[]) {
+    const current = new Set(mountPoints.map((ea) => ea.mountPoint));
+    for (const [mountPoint, v] of volumes) {
+      if (current.has(mountPoint)) continue;
+      clearTimeout(v.timer);
+      volumes.delete(mountPoint);
+      emitter.emit("removed", mountPoint);
+    }
+    for (const mountPoint of current) {
+      if (volumes.has(mountPoint)) continue;
+      const v: VolumeState = { mountPoint, failures: 0 };
+      volumes.set(mountPoint, v);
+      // First checks are spread across one jitter window:
+      schedule(v, Math.random() * o.intervalMs * o.jitter);
+    }
+  }
+
+  async function refresh(): Promise<void> {
+    if (closed) return;
+    clearTimeout(mountTableTimer);
+    try {
+      stats.mountTableReads++;
+      const mountPoints = await deps.listMountPoints();
+      if (!closed) sync(mountPoints);
+    } catch (error) {
+      debug("[VolumeHealthMonitor] mount table read failed: %s", error);
+      if (!closed && emitter.listenerCount("error") > 0) {
+        emitter.emit("error", toError(error));
+      }
+    }
+    if (closed) return;
+    mountTableTimer = setTimeout(
+      () => void refresh(),
+      o.mountTableIntervalMs,
+    ).unref();
+  }
+
+  return Object.assign(emitter, {
+    statuses() {
+      const result = new Map<string, VolumeHealthStatus>();
+      for (const v of volumes.values()) {
+        if (v.status != null) result.set(v.mountPoint, v.status);
+      }
+      return result;
+    },
+    stats() {
+      return { ...stats, volumes: volumes.size };
+    },
+    refresh,
+    close() {
+      if (closed) return;
+      closed = true;
+      clearTimeout(mountTableTimer);
+      for (const v of volumes.values()) clearTimeout(v.timer);
+      volumes.clear();
+      // Queued checks wake, see they're no longer current, and return:
+      for (const wake of waiters.splice(0)) wake();
+    },
+  });
+}
+
+function validatePositive(name: string, value: number) {
+  if (!isNumber(value) || value <= 0) {
+    throw new TypeError(
+      `createVolumeHealthMonitor(): invalid ${name}: ${JSON.stringify(value)}`,
+    );
+  }
+}
+
+export function createVolumeHealthMonitorImpl(
+  opts: Partial<VolumeHealthMonitorOptions>,
+  nativeFn: NativeBindingsFn,
+  deps?: Partial<VolumeHealthMonitorDeps>,
+): VolumeHealthMonitor {
+  const o: VolumeHealthMonitorOptions = {
+    ...VolumeHealthMonitorDefaults,
+    ...optionsWithDefaults<Options & VolumeHealthMonitorOptions>(opts),
+  };
+  validateTimeoutMs(o.timeoutMs, "createVolumeHealthMonitor()");
+  validatePositive("intervalMs", o.intervalMs);
+  validatePositive("maxBackoffMs", o.maxBackoffMs);
+  validatePositive("mountTableIntervalMs", o.mountTableIntervalMs);
+  validatePositive("maxConcurrency", o.maxConcurrency);
+  if (!isNumber(o.jitter) || o.jitter < 0 || o.jitter > 1) {
+    throw new TypeError(
+      `createVolumeHealthMonitor(): invalid jitter: ${JSON.stringify(o.jitter)}`,
+    );
+  }
+
+  const listOptions: Required<GetVolumeMountPointOptions> & {
+    skipHealthCheck: boolean;
+  } = {
+    ...optionsWithDefaults(o),
+    skipHealthCheck: true,
+  };
+  const monitor = startMonitor(o, {
+    // Skipped network volumes and (by default) snapshots are never checked.
+    listMountPoints: async () =>
+      (await getVolumeMountPointsImpl(listOptions, nativeFn)).filter(
+        (ea) =>
+          !(
+            o.skipNetworkVolumes && isRemoteFsType(ea.fstype, o.networkFsTypes)
+          ) &&
+          (o.probeSnapshots === true || ea.isSnapshot !== true),
+      ),
+    // On the addon's own pool: a read stuck on a dead mount must not hold
+    // one of libuv's few threads, which all of node:fs shares.
+    readdir: async (mountPoint) => {
+      const native = await nativeFn();
+      if (native.canReaddir == null) {
+        throw new Error("canReaddir() is not available in these bindings");
+      }
+      return native.canReaddir(mountPoint);
+    },
+    ...deps,
+  });
+  void monitor.refresh();
+  return monitor;
+}
@@ -68,6 +68,21 @@ describe("directoryStatus", () => {
     expect(status).toBe(VolumeHealthStatuses.inaccessible);
   });
 
+  it.each(["ENOTCONN", "ESTALE", "EHOSTDOWN", "ENODEV"])(
+    "should return disconnected status on %s error",
+    async (code) => {
+      const error = new Error(code);
+      Object.assign(error, { code });
+      const result = await directoryStatus("/test/dir", 1000, () =>
+        Promise.reject(error),
+      );
+      expect(result).toEqual({
+        error,
+        status: VolumeHealthStatuses.disconnected,
+      });
+    },
+  );
+
   it("should return unknown status on non-Error throws", async () => {
     const { status } = await directoryStatus("/test/dir", 1000, () =>
       Promise.reject("string error"),
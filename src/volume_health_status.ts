@@ -3,7 +3,7 @@
 import { TimeoutError } from "./async";
 import { debug } from "./debuglog";
 import { toError } from "./error";
-import { canReaddir } from "./fs";
+import { canReaddir, canReaddirSync } from "./fs";
 import { isObject } from "./object";
 import { stringEnum, StringEnumKeys } from "./string_enum";
 
@@ -14,7 +14,7 @@ import { stringEnum, StringEnumKeys } from "./string_enum";
  * - `timeout`: Volume could not be accessed before the specified timeout. It
  *   may be inaccessible or disconnected.
  * - `inaccessible`: Volume exists but can't be accessed (permissions/locks)
- * - `disconnected`: Network volume that's offline
+ * - `disconnected`: Network volume that's offline, or a device that's gone
  * - `unknown`: Status can't be determined
  */
 export const VolumeHealthStatuses = stringEnum(
@@ -37,29 +37,66 @@ export async function directoryStatus(
   dir: string,
   timeoutMs: number,
   canReaddirImpl: typeof canReaddir = canReaddir,
-): Promise<{
-  status: VolumeHealthStatus;
-  error?: Error;
-  isDirectory?: boolean;
-}> {
+): Promise<DirectoryStatus> {
   try {
     if (await canReaddirImpl(dir, timeoutMs)) {
       return { status: VolumeHealthStatuses.healthy, isDirectory: true };
     }
   } catch (error) {
     debug("[directoryStatus] %s: %s", dir, error);
-    let status: VolumeHealthStatus = VolumeHealthStatuses.unknown;
-    if (error instanceof TimeoutError) {
-      status = VolumeHealthStatuses.timeout;
-    } else if (isObject(error) && "code" in error) {
-      if (error.code === "EPERM" || error.code === "EACCES") {
-        status = VolumeHealthStatuses.inaccessible;
-      }
+    return errorToDirectoryStatus(error);
+  }
+  return { status: VolumeHealthStatuses.unknown };
+}
+
+/**
+ * Synchronous {@link directoryStatus}, for the sync API fast path. There is no
+ * timeout: callers must only use this on volumes known to be local.
+ * @throws never
+ */
+export function directoryStatusSync(
+  dir: string,
+  canReaddirImpl: (dir: string) => true = canReaddirSync,
+): DirectoryStatus {
+  try {
+    if (canReaddirImpl(dir)) {
+      return { status: VolumeHealthStatuses.healthy, isDirectory: true };
     }
-    const result = { status, error: toError(error) };
-    return isObject(error) && "code" in error && error.code === "ENOTDIR"
-      ? { ...result, isDirectory: false }
-      : result;
+  } catch (error) {
+    debug("[directoryStatusSync] %s: %s", dir, error);
+    return errorToDirectoryStatus(error);
   }
   return { status: VolumeHealthStatuses.unknown };
 }
+
+export interface DirectoryStatus {
+  status: VolumeHealthStatus;
+  error?: Error;
+  isDirectory?: boolean;
+}
+
+// The server or device behind the mount is gone (ESTALE: an NFS handle the
+// server no longer knows; ENODEV: the block device was removed).
+const DisconnectedCodes = new Set([
+  "ENOTCONN",
+  "ESTALE",
+  "EHOSTDOWN",
+  "ENODEV",
+]);
+
+function errorToDirectoryStatus(error: unknown): DirectoryStatus {
+  let status: VolumeHealthStatus = VolumeHealthStatuses.unknown;
+  if (error instanceof TimeoutError) {
+    status = VolumeHealthStatuses.timeout;
+  } else if (isObject(error) && "code" in error) {
+    if (error.code === "EPERM" || error.code === "EACCES") {
+      status = VolumeHealthStatuses.inaccessible;
+    } else if (DisconnectedCodes.has(String(error.code))) {
+      status = VolumeHealthStatuses.disconnected;
+    }
+  }
+  const result = { status, error: toError(error) };
+  return isObject(error) && "code" in error && error.code === "ENOTDIR"
+    ? { ...result, isDirectory: false }
+    : result;
+}
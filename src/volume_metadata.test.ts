@@ -1,5 +1,7 @@
 // src/volume_metadata.test.ts
 
+import { mkdtemp, realpath, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
 import { join } from "node:path";
 import { compact, times } from "./array";
 import { _dirname } from "./dirname";
@@ -15,9 +17,13 @@ import { IncludeSystemVolumesDefault, optionsWithDefaults } from "./options";
 import { isLinux, isMacOS, isWindows } from "./platform";
 import { pickRandom, randomLetter, randomLetters, shuffle } from "./random";
 import { assertMetadata } from "./test-utils/assert";
-import { systemDrive } from "./test-utils/platform";
+import { describePlatform, systemDrive } from "./test-utils/platform";
 import type { NativeBindingsFn } from "./types/native_bindings";
-import { getVolumeMetadataImpl } from "./volume_metadata";
+import type { ProbePriority } from "./types/options";
+import {
+  getVolumeMetadataForPathImpl,
+  getVolumeMetadataImpl,
+} from "./volume_metadata";
 
 const rootPath = systemDrive();
 
@@ -46,6 +52,19 @@ describe("Volume Metadata", () => {
 
     expect(typeof metadata.isReadOnly).toBe("boolean");
   });
+
+  it("probes at background priority", async () => {
+    const normal = await getVolumeMetadata(rootPath);
+    const background = await getVolumeMetadata(rootPath, {
+      priority: "background",
+    });
+    assertMetadata(background);
+    expect(background).toMatchObject({
+      mountPoint: normal.mountPoint,
+      fstype: normal.fstype,
+      size: normal.size,
+    });
+  });
 });
 describe("Volume Metadata errors", () => {
   it("handles non-existant mount points (from native)", async () => {
@@ -77,6 +96,16 @@ describe("Volume Metadata errors", () => {
       /Invalid mountPoint/,
     );
   });
+
+  it("rejects an invalid priority before probing", async () => {
+    const priority = "low" as ProbePriority;
+    await expect(getVolumeMetadata(rootPath, { priority })).rejects.toThrow(
+      TypeError,
+    );
+    await expect(getAllVolumeMetadata({ priority })).rejects.toThrow(
+      /getAllVolumeMetadata\(\): Expected priority/,
+    );
+  });
 });
 
 describe("concurrent", () => {
@@ -322,6 +351,53 @@ describe("getVolumeMetadataForPath()", () => {
   }
 });
 
+describe("includeQuota", () => {
+  it("reports either no quota or a consistent one for the root volume", async () => {
+    const metadata = await getVolumeMetadata(rootPath, { includeQuota: true });
+    assertMetadata(metadata);
+    if (metadata.quotaType == null) {
+      expect(metadata.quotaLimit).toBeUndefined();
+    } else {
+      expect(isLinux).toBe(true);
+      expect(metadata.quotaLimit).toBeGreaterThan(0);
+      expect(metadata.quotaAvailable).toBe(
+        Math.max(0, metadata.quotaLimit! - metadata.quotaUsed!),
+      );
+    }
+  });
+
+  it("omits quota fields by default", async () => {
+    const metadata = await getVolumeMetadata(rootPath);
+    expect(metadata.quotaType).toBeUndefined();
+  });
+
+  if (isLinux) {
+    it("asks native for the quota of the directory, not the mount point", async () => {
+      const calls: unknown[] = [];
+      const recordingNativeFn = (() => ({
+        getVolumeMetadata: (o: unknown) => {
+          calls.push(o);
+          return Promise.resolve({});
+        },
+      })) as unknown as NativeBindingsFn;
+      const thisDir = await realpath(_dirname());
+      await getVolumeMetadataForPathImpl(
+        thisDir,
+        optionsWithDefaults({
+          includeQuota: true,
+          mountPoints: await getVolumeMountPoints({
+            includeSystemVolumes: true,
+          }),
+        }),
+        recordingNativeFn,
+      );
+      expect(calls).toEqual([
+        expect.objectContaining({ includeQuota: true, quotaPath: thisDir }),
+      ]);
+    });
+  }
+});
+
 describe("Network Filesystems", () => {
   // Timeout configured globally in bootstrap
 
@@ -345,3 +421,77 @@ describe("Network Filesystems", () => {
     }
   });
 });
+
+describePlatform("linux")("overlapped stages", () => {
+  let dir: string;
+  let mtabPath: string;
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-overlap-"));
+    mtabPath = join(dir, "mtab");
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  function run(mountPoint: string, native: object) {
+    return getVolumeMetadataImpl(
+      {
+        ...optionsWithDefaults({ linuxMountTablePaths: [mtabPath] }),
+        mountPoint,
+      },
+      (() => native) as unknown as NativeBindingsFn,
+    );
+  }
+
+  it("starts the native probe of a local volume alongside the health check", async () => {
+    const missing = join(dir, "missing");
+    await writeFile(mtabPath, `/dev/sdz1 ${missing} xfs rw 0 0\n`);
+    let calls = 0;
+    const native = {
+      getVolumeMetadata: async () => {
+        calls++;
+        throw new Error("native failed");
+      },
+    };
+    // The health check's error wins, and the native rejection is dropped:
+    await expect(run(missing, native)).rejects.toThrow(/ENOENT|no such/i);
+    expect(calls).toBe(1);
+  });
+
+  it("keeps the health check as a gate for remote volumes", async () => {
+    const missing = join(dir, "missing-nfs");
+    await writeFile(mtabPath, `nas:/export ${missing} nfs rw 0 0\n`);
+    let calls = 0;
+    const native = {
+      getVolumeMetadata: async () => {
+        calls++;
+        return {};
+      },
+    };
+    await expect(run(missing, native)).rejects.toThrow(/ENOENT|no such/i);
+    expect(calls).toBe(0);
+  });
+
+  it("merges the native result with the health status", async () => {
+    await writeFile(mtabPath, `/dev/sdz1 ${dir} xfs rw 0 0\n`);
+    const native = {
+      getVolumeMetadata: async () => ({
+        size: 10,
+        used: 4,
+        available: 6,
+        uuid: "u-overlap",
+        label: "L",
+      }),
+    };
+    expect(await run(dir, native)).toMatchObject({
+      mountPoint: dir,
+      status: "healthy",
+      fstype: "xfs",
+      uuid: "u-overlap",
+      label: "L",
+      size: 10,
+    });
+  });
+});
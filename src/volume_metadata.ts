@@ -3,8 +3,14 @@
 import type { Stats } from "node:fs";
 import { realpath } from "node:fs/promises";
 import { dirname } from "node:path";
-import { mapConcurrent, validateTimeoutMs, withTimeout } from "./async";
-import { debug } from "./debuglog";
+import {
+  createSlicer,
+  mapConcurrent,
+  type Slicer,
+  validateTimeoutMs,
+  withTimeout,
+} from "./async";
+import { debug, isDebugEnabled } from "./debuglog";
 import { WrappedError } from "./error";
 import { statAsync } from "./fs";
 import { getLabelFromDevDisk, getUuidFromDevDisk } from "./linux/dev_disk";
@@ -15,12 +21,17 @@ import {
 } from "./linux/mtab";
 import { getZfsGuids, zfsEnrichmentTimeoutMs } from "./linux/zfs_guids";
 import { compactValues } from "./object";
-import { IncludeSystemVolumesDefault, optionsWithDefaults } from "./options";
+import {
+  IncludeSystemVolumesDefault,
+  optionsWithDefaults,
+  validatePriority,
+} from "./options";
 import { isAncestorOrSelf, normalizePath } from "./path";
 import { isLinux, isMacOS, isWindows } from "./platform";
 import { extractRemoteInfo, isRemoteFsType } from "./remote_info";
 import { isBlank, isNotBlank } from "./string";
 import { assignSystemVolume } from "./system_volume";
+import type { MountPoint } from "./types/mount_point";
 import type {
   GetVolumeMetadataOptions,
   NativeBindingsFn,
@@ -46,6 +57,7 @@ export async function getVolumeMetadataImpl(
   // Validate before starting any work (including native calls) — also on
   // Windows, where the native health probe also receives this timeout.
   const timeoutMs = validateTimeoutMs(o.timeoutMs, "getVolumeMetadata()");
+  validatePriority(o.priority, "getVolumeMetadata()");
   const deadlineMs =
     operationDeadlineMs ??
     (timeoutMs === 0 ? undefined : Date.now() + timeoutMs);
@@ -117,6 +129,35 @@ async function _getVolumeMetadata(
     }) as VolumeMetadata;
   }
 
+  if (isNotBlank(device)) {
+    o.device = device;
+    debug("[getVolumeMetadata] using device: %s", device);
+  }
+
+  // Pass the mtab fstype to native so the Linux worker can gate btrfs-only
+  // probes (the subvolume-UUID ioctl) without attempting them on other
+  // filesystems.
+  if (isNotBlank(mtabInfo?.fstype)) {
+    o.fstype = mtabInfo.fstype;
+  }
+  if (mtabInfo?.subvolid != null) {
+    o.subvolid = mtabInfo.subvolid;
+  }
+
+  const nativeMetadata = async () => {
+    debug("[getVolumeMetadata] requesting native metadata");
+    return (await (await nativeFn()).getVolumeMetadata(o)) as VolumeMetadata;
+  };
+
+  // The health check and the native probe are independent, so for a volume
+  // the mount table shows to be local they run together. Otherwise (remote,
+  // or no mount table entry) the health check stays a gate in front of the
+  // native worker, so a dead mount ties up one thread rather than two.
+  const overlapped =
+    mtabInfo != null && !remote ? nativeMetadata() : undefined;
+  // If the health check fails first, this result is dropped unobserved:
+  overlapped?.catch(() => undefined);
+
   const pathStatus = await directoryStatus(o.mountPoint, o.timeoutMs);
   const isNonDirectoryLinuxMount =
     isLinux && pathStatus.isDirectory === false && mtabInfo != null;
@@ -135,62 +176,45 @@ async function _getVolumeMetadata(
 
   debug("[getVolumeMetadata] path status: %s", status);
 
-  if (isNotBlank(device)) {
-    o.device = device;
-    debug("[getVolumeMetadata] using device: %s", device);
-  }
-
-  // Pass the mtab fstype to native so the Linux worker can gate btrfs-only
-  // probes (the subvolume-UUID ioctl) without attempting them on other
-  // filesystems.
-  if (isNotBlank(mtabInfo?.fstype)) {
-    o.fstype = mtabInfo.fstype;
-  }
-
-  debug("[getVolumeMetadata] requesting native metadata");
-  const metadata = (await (
-    await nativeFn()
-  ).getVolumeMetadata(o)) as VolumeMetadata;
+  const metadata = await (overlapped ?? nativeMetadata());
   debug("[getVolumeMetadata] native metadata: %o", metadata);
 
-  // Some OS implementations leave it up to us to extract remote info:
-  const remoteInfo =
-    mtabInfo ??
-    extractRemoteInfo(metadata.uri, o.networkFsTypes) ??
-    extractRemoteInfo(metadata.mountFrom, o.networkFsTypes) ??
-    (isWindows ? parseUNCPath(o.mountPoint) : undefined);
-
-  debug("[getVolumeMetadata] extracted remote info: %o", remoteInfo);
-
-  remote ||=
-    isRemoteFsType(metadata.fstype, o.networkFsTypes) ||
-    (remoteInfo?.remote ?? metadata.remote ?? false);
-
-  debug("[getVolumeMetadata] assembling: %o", {
+  const result = assembleVolumeMetadata({
+    o,
     status,
     mtabInfo,
-    remoteInfo,
     metadata,
-    mountPoint: o.mountPoint,
     remote,
   });
-  const result = compactValues({
-    status, // < let the implementation's status win by having this first
-    ...compactValues(remoteInfo),
-    ...compactValues(metadata),
-    ...compactValues(mtabInfo),
-    mountPoint: o.mountPoint,
-    remote,
-  }) as VolumeMetadata;
 
-  // Backfill if blkid failed us:
-  if (isLinux && isNotBlank(device)) {
+  // The /dev/disk backfills (for when blkid failed us) and ZFS enrichment
+  // don't depend on each other. Each fills only its own fields, so the
+  // merge below is the same whichever finishes first.
+  const backfillDevice = isLinux && isNotBlank(device) ? device : undefined;
+  const [uuid, label] = await Promise.all([
     // Sometimes blkid doesn't have the UUID in cache. Try to get it from
     // /dev/disk/by-uuid:
-    result.uuid ??= (await getUuidFromDevDisk(device)) ?? "";
-    result.label ??= (await getLabelFromDevDisk(device)) ?? "";
+    backfillDevice != null && result.uuid == null
+      ? getUuidFromDevDisk(backfillDevice)
+      : undefined,
+    backfillDevice != null && result.label == null
+      ? getLabelFromDevDisk(backfillDevice)
+      : undefined,
+    addZfsGuids(result, o, deadlineMs),
+  ]);
+  if (backfillDevice != null) {
+    result.uuid ??= uuid ?? "";
+    result.label ??= label ?? "";
   }
 
+  return finishVolumeMetadata(result, o);
+}
+
+async function addZfsGuids(
+  result: VolumeMetadata,
+  o: Options,
+  deadlineMs: number | undefined,
+): Promise<void> {
   if (
     isLinux &&
     o.includeZfsGuids &&
@@ -214,7 +238,63 @@ async function _getVolumeMetadata(
       debug("[getVolumeMetadata] skipping ZFS GUIDs: deadline exhausted");
     }
   }
+}
+
+/**
+ * Merge the native probe result with mount-table and remote info. Shared by
+ * the async and sync pipelines so both produce the same shape.
+ */
+export function assembleVolumeMetadata({
+  o,
+  status,
+  mtabInfo,
+  metadata,
+  remote,
+}: {
+  o: GetVolumeMetadataOptions & Options;
+  status: string;
+  mtabInfo: MtabVolumeMetadata | undefined;
+  metadata: VolumeMetadata;
+  remote: boolean;
+}): VolumeMetadata {
+  // Some OS implementations leave it up to us to extract remote info:
+  const remoteInfo =
+    mtabInfo ??
+    extractRemoteInfo(metadata.uri, o.networkFsTypes) ??
+    extractRemoteInfo(metadata.mountFrom, o.networkFsTypes) ??
+    (isWindows ? parseUNCPath(o.mountPoint) : undefined);
+
+  debug("[getVolumeMetadata] extracted remote info: %o", remoteInfo);
+
+  remote ||=
+    isRemoteFsType(metadata.fstype, o.networkFsTypes) ||
+    (remoteInfo?.remote ?? metadata.remote ?? false);
+
+  debug("[getVolumeMetadata] assembling: %o", {
+    status,
+    mtabInfo,
+    remoteInfo,
+    metadata,
+    mountPoint: o.mountPoint,
+    remote,
+  });
+  return compactValues({
+    status, // < let the implementation's status win by having this first
+    ...compactValues(remoteInfo),
+    ...compactValues(metadata),
+    ...compactValues(mtabInfo),
+    mountPoint: o.mountPoint,
+    remote,
+  }) as VolumeMetadata;
+}
 
+/**
+ * Final classification and cleanup shared by the async and sync pipelines.
+ */
+export function finishVolumeMetadata(
+  result: VolumeMetadata,
+  o: GetVolumeMetadataOptions & Options,
+): VolumeMetadata {
   assignSystemVolume(result, o);
 
   // Fix microsoft's UUID format:
@@ -323,13 +403,100 @@ async function _getVolumeMetadataForPath(
     nativeFn,
   );
 
+  // Project quotas are per directory, so read the one the caller named
+  // rather than the mount point's.
   return getVolumeMetadataImpl(
-    { ...opts, mountPoint },
+    {
+      ...opts,
+      mountPoint,
+      ...(isLinux && opts.includeQuota ? { quotaPath: dir } : {}),
+    },
     nativeFn,
     operationDeadlineMs,
   );
 }
 
+/**
+ * Get volume metadata for the volume behind an open file descriptor (Linux).
+ *
+ * There is no path work at all: native code reads the descriptor's mount id
+ * and looks it up in a cached /proc/self/mountinfo, then runs the usual
+ * probes on a duplicate of `fd`. The mount-table fields (remote info,
+ * subvolume, snapshot and system-volume classification) are derived here,
+ * exactly as {@link getVolumeMetadataImpl} derives them from the mtab.
+ *
+ * The caller already holds the volume open, so there is no health check and
+ * `skipNetworkVolumes` does not apply. The /dev/disk backfill for identity
+ * blkid could not read is skipped too, as it is path work.
+ */
+export async function getVolumeMetadataForFdImpl(
+  fd: number,
+  opts: Options,
+  nativeFn: NativeBindingsFn,
+): Promise<VolumeMetadata> {
+  const desc = "getVolumeMetadataForFd()";
+  if (!isLinux) {
+    throw new Error(`${desc} is only supported on Linux`);
+  }
+  if (!Number.isSafeInteger(fd) || fd < 0) {
+    throw new TypeError(`${desc}: invalid fd: ${JSON.stringify(fd)}`);
+  }
+  const timeoutMs = validateTimeoutMs(opts.timeoutMs, desc);
+  const deadlineMs = timeoutMs === 0 ? undefined : Date.now() + timeoutMs;
+  return withTimeout({
+    desc,
+    timeoutMs,
+    promise: _getVolumeMetadataForFd(fd, opts, nativeFn, deadlineMs),
+  });
+}
+
+async function _getVolumeMetadataForFd(
+  fd: number,
+  opts: Options,
+  nativeFn: NativeBindingsFn,
+  deadlineMs: number | undefined,
+): Promise<VolumeMetadata> {
+  const native = await nativeFn();
+  if (native.getVolumeMetadataForFd == null) {
+    throw new Error(
+      "getVolumeMetadataForFd() is not available in these native bindings",
+    );
+  }
+  const { mountOptions, mountRoot, ...metadata } =
+    await native.getVolumeMetadataForFd({
+      fd,
+      includeQuota: opts.includeQuota,
+    });
+  debug(
+    "[getVolumeMetadataForFd] fd %d: %o (root %s)",
+    fd,
+    metadata,
+    mountRoot,
+  );
+
+  const o = { ...opts, mountPoint: metadata.mountPoint };
+  const mtabInfo = mountEntryToPartialVolumeMetadata(
+    {
+      fs_spec: metadata.mountFrom ?? "",
+      fs_file: metadata.mountPoint,
+      fs_vfstype: metadata.fstype ?? "",
+      fs_mntops: mountOptions,
+      fs_freq: undefined,
+      fs_passno: undefined,
+    },
+    o,
+  );
+  const result = assembleVolumeMetadata({
+    o,
+    status: VolumeHealthStatuses.healthy,
+    mtabInfo,
+    metadata,
+    remote: mtabInfo.remote ?? false,
+  });
+  await addZfsGuids(result, o, deadlineMs);
+  return finishVolumeMetadata(result, o);
+}
+
 /**
  * Find the mount point for a resolved path using device ID + path ancestry.
  * Used on Linux and Windows where stat().dev is reliable (no firmlinks).
@@ -366,8 +533,13 @@ export async function findMountPointByDeviceId(
   const deviceMatches: string[] = [];
 
   await Promise.all(
-    mountPoints.map(async ({ mountPoint, fstype }) => {
+    mountPoints.map(async ({ mountPoint, fstype, isSnapshot }) => {
       const isAncestor = isAncestorOrSelf(mountPoint, resolved);
+      // A path inside a snapshot has that snapshot as an ancestor; the
+      // others (possibly thousands) can only be bind-mount fallbacks.
+      if (!isAncestor && isSnapshot === true && !opts.probeSnapshots) {
+        return;
+      }
       // skipNetworkVolumes: don't stat() non-ancestor remote mount points —
       // a dead network mount would hang the lookup for an unrelated local
       // path. Ancestor candidates are still statted: if the target lives
@@ -394,8 +566,19 @@ export async function findMountPointByDeviceId(
     }),
   );
 
-  // Prefer ancestor matches — they're unambiguous. Fall back to device-only
-  // matches only when the mount point isn't an ancestor (e.g. bind mounts).
+  return pickMountPoint(resolved, prefixMatches, deviceMatches);
+}
+
+/**
+ * Prefer ancestor matches — they're unambiguous. Fall back to device-only
+ * matches only when the mount point isn't an ancestor (e.g. bind mounts). The
+ * longest candidate wins.
+ */
+export function pickMountPoint(
+  resolved: string,
+  prefixMatches: string[],
+  deviceMatches: string[],
+): string {
   const candidates = prefixMatches.length > 0 ? prefixMatches : deviceMatches;
   if (candidates.length === 0) {
     throw new Error(
@@ -405,99 +588,166 @@ export async function findMountPointByDeviceId(
   return candidates.reduce((a, b) => (a.length >= b.length ? a : b));
 }
 
+/**
+ * @param probe replaces {@link probeVolume} for each volume that is probed,
+ * as `getAllVolumeMetadataProgressive()` does to report each result as it
+ * arrives
+ */
 export async function getAllVolumeMetadataImpl(
   opts: Required<Options> & {
     includeSystemVolumes?: boolean;
     maxConcurrency?: number;
   },
   nativeFn: NativeBindingsFn,
+  probe: typeof probeVolume = probeVolume,
 ): Promise<VolumeMetadata[]> {
   const o = optionsWithDefaults(opts);
   debug("[getAllVolumeMetadata] starting with options: %o", o);
+  // Each probe would reject it on its own, as a per-volume error.
+  validatePriority(o.priority, "getAllVolumeMetadata()");
 
   const arr = await getVolumeMountPointsImpl(o, nativeFn);
   debug("[getAllVolumeMetadata] found %d mount points", arr.length);
 
-  const unhealthyMountPoints = arr
-    .filter(
-      (ea) => ea.status != null && ea.status !== VolumeHealthStatuses.healthy,
-    )
-    .map((ea) => ({
-      mountPoint: ea.mountPoint,
-      error: new WrappedError("volume not healthy: " + ea.status, {
-        name: "Skipped",
-      }),
-    }));
+  const slicer = createSlicer(o.yieldBudgetMs);
+  const plan = await planVolumeProbes(arr, opts, o, slicer);
 
-  const includeSystemVolumes =
-    opts?.includeSystemVolumes ?? IncludeSystemVolumesDefault;
+  const results = await (mapConcurrent({
+    maxConcurrency: o.maxConcurrency,
+    items: plan.toProbe,
+    fn: async (mp) => probe(mp, o, nativeFn),
+  }) as Promise<VolumeMetadata[]>);
 
-  const systemMountPoints = includeSystemVolumes
-    ? []
-    : arr
-        .filter((ea) => ea.isSystemVolume)
-        .map((ea) => ({
-          mountPoint: ea.mountPoint,
-          error: new WrappedError("system volume", { name: "Skipped" }),
-        }));
-
-  const healthy = arr.filter(
-    (ea) => ea.status == null || ea.status === VolumeHealthStatuses.healthy,
-  );
+  debug("[getAllVolumeMetadata] completed processing all volumes");
+  return mergeVolumeResults(arr, results, plan, slicer);
+}
 
-  // On macOS and Windows, getVolumeMetadataImpl cannot cheaply detect remote
-  // volumes before the native call, but the enumerated mount points carry
-  // fstype — honor skipNetworkVolumes here with mount-point-derived shallow
-  // results. (On Linux, getVolumeMetadataImpl itself short-circuits from the
-  // mount table with richer remote info, so nothing is skipped here.)
-  const skippedNetwork =
-    o.skipNetworkVolumes && !isLinux
-      ? healthy.filter((ea) => isRemoteFsType(ea.fstype, o.networkFsTypes))
-      : [];
-  const skippedNetworkResults = skippedNetwork.map(
-    (ea) =>
-      compactValues({ ...compactValues(ea), remote: true }) as VolumeMetadata,
+/**
+ * {@link getVolumeMetadataImpl} for one of {@link VolumeProbePlan.toProbe},
+ * with failures returned as `{mountPoint, error}` rather than thrown.
+ */
+export function probeVolume(
+  mp: MountPoint,
+  o: Options,
+  nativeFn: NativeBindingsFn,
+): Promise<VolumeMetadata> {
+  return getVolumeMetadataImpl({ ...mp, ...o }, nativeFn).catch(
+    (error) => ({ mountPoint: mp.mountPoint, error }) as VolumeMetadata,
   );
+}
+
+interface VolumeProbePlan {
+  /**
+   * Final results for mount points that won't be probed, keyed by mount
+   * point.
+   */
+  byMountPoint: Map<string, VolumeMetadata>;
+  toProbe: MountPoint[];
+}
+
+/**
+ * Decides which of `arr` {@link getAllVolumeMetadataImpl} probes.
+ */
+async function planVolumeProbes(
+  arr: MountPoint[],
+  opts: { includeSystemVolumes?: boolean },
+  o: Options,
+  slicer: Slicer,
+): Promise<VolumeProbePlan> {
+  const includeSystemVolumes =
+    opts?.includeSystemVolumes ?? IncludeSystemVolumesDefault;
 
-  debug("[getAllVolumeMetadata] ", {
-    allMountPoints: arr.map((ea) => ea.mountPoint),
-    healthyMountPoints: healthy.map((ea) => ea.mountPoint),
+  // Classify every mount point in one (sliced) pass. Results not fetched
+  // from native code are keyed by mount point, so assembling the final list
+  // stays linear with tens of thousands of mounts.
+  const byMountPoint = new Map<string, VolumeMetadata>();
+  const healthy: MountPoint[] = [];
+  const toProbe: MountPoint[] = [];
+  await slicer.forEach(arr, (ea) => {
+    if (ea.status != null && ea.status !== VolumeHealthStatuses.healthy) {
+      byMountPoint.set(ea.mountPoint, {
+        mountPoint: ea.mountPoint,
+        error: new WrappedError("volume not healthy: " + ea.status, {
+          name: "Skipped",
+        }),
+      } as VolumeMetadata);
+      return;
+    }
+    healthy.push(ea);
+    if (!includeSystemVolumes && ea.isSystemVolume) {
+      byMountPoint.set(ea.mountPoint, {
+        mountPoint: ea.mountPoint,
+        error: new WrappedError("system volume", { name: "Skipped" }),
+      } as VolumeMetadata);
+    } else if (
+      // On macOS and Windows, getVolumeMetadataImpl cannot cheaply detect
+      // remote volumes before the native call, but the enumerated mount
+      // points carry fstype — honor skipNetworkVolumes here with
+      // mount-point-derived shallow results. (On Linux, getVolumeMetadataImpl
+      // itself short-circuits from the mount table with richer remote info,
+      // so nothing is skipped here.)
+      o.skipNetworkVolumes &&
+      !isLinux &&
+      isRemoteFsType(ea.fstype, o.networkFsTypes)
+    ) {
+      byMountPoint.set(
+        ea.mountPoint,
+        compactValues({ ...compactValues(ea), remote: true }) as VolumeMetadata,
+      );
+    } else if (!o.probeSnapshots && ea.isSnapshot === true) {
+      // Snapshots keep their mount-table fields (including snapshotOrigin,
+      // for grouping) but are not probed unless asked for.
+      byMountPoint.set(ea.mountPoint, compactValues(ea) as VolumeMetadata);
+    } else {
+      toProbe.push(ea);
+    }
   });
 
+  if (isDebugEnabled()) {
+    debug("[getAllVolumeMetadata] ", {
+      allMountPoints: arr.map((ea) => ea.mountPoint),
+      healthyMountPoints: healthy.map((ea) => ea.mountPoint),
+    });
+  }
+
   debug(
     "[getAllVolumeMetadata] processing %d healthy volumes with max concurrency %d",
     healthy.length,
     o.maxConcurrency,
   );
 
-  const results = await (mapConcurrent({
-    maxConcurrency: o.maxConcurrency,
-    items: (includeSystemVolumes
-      ? healthy
-      : healthy.filter((ea) => !ea.isSystemVolume)
-    ).filter((ea) => !skippedNetwork.includes(ea)),
-    fn: async (mp) =>
-      getVolumeMetadataImpl({ ...mp, ...o }, nativeFn).catch((error) => ({
-        mountPoint: mp.mountPoint,
-        error,
-      })),
-  }) as Promise<(VolumeMetadata | { mountPoint: string; error: Error })[]>);
+  return { byMountPoint, toProbe };
+}
 
-  debug("[getAllVolumeMetadata] completed processing all volumes");
-  return arr.map(
+/**
+ * Orders {@link getAllVolumeMetadataImpl}'s results like `arr`.
+ */
+function mergeVolumeResults(
+  arr: MountPoint[],
+  results: VolumeMetadata[],
+  plan: VolumeProbePlan,
+  slicer: Slicer,
+): Promise<VolumeMetadata[]> {
+  // Native results win over the skip entries above, as before: the first
+  // result for a mount point is the one that's kept.
+  const merged = new Map<string, VolumeMetadata>();
+  for (const ea of results) {
+    if (!merged.has(ea.mountPoint)) {
+      merged.set(ea.mountPoint, ea);
+    }
+  }
+  for (const [mountPoint, ea] of plan.byMountPoint) {
+    if (!merged.has(mountPoint)) merged.set(mountPoint, ea);
+  }
+  return slicer.map(
+    arr,
     (result) =>
-      (results.find((ea) => ea.mountPoint === result.mountPoint) ??
-        unhealthyMountPoints.find(
-          (ea) => ea.mountPoint === result.mountPoint,
-        ) ??
-        systemMountPoints.find((ea) => ea.mountPoint === result.mountPoint) ??
-        skippedNetworkResults.find(
-          (ea) => ea.mountPoint === result.mountPoint,
-        ) ?? {
-          ...result,
-          error: new WrappedError("Mount point metadata not retrieved", {
-            name: "NotApplicableError",
-          }),
-        }) as VolumeMetadata,
+      merged.get(result.mountPoint) ??
+      ({
+        ...result,
+        error: new WrappedError("Mount point metadata not retrieved", {
+          name: "NotApplicableError",
+        }),
+      } as VolumeMetadata),
   );
 }
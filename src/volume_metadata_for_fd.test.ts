@@ -0,0 +1,107 @@
+// src/volume_metadata_for_fd.test.ts
+
+import { open } from "node:fs/promises";
+import { getVolumeMetadataForFd, getVolumeMetadataForPath } from "./index";
+import { optionsWithDefaults } from "./options";
+import { describePlatform } from "./test-utils/platform";
+import type { NativeBindings } from "./types/native_bindings";
+import type { Options } from "./types/options";
+import { getVolumeMetadataForFdImpl } from "./volume_metadata";
+
+describePlatform("linux")("getVolumeMetadataForFd()", () => {
+  const opts = (overrides: Partial<Options> = {}) =>
+    optionsWithDefaults<Options>(overrides);
+
+  function nativeReturning(result: Record<string, unknown>) {
+    const calls: unknown[] = [];
+    const native = {
+      getVolumeMetadataForFd: async (o: unknown) => {
+        calls.push(o);
+        return result;
+      },
+    } as unknown as NativeBindings;
+    return { calls, native };
+  }
+
+  it("matches getVolumeMetadataForPath() for an open file", async () => {
+    const handle = await open(__filename, "r");
+    try {
+      const byFd = await getVolumeMetadataForFd(handle.fd);
+      const byPath = await getVolumeMetadataForPath(__filename);
+      expect(byFd.mountPoint).toBe(byPath.mountPoint);
+      expect(byFd.fstype).toBe(byPath.fstype);
+      expect(byFd.uuid).toBe(byPath.uuid);
+      expect(byFd.size).toBe(byPath.size);
+      expect(byFd.status).toBe("healthy");
+    } finally {
+      await handle.close();
+    }
+  });
+
+  it("classifies from the native mount-table fields alone", async () => {
+    const { calls, native } = nativeReturning({
+      mountPoint: "/home",
+      mountFrom: "/dev/nvme0n1p2",
+      fstype: "btrfs",
+      mountOptions: "ro,relatime,ro,ssd,subvolid=257,subvol=/@home",
+      mountRoot: "/@home",
+      size: 100,
+      used: 40,
+      available: 60,
+      uuid: "6a1f-uuid",
+      label: null,
+      status: "",
+    });
+    // Only the fd binding exists: any path-based call would throw.
+    const result = await getVolumeMetadataForFdImpl(
+      7,
+      opts({ includeQuota: true }),
+      () => native,
+    );
+    expect(calls).toEqual([{ fd: 7, includeQuota: true }]);
+    expect(result).toMatchObject({
+      mountPoint: "/home",
+      mountFrom: "/dev/nvme0n1p2",
+      fstype: "btrfs",
+      subvol: "/@home",
+      subvolid: 257,
+      isReadOnly: true,
+      remote: false,
+      uuid: "6a1f-uuid",
+      status: "healthy",
+      size: 100,
+    });
+    expect(result).not.toHaveProperty("mountOptions");
+    expect(result).not.toHaveProperty("mountRoot");
+  });
+
+  it("marks network mounts remote", async () => {
+    const { native } = nativeReturning({
+      mountPoint: "/mnt/share",
+      mountFrom: "nas:/export/media",
+      fstype: "nfs4",
+      mountOptions: "rw,relatime,rw,vers=4.2",
+      mountRoot: "/",
+      size: 1,
+      used: 0,
+      available: 1,
+    });
+    const result = await getVolumeMetadataForFdImpl(3, opts(), () => native);
+    expect(result).toMatchObject({
+      remote: true,
+      remoteHost: "nas",
+      remoteShare: "export/media",
+    });
+  });
+
+  it("rejects invalid descriptors before calling native code", async () => {
+    const nativeFn = () => {
+      throw new Error("native bindings must not be used");
+    };
+    for (const fd of [-1, 1.5, NaN, Number.MAX_SAFE_INTEGER + 1]) {
+      await expect(
+        getVolumeMetadataForFdImpl(fd, opts(), nativeFn),
+      ).rejects.toThrow(/invalid fd/);
+    }
+  });
+});
@@ -0,0 +1,228 @@
+// src/volume_metadata_progressive.test.ts
+//
+// getAllVolumeMetadataProgressive() must resolve from the mount table alone,
+// before any probe finishes. The mock native probe is held until released.
+
+import { mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { optionsWithDefaults } from "./options";
+import { describePlatform } from "./test-utils/platform";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindings,
+} from "./types/native_bindings";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import { getAllVolumeMetadataImpl } from "./volume_metadata";
+import {
+  getAllVolumeMetadataProgressiveImpl,
+} from "./volume_metadata_progressive";
+
+describePlatform("linux")("getAllVolumeMetadataProgressive (Linux)", () => {
+  let dir: string;
+  let mtabPath: string;
+  let nfs: string;
+  let probed: string[];
+  let release: () => void;
+  let released: Promise<void>;
+
+  const mockNativeFn = () =>
+    ({
+      getVolumeMetadata: async (o: GetVolumeMetadataOptions) => {
+        probed.push(o.mountPoint);
+        await released;
+        return { size: 100, used: 50, available: 50, uuid: "1234" };
+      },
+    }) as unknown as NativeBindings;
+
+  function start() {
+    return getAllVolumeMetadataProgressiveImpl(
+      {
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: true,
+        skipNetworkVolumes: true,
+      },
+      mockNativeFn,
+    );
+  }
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-progressive-"));
+    mtabPath = join(dir, "mtab");
+    // Never created: only the mount table knows about it.
+    nfs = join(dir, "nfs");
+    await writeFile(
+      mtabPath,
+      [
+        `/dev/sdz1 ${dir} ext4 ro,relatime 0 0`,
+        `server:/export ${nfs} nfs rw 0 0`,
+      ].join("\n") + "\n",
+    );
+  });
+
+  beforeEach(() => {
+    probed = [];
+    released = new Promise((resolve) => (release = resolve));
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  it("returns shallow results before any probe finishes", async () => {
+    const progress = await start();
+    const { volumes } = progress;
+    const probedBeforeRelease = [...probed];
+    release();
+    await progress.results;
+    expect(volumes).toEqual([
+      {
+        mountPoint: dir,
+        fstype: "ext4",
+        mountFrom: "/dev/sdz1",
+        isReadOnly: true,
+        isSystemVolume: false,
+        remote: false,
+      },
+      {
+        mountPoint: nfs,
+        fstype: "nfs",
+        mountFrom: "server:/export",
+        isReadOnly: false,
+        isSystemVolume: false,
+        protocol: "nfs",
+        remote: true,
+        remoteHost: "server",
+        remoteShare: "export",
+      },
+    ]);
+    expect(probedBeforeRelease).toEqual([]);
+  });
+
+  it("emits each refinement, then done", async () => {
+    const progress = await start();
+    const refined: VolumeMetadata[] = [];
+    progress.on("refined", (ea) => refined.push(ea));
+    const done = new Promise<VolumeMetadata[]>((resolve) =>
+      progress.once("done", resolve),
+    );
+    release();
+
+    const results = await progress.results;
+    expect(await done).toBe(results);
+    expect(probed).toEqual([dir]);
+    // The network volume comes from the mount table, unprobed:
+    expect(refined.map((ea) => ea.mountPoint).sort()).toEqual(
+      [dir, nfs].sort(),
+    );
+    expect(results.map((ea) => ea.mountPoint)).toEqual([dir, nfs]);
+    expect(results[0]).toMatchObject({
+      mountPoint: dir,
+      size: 100,
+      uuid: "1234",
+      status: "healthy",
+      isReadOnly: true,
+    });
+    expect(results[1]).toMatchObject({ mountPoint: nfs, status: "unknown" });
+  });
+
+  it("refines to exactly what getAllVolumeMetadata() returns", async () => {
+    // A file bind mount and a missing directory: both are listed shallowly,
+    // but the health check drops the first and skips the second.
+    const file = join(dir, "file");
+    const missing = join(dir, "missing");
+    const mtab = join(dir, "mtab-mixed");
+    await writeFile(file, "");
+    await writeFile(
+      mtab,
+      [
+        `/dev/sdz1 ${dir} ext4 ro,relatime 0 0`,
+        `/dev/sdz1 ${file} ext4 rw,relatime 0 0`,
+        `/dev/sdz2 ${missing} ext4 rw,relatime 0 0`,
+        `server:/export ${nfs} nfs rw 0 0`,
+      ].join("\n") + "\n",
+    );
+    release();
+    const opts = {
+      linuxMountTablePaths: [mtab],
+      includeSystemVolumes: true,
+      skipNetworkVolumes: true,
+    };
+    const progress = await getAllVolumeMetadataProgressiveImpl(
+      opts,
+      mockNativeFn,
+    );
+    expect(progress.volumes.map((ea) => ea.mountPoint)).toEqual([
+      dir,
+      file,
+      missing,
+      nfs,
+    ]);
+    const results = await progress.results;
+    const expected = await getAllVolumeMetadataImpl(
+      optionsWithDefaults(opts),
+      mockNativeFn,
+    );
+
+    expect(results).toEqual(expected);
+    expect(results.map((ea) => ea.mountPoint)).toEqual([dir, missing, nfs]);
+    expect(results[1]?.error?.message).toMatch(/volume not healthy/);
+    expect(probed.filter((ea) => ea !== dir && ea !== nfs)).toEqual([]);
+  });
+
+  // The block device filter works for the shallow listing, and fails by the
+  // time refining lists the mount points again.
+  function startFailingRefine() {
+    let classified = 0;
+    return getAllVolumeMetadataProgressiveImpl(
+      {
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: true,
+        blockDeviceFilter: { removable: true },
+      },
+      () =>
+        ({
+          classifyBlockDevices: async (devices: string[]) => {
+            if (classified++ > 0) throw new Error("sysfs went away");
+            return devices.map(() => ({ major: 8, minor: 0, removable: true }));
+          },
+        }) as unknown as NativeBindings,
+    );
+  }
+
+  it("emits error, and rejects results, if refining fails", async () => {
+    const progress = await startFailingRefine();
+    expect(progress.volumes.map((ea) => ea.mountPoint)).toEqual([dir]);
+    const errors: Error[] = [];
+    progress.on("error", (ea) => errors.push(ea));
+    await expect(progress.results).rejects.toThrow(/mount points/);
+    expect(errors).toHaveLength(1);
+    expect(errors[0]?.message).toMatch(/mount points/);
+  });
+
+  it("never leaves an unobserved rejection", async () => {
+    const progress = await startFailingRefine();
+    const unhandled: unknown[] = [];
+    const onUnhandled = (reason: unknown) => unhandled.push(reason);
+    process.on("unhandledRejection", onUnhandled);
+    try {
+      // No `error` listener and nobody awaiting `results`:
+      await new Promise((resolve) => setTimeout(resolve, 50));
+      expect(unhandled).toEqual([]);
+    } finally {
+      process.off("unhandledRejection", onUnhandled);
+    }
+    await expect(progress.results).rejects.toThrow(/mount points/);
+  });
+
+  it("stops emitting after close()", async () => {
+    const progress = await start();
+    const refined: VolumeMetadata[] = [];
+    progress.on("refined", (ea) => refined.push(ea));
+    progress.on("done", () => refined.push({ mountPoint: "done" }));
+    progress.close();
+    release();
+    await progress.results;
+    expect(refined).toEqual([]);
+  });
+});
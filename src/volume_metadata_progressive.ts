@@ -0,0 +1,163 @@
+// src/volume_metadata_progressive.ts
+
+import { EventEmitter } from "node:events";
+import { createSlicer, type Slicer } from "./async";
+import { debug } from "./debuglog";
+import { toError, WrappedError } from "./error";
+import { getLinuxMountEntries } from "./linux/mount_points";
+import {
+  type MountEntry,
+  type MtabVolumeMetadata,
+  mountEntryToPartialVolumeMetadata,
+} from "./linux/mtab";
+import { compactValues, omit } from "./object";
+import { optionsWithDefaults } from "./options";
+import { normalizePosixPath } from "./path";
+import { isLinux } from "./platform";
+import type { MountPoint } from "./types/mount_point";
+import type { NativeBindingsFn } from "./types/native_bindings";
+import type { Options } from "./types/options";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import { getAllVolumeMetadataImpl, probeVolume } from "./volume_metadata";
+import { getVolumeMountPointsImpl } from "./volume_mount_points";
+
+type ProgressiveVolumeMetadataEvents = {
+  refined: [VolumeMetadata];
+  done: [VolumeMetadata[]];
+  error: [Error];
+};
+
+/**
+ * Volume metadata delivered in two phases. See
+ * {@link getAllVolumeMetadataProgressive}.
+ *
+ * Events:
+ * - `refined`: the complete {@link VolumeMetadata} for one volume (or
+ *   `{mountPoint, error}`), as each probe finishes
+ * - `done`: what {@link getAllVolumeMetadata} returns
+ * - `error`: why {@link results} rejected (only emitted if listened to)
+ */
+export interface ProgressiveVolumeMetadata
+  extends EventEmitter<ProgressiveVolumeMetadataEvents> {
+  /**
+   * One shallow result per volume, from the mount table alone. On Linux this
+   * includes `fstype`, `mountFrom`, remote info, `isReadOnly` and
+   * `isSystemVolume`; elsewhere, what the OS reports when listing mount
+   * points.
+   */
+  readonly volumes: MtabVolumeMetadata[];
+
+  /**
+   * Resolves when every volume is refined, to what
+   * {@link getAllVolumeMetadata} would have returned. Like it, this lists
+   * only the volumes that pass its health check, so it can omit mount points
+   * in {@link volumes} (such as bind-mounted files). Rejections are also
+   * emitted as `error`, and never reported as unhandled.
+   */
+  readonly results: Promise<VolumeMetadata[]>;
+
+  /**
+   * Stop emitting events and starting probes. Volumes not yet probed resolve
+   * as `{mountPoint, error}`. Idempotent.
+   */
+  close(): void;
+}
+
+export type ProgressiveVolumeMetadataOptions = Partial<Options> & {
+  includeSystemVolumes?: boolean;
+};
+
+export async function getAllVolumeMetadataProgressiveImpl(
+  opts: ProgressiveVolumeMetadataOptions,
+  nativeFn: NativeBindingsFn,
+): Promise<ProgressiveVolumeMetadata> {
+  const o = optionsWithDefaults(opts);
+  // The health check would touch every volume before anything is returned:
+  // refining runs it, exactly as getAllVolumeMetadata() does.
+  const arr = await getVolumeMountPointsImpl(
+    { ...o, skipHealthCheck: true },
+    nativeFn,
+  );
+  const slicer = createSlicer(o.yieldBudgetMs);
+  const volumes = await shallowVolumeMetadata(arr, o, slicer);
+  debug(
+    "[getAllVolumeMetadataProgressive] %d shallow results",
+    volumes.length,
+  );
+
+  const emitter = new EventEmitter<ProgressiveVolumeMetadataEvents>();
+  let closed = false;
+
+  const refine = async (): Promise<VolumeMetadata[]> => {
+    // Let the caller attach listeners before anything is emitted.
+    await new Promise((resolve) => setImmediate(resolve));
+    let merged: VolumeMetadata[];
+    try {
+      merged = await getAllVolumeMetadataImpl(o, nativeFn, async (mp) => {
+        if (closed) {
+          return {
+            mountPoint: mp.mountPoint,
+            error: new WrappedError("closed", { name: "Skipped" }),
+          } as VolumeMetadata;
+        }
+        const result = await probeVolume(mp, o, nativeFn);
+        if (!closed) emitter.emit("refined", result);
+        return result;
+      });
+    } catch (error) {
+      debug("[getAllVolumeMetadataProgressive] refining failed: %s", error);
+      const err = toError(error);
+      if (!closed && emitter.listenerCount("error") > 0) {
+        emitter.emit("error", err);
+      }
+      throw err;
+    }
+    if (!closed) emitter.emit("done", merged);
+    return merged;
+  };
+
+  const results = refine();
+  // Event-only callers may never look at `results`:
+  results.catch(() => undefined);
+
+  return Object.assign(emitter, {
+    volumes,
+    results,
+    close() {
+      closed = true;
+    },
+  });
+}
+
+/**
+ * On Linux, fills each mount point in from its mount table entry. Nothing
+ * here touches the volumes themselves.
+ */
+async function shallowVolumeMetadata(
+  arr: MountPoint[],
+  o: Options,
+  slicer: Slicer,
+): Promise<MtabVolumeMetadata[]> {
+  const entries = new Map<string, MountEntry>();
+  if (isLinux) {
+    try {
+      await slicer.forEach(await getLinuxMountEntries(o), (ea) => {
+        // The first entry wins, as in getLinuxMtabMetadata():
+        const mountPoint = normalizePosixPath(ea.fs_file) ?? ea.fs_file;
+        if (!entries.has(mountPoint)) entries.set(mountPoint, ea);
+      });
+    } catch (error) {
+      debug("[getAllVolumeMetadataProgressive] mount table: %s", error);
+    }
+  }
+  return slicer.map(arr, (mp) => {
+    const entry = entries.get(mp.mountPoint);
+    return compactValues({
+      ...(entry == null
+        ? {}
+        : compactValues(mountEntryToPartialVolumeMetadata(entry, o))),
+      // getVolumeMountPoints() classified system volumes with every option:
+      ...compactValues(omit(mp, "status")),
+    }) as MtabVolumeMetadata;
+  });
+}
@@ -0,0 +1,205 @@
+// src/volume_metadata_sync.test.ts
+//
+// The sync APIs run on the JS thread with no timeout, so they must refuse to
+// touch anything the mount table does not report as local. Uses a fake mount
+// table naming a real (local) directory, and native-bindings factories that
+// either throw or record their calls.
+
+import { jest } from "@jest/globals";
+import { mkdir, mkdtemp, rm, symlink, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { getMountPointForPath, getVolumeMetadataSync } from "./index";
+import { isLinux } from "./platform";
+import { describePlatform } from "./test-utils/platform";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindings,
+} from "./types/native_bindings";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import {
+  getMountPointForPathSyncImpl,
+  getVolumeMetadataSyncImpl,
+} from "./volume_metadata_sync";
+
+describePlatform("linux")("sync APIs (Linux)", () => {
+  let dir: string;
+  let mtabPath: string;
+
+  const nativeFnThatThrows = () => {
+    throw new Error("native bindings must not be used for this volume");
+  };
+
+  const mockGetVolumeMetadataSync = jest.fn(
+    (opts: GetVolumeMetadataOptions): VolumeMetadata =>
+      ({
+        mountPoint: opts.mountPoint,
+        size: 100,
+        used: 50,
+        available: 50,
+      }) as VolumeMetadata,
+  );
+  const mockNativeFn = () =>
+    ({
+      getVolumeMetadataSync: mockGetVolumeMetadataSync,
+    }) as unknown as NativeBindings;
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-sync-"));
+    mtabPath = join(dir, "mtab");
+  });
+
+  beforeEach(() => mockGetVolumeMetadataSync.mockClear());
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  describe("getVolumeMetadataSyncImpl", () => {
+    it("probes a local volume with the mount table device and fstype", async () => {
+      await writeFile(mtabPath, `/dev/sdz9 ${dir} ext4 rw,relatime 0 0\n`);
+      const result = getVolumeMetadataSyncImpl(
+        { mountPoint: dir, linuxMountTablePaths: [mtabPath] },
+        mockNativeFn,
+      );
+      expect(mockGetVolumeMetadataSync).toHaveBeenCalledWith({
+        mountPoint: dir,
+        device: "/dev/sdz9",
+        fstype: "ext4",
+        includeQuota: false,
+      });
+      expect(result.status).toBe("healthy");
+      expect(result.remote).toBe(false);
+      expect(result.fstype).toBe("ext4");
+      expect(result.size).toBe(100);
+    });
+
+    it("refuses a remote volume without touching it", async () => {
+      await writeFile(mtabPath, `nas:/export ${dir} nfs rw,relatime 0 0\n`);
+      expect(() =>
+        getVolumeMetadataSyncImpl(
+          { mountPoint: dir, linuxMountTablePaths: [mtabPath] },
+          nativeFnThatThrows,
+        ),
+      ).toThrow(/refusing to probe network volume/);
+    });
+
+    it("returns shallow metadata for a remote volume with skipNetworkVolumes", async () => {
+      await writeFile(mtabPath, `nas:/export ${dir} nfs rw,relatime 0 0\n`);
+      const result = getVolumeMetadataSyncImpl(
+        {
+          mountPoint: dir,
+          linuxMountTablePaths: [mtabPath],
+          skipNetworkVolumes: true,
+        },
+        nativeFnThatThrows,
+      );
+      expect(result.remote).toBe(true);
+      expect(result.status).toBe("unknown");
+      expect(result.remoteHost).toBe("nas");
+      expect(result.size).toBeUndefined();
+    });
+
+    it("refuses a mount point missing from the mount table", async () => {
+      await writeFile(mtabPath, `/dev/sdz9 /elsewhere ext4 rw 0 0\n`);
+      expect(() =>
+        getVolumeMetadataSyncImpl(
+          { mountPoint: dir, linuxMountTablePaths: [mtabPath] },
+          nativeFnThatThrows,
+        ),
+      ).toThrow(/not in the mount table/);
+    });
+
+    it("rejects a blank mountPoint", () => {
+      expect(() =>
+        getVolumeMetadataSyncImpl({ mountPoint: " " }, nativeFnThatThrows),
+      ).toThrow(TypeError);
+    });
+  });
+
+  describe("getMountPointForPathSyncImpl", () => {
+    it("refuses a path on a remote mount", async () => {
+      const sub = join(dir, "sub");
+      await mkdir(sub, { recursive: true });
+      await writeFile(mtabPath, `nas:/export ${dir} nfs rw 0 0\n`);
+      expect(() =>
+        getMountPointForPathSyncImpl(sub, { linuxMountTablePaths: [mtabPath] }),
+      ).toThrow(/refusing to resolve/);
+    });
+
+    it("refuses a symlink that resolves onto a remote mount", async () => {
+      const remote = join(dir, "remote");
+      const local = join(dir, "local");
+      await mkdir(remote, { recursive: true });
+      await mkdir(local, { recursive: true });
+      const link = join(local, "link");
+      await rm(link, { force: true });
+      await symlink(remote, link);
+      await writeFile(
+        mtabPath,
+        `/dev/sdz9 / ext4 rw 0 0\nnas:/export ${remote} nfs rw 0 0\n`,
+      );
+      expect(() =>
+        getMountPointForPathSyncImpl(link, {
+          linuxMountTablePaths: [mtabPath],
+        }),
+      ).toThrow(/refusing to resolve/);
+    });
+
+    it("refuses a symlink onto a remote mount without reading through it", async () => {
+      const remote = join(dir, "remote");
+      const local = join(dir, "local");
+      await mkdir(remote, { recursive: true });
+      await mkdir(local, { recursive: true });
+      const link = join(local, "deep-link");
+      await rm(link, { force: true });
+      // realpath() would lstat() "missing" on the remote volume, and fail
+      // with ENOENT, before the second check could refuse it:
+      await symlink(join(remote, "missing", "file"), link);
+      await writeFile(
+        mtabPath,
+        `/dev/sdz9 / ext4 rw 0 0\nnas:/export ${remote} nfs rw 0 0\n`,
+      );
+      expect(() =>
+        getMountPointForPathSyncImpl(link, {
+          linuxMountTablePaths: [mtabPath],
+        }),
+      ).toThrow(/refusing to resolve/);
+    });
+
+    it("resolves relative symlinks and .. as realpath() does", async () => {
+      const target = join(dir, "a", "b");
+      await mkdir(target, { recursive: true });
+      const link = join(dir, "rel-link");
+      await rm(link, { force: true });
+      await symlink(join("a", "b"), link);
+      await writeFile(mtabPath, `/dev/sdz9 / ext4 rw 0 0\n`);
+      // "rel-link/.." is "a", not dir:
+      expect(
+        getMountPointForPathSyncImpl(`${link}/../b`, {
+          linuxMountTablePaths: [mtabPath],
+        }),
+      ).toBe(getMountPointForPathSyncImpl(target, {}));
+    });
+
+    it("matches getMountPointForPath() for the temp dir", async () => {
+      expect(getMountPointForPathSyncImpl(dir, {})).toBe(
+        await getMountPointForPath(dir),
+      );
+    });
+  });
+
+  it("getVolumeMetadataSync() reports the root volume", () => {
+    const result = getVolumeMetadataSync("/");
+    expect(result.mountPoint).toBe("/");
+    expect(result.status).toBe("healthy");
+    expect(result.size).toBeGreaterThan(0);
+  });
+});
+
+describePlatform("darwin", "win32")("sync APIs (unsupported platforms)", () => {
+  it("throws rather than risking a blocking call", () => {
+    expect(isLinux).toBe(false);
+    expect(() => getVolumeMetadataSync("/")).toThrow(/only supported on Linux/);
+  });
+});
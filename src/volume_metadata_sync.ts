@@ -0,0 +1,289 @@
+// src/volume_metadata_sync.ts
+
+import { lstatSync, readlinkSync, statSync, type Stats } from "node:fs";
+import { dirname, isAbsolute, join, resolve } from "node:path";
+import { debug } from "./debuglog";
+import { WrappedError } from "./error";
+import {
+  getLabelFromDevDiskSync,
+  getUuidFromDevDiskSync,
+} from "./linux/dev_disk";
+import {
+  getLinuxMountPointsSync,
+  getLinuxMtabMetadataSync,
+} from "./linux/mount_points";
+import {
+  type MtabVolumeMetadata,
+  mountEntryToPartialVolumeMetadata,
+} from "./linux/mtab";
+import { compactValues } from "./object";
+import { optionsWithDefaults } from "./options";
+import { isAncestorOrSelf, normalizePath } from "./path";
+import { isLinux } from "./platform";
+import { isRemoteFsType } from "./remote_info";
+import { isBlank, isNotBlank } from "./string";
+import type { MountPoint } from "./types/mount_point";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindingsSyncFn,
+} from "./types/native_bindings";
+import type { Options } from "./types/options";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import {
+  assembleVolumeMetadata,
+  finishVolumeMetadata,
+  pickMountPoint,
+} from "./volume_metadata";
+import {
+  directoryStatusSync,
+  VolumeHealthStatuses,
+} from "./volume_health_status";
+
+/**
+ * Options honored by the synchronous APIs. There is no `timeoutMs`: these
+ * calls never reach a volume that the mount table does not report as local.
+ */
+export type SyncOptions = Pick<
+  Options,
+  | "linuxMountTablePaths"
+  | "networkFsTypes"
+  | "skipNetworkVolumes"
+  | "includeQuota"
+> &
+  Partial<Pick<Options, "mountPoints">>;
+
+function assertSyncSupported(desc: string) {
+  // Only Linux can prove a volume is local without touching it: the mount
+  // table lives in /proc. macOS and Windows would have to issue the very
+  // call that can hang on a dead network share to find out.
+  if (!isLinux) {
+    throw new Error(
+      desc +
+        " is only supported on Linux. Use the asynchronous API on " +
+        process.platform,
+    );
+  }
+}
+
+export function getVolumeMetadataSyncImpl(
+  o: GetVolumeMetadataOptions & Partial<SyncOptions>,
+  nativeFn: NativeBindingsSyncFn,
+): VolumeMetadata {
+  const desc = "getVolumeMetadataSync()";
+  if (isBlank(o.mountPoint)) {
+    throw new TypeError(
+      "Invalid mountPoint: got " + JSON.stringify(o.mountPoint),
+    );
+  }
+  assertSyncSupported(desc);
+
+  const opts = optionsWithDefaults<GetVolumeMetadataOptions & Options>(o);
+  const mountPoint = normalizePath(opts.mountPoint);
+  if (mountPoint == null) {
+    throw new Error("Invalid mountPoint: " + JSON.stringify(opts.mountPoint));
+  }
+  opts.mountPoint = mountPoint;
+
+  // Unlike the async pipeline, an mtab miss is fatal: without the mount
+  // table we cannot prove the volume is local, and there is no timeout to
+  // fall back on.
+  let mtabInfo: MtabVolumeMetadata;
+  let device: string | undefined;
+  try {
+    const m = getLinuxMtabMetadataSync(mountPoint, opts);
+    mtabInfo = mountEntryToPartialVolumeMetadata(m, opts);
+    device = isNotBlank(m.fs_spec) ? m.fs_spec : undefined;
+  } catch (cause) {
+    throw new WrappedError(
+      `${desc}: ${JSON.stringify(mountPoint)} is not in the mount table, so it cannot be verified as a local volume`,
+      { cause },
+    );
+  }
+  debug("[getVolumeMetadataSync] mtab info: %o", mtabInfo);
+
+  if (mtabInfo.remote) {
+    if (opts.skipNetworkVolumes) {
+      return compactValues({
+        ...compactValues(mtabInfo),
+        mountPoint,
+        status: VolumeHealthStatuses.unknown,
+        remote: true,
+      }) as VolumeMetadata;
+    }
+    throw new Error(
+      `${desc}: refusing to probe network volume ${JSON.stringify(mountPoint)} (${mtabInfo.fstype}) on the calling thread. Use getVolumeMetadata() instead`,
+    );
+  }
+
+  const pathStatus = directoryStatusSync(mountPoint);
+  const isNonDirectoryMount = pathStatus.isDirectory === false;
+  if (
+    pathStatus.status !== VolumeHealthStatuses.healthy &&
+    !isNonDirectoryMount
+  ) {
+    throw (
+      pathStatus.error ?? new Error("Volume not healthy: " + pathStatus.status)
+    );
+  }
+
+  const native = nativeFn();
+  if (native.getVolumeMetadataSync == null) {
+    throw new Error(desc + ": native getVolumeMetadataSync is unavailable");
+  }
+  const metadata = native.getVolumeMetadataSync({
+    mountPoint,
+    ...(device == null ? {} : { device }),
+    ...(isNotBlank(mtabInfo.fstype) ? { fstype: mtabInfo.fstype } : {}),
+    ...(mtabInfo.subvolid == null ? {} : { subvolid: mtabInfo.subvolid }),
+    includeQuota: opts.includeQuota,
+  }) as VolumeMetadata;
+  debug("[getVolumeMetadataSync] native metadata: %o", metadata);
+
+  const result = assembleVolumeMetadata({
+    o: opts,
+    status: VolumeHealthStatuses.healthy,
+    mtabInfo,
+    metadata,
+    remote: false,
+  });
+
+  if (device != null) {
+    result.uuid ??= getUuidFromDevDiskSync(device) ?? "";
+    result.label ??= getLabelFromDevDiskSync(device) ?? "";
+  }
+
+  return finishVolumeMetadata(result, opts);
+}
+
+export function getMountPointForPathSyncImpl(
+  pathname: string,
+  opts: Partial<SyncOptions>,
+): string {
+  const desc = "getMountPointForPathSync()";
+  if (isBlank(pathname)) {
+    throw new TypeError("Invalid pathname: got " + JSON.stringify(pathname));
+  }
+  assertSyncSupported(desc);
+
+  const o = optionsWithDefaults(opts);
+  const mountPoints = o.mountPoints ?? getLinuxMountPointsSync(o);
+
+  // Check lexically before anything is touched, then each component as
+  // symlinks are resolved, since one may cross onto another mount.
+  assertLocalPath(desc, resolve(pathname), mountPoints, o.networkFsTypes);
+  const resolved = realpathLocalSync(
+    desc,
+    pathname,
+    mountPoints,
+    o.networkFsTypes,
+  );
+
+  return findMountPointByDeviceIdSync(
+    resolved,
+    statSync(resolved),
+    mountPoints,
+    o.networkFsTypes,
+  );
+}
+
+// Linux's MAXSYMLINKS.
+const MaxSymlinks = 40;
+
+/**
+ * `realpath()`, one component at a time: each is checked with
+ * {@link assertLocalPath} before it is `lstat()`ed, so a symlink onto a
+ * network volume is refused before anything on that volume is touched.
+ */
+function realpathLocalSync(
+  desc: string,
+  pathname: string,
+  mountPoints: MountPoint[],
+  networkFsTypes: string[],
+): string {
+  // process.cwd() is already physical. Not resolve(): ".." must apply after
+  // the symlink before it, as it does for realpath().
+  const pending = (
+    isAbsolute(pathname) ? pathname : process.cwd() + "/" + pathname
+  )
+    .split("/")
+    .reverse();
+  let resolved = "/";
+  let links = 0;
+  for (let name = pending.pop(); name != null; name = pending.pop()) {
+    if (name === "" || name === ".") continue;
+    if (name === "..") {
+      resolved = dirname(resolved);
+      continue;
+    }
+    const next = join(resolved, name);
+    assertLocalPath(desc, next, mountPoints, networkFsTypes);
+    if (!lstatSync(next).isSymbolicLink()) {
+      resolved = next;
+      continue;
+    }
+    if (++links > MaxSymlinks) {
+      throw new WrappedError(
+        `${desc}: too many symbolic links in ${JSON.stringify(pathname)}`,
+        { code: "ELOOP", path: pathname },
+      );
+    }
+    const target = readlinkSync(next);
+    pending.push(...target.split("/").reverse());
+    if (isAbsolute(target)) resolved = "/";
+  }
+  return resolved;
+}
+
+function assertLocalPath(
+  desc: string,
+  pathname: string,
+  mountPoints: MountPoint[],
+  networkFsTypes: string[],
+) {
+  let deepest: MountPoint | undefined;
+  for (const mp of mountPoints) {
+    if (
+      isAncestorOrSelf(mp.mountPoint, pathname) &&
+      (deepest == null || mp.mountPoint.length > deepest.mountPoint.length)
+    ) {
+      deepest = mp;
+    }
+  }
+  if (deepest != null && isRemoteFsType(deepest.fstype, networkFsTypes)) {
+    throw new Error(
+      `${desc}: refusing to resolve ${JSON.stringify(pathname)} on network volume ${JSON.stringify(deepest.mountPoint)} (${deepest.fstype}) on the calling thread. Use the asynchronous API instead`,
+    );
+  }
+}
+
+/**
+ * Synchronous `findMountPointByDeviceId()`. Remote mount points that are
+ * not ancestors of the target are never statted, regardless of
+ * `skipNetworkVolumes`: there is no timeout to save us from a dead mount.
+ * Nor are non-ancestor snapshots, of which there may be thousands.
+ */
+function findMountPointByDeviceIdSync(
+  resolved: string,
+  resolvedStat: Stats,
+  mountPoints: MountPoint[],
+  networkFsTypes: string[],
+): string {
+  const prefixMatches: string[] = [];
+  const deviceMatches: string[] = [];
+  for (const { mountPoint, fstype, isSnapshot } of mountPoints) {
+    const isAncestor = isAncestorOrSelf(mountPoint, resolved);
+    if (
+      !isAncestor &&
+      (isSnapshot === true || isRemoteFsType(fstype, networkFsTypes))
+    ) {
+      continue;
+    }
+    try {
+      if (statSync(mountPoint).dev !== resolvedStat.dev) continue;
+    } catch {
+      continue; // skip inaccessible mount points
+    }
+    (isAncestor ? prefixMatches : deviceMatches).push(mountPoint);
+  }
+  return pickMountPoint(resolved, prefixMatches, deviceMatches);
+}
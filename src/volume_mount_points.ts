@@ -1,14 +1,24 @@
 // src/mount_point.ts
 
 import { uniqBy } from "./array";
-import { mapConcurrent, validateTimeoutMs, withTimeout } from "./async";
+import {
+  createSlicer,
+  mapConcurrent,
+  validateTimeoutMs,
+  withTimeout,
+} from "./async";
 import { debug } from "./debuglog";
+import {
+  filterMountEntriesByBlockDevice,
+  validateBlockDeviceFilter,
+} from "./linux/block_devices";
 import { getLinuxMountPoints } from "./linux/mount_points";
 import { compactValues } from "./object";
 import { isMacOS, isWindows } from "./platform";
 import { isRemoteFsType } from "./remote_info";
 import { isBlank, isNotBlank, sortObjectsByLocale, toNotBlank } from "./string";
 import { assignSystemVolume, SystemVolumeConfig } from "./system_volume";
+import type { BlockDeviceFilter } from "./types/block_device";
 import type { MountPoint } from "./types/mount_point";
 import type { NativeBindingsFn } from "./types/native_bindings";
 import type { Options } from "./types/options";
@@ -23,16 +33,32 @@ export type GetVolumeMountPointOptions = Partial<
     | "includeSystemVolumes"
     | "skipNetworkVolumes"
     | "networkFsTypes"
+    | "probeSnapshots"
+    | "useWorkerThread"
+    | "yieldBudgetMs"
+    | "blockDeviceFilter"
   > &
     SystemVolumeConfig
 >;
 
-type GetVolumeMountPointImplOptions = Required<GetVolumeMountPointOptions> & {
+type GetVolumeMountPointImplOptions = Required<
+  Omit<GetVolumeMountPointOptions, "blockDeviceFilter">
+> & {
+  /**
+   * See {@link Options.blockDeviceFilter}. Not defaulted: omitted means
+   * unfiltered.
+   */
+  blockDeviceFilter?: BlockDeviceFilter;
   /**
    * Internal path resolution needs every Linux VFS mount, including file bind
    * mounts. Public volume enumeration omits detected non-directory targets.
    */
   includeNonDirectoryMountPoints?: boolean;
+  /**
+   * Return the mount table without health-probing anything. Used by the
+   * health monitor, which probes each volume on its own schedule.
+   */
+  skipHealthCheck?: boolean;
 };
 
 export async function getVolumeMountPointsImpl(
@@ -54,6 +80,13 @@ async function _getVolumeMountPoints(
 ): Promise<MountPoint[]> {
   debug("[getVolumeMountPoints] gathering mount points with options: %o", o);
 
+  const filter =
+    o.blockDeviceFilter == null
+      ? undefined
+      : validateBlockDeviceFilter(o.blockDeviceFilter);
+  if (filter != null && (isWindows || isMacOS)) {
+    throw new Error("blockDeviceFilter is only supported on Linux");
+  }
   const raw = await (isWindows || isMacOS
     ? (async () => {
         debug("[getVolumeMountPoints] using native implementation");
@@ -64,42 +97,56 @@ async function _getVolumeMountPoints(
         );
         return points;
       })()
-    : getLinuxMountPoints(o));
+    : getLinuxMountPoints(
+        o,
+        filter == null
+          ? undefined
+          : (entries) =>
+              filterMountEntriesByBlockDevice(entries, filter, nativeFn),
+      ));
 
   debug("[getVolumeMountPoints] raw mount points: %o", raw);
 
-  const compacted = raw
-    .map((ea) => compactValues(ea) as MountPoint)
-    .filter((ea) => isNotBlank(ea.mountPoint));
-
-  for (const ea of compacted) {
-    assignSystemVolume(ea, o);
-  }
-
-  const filtered = o.includeSystemVolumes
-    ? compacted
-    : compacted.filter((ea) => !ea.isSystemVolume);
+  // Everything up to the health checks is synchronous, and grows with the
+  // mount table: slice it so thousands of mounts don't stall the event loop.
+  const slicer = createSlicer(o.yieldBudgetMs);
+  const compacted: MountPoint[] = [];
+  await slicer.forEach(raw, (ea) => {
+    const mp = compactValues(ea) as MountPoint;
+    if (isNotBlank(mp.mountPoint)) {
+      assignSystemVolume(mp, o);
+      if (o.includeSystemVolumes || !mp.isSystemVolume) compacted.push(mp);
+    }
+  });
 
-  const uniq = uniqBy(filtered, (ea) => toNotBlank(ea.mountPoint));
+  const uniq = uniqBy(compacted, (ea) => toNotBlank(ea.mountPoint));
   debug("[getVolumeMountPoints] found %d unique mount points", uniq.length);
 
+  await slicer.checkpoint();
   const results = sortObjectsByLocale(uniq, (ea) => ea.mountPoint);
   debug(
     "[getVolumeMountPoints] getting status for %d mount points",
     results.length,
   );
+  await slicer.checkpoint();
+
+  if (o.skipHealthCheck) return results;
 
   const nonDirectoryMountPoints = new Set<string>();
   await mapConcurrent({
     maxConcurrency: o.maxConcurrency,
-    items: results.filter(
+    items: await slicer.filter(
+      results,
       (ea) =>
         // trust but verify
         (isBlank(ea.status) || ea.status === "healthy") &&
         // skipNetworkVolumes: don't health-probe remote volumes — a dead
         // network mount can hang the readdir() probe. Their status is left
         // as reported (undefined on Linux). See Options.skipNetworkVolumes.
-        !(o.skipNetworkVolumes && isRemoteFsType(ea.fstype, o.networkFsTypes)),
+        !(o.skipNetworkVolumes && isRemoteFsType(ea.fstype, o.networkFsTypes)) &&
+        // Snapshots are left unprobed (status undefined) unless asked for,
+        // so enumeration cost doesn't grow with the number of snapshots.
+        (o.probeSnapshots || ea.isSnapshot !== true),
     ),
     fn: async (mp) => {
       debug("[getVolumeMountPoints] checking status of %s", mp.mountPoint);
@@ -118,7 +165,10 @@ async function _getVolumeMountPoints(
 
   const visibleResults = o.includeNonDirectoryMountPoints
     ? results
-    : results.filter((ea) => !nonDirectoryMountPoints.has(ea.mountPoint));
+    : await slicer.filter(
+        results,
+        (ea) => !nonDirectoryMountPoints.has(ea.mountPoint),
+      );
   debug(
     "[getVolumeMountPoints] completed with %d mount points",
     visibleResults.length,
@@ -0,0 +1,231 @@
+// src/volume_probe.test.ts
+
+import { mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { createVolumeProbe, getVolumeMetadata } from "./index";
+import { optionsWithDefaults } from "./options";
+import { isLinux } from "./platform";
+import { assertMetadata } from "./test-utils/assert";
+import { describePlatform, systemDrive } from "./test-utils/platform";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindings,
+} from "./types/native_bindings";
+import type { Options } from "./types/options";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import type { VolumeProbeOptions } from "./volume_probe";
+import { createVolumeProbeImpl } from "./volume_probe";
+
+const rootPath = systemDrive();
+
+describe("createVolumeProbe()", () => {
+  it("captures the same identity as getVolumeMetadata()", async () => {
+    const probe = await createVolumeProbe(rootPath);
+    try {
+      const expected = await getVolumeMetadata(rootPath);
+      assertMetadata(probe.metadata);
+      expect(probe.mountPoint).toBe(rootPath);
+      expect(probe.metadata.uuid).toEqual(expected.uuid);
+      expect(probe.metadata.fstype).toEqual(expected.fstype);
+      expect(probe.metadata.isSystemVolume).toEqual(expected.isSystemVolume);
+    } finally {
+      probe.close();
+    }
+  });
+
+  it("refreshes space while keeping identity", async () => {
+    const probe = await createVolumeProbe(rootPath);
+    try {
+      const before = probe.metadata;
+      const after = await probe.refresh();
+      assertMetadata(after);
+      expect(after.size).toBeGreaterThan(0);
+      expect(after.uuid).toEqual(before.uuid);
+      expect(after.label).toEqual(before.label);
+      expect(after.status).toEqual(before.status);
+      expect(probe.metadata).toBe(after);
+    } finally {
+      probe.close();
+    }
+  });
+
+  it("rejects refresh() after close(), and close() is idempotent", async () => {
+    const probe = await createVolumeProbe(rootPath);
+    probe.close();
+    probe.close();
+    await expect(probe.refresh()).rejects.toThrow(/closed/);
+  });
+
+  it("rejects a missing mount point", async () => {
+    await expect(
+      createVolumeProbe(join(rootPath, "nonexistent-probe-path-123")),
+    ).rejects.toThrow();
+  });
+});
+
+describePlatform("linux")("createVolumeProbeImpl() (Linux)", () => {
+  let dir: string;
+  let mtabPath: string;
+
+  type ProbeOptions = GetVolumeMetadataOptions & Options & VolumeProbeOptions;
+  const opts = (overrides: Partial<ProbeOptions> = {}): ProbeOptions =>
+    optionsWithDefaults<ProbeOptions>({
+      mountPoint: dir,
+      linuxMountTablePaths: [mtabPath],
+      ...overrides,
+    });
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-probe-"));
+    mtabPath = join(dir, "mtab");
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  it("refreshes through the held handle without re-running the pipeline", async () => {
+    await writeFile(mtabPath, `/dev/sdz9 ${dir} xfs rw,relatime 0 0\n`);
+    const calls: string[] = [];
+    const handle = {};
+    const native = {
+      getVolumeMetadata: async () => {
+        calls.push("getVolumeMetadata");
+        return { size: 100, used: 10, available: 90, uuid: "u-1" };
+      },
+      openVolumeProbe: async (o: GetVolumeMetadataOptions) => {
+        calls.push("open");
+        expect(o).toEqual({
+          mountPoint: dir,
+          device: "/dev/sdz9",
+          fstype: "xfs",
+          includeQuota: true,
+          historySize: 64,
+        });
+        return handle;
+      },
+      refreshVolumeProbe: async (h: unknown) => {
+        calls.push("refresh");
+        expect(h).toBe(handle);
+        // Native refresh results carry null identity fields:
+        return {
+          size: 100,
+          used: 40,
+          available: 60,
+          uuid: null,
+          label: null,
+          quotaType: "project",
+          quotaLimit: 50,
+          quotaUsed: 20,
+          quotaAvailable: 30,
+        } as unknown as VolumeMetadata;
+      },
+      closeVolumeProbe: (h: unknown) => {
+        calls.push("close");
+        expect(h).toBe(handle);
+      },
+    } as unknown as NativeBindings;
+
+    const probe = await createVolumeProbeImpl(
+      opts({ includeQuota: true }),
+      () => native,
+    );
+    const result = await probe.refresh();
+    probe.close();
+
+    expect(calls).toEqual(["getVolumeMetadata", "open", "refresh", "close"]);
+    expect(result).toMatchObject({
+      mountPoint: dir,
+      fstype: "xfs",
+      uuid: "u-1",
+      status: "healthy",
+      used: 40,
+      available: 60,
+      quotaType: "project",
+      quotaAvailable: 30,
+    });
+  });
+
+  it("never touches a skipped network volume, even on refresh", async () => {
+    await writeFile(mtabPath, `nas:/export ${dir} nfs rw,relatime 0 0\n`);
+    const probe = await createVolumeProbeImpl(
+      opts({ skipNetworkVolumes: true }),
+      () => {
+        throw new Error("native bindings must not be used");
+      },
+    );
+    const result = await probe.refresh();
+    expect(result.status).toBe("unknown");
+    expect(result.remote).toBe(true);
+    expect(result.size).toBeUndefined();
+    expect(probe.trend()).toBeUndefined();
+    probe.close();
+  });
+
+  it("reads trends from the native history, even after close()", async () => {
+    await writeFile(mtabPath, `/dev/sdz9 ${dir} ext4 rw,relatime 0 0\n`);
+    const handle = {};
+    const trend = {
+      samples: 3,
+      spanSeconds: 20,
+      used: 700,
+      available: 300,
+      bytesPerSecond: 10,
+      secondsToFull: 30,
+      inodesFree: 50,
+      inodesPerSecond: 0,
+    };
+    const opened: unknown[] = [];
+    const native = {
+      getVolumeMetadata: async () => ({ size: 1000, used: 700 }),
+      openVolumeProbe: async (o: unknown) => {
+        opened.push(o);
+        return handle;
+      },
+      getVolumeProbeTrend: (h: unknown) => {
+        expect(h).toBe(handle);
+        return trend;
+      },
+      closeVolumeProbe: () => undefined,
+    } as unknown as NativeBindings;
+
+    const probe = await createVolumeProbeImpl(
+      opts({ historySize: 8 }),
+      () => native,
+    );
+    expect(opened).toMatchObject([{ historySize: 8 }]);
+    expect(probe.trend()).toEqual(trend);
+    probe.close();
+    expect(probe.trend()).toEqual(trend);
+  });
+
+  it("rejects an invalid historySize before any native call", async () => {
+    for (const historySize of [0, 1, 2.5, 4097, NaN]) {
+      await expect(
+        createVolumeProbeImpl(opts({ historySize }), () => {
+          throw new Error("native bindings must not be used");
+        }),
+      ).rejects.toThrow(/historySize/);
+    }
+  });
+
+  it("uses the held handle with the real bindings", async () => {
+    expect(isLinux).toBe(true);
+    const probe = await createVolumeProbe("/", { includeQuota: true });
+    try {
+      const a = await probe.refresh();
+      const b = await probe.refresh();
+      expect(b.size).toBe(a.size);
+      if (b.inodes != null) {
+        expect(b.inodesFree).toBeLessThanOrEqual(b.inodes);
+      }
+      const trend = probe.trend();
+      expect(trend?.samples).toBe(3);
+      expect(trend?.spanSeconds).toBeGreaterThanOrEqual(0);
+      expect(trend?.available).toBeGreaterThanOrEqual(0);
+    } finally {
+      probe.close();
+    }
+  });
+});
@@ -0,0 +1,202 @@
+// src/volume_probe.ts
+
+import { validateTimeoutMs, withTimeout } from "./async";
+import { debug } from "./debuglog";
+import { compactValues, omit } from "./object";
+import { isLinux } from "./platform";
+import { isNotBlank } from "./string";
+import type { CapacityTrend } from "./types/capacity_trend";
+import type {
+  GetVolumeMetadataOptions,
+  NativeBindingsFn,
+  NativeVolumeProbeHandle,
+} from "./types/native_bindings";
+import type { Options } from "./types/options";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import { VolumeHealthStatuses } from "./volume_health_status";
+import { getVolumeMetadataImpl } from "./volume_metadata";
+
+/**
+ * Settings specific to {@link createVolumeProbe}.
+ */
+export interface VolumeProbeOptions {
+  /**
+   * How many recent space samples {@link VolumeProbe.trend} fits its rates
+   * to. Kept natively, in a fixed-size ring: an integer from 2 to 4096.
+   *
+   * @see {@link VolumeProbeHistorySizeDefault}
+   */
+  historySize?: number;
+}
+
+/**
+ * Default value for {@link VolumeProbeOptions.historySize}.
+ */
+export const VolumeProbeHistorySizeDefault = 64;
+
+/**
+ * A prepared handle for polling one volume. See {@link createVolumeProbe}.
+ */
+export interface VolumeProbe {
+  readonly mountPoint: string;
+
+  /**
+   * Metadata from the most recent successful probe.
+   */
+  readonly metadata: VolumeMetadata;
+
+  /**
+   * Re-read the fields that change while a volume stays mounted (space,
+   * quota, and on macOS and Windows, health status) and merge them over the
+   * identity cached when the probe was created. Bounded by `timeoutMs`.
+   *
+   * @throws if the probe is closed, or the volume cannot be read
+   */
+  refresh(): Promise<VolumeMetadata>;
+
+  /**
+   * Fill rate and time-to-full estimates for space and inodes, from the
+   * samples taken at creation and by each successful {@link refresh}. Cheap
+   * and synchronous: the history lives in native memory, not in JavaScript.
+   *
+   * **Linux only.** Undefined on other platforms, and for network volumes
+   * skipped with `skipNetworkVolumes`. Still answers after {@link close}.
+   */
+  trend(): CapacityTrend | undefined;
+
+  /**
+   * Release the held descriptor. Idempotent. Probes that are never closed
+   * release it when garbage collected.
+   */
+  close(): void;
+}
+
+/**
+ * Fields that {@link VolumeProbe.refresh} re-reads. Everything else (uuid,
+ * label, fstype, remote info, system-volume classification, ...) is identity,
+ * fixed for the life of the mount.
+ */
+const DynamicFields = [
+  "size",
+  "used",
+  "available",
+  "inodes",
+  "inodesFree",
+  "quotaType",
+  "quotaLimit",
+  "quotaUsed",
+  "quotaAvailable",
+] as const satisfies readonly (keyof VolumeMetadata)[];
+
+export async function createVolumeProbeImpl(
+  o: GetVolumeMetadataOptions & Options & VolumeProbeOptions,
+  nativeFn: NativeBindingsFn,
+): Promise<VolumeProbe> {
+  const desc = "createVolumeProbe()";
+  const timeoutMs = validateTimeoutMs(o.timeoutMs, desc);
+  const historySize = o.historySize ?? VolumeProbeHistorySizeDefault;
+  if (
+    !Number.isInteger(historySize) ||
+    historySize < 2 ||
+    historySize > 4096
+  ) {
+    throw new TypeError(
+      `${desc}: historySize must be an integer from 2 to 4096, but got ` +
+        JSON.stringify(o.historySize),
+    );
+  }
+
+  // The full pipeline runs once: mount table, health check, blkid and
+  // subvolume identity, remote info, and system-volume matching.
+  let metadata = await getVolumeMetadataImpl(o, nativeFn);
+  const { mountPoint } = metadata;
+  const identity = omit(metadata, ...DynamicFields);
+
+  // skipNetworkVolumes returned mount-table-only metadata without touching
+  // the volume; refreshing must not touch it either.
+  const untouchable =
+    o.skipNetworkVolumes &&
+    metadata.remote === true &&
+    metadata.status === VolumeHealthStatuses.unknown;
+
+  const native = untouchable ? undefined : await nativeFn();
+
+  // Linux holds the mount point's fd, so refresh() is one fstatvfs() (plus
+  // quotactl with includeQuota) with nothing to re-parse or re-validate.
+  let handle: NativeVolumeProbeHandle | undefined;
+  if (isLinux && native?.openVolumeProbe != null) {
+    handle = await withTimeout({
+      desc,
+      timeoutMs,
+      promise: native.openVolumeProbe({
+        mountPoint,
+        ...(isNotBlank(metadata.mountFrom)
+          ? { device: metadata.mountFrom }
+          : {}),
+        ...(isNotBlank(metadata.fstype) ? { fstype: metadata.fstype } : {}),
+        includeQuota: o.includeQuota ?? false,
+        historySize,
+      }),
+    });
+  }
+
+  // Elsewhere, refresh() re-issues the native call with options built once.
+  const nativeOptions: GetVolumeMetadataOptions = {
+    ...o,
+    mountPoint,
+  };
+
+  let closed = false;
+  // Kept past close(): the history outlives the descriptor.
+  const trendHandle = handle;
+
+  async function readDynamic(): Promise<Partial<VolumeMetadata>> {
+    if (native == null) return {};
+    if (handle != null && native.refreshVolumeProbe != null) {
+      return native.refreshVolumeProbe(handle);
+    }
+    return native.getVolumeMetadata(nativeOptions);
+  }
+
+  return {
+    mountPoint,
+    get metadata() {
+      return metadata;
+    },
+    async refresh() {
+      if (closed) {
+        throw new Error(`${desc}: probe for ${mountPoint} is closed`);
+      }
+      const dynamic = await withTimeout({
+        desc: "VolumeProbe.refresh()",
+        timeoutMs,
+        promise: readDynamic(),
+      });
+      debug("[VolumeProbe] %s refreshed: %o", mountPoint, dynamic);
+      const picked = compactValues(
+        Object.fromEntries(DynamicFields.map((key) => [key, dynamic[key]])),
+      );
+      // Only the non-Linux fallback reports status; a successful fstatvfs()
+      // on the held fd means the volume is answering.
+      const status =
+        handle == null && isNotBlank(dynamic.status)
+          ? dynamic.status
+          : identity.status;
+      metadata = { ...identity, ...picked, status } as VolumeMetadata;
+      return metadata;
+    },
+    trend() {
+      return trendHandle == null
+        ? undefined
+        : native?.getVolumeProbeTrend?.(trendHandle);
+    },
+    close() {
+      if (closed) return;
+      closed = true;
+      if (handle != null) {
+        native?.closeVolumeProbe?.(handle);
+        handle = undefined;
+      }
+    },
+  };
+}
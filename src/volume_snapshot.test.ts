@@ -0,0 +1,231 @@
+// src/volume_snapshot.test.ts
+
+import { jest } from "@jest/globals";
+import { decodeVolumeSnapshot as decodeWithNative } from "./index";
+import type { NativeBindings } from "./types/native_bindings";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import {
+  decodeVolumeSnapshot,
+  decodeVolumeSnapshotImpl,
+  encodeVolumeSnapshot,
+  readVolumeSnapshot,
+  VolumeSnapshotVersion,
+} from "./volume_snapshot";
+
+function volume(i: number, extra: Partial<VolumeMetadata> = {}) {
+  return {
+    mountPoint: `/mnt/vol${i}`,
+    fstype: i % 3 === 0 ? "nfs" : "ext4",
+    status: "healthy",
+    isSystemVolume: false,
+    isReadOnly: i % 2 === 0,
+    size: 1_000_000_000_000 + i,
+    used: 400_000_000_000 + i * 4096,
+    available: 600_000_000_000 - i * 4096,
+    inodes: 65536,
+    inodesFree: 60000 - i,
+    mountFrom: `/dev/sd${String.fromCharCode(97 + (i % 26))}1`,
+    uuid: `0000-${i.toString(16).padStart(4, "0")}`,
+    ...extra,
+  } as VolumeMetadata;
+}
+
+// Errors don't compare structurally: reduce them to name and message.
+function plain(volumes: readonly VolumeMetadata[]) {
+  return volumes.map((v) =>
+    Object.fromEntries(
+      Object.entries(v)
+        .filter(([, value]) => value !== undefined)
+        .map(([key, value]) => [
+          key,
+          value instanceof Error ? [value.name, value.message] : value,
+        ])
+        .sort(([a], [b]) => String(a).localeCompare(String(b))),
+    ),
+  );
+}
+
+describe("volume snapshots", () => {
+  const volumes = Array.from({ length: 200 }, (_, i) => volume(i));
+
+  it("roundtrips every VolumeMetadata field", () => {
+    const bytes = encodeVolumeSnapshot(volumes);
+    expect(plain(decodeVolumeSnapshot(bytes))).toEqual(plain(volumes));
+  });
+
+  it("is much smaller than JSON", () => {
+    const bytes = encodeVolumeSnapshot(volumes);
+    const json = Buffer.byteLength(JSON.stringify(volumes));
+    expect(bytes.length).toBeLessThan(json / 2);
+  });
+
+  it("keeps error names and plain-string errors", () => {
+    const timeout = new Error("probe timed out");
+    timeout.name = "TimeoutError";
+    const input = [
+      volume(1, { status: "inaccessible", error: timeout }),
+      volume(2, { status: "unknown", error: "ENOENT" }),
+    ];
+    const [a, b] = decodeVolumeSnapshot(encodeVolumeSnapshot(input));
+    expect(a?.error).toBeInstanceOf(Error);
+    expect((a?.error as Error).name).toBe("TimeoutError");
+    expect((a?.error as Error).message).toBe("probe timed out");
+    expect(b?.error).toBe("ENOENT");
+  });
+
+  it("keeps fractional, negative and very large numbers exactly", () => {
+    const input = [
+      volume(1, { size: 1.5, used: -42, available: 2 ** 60 }),
+      volume(2, { size: Number.MAX_VALUE, used: 0, available: -0.25 }),
+    ];
+    expect(plain(decodeVolumeSnapshot(encodeVolumeSnapshot(input)))).toEqual(
+      plain(input),
+    );
+  });
+
+  it("drops fields that aren't part of VolumeMetadata", () => {
+    const input = [{ ...volume(1), extra: "nope" } as VolumeMetadata];
+    const [v] = decodeVolumeSnapshot(encodeVolumeSnapshot(input));
+    expect(v).not.toHaveProperty("extra");
+  });
+
+  describe("readVolumeSnapshot()", () => {
+    it("decodes volumes on access, in any order", () => {
+      const reader = readVolumeSnapshot(encodeVolumeSnapshot(volumes));
+      expect(reader.version).toBe(VolumeSnapshotVersion);
+      expect(reader.length).toBe(volumes.length);
+      expect(plain([reader.get(150)])).toEqual(plain([volumes[150]!]));
+      expect(plain([reader.get(3)])).toEqual(plain([volumes[3]!]));
+      expect(plain([...reader])).toEqual(plain(volumes));
+    });
+
+    it("rejects out-of-bounds indexes", () => {
+      const reader = readVolumeSnapshot(encodeVolumeSnapshot(volumes));
+      expect(() => reader.get(volumes.length)).toThrow(RangeError);
+      expect(() => reader.get(-1)).toThrow(RangeError);
+    });
+
+    it("rejects delta snapshots", () => {
+      const delta = encodeVolumeSnapshot(volumes, { base: volumes });
+      expect(() => readVolumeSnapshot(delta)).toThrow(TypeError);
+    });
+  });
+
+  describe("deltas", () => {
+    const next = [
+      ...volumes.slice(0, 100),
+      // changed
+      volume(100, { used: volumes[100]!.used + 8192, label: "data" }),
+      // removed field
+      { ...volumes[101]!, uuid: undefined } as VolumeMetadata,
+      ...volumes.slice(103), // volume 102 unmounted
+      volume(500), // newly mounted
+    ];
+
+    it("roundtrips changed, removed and new volumes", () => {
+      const delta = encodeVolumeSnapshot(next, { base: volumes });
+      expect(plain(decodeVolumeSnapshot(delta, { base: volumes }))).toEqual(
+        plain(next),
+      );
+    });
+
+    it("only writes what changed", () => {
+      const delta = encodeVolumeSnapshot(next, { base: volumes });
+      expect(delta.length).toBeLessThan(
+        encodeVolumeSnapshot(next).length / 10,
+      );
+    });
+
+    it("chains: each snapshot can be the next one's base", () => {
+      let base = volumes;
+      for (let round = 1; round <= 3; round++) {
+        const current = base.map((v) => ({ ...v, used: v.used + round }));
+        const delta = encodeVolumeSnapshot(current, { base });
+        base = decodeVolumeSnapshot(delta, { base });
+        expect(plain(base)).toEqual(plain(current));
+      }
+    });
+
+    it("throws without the base it was encoded against", () => {
+      const delta = encodeVolumeSnapshot(next, { base: volumes });
+      expect(() => decodeVolumeSnapshot(delta)).toThrow(TypeError);
+      expect(() => decodeVolumeSnapshot(delta, { base: next })).toThrow(
+        TypeError,
+      );
+      const tampered = volumes.map((v, i) =>
+        i === 7 ? { ...v, used: v.used + 1 } : v,
+      );
+      expect(() => decodeVolumeSnapshot(delta, { base: tampered })).toThrow(
+        TypeError,
+      );
+    });
+  });
+
+  describe("invalid input", () => {
+    it("rejects bytes that aren't a snapshot", () => {
+      expect(() => decodeVolumeSnapshot(new Uint8Array([1, 2, 3]))).toThrow(
+        TypeError,
+      );
+      expect(() =>
+        decodeVolumeSnapshot(new TextEncoder().encode('{"json":true}')),
+      ).toThrow(TypeError);
+    });
+
+    it("rejects other versions", () => {
+      const bytes = encodeVolumeSnapshot(volumes);
+      bytes[4] = VolumeSnapshotVersion + 1;
+      expect(() => decodeVolumeSnapshot(bytes)).toThrow(/version/);
+    });
+
+    it("rejects truncated snapshots", () => {
+      const bytes = encodeVolumeSnapshot(volumes);
+      for (const end of [6, 40, bytes.length - 1]) {
+        expect(() => decodeVolumeSnapshot(bytes.subarray(0, end))).toThrow(
+          /truncated/,
+        );
+      }
+    });
+  });
+
+  describe("native decoding", () => {
+    it("is used for full snapshots only", () => {
+      const native = jest.fn((_bytes: Uint8Array) => [] as VolumeMetadata[]);
+      const nativeFn = () =>
+        ({ decodeVolumeSnapshot: native }) as unknown as NativeBindings;
+      const full = encodeVolumeSnapshot(volumes);
+      expect(decodeVolumeSnapshotImpl(full, {}, nativeFn)).toEqual([]);
+      expect(native).toHaveBeenCalledWith(full);
+
+      const delta = encodeVolumeSnapshot(volumes, { base: volumes });
+      native.mockClear();
+      expect(
+        decodeVolumeSnapshotImpl(delta, { base: volumes }, nativeFn),
+      ).toHaveLength(volumes.length);
+      expect(native).not.toHaveBeenCalled();
+    });
+
+    it("matches the JavaScript decoder", () => {
+      const timeout = new Error("probe timed out");
+      timeout.name = "TimeoutError";
+      const input = [
+        ...volumes,
+        volume(900, { error: timeout, size: 1.5, used: 2 ** 60 }),
+        volume(901, { error: "ENOENT", remote: true, label: "日本語" }),
+      ];
+      const bytes = Buffer.from(encodeVolumeSnapshot(input));
+      expect(plain(decodeWithNative(bytes))).toEqual(
+        plain(decodeVolumeSnapshot(bytes)),
+      );
+    });
+
+    it("rejects a volume count the bytes can't hold", () => {
+      // An empty snapshot ends with its volume count: claim 2^32 - 1.
+      const empty = encodeVolumeSnapshot([]);
+      const bytes = Buffer.concat([
+        empty.subarray(0, empty.length - 1),
+        Buffer.from([0xff, 0xff, 0xff, 0xff, 0x0f]),
+      ]);
+      expect(() => decodeWithNative(bytes)).toThrow(/truncated/);
+    });
+  });
+});
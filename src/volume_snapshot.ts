@@ -0,0 +1,658 @@
+// src/volume_snapshot.ts
+//
+// Compact binary snapshots of VolumeMetadata[], for shipping volume state
+// between hosts and persisting it across restarts.
+//
+// Layout (all varints are unsigned LEB128):
+//
+//   "FSMS" | version u8 | flags u8
+//   [flags & Delta: base checksum u32le | base volume count varint]
+//   string count varint | (byte length varint | UTF-8 bytes)*
+//   volume count varint | record*
+//
+// A full record is a presence bitset over Fields, then each present value in
+// field order: strings as string table indexes, booleans as one byte, and
+// numbers as zigzag varints (or a float64 escape). Every string is stored
+// once, however many volumes share it.
+//
+// A delta record starts with a varint reference into the base snapshot: 0 is
+// a new volume (a full record follows), 2(i+1)+1 is base[i] unchanged, and
+// 2(i+1) is base[i] with changes: a bitset of changed fields, a bitset of
+// removed fields, then the changed values. Numbers that were already present
+// are stored as the difference from the base value.
+//
+// src/common/volume_snapshot.h reads the same format natively.
+
+import { WrappedError } from "./error";
+import type { NativeBindings } from "./types/native_bindings";
+import type { VolumeMetadata } from "./types/volume_metadata";
+
+/**
+ * Format version written by {@link encodeVolumeSnapshot}. Readers reject any
+ * other version.
+ */
+export const VolumeSnapshotVersion = 1;
+
+const Magic = [0x46, 0x53, 0x4d, 0x53]; // "FSMS"
+const FlagDelta = 1;
+
+type FieldKind = "string" | "number" | "boolean" | "error";
+
+// Wire order: a field's position is its id in the format, so append only
+// (and bump VolumeSnapshotVersion when the kind of any field changes).
+// Keep in sync with kSnapshotFields in src/common/volume_snapshot.h.
+const Fields: readonly (readonly [keyof VolumeMetadata, FieldKind])[] = [
+  ["mountPoint", "string"],
+  ["fstype", "string"],
+  ["status", "string"],
+  ["isSystemVolume", "boolean"],
+  ["volumeRole", "string"],
+  ["subvol", "string"],
+  ["subvolid", "number"],
+  ["isSnapshot", "boolean"],
+  ["snapshotOrigin", "string"],
+  ["isReadOnly", "boolean"],
+  ["error", "error"],
+  ["label", "string"],
+  ["size", "number"],
+  ["used", "number"],
+  ["available", "number"],
+  ["inodes", "number"],
+  ["inodesFree", "number"],
+  ["mountFrom", "string"],
+  ["mountName", "string"],
+  ["uuid", "string"],
+  ["subvolumeUuid", "string"],
+  ["subvolumeParentUuid", "string"],
+  ["fsid", "string"],
+  ["zfsDatasetGuid", "string"],
+  ["zfsPoolGuid", "string"],
+  ["zfsObjsetId", "string"],
+  ["quotaType", "string"],
+  ["quotaLimit", "number"],
+  ["quotaUsed", "number"],
+  ["quotaAvailable", "number"],
+  ["uri", "string"],
+  ["protocol", "string"],
+  ["remote", "boolean"],
+  ["remoteUser", "string"],
+  ["remoteHost", "string"],
+  ["remoteShare", "string"],
+];
+
+const BitsetBytes = Math.ceil(Fields.length / 8);
+
+// Integers below this magnitude take the varint path: doubled zigzag values
+// stay exact doubles. Anything else is a float64.
+const MaxVarintMagnitude = 2 ** 50;
+
+type FieldValue = string | number | boolean | Error;
+
+function fieldValue(
+  v: VolumeMetadata,
+  [key, kind]: readonly [keyof VolumeMetadata, FieldKind],
+): FieldValue | undefined {
+  const value: unknown = v[key];
+  switch (kind) {
+    case "string":
+      return typeof value === "string" ? value : undefined;
+    case "number":
+      return typeof value === "number" ? value : undefined;
+    case "boolean":
+      return typeof value === "boolean" ? value : undefined;
+    case "error":
+      return value instanceof Error || typeof value === "string"
+        ? value
+        : undefined;
+  }
+}
+
+function sameValue(a: FieldValue | undefined, b: FieldValue | undefined) {
+  if (a instanceof Error || b instanceof Error) {
+    return (
+      a instanceof Error &&
+      b instanceof Error &&
+      a.name === b.name &&
+      a.message === b.message
+    );
+  }
+  return Object.is(a, b);
+}
+
+function isVarintNumber(n: number): boolean {
+  return Number.isInteger(n) && Math.abs(n) < MaxVarintMagnitude;
+}
+
+class Writer {
+  #buf = new Uint8Array(1024);
+  #view = new DataView(this.#buf.buffer);
+  #pos = 0;
+  readonly #strings = new Map<string, number>();
+  readonly #encoder = new TextEncoder();
+
+  #ensure(n: number) {
+    if (this.#pos + n <= this.#buf.length) return;
+    const next = new Uint8Array(Math.max(this.#buf.length * 2, this.#pos + n));
+    next.set(this.#buf.subarray(0, this.#pos));
+    this.#buf = next;
+    this.#view = new DataView(next.buffer);
+  }
+
+  byte(b: number) {
+    this.#ensure(1);
+    this.#buf[this.#pos++] = b;
+  }
+
+  uint32(n: number) {
+    this.#ensure(4);
+    this.#view.setUint32(this.#pos, n, true);
+    this.#pos += 4;
+  }
+
+  varint(n: number) {
+    this.#ensure(10);
+    while (n >= 0x80) {
+      this.#buf[this.#pos++] = (n % 0x80) | 0x80;
+      n = Math.floor(n / 0x80);
+    }
+    this.#buf[this.#pos++] = n;
+  }
+
+  number(n: number) {
+    if (isVarintNumber(n)) {
+      // zigzag, then doubled: the low bit flags the float64 escape.
+      this.varint((n >= 0 ? n * 2 : -n * 2 - 1) * 2);
+    } else {
+      this.varint(1);
+      this.#ensure(8);
+      this.#view.setFloat64(this.#pos, n, true);
+      this.#pos += 8;
+    }
+  }
+
+  bitset(bits: boolean[]) {
+    for (let i = 0; i < BitsetBytes; i++) {
+      let b = 0;
+      for (let bit = 0; bit < 8; bit++) {
+        if (bits[i * 8 + bit] === true) b |= 1 << bit;
+      }
+      this.byte(b);
+    }
+  }
+
+  /** Interns `s`, returning its string table index. */
+  intern(s: string): number {
+    let index = this.#strings.get(s);
+    if (index == null) {
+      index = this.#strings.size;
+      this.#strings.set(s, index);
+    }
+    return index;
+  }
+
+  value(kind: FieldKind, value: FieldValue) {
+    switch (kind) {
+      case "string":
+        this.varint(this.intern(value as string));
+        break;
+      case "number":
+        this.number(value as number);
+        break;
+      case "boolean":
+        this.byte(value === true ? 1 : 0);
+        break;
+      case "error":
+        // 0: a plain string. Otherwise an Error, with its name at index - 1.
+        if (value instanceof Error) {
+          this.varint(this.intern(value.name) + 1);
+          this.varint(this.intern(value.message));
+        } else {
+          this.varint(0);
+          this.varint(this.intern(value as string));
+        }
+        break;
+    }
+  }
+
+  /**
+   * The finished snapshot: the header, then the string table interned while
+   * writing the body, then the body.
+   */
+  finish(header: (w: Writer) => void): Uint8Array {
+    const body = this.#buf.subarray(0, this.#pos);
+    const out = new Writer();
+    header(out);
+    out.varint(this.#strings.size);
+    for (const s of this.#strings.keys()) {
+      const bytes = this.#encoder.encode(s);
+      out.varint(bytes.length);
+      out.#ensure(bytes.length);
+      out.#buf.set(bytes, out.#pos);
+      out.#pos += bytes.length;
+    }
+    out.#ensure(body.length);
+    out.#buf.set(body, out.#pos);
+    out.#pos += body.length;
+    return out.#buf.slice(0, out.#pos);
+  }
+}
+
+function writeFullRecord(w: Writer, v: VolumeMetadata) {
+  const values = Fields.map((field) => fieldValue(v, field));
+  w.bitset(values.map((ea) => ea !== undefined));
+  Fields.forEach(([, kind], i) => {
+    const value = values[i];
+    if (value !== undefined) w.value(kind, value);
+  });
+}
+
+// FNV-1a: identifies the base a delta was encoded against.
+function checksum(bytes: Uint8Array): number {
+  let hash = 0x811c9dc5;
+  for (const b of bytes) {
+    hash = Math.imul(hash ^ b, 0x01000193) >>> 0;
+  }
+  return hash;
+}
+
+/**
+ * Encode volumes as a compact binary snapshot. Only the fields of
+ * {@link VolumeMetadata} are kept; errors keep their `name` and `message`.
+ *
+ * With `base`, the snapshot is a delta that only {@link decodeVolumeSnapshot}
+ * given the same `base` can decode: volumes are matched to the base by
+ * `mountPoint`, and only what changed is written.
+ */
+export function encodeVolumeSnapshot(
+  volumes: readonly VolumeMetadata[],
+  opts: { base?: readonly VolumeMetadata[] } = {},
+): Uint8Array {
+  const { base } = opts;
+  const w = new Writer();
+  w.varint(volumes.length);
+  if (base == null) {
+    for (const v of volumes) writeFullRecord(w, v);
+    return w.finish((h) => writeHeader(h, 0));
+  }
+
+  const baseIndex = new Map<string, number>();
+  base.forEach((v, i) => {
+    if (!baseIndex.has(v.mountPoint)) baseIndex.set(v.mountPoint, i);
+  });
+  for (const v of volumes) {
+    const i = baseIndex.get(v.mountPoint);
+    const prev = i == null ? undefined : base[i];
+    if (i == null || prev == null) {
+      w.varint(0);
+      writeFullRecord(w, v);
+      continue;
+    }
+    const before = Fields.map((field) => fieldValue(prev, field));
+    const after = Fields.map((field) => fieldValue(v, field));
+    const changed = after.map(
+      (ea, f) => ea !== undefined && !sameValue(ea, before[f]),
+    );
+    const removed = after.map(
+      (ea, f) => ea === undefined && before[f] !== undefined,
+    );
+    if (!changed.includes(true) && !removed.includes(true)) {
+      w.varint(2 * (i + 1) + 1);
+      continue;
+    }
+    w.varint(2 * (i + 1));
+    w.bitset(changed);
+    w.bitset(removed);
+    Fields.forEach(([, kind], f) => {
+      const value = after[f];
+      if (!changed[f] || value === undefined) return;
+      const prior = before[f];
+      if (kind === "number" && typeof prior === "number") {
+        const delta = (value as number) - prior;
+        // Exact differences only: anything else is written absolute.
+        if (
+          isVarintNumber(value as number) &&
+          isVarintNumber(prior) &&
+          isVarintNumber(delta)
+        ) {
+          w.byte(1);
+          w.number(delta);
+        } else {
+          w.byte(0);
+          w.number(value as number);
+        }
+      } else {
+        w.value(kind, value);
+      }
+    });
+  }
+  const baseBytes = encodeVolumeSnapshot(base);
+  return w.finish((h) => {
+    writeHeader(h, FlagDelta);
+    h.uint32(checksum(baseBytes));
+    h.varint(base.length);
+  });
+}
+
+function writeHeader(w: Writer, flags: number) {
+  for (const b of Magic) w.byte(b);
+  w.byte(VolumeSnapshotVersion);
+  w.byte(flags);
+}
+
+class Reader {
+  readonly #bytes: Uint8Array;
+  readonly #view: DataView;
+  pos = 0;
+
+  constructor(bytes: Uint8Array) {
+    this.#bytes = bytes;
+    this.#view = new DataView(bytes.buffer, bytes.byteOffset, bytes.length);
+  }
+
+  #need(n: number) {
+    if (this.pos + n > this.#bytes.length) {
+      throw new WrappedError("volume snapshot is truncated", {
+        name: "RangeError",
+      });
+    }
+  }
+
+  byte(): number {
+    this.#need(1);
+    return this.#bytes[this.pos++] as number;
+  }
+
+  uint32(): number {
+    this.#need(4);
+    const n = this.#view.getUint32(this.pos, true);
+    this.pos += 4;
+    return n;
+  }
+
+  varint(): number {
+    let n = 0;
+    let scale = 1;
+    for (;;) {
+      const b = this.byte();
+      n += (b & 0x7f) * scale;
+      if (b < 0x80) return n;
+      scale *= 0x80;
+      if (scale > 2 ** 56) {
+        throw new WrappedError("volume snapshot has an invalid varint", {
+          name: "RangeError",
+        });
+      }
+    }
+  }
+
+  number(): number {
+    const u = this.varint();
+    if (u % 2 === 1) {
+      this.#need(8);
+      const n = this.#view.getFloat64(this.pos, true);
+      this.pos += 8;
+      return n;
+    }
+    const z = u / 2;
+    return z % 2 === 0 ? z / 2 : -(z + 1) / 2;
+  }
+
+  bitset(): boolean[] {
+    this.#need(BitsetBytes);
+    const bits: boolean[] = [];
+    for (let i = 0; i < Fields.length; i++) {
+      const b = this.#bytes[this.pos + (i >> 3)] as number;
+      bits.push((b & (1 << i % 8)) !== 0);
+    }
+    this.pos += BitsetBytes;
+    return bits;
+  }
+
+  skip(n: number) {
+    this.#need(n);
+    this.pos += n;
+  }
+
+  subarray(start: number, length: number): Uint8Array {
+    return this.#bytes.subarray(start, start + length);
+  }
+}
+
+interface Parsed {
+  reader: Reader;
+  version: number;
+  isDelta: boolean;
+  baseChecksum: number;
+  baseLength: number;
+  string: (index: number) => string;
+  length: number;
+  /** Offset of the first record. */
+  bodyStart: number;
+}
+
+function parse(bytes: Uint8Array): Parsed {
+  const r = new Reader(bytes);
+  for (const b of Magic) {
+    if (r.byte() !== b) {
+      throw new TypeError("not a volume snapshot");
+    }
+  }
+  const version = r.byte();
+  if (version !== VolumeSnapshotVersion) {
+    throw new TypeError(
+      `unsupported volume snapshot version ${version} (expected ${VolumeSnapshotVersion})`,
+    );
+  }
+  const isDelta = (r.byte() & FlagDelta) !== 0;
+  const baseChecksum = isDelta ? r.uint32() : 0;
+  const baseLength = isDelta ? r.varint() : 0;
+
+  // Strings stay in `bytes` until first use; each is decoded at most once.
+  const count = r.varint();
+  const offsets = new Array<number>(count);
+  const lengths = new Array<number>(count);
+  for (let i = 0; i < count; i++) {
+    lengths[i] = r.varint();
+    offsets[i] = r.pos;
+    r.skip(lengths[i] as number);
+  }
+  const decoded = new Array<string | undefined>(count);
+  const decoder = new TextDecoder("utf-8", { fatal: true });
+  const string = (index: number): string => {
+    if (!(index >= 0 && index < count)) {
+      throw new WrappedError(`volume snapshot string ${index} is missing`, {
+        name: "RangeError",
+      });
+    }
+    return (decoded[index] ??= decoder.decode(
+      r.subarray(offsets[index] as number, lengths[index] as number),
+    ));
+  };
+  const length = r.varint();
+  return {
+    reader: r,
+    version,
+    isDelta,
+    baseChecksum,
+    baseLength,
+    string,
+    length,
+    bodyStart: r.pos,
+  };
+}
+
+function readValue(
+  r: Reader,
+  kind: FieldKind,
+  string: (index: number) => string,
+): FieldValue {
+  switch (kind) {
+    case "string":
+      return string(r.varint());
+    case "number":
+      return r.number();
+    case "boolean":
+      return r.byte() !== 0;
+    case "error": {
+      const name = r.varint();
+      const message = string(r.varint());
+      return name === 0
+        ? message
+        : new WrappedError(message, { name: string(name - 1) });
+    }
+  }
+}
+
+function readFullRecord(
+  r: Reader,
+  string: (index: number) => string,
+): VolumeMetadata {
+  const present = r.bitset();
+  const result: Record<string, FieldValue> = {};
+  Fields.forEach(([key, kind], f) => {
+    if (present[f]) result[key] = readValue(r, kind, string);
+  });
+  return result as unknown as VolumeMetadata;
+}
+
+/**
+ * A lazy view of a full (non-delta) snapshot. Nothing is copied out of the
+ * snapshot bytes up front: volumes are decoded on access, and each interned
+ * string at most once.
+ */
+export interface VolumeSnapshotReader {
+  readonly version: number;
+  readonly length: number;
+  /**
+   * Decode the volume at `index`.
+   *
+   * @throws {RangeError} if `index` is out of bounds
+   */
+  get(index: number): VolumeMetadata;
+  [Symbol.iterator](): Iterator<VolumeMetadata>;
+}
+
+/**
+ * Open a full snapshot from {@link encodeVolumeSnapshot} without decoding it.
+ * `bytes` must not be modified while the reader is in use.
+ *
+ * @throws {TypeError} for delta snapshots (use {@link decodeVolumeSnapshot}
+ * with their base), other versions, and anything that isn't a snapshot
+ */
+export function readVolumeSnapshot(bytes: Uint8Array): VolumeSnapshotReader {
+  const p = parse(bytes);
+  if (p.isDelta) {
+    throw new TypeError(
+      "readVolumeSnapshot(): delta snapshots need decodeVolumeSnapshot() with their base",
+    );
+  }
+  // Record offsets, found by skimming as far as the furthest access.
+  const offsets = [p.bodyStart];
+  function offsetOf(index: number): number {
+    while (offsets.length <= index) {
+      p.reader.pos = offsets[offsets.length - 1] as number;
+      readFullRecord(p.reader, () => "");
+      offsets.push(p.reader.pos);
+    }
+    return offsets[index] as number;
+  }
+  function get(index: number): VolumeMetadata {
+    if (!(Number.isInteger(index) && index >= 0 && index < p.length)) {
+      throw new RangeError(
+        `readVolumeSnapshot(): index ${index} out of bounds (length ${p.length})`,
+      );
+    }
+    p.reader.pos = offsetOf(index);
+    const result = readFullRecord(p.reader, p.string);
+    if (offsets.length === index + 1) offsets.push(p.reader.pos);
+    return result;
+  }
+  return {
+    version: p.version,
+    length: p.length,
+    get,
+    *[Symbol.iterator]() {
+      for (let i = 0; i < p.length; i++) yield get(i);
+    },
+  };
+}
+
+/**
+ * Decode a snapshot from {@link encodeVolumeSnapshot}.
+ *
+ * @param opts.base Required for delta snapshots: the same volumes the delta
+ * was encoded against (typically the previous decoded snapshot)
+ * @throws {TypeError} if a delta's `base` is missing or is not the one it was
+ * encoded against, or the bytes aren't a supported snapshot
+ */
+export function decodeVolumeSnapshot(
+  bytes: Uint8Array,
+  opts: { base?: readonly VolumeMetadata[] } = {},
+): VolumeMetadata[] {
+  return decodeVolumeSnapshotImpl(bytes, opts);
+}
+
+/**
+ * {@link decodeVolumeSnapshot}, with full snapshots decoded natively when
+ * `nativeFn` provides a decoder. The header is still checked here, so both
+ * paths reject bad input with the same errors.
+ */
+export function decodeVolumeSnapshotImpl(
+  bytes: Uint8Array,
+  opts: { base?: readonly VolumeMetadata[] },
+  nativeFn?: () => NativeBindings,
+): VolumeMetadata[] {
+  const p = parse(bytes);
+  if (!p.isDelta) {
+    const native = nativeFn?.().decodeVolumeSnapshot;
+    return native == null ? [...readVolumeSnapshot(bytes)] : native(bytes);
+  }
+
+  const { base } = opts;
+  if (
+    base == null ||
+    base.length !== p.baseLength ||
+    checksum(encodeVolumeSnapshot(base)) !== p.baseChecksum
+  ) {
+    throw new TypeError(
+      "decodeVolumeSnapshot(): delta snapshot needs the base it was encoded against",
+    );
+  }
+  const r = p.reader;
+  const result: VolumeMetadata[] = [];
+  for (let i = 0; i < p.length; i++) {
+    const ref = r.varint();
+    if (ref === 0) {
+      result.push(readFullRecord(r, p.string));
+      continue;
+    }
+    const prev = base[Math.floor(ref / 2) - 1];
+    if (prev == null) {
+      throw new WrappedError(`volume snapshot base volume ${ref} is missing`, {
+        name: "RangeError",
+      });
+    }
+    const v: Record<string, FieldValue> = {};
+    for (const field of Fields) {
+      const value = fieldValue(prev, field);
+      if (value !== undefined) v[field[0]] = value;
+    }
+    if (ref % 2 === 0) {
+      const changed = r.bitset();
+      const removed = r.bitset();
+      Fields.forEach(([key, kind], f) => {
+        if (removed[f]) delete v[key];
+        if (!changed[f]) return;
+        if (kind === "number" && typeof v[key] === "number") {
+          const isDelta = r.byte() === 1;
+          const n = r.number();
+          v[key] = isDelta ? (v[key] as number) + n : n;
+        } else {
+          v[key] = readValue(r, kind, p.string);
+        }
+      });
+    }
+    result.push(v as unknown as VolumeMetadata);
+  }
+  return result;
+}
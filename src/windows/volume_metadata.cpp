@@ -150,10 +150,10 @@ public:
 
 class GetVolumeMetadataWorker : public MetadataWorkerBase {
 public:
-  GetVolumeMetadataWorker(const std::string &mountPoint,
-                          const VolumeMetadataOptions &options,
+  GetVolumeMetadataWorker(VolumeMetadataOptions &&options,
                           const Napi::Promise::Deferred &deferred)
-      : MetadataWorkerBase(mountPoint, deferred), options_(options) {}
+      : MetadataWorkerBase(options.mountPoint, deferred),
+        options_(std::move(options)) {}
 
 private:
   VolumeMetadataOptions options_;
@@ -253,9 +253,9 @@ Napi::Value GetVolumeMetadata(const Napi::CallbackInfo &info) {
   auto options = VolumeMetadataOptions::FromObject(info[0].As<Napi::Object>());
 
   auto deferred = Napi::Promise::Deferred::New(env);
-  auto *worker =
-      new GetVolumeMetadataWorker(options.mountPoint, options, deferred);
-  worker->Queue();
+  const WorkPriority priority = options.priority;
+  auto *worker = new GetVolumeMetadataWorker(std::move(options), deferred);
+  worker->Queue(priority);
   return deferred.Promise();
 }
 
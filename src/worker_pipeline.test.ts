@@ -0,0 +1,211 @@
+// src/worker_pipeline.test.ts
+
+import { mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { monitorEventLoopDelay } from "node:perf_hooks";
+import { env } from "node:process";
+import { times } from "./array";
+import { TimeoutError } from "./async";
+import { _dirname } from "./dirname";
+import { WrappedError } from "./error";
+import { getMountPointForPath, getVolumeMountPoints } from "./index";
+import { isLinux } from "./platform";
+import { describeSkipWindowsCI } from "./test-utils/platform";
+import {
+  decodePipelineResult,
+  encodePipelineResult,
+  setPipelineWorkerScriptForTest,
+  viaPipelineWorker,
+} from "./worker_pipeline";
+
+describe("worker_pipeline", () => {
+  it("round-trips results, including nested errors", () => {
+    const cause = new WrappedError("statvfs failed", {
+      name: "Skipped",
+      code: "EIO",
+      errno: 5,
+      path: "/mnt/x",
+    });
+    cause.cause = new RangeError("out of range");
+    const decoded = decodePipelineResult<
+      { mountPoint: string; size?: number; error?: Error }[]
+    >(
+      encodePipelineResult([
+        { mountPoint: "/", size: 100 },
+        { mountPoint: "/mnt/x", error: cause },
+      ]),
+    );
+    expect(decoded[0]).toEqual({ mountPoint: "/", size: 100 });
+    const error = decoded[1]?.error as WrappedError;
+    expect(error).toBeInstanceOf(WrappedError);
+    expect(error.name).toBe("Skipped");
+    expect(error.message).toBe(cause.message);
+    expect(error.code).toBe("EIO");
+    expect(error.errno).toBe(5);
+    expect(error.path).toBe("/mnt/x");
+    expect(error.stack).toBe(cause.stack);
+    expect(error.cause).toBeInstanceOf(RangeError);
+    expect((error.cause as Error).message).toBe("out of range");
+  });
+
+  it("round-trips a top-level error", () => {
+    const error = decodePipelineResult<Error>(
+      encodePipelineResult(new TypeError("Invalid pathname")),
+    );
+    expect(error).toBeInstanceOf(TypeError);
+    expect(error.name).toBe("TypeError");
+    expect(error.message).toBe("Invalid pathname");
+  });
+
+  it("rebuilds TimeoutErrors as TimeoutErrors", () => {
+    const error = decodePipelineResult<Error[]>(
+      encodePipelineResult([new TimeoutError("getVolumeMetadata(): timeout")]),
+    )[0];
+    expect(error).toBeInstanceOf(TimeoutError);
+    expect(error?.name).toBe("TimeoutError");
+    expect(error?.message).toBe("getVolumeMetadata(): timeout");
+  });
+
+  it("leaves results without errors as they are", () => {
+    const value = {
+      volumes: [{ mountPoint: "/", size: 100, remote: false }],
+      at: new Date(0),
+    };
+    expect(decodePipelineResult(encodePipelineResult(value))).toEqual(value);
+  });
+
+  it("stays on the calling thread unless asked", () => {
+    expect(viaPipelineWorker(undefined, "getVolumeMountPoints", [])).toBe(
+      undefined,
+    );
+    expect(
+      viaPipelineWorker({ useWorkerThread: false }, "getVolumeMountPoints", []),
+    ).toBe(undefined);
+  });
+
+  it("falls back to the calling thread without a bundled worker script", async () => {
+    // jest runs from TypeScript sources, so there is no worker script:
+    expect(
+      viaPipelineWorker({ useWorkerThread: true }, "getVolumeMountPoints", []),
+    ).toBe(undefined);
+    const [a, b] = await Promise.all([
+      getVolumeMountPoints({ useWorkerThread: true }),
+      getVolumeMountPoints(),
+    ]);
+    expect(a.map((ea) => ea.mountPoint)).toEqual(b.map((ea) => ea.mountPoint));
+  });
+});
+
+describeSkipWindowsCI("worker_pipeline in a worker thread", () => {
+  // Runs src/worker_pipeline_entry.ts from source, through tsx:
+  const script = join(_dirname(), "test-utils", "pipeline-worker.cjs");
+
+  async function startWorker(mode?: "crash" | "timeout") {
+    if (mode == null) delete env["PIPELINE_WORKER_MODE"];
+    else env["PIPELINE_WORKER_MODE"] = mode;
+    await setPipelineWorkerScriptForTest(script);
+  }
+
+  afterEach(async () => {
+    delete env["PIPELINE_WORKER_MODE"];
+    await setPipelineWorkerScriptForTest(undefined);
+  });
+
+  it("returns what the calling thread returns", async () => {
+    await startWorker();
+    const [a, b] = await Promise.all([
+      getVolumeMountPoints({ useWorkerThread: true }),
+      getVolumeMountPoints(),
+    ]);
+    expect(a.map((ea) => ea.mountPoint)).toEqual(b.map((ea) => ea.mountPoint));
+    expect(a.map((ea) => ea.fstype)).toEqual(b.map((ea) => ea.fstype));
+  }, 30_000);
+
+  it("rejects with the worker's error class", async () => {
+    await startWorker();
+    await expect(
+      getMountPointForPath("", { useWorkerThread: true }),
+    ).rejects.toThrow(TypeError);
+  }, 30_000);
+
+  it("rejects with TimeoutError when the worker's call times out", async () => {
+    await startWorker("timeout");
+    const error = await getVolumeMountPoints({ useWorkerThread: true }).then(
+      () => undefined,
+      (e: unknown) => e,
+    );
+    expect(error).toBeInstanceOf(TimeoutError);
+    expect((error as Error).message).toMatch(/timeout/);
+  }, 30_000);
+
+  it("fails pending calls if the worker dies, then starts a new one", async () => {
+    await startWorker("crash");
+    const calls = [
+      getVolumeMountPoints({ useWorkerThread: true }),
+      getVolumeMountPoints({ useWorkerThread: true }),
+    ];
+    for (const ea of calls) {
+      await expect(ea).rejects.toThrow(/exited with code 3/);
+    }
+    // The worker inherited the crash mode from the environment it started
+    // with; the next one starts without it.
+    delete env["PIPELINE_WORKER_MODE"];
+    const mountPoints = await getVolumeMountPoints({ useWorkerThread: true });
+    expect(mountPoints.length).toBeGreaterThan(0);
+  }, 30_000);
+
+  (isLinux ? describe : describe.skip)("event-loop delay", () => {
+    const MountCount = 100_000;
+    let dir: string;
+    let mtabPath: string;
+
+    beforeAll(async () => {
+      dir = await mkdtemp(join(tmpdir(), "fs-metadata-pipeline-"));
+      mtabPath = join(dir, "mtab");
+      // Mostly system volumes, so the result (and its decoding) stays small
+      // while parsing and filtering the table is measurably long.
+      const lines = times(MountCount, (i) =>
+        i % 100 === 0
+          ? `/dev/loop${i} ${dir}/mnt/vol-${i} ext4 rw 0 0`
+          : `tmpfs /run/user/${i} tmpfs rw,nosuid 0 0`,
+      );
+      await writeFile(mtabPath, lines.join("\n") + "\n");
+    });
+
+    afterAll(async () => {
+      await rm(dir, { recursive: true, force: true });
+    });
+
+    async function maxDelayMs(fn: () => Promise<unknown>): Promise<number> {
+      const histogram = monitorEventLoopDelay({ resolution: 1 });
+      histogram.enable();
+      try {
+        await fn();
+      } finally {
+        histogram.disable();
+      }
+      return histogram.max / 1e6;
+    }
+
+    it("stays well under the calling thread's", async () => {
+      await startWorker();
+      const opts = {
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: false,
+        yieldBudgetMs: 0,
+      };
+      // Start the worker, and warm up both threads:
+      await getVolumeMountPoints({ ...opts, useWorkerThread: true });
+      await getVolumeMountPoints(opts);
+
+      const onThread = await maxDelayMs(() => getVolumeMountPoints(opts));
+      const inWorker = await maxDelayMs(() =>
+        getVolumeMountPoints({ ...opts, useWorkerThread: true }),
+      );
+      // The table must be big enough for the comparison to mean anything:
+      expect(onThread).toBeGreaterThan(50);
+      expect(inWorker).toBeLessThan(onThread / 2);
+    }, 120_000);
+  });
+});
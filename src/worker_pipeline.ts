@@ -0,0 +1,277 @@
+// src/worker_pipeline.ts
+
+import { join } from "node:path";
+import { deserialize, serialize } from "node:v8";
+import { Worker } from "node:worker_threads";
+import { TimeoutError } from "./async";
+import { debug } from "./debuglog";
+import { defer } from "./defer";
+import { _dirname } from "./dirname";
+import { WrappedError } from "./error";
+import { existsSync } from "./fs";
+import { isNumber } from "./number";
+import { isNotBlank } from "./string";
+
+/**
+ * Public API calls that {@link Options.useWorkerThread} can route to the
+ * pipeline worker.
+ */
+export type PipelineMethod =
+  | "getVolumeMountPoints"
+  | "getVolumeMetadata"
+  | "getVolumeMetadataForPath"
+  | "getMountPointForPath"
+  | "getAllVolumeMetadata";
+
+export interface PipelineRequest {
+  id: number;
+  method: PipelineMethod;
+  args: unknown[];
+}
+
+export interface PipelineResponse {
+  id: number;
+  ok: boolean;
+  /**
+   * {@link encodePipelineResult} output. Its buffer is transferred, not
+   * copied.
+   */
+  payload: Uint8Array;
+}
+
+/**
+ * Worker script emitted by tsup next to index.cjs. Absent when running from
+ * source (as jest does), where calls fall back to the calling thread.
+ */
+export const PipelineWorkerScript = "worker_pipeline_entry.cjs";
+
+interface SerializedError {
+  /** `constructor.name`, used to rebuild known error classes. */
+  className: string;
+  name: string;
+  message: string;
+  stack?: string;
+  code?: string;
+  errno?: number;
+  syscall?: string;
+  path?: string;
+  cause?: SerializedError;
+}
+
+interface EncodedResult {
+  value: unknown;
+  /** Key paths of the errors in `value`; `[]` is `value` itself. */
+  errors: (string | number)[][];
+}
+
+function serializeError(error: Error): SerializedError {
+  const e = error as Error & Partial<SerializedError>;
+  return {
+    className: e.constructor?.name ?? "Error",
+    name: e.name,
+    message: e.message,
+    ...(isNotBlank(e.stack) ? { stack: e.stack } : {}),
+    ...(isNotBlank(e.code) ? { code: e.code } : {}),
+    ...(isNumber(e.errno) ? { errno: e.errno } : {}),
+    ...(isNotBlank(e.syscall) ? { syscall: e.syscall } : {}),
+    ...(isNotBlank(e.path) ? { path: e.path } : {}),
+    ...(e.cause instanceof Error ? { cause: serializeError(e.cause) } : {}),
+  };
+}
+
+// Replaces errors in `value` with SerializedErrors, copying only the arrays
+// and plain objects on the way to one, and records where each error was.
+function replaceErrors(
+  value: unknown,
+  keys: (string | number)[],
+  errors: (string | number)[][],
+): unknown {
+  if (value instanceof Error) {
+    errors.push([...keys]);
+    return serializeError(value);
+  }
+  if (value == null || typeof value !== "object") return value;
+  const isArray = Array.isArray(value);
+  if (!isArray && Object.getPrototypeOf(value) !== Object.prototype) {
+    return value;
+  }
+  let copy: Record<string | number, unknown> | undefined;
+  for (const [key, v] of Object.entries(value)) {
+    keys.push(isArray ? Number(key) : key);
+    const replaced = replaceErrors(v, keys, errors);
+    keys.pop();
+    if (replaced !== v) {
+      copy ??= (isArray ? [...value] : { ...value }) as Record<
+        string | number,
+        unknown
+      >;
+      copy[key] = replaced;
+    }
+  }
+  return copy ?? value;
+}
+
+// Built-in error classes that can be rebuilt as themselves.
+const BuiltinErrors: Record<string, ErrorConstructor> = {
+  Error,
+  EvalError,
+  RangeError,
+  ReferenceError,
+  SyntaxError,
+  TypeError,
+  URIError,
+};
+
+function reviveError(e: SerializedError): Error {
+  const details = {
+    ...(e.code == null ? {} : { code: e.code }),
+    ...(e.errno == null ? {} : { errno: e.errno }),
+    ...(e.syscall == null ? {} : { syscall: e.syscall }),
+    ...(e.path == null ? {} : { path: e.path }),
+  };
+  const Builtin = BuiltinErrors[e.className];
+  const error =
+    e.className === "TimeoutError"
+      ? new TimeoutError(e.message, false)
+      : Builtin != null
+        ? Object.assign(new Builtin(e.message), details)
+        : // WrappedError, and anything this thread has no class for:
+          new WrappedError(e.message, { name: e.name, ...details });
+  error.name = e.name;
+  if (e.cause != null) error.cause = reviveError(e.cause);
+  if (e.stack != null) error.stack = e.stack;
+  return error;
+}
+
+/**
+ * Serializes a pipeline result (or error) with the structured clone
+ * algorithm, as `v8.serialize()` does. Errors, including those nested in
+ * {@link getAllVolumeMetadata} results, keep their class, name, message,
+ * stack, cause, and errno details.
+ */
+export function encodePipelineResult(value: unknown): Uint8Array {
+  const errors: (string | number)[][] = [];
+  const buf = serialize({
+    value: replaceErrors(value, [], errors),
+    errors,
+  } satisfies EncodedResult);
+  // Only a buffer of its own can be transferred:
+  return buf.byteOffset === 0 && buf.byteLength === buf.buffer.byteLength
+    ? buf
+    : new Uint8Array(buf);
+}
+
+export function decodePipelineResult<T>(payload: Uint8Array): T {
+  const { value, errors } = deserialize(payload) as EncodedResult;
+  let result = value;
+  for (const keys of errors) {
+    const last = keys.at(-1);
+    if (last == null) {
+      result = reviveError(result as SerializedError);
+      continue;
+    }
+    let parent = result as Record<string | number, unknown>;
+    for (const key of keys.slice(0, -1)) {
+      parent = parent[key] as Record<string | number, unknown>;
+    }
+    parent[last] = reviveError(parent[last] as SerializedError);
+  }
+  return result as T;
+}
+
+const workerScript = defer(() => {
+  const file = join(_dirname(), PipelineWorkerScript);
+  if (existsSync(file)) return file;
+  debug("[worker_pipeline] %s not found; using the calling thread", file);
+  return undefined;
+});
+
+const pending = new Map<
+  number,
+  { resolve: (value: unknown) => void; reject: (error: Error) => void }
+>();
+let nextId = 1;
+let worker: Worker | undefined;
+let scriptForTest: string | undefined;
+
+function failAll(error: Error) {
+  for (const { reject } of pending.values()) reject(error);
+  pending.clear();
+}
+
+function getWorker(script: string): Worker {
+  if (worker != null) return worker;
+  const w = new Worker(script);
+  w.on("message", ({ id, ok, payload }: PipelineResponse) => {
+    const p = pending.get(id);
+    if (p == null) return;
+    pending.delete(id);
+    // An idle worker must not keep the process alive:
+    if (pending.size === 0) w.unref();
+    try {
+      const value = decodePipelineResult<unknown>(payload);
+      if (ok) p.resolve(value);
+      else p.reject(value as Error);
+    } catch (error) {
+      p.reject(
+        new WrappedError("worker_pipeline: bad response", { cause: error }),
+      );
+    }
+  });
+  w.on("error", (error) => {
+    debug("[worker_pipeline] worker error: %s", error);
+    if (worker === w) worker = undefined;
+    failAll(
+      new WrappedError("worker_pipeline: worker failed", { cause: error }),
+    );
+  });
+  w.on("exit", (code) => {
+    debug("[worker_pipeline] worker exited with code %d", code);
+    if (worker === w) worker = undefined;
+    failAll(new Error("worker_pipeline: worker exited with code " + code));
+  });
+  worker = w;
+  return w;
+}
+
+/**
+ * Runs `method` in the shared pipeline worker when `opts.useWorkerThread` is
+ * set. The main thread then sees one message per call: mount table parsing,
+ * glob matching, sorting and result assembly all happen in the worker.
+ *
+ * @returns undefined if the caller didn't opt in, or if the worker script
+ * isn't available; the caller then runs the pipeline itself.
+ */
+export function viaPipelineWorker<T>(
+  opts: { useWorkerThread?: boolean | undefined } | undefined,
+  method: PipelineMethod,
+  args: unknown[],
+): Promise<T> | undefined {
+  if (opts?.useWorkerThread !== true) return;
+  const script = scriptForTest ?? workerScript();
+  if (script == null) return;
+  return new Promise<T>((resolve, reject) => {
+    const w = getWorker(script);
+    const id = nextId++;
+    pending.set(id, {
+      resolve: resolve as (value: unknown) => void,
+      reject,
+    });
+    w.ref();
+    w.postMessage({ id, method, args } satisfies PipelineRequest);
+  });
+}
+
+/**
+ * Runs the pipeline worker from `script` instead of the bundled one (or from
+ * the bundled one again, given undefined), after stopping the current
+ * worker. Lets tests run the worker from TypeScript sources.
+ */
+export async function setPipelineWorkerScriptForTest(
+  script: string | undefined,
+): Promise<void> {
+  scriptForTest = script;
+  const w = worker;
+  worker = undefined;
+  await w?.terminate();
+}
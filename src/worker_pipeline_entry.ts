@@ -0,0 +1,63 @@
+// src/worker_pipeline_entry.ts
+//
+// Entry point of the pipeline worker started by src/worker_pipeline.ts. Runs
+// the public API with useWorkerThread forced off, and transfers each result
+// back as one encoded buffer.
+
+import { parentPort } from "node:worker_threads";
+import { toError } from "./error";
+import {
+  getAllVolumeMetadata,
+  getMountPointForPath,
+  getVolumeMetadata,
+  getVolumeMetadataForPath,
+  getVolumeMountPoints,
+} from "./index";
+import type {
+  PipelineMethod,
+  PipelineRequest,
+  PipelineResponse,
+} from "./worker_pipeline";
+import { encodePipelineResult } from "./worker_pipeline";
+
+const NoWorker = { useWorkerThread: false };
+
+type Handler = (args: unknown[]) => Promise<unknown>;
+
+const handlers: Record<PipelineMethod, Handler> = {
+  getVolumeMountPoints: ([opts]) =>
+    getVolumeMountPoints({ ...(opts as object), ...NoWorker }),
+  getVolumeMetadata: ([mountPoint, opts]) =>
+    getVolumeMetadata(mountPoint as string, {
+      ...(opts as object),
+      ...NoWorker,
+    }),
+  getVolumeMetadataForPath: ([pathname, opts]) =>
+    getVolumeMetadataForPath(pathname as string, {
+      ...(opts as object),
+      ...NoWorker,
+    }),
+  getMountPointForPath: ([pathname, opts]) =>
+    getMountPointForPath(pathname as string, {
+      ...(opts as object),
+      ...NoWorker,
+    }),
+  getAllVolumeMetadata: ([opts]) =>
+    getAllVolumeMetadata({ ...(opts as object), ...NoWorker }),
+};
+
+const port = parentPort;
+port?.on("message", ({ id, method, args }: PipelineRequest) => {
+  const reply = (ok: boolean, value: unknown) => {
+    const payload = encodePipelineResult(value);
+    port.postMessage({ id, ok, payload } satisfies PipelineResponse, [
+      payload.buffer as ArrayBuffer,
+    ]);
+  };
+  Promise.resolve()
+    .then(() => handlers[method](args))
+    .then(
+      (value) => reply(true, value),
+      (error) => reply(false, toError(error)),
+    );
+});
@@ -0,0 +1,164 @@
+// src/yield_budget.test.ts
+//
+// Post-processing a huge mount table must not hold the event loop for the
+// whole sweep: with yieldBudgetMs set, timers keep firing while it runs.
+//
+// Uses fake 20k- and 200k-entry mount tables and skips health checks, so only
+// the synchronous JavaScript work is measured.
+
+import { mkdtemp, rm, writeFile } from "node:fs/promises";
+import { tmpdir } from "node:os";
+import { join } from "node:path";
+import { times } from "./array";
+import { optionsWithDefaults } from "./options";
+import { runAdaptiveBenchmark } from "./test-utils/benchmark-harness";
+import { describePlatform } from "./test-utils/platform";
+import type { MountPoint } from "./types/mount_point";
+import type { NativeBindings } from "./types/native_bindings";
+import type { VolumeMetadata } from "./types/volume_metadata";
+import { getAllVolumeMetadataImpl } from "./volume_metadata";
+import { getVolumeMountPointsImpl } from "./volume_mount_points";
+
+describePlatform("linux")("yieldBudgetMs (Linux)", () => {
+  const MountCount = 20_000;
+  // Long enough to stall the event loop measurably on any host:
+  const LargeMountCount = 200_000;
+  let dir: string;
+  let mtabPath: string;
+  let largeMtabPath: string;
+
+  const nativeFnThatThrows = () => {
+    throw new Error("native bindings must not be used");
+  };
+
+  const sweep = (
+    yieldBudgetMs: number,
+    path = mtabPath,
+  ): Promise<MountPoint[]> =>
+    getVolumeMountPointsImpl(
+      {
+        ...optionsWithDefaults({
+          linuxMountTablePaths: [path],
+          includeSystemVolumes: false,
+          yieldBudgetMs,
+        }),
+        skipHealthCheck: true,
+      },
+      nativeFnThatThrows,
+    );
+
+  // Longest gap between 1ms interval ticks while `fn` runs.
+  async function longestStall(fn: () => Promise<unknown>): Promise<number> {
+    let last = performance.now();
+    let longest = 0;
+    const timer = setInterval(() => {
+      const now = performance.now();
+      longest = Math.max(longest, now - last);
+      last = now;
+    }, 1);
+    try {
+      // Let the interval start before the sweep does.
+      await new Promise((resolve) => setTimeout(resolve, 5));
+      last = performance.now();
+      await fn();
+      return Math.max(longest, performance.now() - last);
+    } finally {
+      clearInterval(timer);
+    }
+  }
+
+  const mountTable = (count: number) => {
+    const lines = times(count, (i) =>
+      i % 10 === 0
+        ? `tmpfs ${dir}/run/user/${i} tmpfs rw,nosuid 0 0`
+        : `/dev/loop${i} ${dir}/mnt/vol-${count - i} ext4 rw 0 0`,
+    );
+    // Duplicate mount points (overmounts) are collapsed:
+    lines.push(`/dev/sdz1 ${dir}/mnt/vol-1 ext4 rw 0 0`);
+    return lines.join("\n") + "\n";
+  };
+
+  beforeAll(async () => {
+    dir = await mkdtemp(join(tmpdir(), "fs-metadata-yield-"));
+    mtabPath = join(dir, "mtab");
+    largeMtabPath = join(dir, "mtab-large");
+    await writeFile(mtabPath, mountTable(MountCount));
+    await writeFile(largeMtabPath, mountTable(LargeMountCount));
+  });
+
+  afterAll(async () => {
+    await rm(dir, { recursive: true, force: true });
+  });
+
+  it("returns the same mount points with and without yielding", async () => {
+    const sliced = await sweep(1);
+    const unsliced = await sweep(0);
+    expect(sliced).toEqual(unsliced);
+    expect(sliced).toHaveLength(MountCount * 0.9);
+    expect(sliced.some((ea) => ea.fstype === "tmpfs")).toBe(false);
+    const mountPoints = sliced.map((ea) => ea.mountPoint);
+    expect(new Set(mountPoints).size).toBe(mountPoints.length);
+  });
+
+  it("keeps the event loop responsive during a sweep", async () => {
+    // Warm up, so neither run pays for compilation:
+    await sweep(0, largeMtabPath);
+    const unsliced = await longestStall(() => sweep(0, largeMtabPath));
+    const sliced = await longestStall(() => sweep(5, largeMtabPath));
+    // The workload must stall the loop measurably for the comparison to
+    // mean anything:
+    expect(unsliced).toBeGreaterThan(50);
+    expect(sliced).toBeLessThan(unsliced / 2);
+  }, 60_000);
+
+  it("shows less event-loop delay with a budget in the benchmark harness", async () => {
+    const results = [];
+    for (const yieldBudgetMs of [0, 10]) {
+      const result = await runAdaptiveBenchmark(
+        async () => {
+          await sweep(yieldBudgetMs, largeMtabPath);
+        },
+        {
+          targetDurationMs: 1_000,
+          maxTimeoutMs: 10_000,
+          minIterations: 2,
+          warmupIterations: 1,
+          measureEventLoopDelay: true,
+        },
+      );
+      results.push(result.eventLoopDelay);
+    }
+    const [unsliced, sliced] = results;
+    for (const ea of results) {
+      expect(ea?.p99Ms).toBeLessThanOrEqual(ea?.maxMs ?? 0);
+    }
+    expect(unsliced?.maxMs).toBeGreaterThan(50);
+    expect(sliced?.maxMs).toBeLessThan((unsliced?.maxMs ?? 0) / 2);
+  }, 60_000);
+
+  it("assembles getAllVolumeMetadata() results in mount-table order", async () => {
+    // Every mount point is missing, so all are unhealthy and none are probed.
+    const results = (await getAllVolumeMetadataImpl(
+      optionsWithDefaults({
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: true,
+        maxConcurrency: 64,
+        yieldBudgetMs: 1,
+      }),
+      () => ({}) as NativeBindings,
+    )) as (VolumeMetadata & { error?: Error })[];
+    const listed = await getVolumeMountPointsImpl(
+      optionsWithDefaults({
+        linuxMountTablePaths: [mtabPath],
+        includeSystemVolumes: true,
+      }),
+      nativeFnThatThrows,
+    );
+    expect(results.map((ea) => ea.mountPoint)).toEqual(
+      listed.map((ea) => ea.mountPoint),
+    );
+    for (const ea of results) {
+      expect(ea.error?.name).toBe("Skipped");
+    }
+  }, 60_000);
+});
@@ -1,7 +1,14 @@
 import { defineConfig } from "tsup";
 
 export default defineConfig({
-  entry: ["src/index.ts"],
+  entry: {
+    index: "src/index.ts",
+    // Lightweight subpath exports: see package.json "exports"
+    hidden: "src/hidden_entry.ts",
+    "mount-points": "src/mount_points_entry.ts",
+    // The pipeline worker is loaded by path at runtime; see src/worker_pipeline.ts
+    worker_pipeline_entry: "src/worker_pipeline_entry.ts",
+  },
   format: ["cjs", "esm"],
   dts: true, // Generate .d.ts files automatically
   clean: true, // Clean dist before each build